@@ -22,30 +22,51 @@
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QJsonObject>
 #include <QMetaObject>
 #include <QString>
 #include <QStringList>
-#include <QTextStream>
 
 #include <QtConcurrent>
 
 #include "Functions.hpp"
 #include "Macros.hpp"
+#include "Profiler.hpp"
 
+#include "ColumnarFile.hpp"
 #include "ConcurrentWatcher.hpp"
+#include "InputReader.hpp"
 #include "Scan.hpp"
 #include "ScanArray.hpp"
+#include "ShardFile.hpp"
 
 #include "Console.hpp"
 
+const QString As::Console::DEFAULT_SOCKET_NAME = "davinci-console";
+
 /*!
     Constructs a console version of the application with command line parser.
 */
 As::Console::Console(QObject* parent)
-    : QObject(parent) {
+    : QObject(parent),
+      m_scans(new As::ScanArray) {
     As::SetDebugOutputFormat(IS_DEBUG_OR_PROFILE);
+    As::Profiler::instance().setEnabled(true);
     createCommandLineParser(qApp); }
 
+/*!
+    Constructs a console worker processing the single \a job of the jobs manifest
+    or of the server request.
+    The worker doesn't parse the command line and keeps its messages, so that they
+    can be printed later in the summary.
+*/
+As::Console::Console(const As::Console::Job& job,
+                     QObject* parent)
+    : QObject(parent),
+      m_job(job),
+      m_scans(new As::ScanArray),
+      m_isWorker(true) {}
+
 /*!
     Destroys the console.
 */
@@ -53,30 +74,134 @@ As::Console::~Console() {
     ADESTROYED; }
 
 /*!
-    Starts the data processing.
+    Starts the data processing, or the server, or sends the request to the server,
+    depending on the command line options. The result is given by exitCode().
 */
 void As::Console::run() {
     printAppDescription();
+    m_exitCode = 1;
+
+    if (!setThreadCounts()) {
+        return; }
+
+    if (m_parser.isSet("serve")) {
+        m_exitCode = serve(socketName()) ? 0 : 1;
+        return; }
+    if (m_parser.isSet("stop")) {
+        m_exitCode = stopServer(socketName()) ? 0 : 1;
+        return; }
+    if (m_parser.isSet("merge")) {
+        m_job = jobFromCommandLine();
+        if (mergeShards(m_parser.positionalArguments())) {
+            printProgramOutput();
+            printProfile();
+            m_exitCode = 0; }
+        return; }
+    if (m_parser.isSet("jobs")) {
+        m_exitCode = runManifest(m_parser.value("jobs"));
+        printProfile();
+        return; }
 
     if (!checkRequiredOptionsAreProvided(QStringList{ "path" }))
         return;
-    if (!setOutputFileExt()) {
+
+    const Job job = jobFromCommandLine();
+
+    if (m_parser.isSet("submit")) {
+        m_exitCode = submit(socketName(), job) ? 0 : 1;
         return; }
-    if (!openFiles()) {
+
+    if (!processJob(job)) {
         return; }
+
+    printProgramOutput();
+    printProfile();
+    m_exitCode = 0; }
+
+/*!
+    Returns the exit code of the application: 0 on success, otherwise non-zero.
+*/
+int As::Console::exitCode() const {
+    return m_exitCode; }
+
+/*!
+    Returns the processing request given by the command line options. The paths are
+    made absolute, so that the request can be processed by a server started elsewhere.
+*/
+As::Console::Job As::Console::jobFromCommandLine() const {
+    Job job;
+    job.path = m_parser.value("path").isEmpty() ? QString() : QFileInfo(m_parser.value("path")).absoluteFilePath();
+    job.output = m_parser.value("output").isEmpty() ? QString() : QFileInfo(m_parser.value("output")).absoluteFilePath();
+    job.format = m_parser.value("format");
+    job.fit = m_parser.value("fit");
+    job.shard = m_parser.value("shard");
+    job.laue = m_parser.value("laue");
+    job.repeats = m_parser.value("repeats");
+    job.useCache = !m_parser.isSet("no-cache");
+    return job; }
+
+/*!
+    Processes the single request \a job: reads the input files, treats all the scans
+    and saves the output table. Returns true on success.
+*/
+bool As::Console::processJob(const As::Console::Job& job) {
+    return loadJob(job) AND treatJob(); }
+
+/*!
+    Reads the input files of the request \a job and extracts their scans. This part
+    is limited by the disk access and is done in the calling thread only, so that
+    the thread pool stays free for the treatment. Returns true on success.
+*/
+bool As::Console::loadJob(const As::Console::Job& job) {
+    m_job = job;
+    m_scans.reset(new As::ScanArray);
+
+    if (!setOutputFileExt()) {
+        return false; }
+    if (!setPeakFitType()) {
+        return false; }
+    if (!setMergeGroup()) {
+        return false; }
+    if (!setRepeatPolicy()) {
+        return false; }
+    m_scans->setRepeatPolicy(m_repeatPolicy);
+    if (!setShard()) {
+        return false; }
+    if (!openFiles()) {
+        return false; }
+
+    // The shard beyond the end of a small dataset is empty, but still has to be saved for merging
+    if (m_scans->m_inputFilesContents.first.isEmpty()) {
+        return true; }
+
     if (!detectInputFilesType()) {
-        return; }
+        return false; }
+
+    extractFiles();
+    m_scans->saveSessionCache();
+    printMessage(QString("Number of treated files:  %1").arg(m_scans->m_inputFilesContents.first.size()));
+
+    return true; }
+
+/*!
+    Treats all the scans extracted by loadJob() in parallel and saves the output
+    table. Returns true on success.
+*/
+bool As::Console::treatJob() {
+    if (m_scans->m_inputFilesContents.first.isEmpty()) {
+        return exportOutputTable(); }
 
     // Process the data using Multi-Thread (concurrentRun)
-    concurrentRun("extract", &m_scans);
-    printMessage(QString("Number of treated files:  %1").arg(m_scans.m_inputFilesContents.first.size()));
-    concurrentRun("fill", &m_scans);
-    concurrentRun("index", &m_scans);
-    concurrentRun("treat", &m_scans);
-    printMessage(QString("Number of treated reflections:  %1").arg(m_scans.size()));
+    concurrentRun("fill", m_scans.data());
+    concurrentRun("index", m_scans.data());
+    if (m_isPeakFit) {
+        for (int i = 0; i < m_scans->size(); ++i) {
+            m_scans->at(i)->setPeakAnalysisType(As::Scan::PeakFit);
+            m_scans->at(i)->setPeakFitType(m_peakFitType); } }
+    concurrentRun("treat", m_scans.data());
+    printMessage(QString("Number of treated reflections:  %1").arg(m_scans->size()));
 
-    exportOutputTable();
-    printProgramOutput(); }
+    return exportOutputTable(); }
 
 /*!
     Returns the application description.
@@ -88,7 +213,7 @@ QString As::Console::applicationDescription() const {
     Returns the format of the output file. Default value: "General".
 */
 QString As::Console::outputFileFormat() const {
-    return m_parser.value("format").isEmpty() ? "General" : m_parser.value("format"); }
+    return m_job.format.isEmpty() ? "General" : m_job.format; }
 
 /*!
     Sets the extension of the output file. Default value: "csv"
@@ -116,6 +241,9 @@ bool As::Console::setOutputFileExt() {
     else if (format.contains("ccsl")) {
         m_outputFileExt = "fli"; }
 
+    else if (format.contains("binary")) {
+        m_outputFileExt = As::ColumnarFile::EXTENSION; }
+
     else {
         printMessage(QString("Unknown output file format '%1'").arg(format));
         printMessage("Run the program with '--help' or '-h' to see more.");
@@ -123,6 +251,94 @@ bool As::Console::setOutputFileExt() {
 
     return true; }
 
+/*!
+    Sets the number of the treatment and file reading threads given by the user.
+*/
+bool As::Console::setThreadCounts() {
+    const QStringList options = { "threads", "io-threads" };
+
+    for (const QString& option : options) {
+        if (!m_parser.isSet(option)) {
+            continue; }
+
+        bool ok = false;
+        const int count = m_parser.value(option).toInt(&ok);
+        if (!ok OR count < 0) {
+            printMessage(QString("Wrong number of threads '%1' for '--%2'.").arg(m_parser.value(option), option));
+            printMessage("Run the program with '--help' or '-h' to see more.");
+            return false; }
+
+        if (option == "threads") {
+            As::ConcurrentWatcher::setThreadCount(count); }
+        else {
+            As::ConcurrentWatcher::setIoThreadCount(count); } }
+
+    return true; }
+
+/*!
+    Sets the peak profile function, if the peak fitting is requested. The fit results
+    are then added to the output table in addition to the conventional integration.
+*/
+bool As::Console::setPeakFitType() {
+
+    const QString type = m_job.fit.toLower();
+
+    if (type.isEmpty()) {
+        m_isPeakFit = false;
+        return true; }
+
+    if (type == "gauss") {
+        m_peakFitType = As::Scan::GaussFit; }
+
+    else if (type == "lorentz") {
+        m_peakFitType = As::Scan::LorentzFit; }
+
+    else if (type == "pseudo-voigt") {
+        m_peakFitType = As::Scan::PseudoVoigtFit; }
+
+    else {
+        printMessage(QString("Unknown peak fit function '%1'").arg(type));
+        printMessage("Run the program with '--help' or '-h' to see more.");
+        return false; }
+
+    m_isPeakFit = true;
+    return true; }
+
+/*!
+    Sets the group of the symmetry-equivalent reflections to be merged, if given by
+    the user.
+*/
+bool As::Console::setMergeGroup() {
+    m_isMerging = !m_job.laue.isEmpty();
+    if (!m_isMerging) {
+        return true; }
+
+    if (!m_merger.setGroup(m_job.laue)) {
+        printMessage(QString("Unknown Laue class or point group '%1'").arg(m_job.laue));
+        printMessage("Run the program with '--help' or '-h' to see more.");
+        return false; }
+
+    return true; }
+
+/*!
+    Sets the policy of the export of the repeated measurements, if given by the user.
+    All the measurements are kept by default.
+*/
+bool As::Console::setRepeatPolicy() {
+    const QString name = m_job.repeats.toLower();
+
+    if (name.isEmpty()) {
+        m_repeatPolicy = As::RepeatedMeasurements::KeepAll;
+        return true; }
+
+    if (!As::RepeatedMeasurements::PolicyNameDict.values().contains(name)) {
+        printMessage(QString("Unknown policy of the repeated measurements '%1'").arg(name));
+        printMessage("Run the program with '--help' or '-h' to see more.");
+        return false; }
+
+    m_repeatPolicy = As::RepeatedMeasurements::PolicyNameDict.key(name);
+    return true; }
+
 /*!
     Returns the extension of the output file.
 */
@@ -130,23 +346,33 @@ QString As::Console::outputFileExt() const {
     return m_outputFileExt; }
 
 /*!
-    Returns the name of the output file.
+    Returns the name of the output file. If it is not given by the user, the file
+    is named after the 1st and the last scans, or after the input path if there are
+    no scans.
 */
 QString As::Console::outputFileName() const {
-    const auto firstScan = m_scans.at(0);
-    const auto lastScan = m_scans.at( m_scans.size() - 1 );
+    if (!m_job.output.isEmpty()) {
+        return m_job.output; }
+
+    if (m_scans->size() == 0) {
+        const QFileInfo inputInfo(m_job.path);
+        return QDir(inputInfo.absolutePath()).filePath(inputInfo.completeBaseName()); }
+
+    const auto firstScan = m_scans->at(0);
+    const auto lastScan = m_scans->at( m_scans->size() - 1 );
 
     const QString baseNameFirst = firstScan->baseName();
     const QString baseNameLast = lastScan->baseName();
     const QString absolutePathLast = lastScan->absolutePath();
-    const QString pathWithName = FormatToPathWithName(baseNameFirst, baseNameLast, absolutePathLast);
-
-    return m_parser.value("output").isEmpty() ? pathWithName : m_parser.value("output"); }
+    return FormatToPathWithName(baseNameFirst, baseNameLast, absolutePathLast); }
 
 /*!
-    Returns the name with extension of the output file.
+    Returns the name with extension of the output file. The shard file is named after
+    the shard, e.g. "output.2-of-8.shard".
 */
 QString As::Console::outputFileNameWithExt() const {
+    if (isShard()) {
+        return QString("%1.%2-of-%3.%4").arg(outputFileName()).arg(m_shardIndex).arg(m_shardCount).arg(As::ShardFile::EXTENSION); }
     return outputFileName() + "." + outputFileExt(); }
 
 /*!
@@ -165,9 +391,26 @@ void As::Console::createCommandLineParser(QCoreApplication* app) {
     m_parser.setApplicationDescription(qPrintable(text));
 
     m_parser.addHelpOption();
-    m_parser.addOptions({{{"p", "path" },   "File/dir to open.", "file/dir" },
+    m_parser.addOptions({{{"p", "path" },   "File/dir to open, also .gz, .tar, .tar.gz, .tgz or .zip.", "file/dir" },
         {{"o", "output" }, "File to save output data.", "file" },
-        {{"f", "format" }, "Output file format <type>: general, shelx, tbar, umweg, ccsl.", "type" }, });
+        {{"f", "format" }, "Output file format <type>: general, shelx, tbar, umweg, ccsl, binary.", "type" },
+        {"profile", "File to save the profiling report (time per stage, counters) in JSON format.", "file" },
+        {"fit", "Fit the peaks with the profile <function>: gauss, lorentz, pseudo-voigt.", "function" },
+        {"no-cache", "Do not use the session cache of the extracted scans." },
+        {"threads", "Number of threads <count> to treat the scans. Default: one per processor core.", "count" },
+        {"io-threads", "Number of separate threads <count> to read the files. Default: the treatment threads are used.", "count" },
+        {"laue", QString("Merge the symmetry-equivalent reflections of the Laue class or the point group <name>: %1.")
+                 .arg(As::ReflectionMerger::groupNames().join(", ")), "name" },
+        {"repeats", QString("Export the reflections measured repeatedly at the same conditions by <policy>: %1. Default: all.")
+                    .arg(As::RepeatedMeasurements::PolicyNameDict.values().join(", ")), "policy" },
+        {"shard", "Process only the part <i/N> of the input files sorted by name and save it for '--merge'.", "i/N" },
+        {"merge", "Merge the shard files given as arguments into the output file." },
+        {"jobs", "Process all the datasets listed in the JSON <manifest> on the shared thread pool.", "manifest" },
+        {"serve", "Keep running and process the requests sent by '--submit'." },
+        {"submit", "Send the request to the running server instead of processing it here." },
+        {"stop", "Stop the running server." },
+        {"socket", QString("Local socket <name> of the server. Default: %1.").arg(DEFAULT_SOCKET_NAME), "name" }, });
+    m_parser.addPositionalArgument("shards", "Shard files to merge with '--merge'.", "[shards...]");
 
     // Link parser to application
     m_parser.process(*app); }
@@ -177,7 +420,7 @@ void As::Console::createCommandLineParser(QCoreApplication* app) {
 */
 bool As::Console::openFiles() {
 
-    const QString& path = m_parser.value("path");
+    const QString& path = m_job.path;
     const QFileInfo fileInfo(path);
     QStringList filePathList;
 
@@ -194,6 +437,19 @@ bool As::Console::openFiles() {
                      .arg(QDir::toNativeSeparators(path)));
         return false; }
 
+    // Keep only the files of the current shard
+    if (isShard()) {
+        int first = 0;
+        int last = 0;
+        As::ShardFile::fileRange(filePathList.size(), m_shardIndex, m_shardCount, first, last);
+        m_datasetFileCount = filePathList.size();
+        m_shardFirstFileIndex = first;
+        filePathList = filePathList.mid(first, last - first);
+        printMessage(QString("Shard %1/%2:  %3 of %4 files")
+                     .arg(m_shardIndex).arg(m_shardCount).arg(filePathList.size()).arg(m_datasetFileCount));
+        if (filePathList.isEmpty()) {
+            return true; } }
+
     if (!loadData(filePathList)) {
         return false; }
 
@@ -203,21 +459,34 @@ bool As::Console::openFiles() {
     Loads the file(s) according to the given list of file path \a filePathList.
 */
 bool As::Console::loadData(const QStringList& filePathList) {
-    for (const auto& path : filePathList) {
-        QFile file(path);
-        if (!file.open(QFile::ReadOnly | QFile::Text)) {
-            printMessage(QString("Cannot read file '%1': %2.")
-                         .arg(QDir::toNativeSeparators(path), file.errorString()));
-            return false; }
-
-        // Read file content to QStringList using QTextStream
-        QTextStream textStream(&file);
-        textStream.setAutoDetectUnicode(true);
-        textStream.setCodec("MacRoman"); // "ISO 8859-1", "UTF-8", "UTF-16", "MacRoman" (POLI)?!
+    As::ProfilerStage profilerStage("load");
+
+    // Skip reading of the files, if all their scans can be restored from the session cache
+    if (m_job.useCache) {
+        m_scans->m_inputFilesContents.first = filePathList;
+        const bool cached = m_scans->loadSessionCache();
+        m_scans->m_inputFilesContents.first.clear();
+
+        if (cached) {
+            for (const auto& path : filePathList) {
+                m_scans->m_inputFilesContents.first  << path;
+                m_scans->m_inputFilesContents.second << QString(); }
+            As::Profiler::instance().addCounter("load", "cached files", filePathList.size());
+            return true; } }
+
+    // Read the files and the archive members in parallel, add their paths and contents to the member variable
+    QString error;
+    if (!As::InputReader::readFiles(filePathList,
+                                    m_scans->m_inputFilesContents.first,
+                                    m_scans->m_inputFilesContents.second,
+                                    error,
+                                    "MacRoman")) { // "ISO 8859-1", "UTF-8", "UTF-16", "MacRoman" (POLI)?!
+        printMessage(error);
+        return false; }
 
-        // Add file path and content to the member variable
-        m_scans.m_inputFilesContents.first  << path;
-        m_scans.m_inputFilesContents.second << textStream.readAll(); }
+    As::Profiler::instance().addCounter("load", "files", m_scans->m_inputFilesContents.first.size());
+    for (const auto& path : filePathList) {
+        As::Profiler::instance().addCounter("load", "bytes read", QFileInfo(path).size()); }
 
     return true; }
 
@@ -225,18 +494,76 @@ bool As::Console::loadData(const QStringList& filePathList) {
     Detects a type of the input files.
 */
 bool As::Console::detectInputFilesType() {
-    if (!m_scans.detectInputFilesType()) {
+    As::ProfilerStage profilerStage("detect");
+
+    if (!m_scans->detectInputFilesType()) {
         printMessage("Files of multiple types were selected for opening. "
                      "Please open the files of the same type only.");
+        printMessageList(m_scans->inputFilesTypesReport());
+        return false; }
+    return true; }
+
+/*!
+    Exports the output table to disk. The shard is saved in the intermediate format
+    instead, with all the result columns to be merged alike. Returns true on success.
+*/
+bool As::Console::exportOutputTable() {
+    m_scans->createFullOutputTable(isShard());
+    if (isShard()) {
+        return exportShard(); }
+    printRepeatedMeasurements();
+    if (!mergeEquivalents()) {
+        return false; }
+    m_scans->saveSelectedOutputColumns(outputFileNameWithExt(), outputFileFormat());
+    return true; }
+
+/*!
+    Replaces the output table by the merged symmetry-equivalent reflections, if the
+    merging is requested, and prints the merging statistics. The shards are merged
+    only after they are combined. Returns true on success.
+*/
+bool As::Console::mergeEquivalents() {
+    if (!m_isMerging) {
+        return true; }
+
+    // The repeated measurements are treated first, so that they are not merged as equivalents
+    QVector<int> rows;
+    const As::ResultTable table = m_scans->exportedTable(rows);
+
+    As::ResultTable merged;
+    if (!m_merger.merge(table, rows, merged)) {
+        printMessage("Cannot merge the reflections without the Miller indices and the structure factors.");
         return false; }
+    m_scans->m_outputTable = merged;
+
+    printMessage(QString("Merged in the group %1:  %2 unique reflections")
+                 .arg(m_merger.group()).arg(merged.rowCount()));
+    if (m_merger.skippedCount() > 0) {
+        printMessage(QString("Skipped reflections with non-integer indices:  %1").arg(m_merger.skippedCount())); }
+    for (const As::ReflectionMerger::Statistics& statistics : m_merger.statistics()) {
+        printMessage(QString("Sf2%1:  %2 observations, %3 unique, Rint %4, chi2 %5")
+                     .arg(statistics.beamType)
+                     .arg(statistics.observationCount)
+                     .arg(statistics.uniqueCount)
+                     .arg(statistics.rInt, 0, 'f', 4)
+                     .arg(statistics.chi2, 0, 'f', 2)); }
+
     return true; }
 
 /*!
-    Exports the output table to disk.
+    Prints the number of the reflections measured repeatedly and how they are exported.
 */
-void As::Console::exportOutputTable() {
-    m_scans.createFullOutputTable();
-    m_scans.saveSelectedOutputColumns(outputFileNameWithExt(), outputFileFormat()); }
+void As::Console::printRepeatedMeasurements() const {
+    const As::RepeatedMeasurements& repeats = m_scans->repeatedMeasurements();
+    if (repeats.groups().isEmpty()) {
+        return; }
+
+    printMessage(QString("Repeatedly measured reflections:  %1 (%2 repeats), export policy: %3")
+                 .arg(repeats.groups().size())
+                 .arg(repeats.repeatCount())
+                 .arg(As::RepeatedMeasurements::PolicyNameDict.value(m_repeatPolicy)));
+    if (repeats.skippedCount() > 0) {
+        printMessage(QString("Not checked for repeats, as the indices are non-integer:  %1").arg(repeats.skippedCount())); } }
 
 /*!
     Checks if all the required options \a optionList are provided by the user.
@@ -255,6 +582,11 @@ bool As::Console::checkRequiredOptionsAreProvided(const QStringList& optionList)
 */
 void As::Console::printMessage(const QString& message,
                                const QString& arg) const {
+    // The worker collects them to be sent back to the client in the serve mode, or to be printed in the jobs summary
+    if (m_isWorker) {
+        m_messages << (arg.isEmpty() ? message : QString(message).replace("%s", arg).trimmed());
+        return; }
+
     if (arg.isEmpty()) {
         fprintf(stderr, "%s\n", qUtf8Printable(message)); }
     else {
@@ -284,6 +616,43 @@ void As::Console::printProgramOutput() const {
 
     printMessageList(messageList); }
 
+/*!
+    Prints the profiling summary. If the '--profile' option is given, the profiling
+    report is also saved in JSON format to the file specified by the user.
+*/
+void As::Console::printProfile() const {
+    printMessageList(QStringList{ "", "Profiling summary:" });
+    printMessageList(As::Profiler::instance().summary());
+
+    const QString fileName = m_parser.value("profile");
+    if (fileName.isEmpty()) {
+        return; }
+
+    const QJsonObject info{
+        { "application", APP_NAME },
+        { "version", APP_VERSION },
+        { "input", m_job.path },
+        { "format", outputFileFormat() } };
+
+    if (As::Profiler::instance().saveJson(fileName, info)) {
+        printMessage(QString("Profiling report:  %1").arg(QDir::toNativeSeparators(fileName))); }
+    else {
+        printMessage(QString("Cannot write profiling report '%1'.").arg(QDir::toNativeSeparators(fileName))); } }
+
+/*!
+    Extracts the scans from all the input files one by one in the calling thread, in
+    order to keep the scans order.
+*/
+void As::Console::extractFiles() {
+    As::ProfilerStage profilerStage("extract");
+
+    const int count = m_scans->m_inputFilesContents.first.size();
+    As::Profiler::instance().addCounter("extract", "files", count);
+
+    for (int i = 0; i < count; ++i) {
+        As::ProfilerItem profilerItem("extract", i);
+        m_scans->extractDataFromFile(i); } }
+
 /*!
     Starts parallel computation of type \a type on the scan array \a scans.
 */
@@ -22,13 +22,22 @@
 #define AS_CONSOLE_HPP
 
 #include <QCommandLineParser>
+#include <QJsonObject>
+#include <QList>
 #include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
 
+#include "ReflectionMerger.hpp"
+#include "RepeatedMeasurements.hpp"
+#include "Scan.hpp"
 #include "ScanArray.hpp"
 
 class QCoreApplication;
+class QLocalServer;
+class QLocalSocket;
 class QString;
-class QStringList;
+class QThreadPool;
 
 namespace As { //AS_BEGIN_NAMESPACE
 
@@ -36,20 +45,72 @@ class Console : public QObject {
     Q_OBJECT
 
   public:
+    // Processing request, given either by the command line or by a client in the serve mode
+    struct Job {
+        QString path;
+        QString output;
+        QString format;
+        QString fit;
+        QString shard;
+        QString laue;
+        QString repeats;
+        bool useCache = true;
+
+        static Job fromJson(const QJsonObject& json);
+        QJsonObject toJson() const; };
+
+    static const QString DEFAULT_SOCKET_NAME;
+
     Console(QObject* parent = Q_NULLPTR);
+    Console(const As::Console::Job& job,
+            QObject* parent = Q_NULLPTR);
     ~Console();
 
     void createCommandLineParser(QCoreApplication* app);
 
+    int exitCode() const;
+
+    As::Console::Job jobFromCommandLine() const;
+    bool processJob(const As::Console::Job& job);
+    bool loadJob(const As::Console::Job& job);
+    bool treatJob();
+
+    // Jobs.cpp
+    static bool readManifest(const QString& filePath,
+                             QList<As::Console::Job>& jobs,
+                             QString& error);
+    int runManifest(const QString& filePath);
+
+    // Serve.cpp
+    QString socketName() const;
+    bool serve(const QString& name);
+    bool isServing() const;
+    bool submit(const QString& name,
+                const As::Console::Job& job);
+    bool stopServer(const QString& name);
+
+    // Shard.cpp
+    bool setShard();
+    bool isShard() const;
+    bool exportShard();
+    bool mergeShards(const QStringList& filePaths);
+
     bool checkRequiredOptionsAreProvided(const QStringList& optionList) const;
     bool setOutputFileExt();
+    bool setPeakFitType();
+    bool setMergeGroup();
+    bool setRepeatPolicy();
+    bool setThreadCounts();
     bool openFiles();
     bool loadData(const QStringList& filePathList);
     bool detectInputFilesType();
 
+    void extractFiles();
     void concurrentRun(const QString& type,
                        As::ScanArray* scans) const;
-    void exportOutputTable();
+    bool exportOutputTable();
+    bool mergeEquivalents();
+    void printRepeatedMeasurements() const;
 
     void printMessage(const QString& message,
                       const QString& arg = QString()) const;
@@ -57,6 +118,7 @@ class Console : public QObject {
 
     void printAppDescription() const;
     void printProgramOutput() const;
+    void printProfile() const;
 
     QString applicationDescription() const;
     QString outputFileFormat() const;
@@ -71,9 +133,37 @@ class Console : public QObject {
     void finished() const;
 
   private:
+    // Serve.cpp
+    void acceptConnections();
+    void readRequests(QLocalSocket* socket);
+    void sendResponse(QLocalSocket* socket,
+                      const QJsonObject& response) const;
+    void stopServing();
+    QJsonObject handleJob(const As::Console::Job& job) const;
+    bool sendRequest(const QString& name,
+                     const QJsonObject& request,
+                     QJsonObject* response) const;
+
     QCommandLineParser m_parser;
-    As::ScanArray m_scans;
-    QString m_outputFileExt; };
+    Job m_job;
+    QScopedPointer<As::ScanArray> m_scans;  // Recreated for every job
+    QLocalServer* m_server = Q_NULLPTR;
+    QThreadPool* m_requestPool = Q_NULLPTR; // Processes the requests of the clients one by one
+    int m_pendingRequestCount = 0;
+    bool m_isStopping = false;
+    mutable QStringList m_messages;         // Messages of the worker, to be sent to the client or printed in the summary
+    QString m_outputFileExt;
+    int m_shardIndex = 0;
+    int m_shardCount = 0;                   // 0 if the whole dataset is processed
+    int m_datasetFileCount = 0;             // Number of the input files of the whole dataset
+    int m_shardFirstFileIndex = 0;
+    bool m_isPeakFit = false;
+    bool m_isMerging = false;
+    As::ReflectionMerger m_merger;
+    As::RepeatedMeasurements::Policy m_repeatPolicy = As::RepeatedMeasurements::KeepAll;
+    bool m_isWorker = false;                // Messages are kept for the summary instead of being printed
+    int m_exitCode = 0;
+    As::Scan::PeakFitType m_peakFitType = As::Scan::GaussFit; };
 
 } //AS_END_NAMESPACE
 
@@ -0,0 +1,221 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QList>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <QtConcurrent>
+
+#include "Macros.hpp"
+
+#include "ConcurrentWatcher.hpp"
+#include "ScanArray.hpp"
+
+#include "Console.hpp"
+
+/*
+    Jobs mode of the console application.
+
+    The manifest is a JSON array of the processing requests, with the same keys as
+    the requests of the serve mode, e.g.
+
+        [ {"path": "sample1", "format": "shelx", "output": "sample1"},
+          {"path": "sample2/scans", "format": "umweg", "fit": "gauss"} ]
+
+    The relative paths are resolved against the directory of the manifest.
+
+    Every dataset is processed by its own worker in two steps. The loading (reading
+    and extraction of the input files) is limited by the disk access and runs in the
+    calling thread of a small dedicated pool. The treatment runs on the shared
+    computation pool. Thus, the next datasets are already loaded while the previous ones are
+    treated. The number of datasets kept in memory at once is limited.
+*/
+
+namespace {
+
+const int LOADING_JOB_COUNT  = 2; // Datasets loaded at once, by default
+const int TREATING_JOB_COUNT = 2; // Datasets treated at once, sharing the computation thread pool
+
+const int EXIT_JOB_FAILED = 1;
+const int EXIT_MANIFEST_FAILED = 2;
+
+// What is kept of the processed dataset for the summary, after its scans are freed
+struct JobSummary {
+    QString outputFile;
+    int fileCount = 0;
+    int reflectionCount = 0; };
+
+}
+
+/*!
+    Reads the processing requests \a jobs from the manifest file \a filePath. Returns
+    false and sets the \a error message if the manifest can't be read.
+*/
+bool As::Console::readManifest(const QString& filePath,
+                               QList<As::Console::Job>& jobs,
+                               QString& error) {
+    jobs.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot read jobs manifest '%1': %2.").arg(QDir::toNativeSeparators(filePath), file.errorString());
+        return false; }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isArray()) {
+        const QString reason = parseError.error != QJsonParseError::NoError ? parseError.errorString() : "array of jobs is expected";
+        error = QString("Wrong jobs manifest '%1': %2.").arg(QDir::toNativeSeparators(filePath), reason);
+        return false; }
+
+    const QDir dir = QFileInfo(filePath).absoluteDir();
+    for (const QJsonValue& value : document.array()) {
+        Job job = Job::fromJson(value.toObject());
+        if (job.path.isEmpty()) {
+            error = QString("Job %1 of the manifest '%2' has no path.").arg(jobs.size() + 1).arg(QDir::toNativeSeparators(filePath));
+            jobs.clear();
+            return false; }
+
+        job.path = QFileInfo(dir, job.path).absoluteFilePath();
+        if (!job.output.isEmpty()) {
+            job.output = QFileInfo(dir, job.output).absoluteFilePath(); }
+        jobs << job; }
+
+    if (jobs.isEmpty()) {
+        error = QString("Jobs manifest '%1' contains no jobs.").arg(QDir::toNativeSeparators(filePath));
+        return false; }
+
+    return true; }
+
+/*!
+    Processes all the datasets listed in the manifest file \a filePath and prints the
+    summary of every dataset. Returns the exit code: 0 if all the datasets are
+    processed successfully, 1 if any of them failed, 2 if the manifest can't be read.
+*/
+int As::Console::runManifest(const QString& filePath) {
+    QList<Job> jobs;
+    QString error;
+    if (!readManifest(filePath, jobs, error)) {
+        printMessage(error);
+        return EXIT_MANIFEST_FAILED; }
+
+    const int count = jobs.size();
+    printMessage(QString("Number of jobs:  %1").arg(count));
+
+    QVector<QSharedPointer<As::Console>> workers;
+    for (const Job& job : jobs) {
+        workers << QSharedPointer<As::Console>(new As::Console(job)); }
+
+    QVector<int> exitCodes(count, EXIT_JOB_FAILED);
+    QVector<qint64> loadTimes(count, 0);
+    QVector<qint64> treatTimes(count, 0);
+    QVector<JobSummary> summaries(count);
+    JobSummary* summariesData = summaries.data();
+
+    // The number of the file reading threads, if given, is the number of datasets loaded at once
+    const int loadingJobCount = As::ConcurrentWatcher::ioThreadCount() > 0 ? As::ConcurrentWatcher::ioThreadCount() :
+                                                                             LOADING_JOB_COUNT;
+    QThreadPool loadPool;
+    loadPool.setMaxThreadCount(loadingJobCount);
+    QThreadPool treatPool;
+    treatPool.setMaxThreadCount(TREATING_JOB_COUNT);
+
+    // Every dataset holds its slot from the start of loading till the end of treatment
+    QSemaphore datasetSlots(loadingJobCount + TREATING_JOB_COUNT);
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    for (int i = 0; i < count; ++i) {
+        QtConcurrent::run(&loadPool, [&, i] () {
+            datasetSlots.acquire();
+
+            QElapsedTimer timer;
+            timer.start();
+            const bool isLoaded = workers.at(i)->loadJob(jobs.at(i));
+            loadTimes[i] = timer.elapsed();
+
+            if (!isLoaded) {
+                workers.at(i)->m_scans.reset();
+                datasetSlots.release();
+                return; }
+
+            QtConcurrent::run(&treatPool, [&, i, summariesData] () {
+                QElapsedTimer timer;
+                timer.start();
+                As::Console* worker = workers.at(i).data();
+                exitCodes[i] = worker->treatJob() ? 0 : EXIT_JOB_FAILED;
+                treatTimes[i] = timer.elapsed();
+
+                // Free the dataset before its slot is released, so that the memory does not grow with the manifest
+                if (exitCodes[i] == 0) {
+                    summariesData[i].outputFile = worker->outputFileNameWithExt();
+                    summariesData[i].fileCount = worker->m_scans->m_inputFilesContents.first.size();
+                    summariesData[i].reflectionCount = worker->m_scans->size(); }
+                worker->m_scans.reset();
+                datasetSlots.release(); }); }); }
+
+    // All the treatments are queued, once all the loadings are done
+    loadPool.waitForDone();
+    treatPool.waitForDone();
+
+    // Print the summary of every dataset
+    int failedCount = 0;
+    printMessageList(QStringList{ "", "Jobs summary:" });
+    for (int i = 0; i < count; ++i) {
+        const As::Console* worker = workers[i].data();
+        const bool isProcessed = exitCodes[i] == 0;
+
+        printMessage(QString("[%1/%2] %3  %4")
+                     .arg(i + 1).arg(count)
+                     .arg(isProcessed ? "ok   " : "error")
+                     .arg(QDir::toNativeSeparators(jobs[i].path)));
+
+        if (isProcessed) {
+            printMessage(QString("        Output file:  %1").arg(QDir::toNativeSeparators(summaries[i].outputFile)));
+            printMessage(QString("        Files: %1, reflections: %2, load: %3 ms, treat: %4 ms")
+                         .arg(summaries[i].fileCount)
+                         .arg(summaries[i].reflectionCount)
+                         .arg(loadTimes[i]).arg(treatTimes[i])); }
+        else {
+            ++failedCount;
+            for (const QString& message : worker->m_messages) {
+                printMessage(QString("        %1").arg(message)); } }
+
+        printMessage(QString("        Exit code:  %1").arg(exitCodes[i])); }
+
+    printMessageList(QStringList{ "",
+                                  QString("Datasets: %1 processed, %2 failed in %3 ms.")
+                                  .arg(count - failedCount).arg(failedCount).arg(totalTimer.elapsed()) });
+
+    return failedCount > 0 ? EXIT_JOB_FAILED : 0; }
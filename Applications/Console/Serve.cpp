@@ -0,0 +1,313 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "Macros.hpp"
+#include "Profiler.hpp"
+
+#include "ConcurrentWatcher.hpp"
+#include "ScanArray.hpp"
+
+#include "Console.hpp"
+
+/*
+    Serve mode of the console application.
+
+    The server keeps a warm process with the already built dictionaries and the
+    running threads of the thread pools. It listens on a local socket (Unix
+    domain socket or Windows named pipe) and processes the requests one by one
+    in the background, so that the event loop keeps accepting the clients while
+    a dataset is treated. Every request and response is a single line with a
+    compact JSON object. The stop request lets the queued requests finish.
+
+    Request:  {"path": "...", "output": "...", "format": "...", "fit": "...", "shard": "i/N", "laue": "mmm", "repeats": "latest", "useCache": true}
+              {"command": "stop"}
+    Response: {"status": "ok"|"error", "output": "...", "files": N, "scans": N,
+               "elapsedMs": N, "messages": [...], "profile": {...}}
+*/
+
+// Time to wait for the server to accept the connection
+static const int CONNECT_TIMEOUT_MS = 3000;
+
+// Time to wait for the response, including the queued requests of the other clients
+static const int RESPONSE_TIMEOUT_MS = 60 * 60 * 1000;
+
+/*!
+    Returns the processing request given by the JSON object \a json.
+*/
+As::Console::Job As::Console::Job::fromJson(const QJsonObject& json) {
+    Job job;
+    job.path = json.value("path").toString();
+    job.output = json.value("output").toString();
+    job.format = json.value("format").toString();
+    job.fit = json.value("fit").toString();
+    job.shard = json.value("shard").toString();
+    job.laue = json.value("laue").toString();
+    job.repeats = json.value("repeats").toString();
+    job.useCache = json.value("useCache").toBool(true);
+    return job; }
+
+/*!
+    Returns the processing request as a JSON object.
+*/
+QJsonObject As::Console::Job::toJson() const {
+    return QJsonObject{
+        { "path", path },
+        { "output", output },
+        { "format", format },
+        { "fit", fit },
+        { "shard", shard },
+        { "laue", laue },
+        { "repeats", repeats },
+        { "useCache", useCache } }; }
+
+/*!
+    Returns the name of the local socket of the server given by the user.
+*/
+QString As::Console::socketName() const {
+    return m_parser.value("socket").isEmpty() ? DEFAULT_SOCKET_NAME : m_parser.value("socket"); }
+
+/*!
+    Starts the server listening on the local socket \a name. The requests are then
+    received in the event loop of the application and processed in the background.
+    Returns false if the server cannot be started.
+*/
+bool As::Console::serve(const QString& name) {
+    // Do not take over the socket of the running server, but remove the one left by a crashed server
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(CONNECT_TIMEOUT_MS)) {
+        printMessage(QString("Server '%1' is already running.").arg(name));
+        return false; }
+    QLocalServer::removeServer(name);
+
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server->listen(name)) {
+        printMessage(QString("Cannot start server '%1': %2.").arg(name, m_server->errorString()));
+        delete m_server;
+        m_server = Q_NULLPTR;
+        return false; }
+
+    // Keep the worker threads alive between the requests
+    As::ConcurrentWatcher::computePool()->setExpiryTimeout(-1);
+    As::ConcurrentWatcher::ioPool()->setExpiryTimeout(-1);
+
+    // The requests share the thread pools and the profiler, so they are processed one by one
+    m_requestPool = new QThreadPool(this);
+    m_requestPool->setMaxThreadCount(1);
+    m_requestPool->setExpiryTimeout(-1);
+
+    connect(m_server, &QLocalServer::newConnection, this, &As::Console::acceptConnections);
+
+    printMessage(QString("Server is listening on '%1'.").arg(m_server->fullServerName()));
+    return true; }
+
+/*!
+    Returns true if the server is started and waits for the requests.
+*/
+bool As::Console::isServing() const {
+    return m_server != Q_NULLPTR AND m_server->isListening(); }
+
+/*!
+    Accepts the new connections of the clients.
+*/
+void As::Console::acceptConnections() {
+    while (m_server->hasPendingConnections()) {
+        QLocalSocket* socket = m_server->nextPendingConnection();
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readRequests(socket); }); } }
+
+/*!
+    Queues all the complete requests received from the client \a socket. The
+    responses are sent back by sendResponse() once the requests are processed.
+*/
+void As::Console::readRequests(QLocalSocket* socket) {
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue; }
+
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+        const QJsonObject request = document.object();
+
+        if (!document.isObject()) {
+            sendResponse(socket, QJsonObject{
+                { "status", "error" },
+                { "messages", QJsonArray{ QString("Wrong request: %1.").arg(error.errorString()) } } });
+            continue; }
+
+        if (request.value("command").toString() == "stop") {
+            sendResponse(socket, QJsonObject{ { "status", "ok" } });
+            socket->waitForBytesWritten(CONNECT_TIMEOUT_MS);
+            stopServing();
+            return; }
+
+        if (m_isStopping) {
+            sendResponse(socket, QJsonObject{
+                { "status", "error" },
+                { "messages", QJsonArray{ QString("Server is stopping.") } } });
+            continue; }
+
+        // The client may disconnect before its request is processed
+        const QPointer<QLocalSocket> client(socket);
+        const Job job = As::Console::Job::fromJson(request);
+        auto watcher = new QFutureWatcher<QJsonObject>(this);
+        connect(watcher, &QFutureWatcher<QJsonObject>::finished, this, [this, watcher, client]() {
+            --m_pendingRequestCount;
+            if (client) {
+                sendResponse(client, watcher->result()); }
+            watcher->deleteLater();
+            if (m_isStopping AND m_pendingRequestCount == 0) {
+                if (client) {
+                    client->waitForBytesWritten(CONNECT_TIMEOUT_MS); }
+                qApp->quit(); } });
+
+        ++m_pendingRequestCount;
+        watcher->setFuture(QtConcurrent::run(m_requestPool, [this, job]() {
+            return handleJob(job); })); } }
+
+/*!
+    Sends the \a response to the client \a socket.
+*/
+void As::Console::sendResponse(QLocalSocket* socket,
+                               const QJsonObject& response) const {
+    socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n');
+    socket->flush(); }
+
+/*!
+    Stops accepting the requests and quits once all the queued ones are answered.
+*/
+void As::Console::stopServing() {
+    printMessage("Server is stopped.");
+    m_isStopping = true;
+    m_server->close();
+    if (m_pendingRequestCount == 0) {
+        qApp->quit(); } }
+
+/*!
+    Processes the single request \a job by a separate worker console and returns
+    the response with the status, the output file, the timings and the messages.
+    Runs in the request thread.
+*/
+QJsonObject As::Console::handleJob(const As::Console::Job& job) const {
+    printMessage(QString("Request:  %1").arg(job.path));
+
+    As::Profiler::instance().clear();
+    QElapsedTimer timer;
+    timer.start();
+
+    As::Console worker(job);
+    const bool isProcessed = worker.processJob(job);
+
+    QJsonObject response{
+        { "status", isProcessed ? "ok" : "error" },
+        { "files", worker.m_scans->m_inputFilesContents.first.size() },
+        { "scans", worker.m_scans->size() },
+        { "elapsedMs", static_cast<double>(timer.elapsed()) },
+        { "messages", QJsonArray::fromStringList(worker.m_messages) },
+        { "profile", As::Profiler::instance().toJson() } };
+    if (isProcessed) {
+        response.insert("output", QFileInfo(worker.outputFileNameWithExt()).absoluteFilePath()); }
+
+    printMessage(QString("Response: %1 in %2 ms").arg(response.value("status").toString()).arg(timer.elapsed()));
+    return response; }
+
+/*!
+    Sends the \a request to the server with the local socket \a name and waits for
+    its \a response. Returns false if the server cannot be reached.
+*/
+bool As::Console::sendRequest(const QString& name,
+                              const QJsonObject& request,
+                              QJsonObject* response) const {
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (!socket.waitForConnected(CONNECT_TIMEOUT_MS)) {
+        printMessage(QString("Cannot connect to server '%1': %2.").arg(name, socket.errorString()));
+        return false; }
+
+    socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+    socket.flush();
+
+    // The processing may take long, but a hanging server must not block the client forever
+    QElapsedTimer timer;
+    timer.start();
+    while (!socket.canReadLine()) {
+        const int timeLeft = RESPONSE_TIMEOUT_MS - static_cast<int>(timer.elapsed());
+        if (timeLeft <= 0) {
+            printMessage(QString("Server '%1' didn't respond in %2 s.").arg(name).arg(RESPONSE_TIMEOUT_MS / 1000));
+            return false; }
+        if (!socket.waitForReadyRead(timeLeft)) {
+            if (socket.state() == QLocalSocket::ConnectedState) {
+                continue; }
+            printMessage(QString("Server '%1' closed the connection: %2.").arg(name, socket.errorString()));
+            return false; } }
+
+    *response = QJsonDocument::fromJson(socket.readLine()).object();
+    return true; }
+
+/*!
+    Sends the processing request \a job to the server with the local socket \a name
+    and prints its response. Returns true if the request is processed successfully.
+*/
+bool As::Console::submit(const QString& name,
+                         const As::Console::Job& job) {
+    QJsonObject response;
+    if (!sendRequest(name, job.toJson(), &response)) {
+        return false; }
+
+    for (const QJsonValue& message : response.value("messages").toArray()) {
+        printMessage(message.toString()); }
+
+    const bool isProcessed = response.value("status").toString() == "ok";
+    if (isProcessed) {
+        printMessageList(QStringList{
+            QString("Output file:  %1").arg(response.value("output").toString()),
+            QString("Processing time:  %1 ms").arg(response.value("elapsedMs").toDouble()),
+            "",
+            "The program is finished successfully." }); }
+
+    return isProcessed; }
+
+/*!
+    Asks the server with the local socket \a name to stop. Returns true if it is stopped.
+*/
+bool As::Console::stopServer(const QString& name) {
+    QJsonObject response;
+    if (!sendRequest(name, QJsonObject{ { "command", "stop" } }, &response)) {
+        return false; }
+
+    printMessage(QString("Server '%1' is stopped.").arg(name));
+    return true; }
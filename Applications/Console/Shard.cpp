@@ -0,0 +1,170 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QDir>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "Functions.hpp"
+#include "Macros.hpp"
+#include "Profiler.hpp"
+
+#include "Scan.hpp"
+#include "ScanArray.hpp"
+#include "ShardFile.hpp"
+
+#include "Console.hpp"
+
+/*
+    Sharded mode of the console application.
+
+    One huge dataset is split between several nodes, each of them started with the
+    same input path and output name, but with its own '--shard i/N'. Every node
+    processes its contiguous part of the input files sorted by name and saves the
+    full output table to "<output>.i-of-N.shard". Then '--merge' combines all the
+    shard files into the output file of the requested format, with the same row order
+    and scan numbers as a single-node run.
+*/
+
+/*!
+    Sets the shard to be processed according to the "i/N" specification of the
+    current job. Returns false if the specification is wrong.
+*/
+bool As::Console::setShard() {
+    m_shardIndex = 0;
+    m_shardCount = 0;
+    m_datasetFileCount = 0;
+    m_shardFirstFileIndex = 0;
+
+    if (m_job.shard.isEmpty()) {
+        return true; }
+
+    int index = 0;
+    int count = 0;
+    if (!As::ShardFile::parseSpec(m_job.shard, index, count)) {
+        printMessage(QString("Wrong shard '%1', expected 'i/N' with 1 <= i <= N.").arg(m_job.shard));
+        printMessage("Run the program with '--help' or '-h' to see more.");
+        return false; }
+
+    // The default output name depends on the files of the shard, so it can't be shared
+    if (m_job.output.isEmpty()) {
+        printMessage("Option '--output' is required with '--shard', so that all the shards are named alike.");
+        return false; }
+
+    m_shardIndex = index;
+    m_shardCount = count;
+    return true; }
+
+/*!
+    Returns true if only a part of the dataset is processed.
+*/
+bool As::Console::isShard() const {
+    return m_shardCount > 0; }
+
+/*!
+    Saves the output table of the current shard in the intermediate format.
+    Returns true on success.
+*/
+bool As::Console::exportShard() {
+    As::ProfilerStage profilerStage("export");
+
+    As::ShardFile shard;
+    shard.index = m_shardIndex;
+    shard.count = m_shardCount;
+    shard.fileCount = m_datasetFileCount;
+    shard.firstFileIndex = m_shardFirstFileIndex;
+    shard.inputFilesType = m_scans->m_inputFilesType;
+    shard.fit = m_isPeakFit ? m_job.fit.toLower() : QString();
+    shard.table = m_scans->m_outputTable;
+
+    if (m_scans->size() > 0) {
+        shard.firstBaseName = m_scans->at(0)->baseName();
+        shard.lastBaseName = m_scans->at(m_scans->size() - 1)->baseName();
+        shard.lastAbsolutePath = m_scans->at(m_scans->size() - 1)->absolutePath(); }
+
+    const QString fileName = outputFileNameWithExt();
+    if (!shard.save(fileName)) {
+        printMessage(QString("Cannot write shard file '%1'.").arg(QDir::toNativeSeparators(fileName)));
+        return false; }
+
+    return true; }
+
+/*!
+    Merges the shard files \a filePaths into the output file of the requested format.
+    If no output file is given, it is named after the 1st and the last scans of the
+    whole dataset. Returns true on success.
+*/
+bool As::Console::mergeShards(const QStringList& filePaths) {
+    m_scans.reset(new As::ScanArray);
+    m_shardCount = 0;
+
+    if (!setOutputFileExt()) {
+        return false; }
+
+    if (filePaths.isEmpty()) {
+        printMessage("No shard files are given to merge.");
+        printMessage("Run the program with '--help' or '-h' to see more.");
+        return false; }
+
+    QList<As::ShardFile> shards;
+    {
+        As::ProfilerStage profilerStage("load");
+        for (const QString& filePath : filePaths) {
+            As::ShardFile shard;
+            if (!shard.load(filePath)) {
+                printMessage(QString("Cannot read shard file '%1'.").arg(QDir::toNativeSeparators(filePath)));
+                return false; }
+            shards << shard; }
+    }
+
+    As::ShardFile merged;
+    QString error;
+    if (!As::ShardFile::merge(shards, merged, error)) {
+        printMessage(error);
+        return false; }
+
+    if (merged.table.rowCount() == 0) {
+        printMessage("The merged shards contain no scans.");
+        return false; }
+
+    if (m_job.output.isEmpty()) {
+        m_job.output = As::FormatToPathWithName(merged.firstBaseName, merged.lastBaseName, merged.lastAbsolutePath); }
+
+    m_scans->m_inputFilesType = merged.inputFilesType;
+    m_scans->m_outputTable = merged.table;
+    if (!setRepeatPolicy()) {
+        return false; }
+
+    // The repeats are found through the whole dataset, also across the shards
+    m_scans->setRepeatPolicy(m_repeatPolicy);
+    m_scans->linkRepeatedMeasurements();
+    printRepeatedMeasurements();
+
+    if (!setMergeGroup() OR !mergeEquivalents()) {
+        return false; }
+    m_scans->saveSelectedOutputColumns(outputFileNameWithExt(), outputFileFormat());
+
+    printMessage(QString("Number of merged shards:  %1").arg(shards.size()));
+    printMessage(QString("Number of treated files:  %1").arg(merged.fileCount));
+    printMessage(QString("Number of treated reflections:  %1").arg(merged.table.rowCount()));
+
+    return true; }
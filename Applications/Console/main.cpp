@@ -34,4 +34,8 @@ int main(int argc, char* argv[]) {
     As::Console mainConsole;
     mainConsole.run();
 
-    return 0; }
+    // Process the requests of the clients until the server is stopped
+    if (mainConsole.isServing()) {
+        return app.exec(); }
+
+    return mainConsole.exitCode(); }
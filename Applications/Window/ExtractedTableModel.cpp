@@ -0,0 +1,70 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QStandardItem>
+
+#include "Macros.hpp"
+
+#include "Scan.hpp"
+
+#include "ExtractedTableModel.hpp"
+
+/*!
+    \class As::ExtractedTableModel
+
+    \brief Table model with the extracted data of a single scan to be shown in the
+    table view. The scans themselves keep no GUI data, so that the diffraction library
+    does not depend on Qt GUI and the single model is refilled for every scan shown.
+*/
+
+/*!
+    Constructs an empty model with the given \a parent.
+*/
+As::ExtractedTableModel::ExtractedTableModel(QObject* parent)
+    : QStandardItemModel(parent) {}
+
+/*!
+    Destroys the model.
+*/
+As::ExtractedTableModel::~ExtractedTableModel() {
+    ADESTROYED; }
+
+/*!
+    Fills the model with the extracted data of the given \a scan.
+*/
+void As::ExtractedTableModel::setScan(const As::Scan* scan) {
+    const As::Scan::ExtractedTable table = scan->extractedTable();
+
+    const int columnCount = table.columns.size();
+    const int rowCount = columnCount > 0 ? table.columns[0].size() : 0;
+
+    clear();
+    setColumnCount(columnCount);
+    setRowCount(rowCount);
+
+    for (int column = 0; column < columnCount; ++column) {
+        // Headers
+        setHorizontalHeaderItem(column, new QStandardItem(table.headers[column]));
+        // Values
+        for (int row = 0; row < rowCount AND row < table.columns[column].size(); ++row) {
+            auto item = new QStandardItem(table.columns[column][row]);
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            setItem(row, column, item); } } }
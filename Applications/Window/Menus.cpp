@@ -32,6 +32,7 @@
 #include "Macros.hpp"
 
 #include "LineEdit.hpp"
+#include "OverviewPlot.hpp"
 #include "ToolBarButton.hpp"
 #include "ToolBarSpacer.hpp"
 #include "UnderLabeledWidget.hpp"
@@ -91,6 +92,13 @@ void As::Window::createActionsMenusToolBar() {
     connect(this, &As::Window::newFilesLoaded_Signal, export_Act, &QAction::setEnabled);
     connect(this, &As::Window::oldFilesClosed_Signal, export_Act, &QAction::setEnabled);
 
+    // Add action
+    QAction* exportPlots_Act = fileMenu->addAction(tr("Export &Plots..."), this, &As::Window::exportPlots_Slot);
+    exportPlots_Act->setToolTip(tr("Export the plots of all or some of the scans."));
+    exportPlots_Act->setEnabled(false);
+    connect(this, &As::Window::newScansPlotted_Signal, exportPlots_Act, &QAction::setEnabled);
+    connect(this, &As::Window::oldFilesClosed_Signal, exportPlots_Act, &QAction::setEnabled);
+
     auto exportButton = new As::UnderLabeledWidget(new As::ToolBarButton(export_Act), tr("Export"));
     exportButton->setEnabled(false);
     connect(this, &As::Window::newFilesLoaded_Signal, exportButton, &As::UnderLabeledWidget::setEnabled);
@@ -172,6 +180,19 @@ void As::Window::createActionsMenusToolBar() {
     connect(this, &As::Window::newFilesLoaded_Signal, sidebarButton, &As::UnderLabeledWidget::setEnabled);
     connect(this, &As::Window::oldFilesClosed_Signal, sidebarButton, &As::UnderLabeledWidget::setEnabled);
 
+    // Add submenu
+    QMenu* overviewMenu = viewMenu->addMenu(tr("&Overview"));
+    overviewMenu->setToolTip(tr("Show all the treated scans at once."));
+    overviewMenu->setEnabled(false);
+    connect(this, &As::Window::peaksTreatmentIsFinished, overviewMenu, &QMenu::setEnabled);
+    connect(this, &As::Window::oldFilesClosed_Signal, overviewMenu, &QMenu::setEnabled);
+    for (const As::OverviewPlot::Mode mode : {As::OverviewPlot::Profiles,
+                                               As::OverviewPlot::StructFactorVsTwoTheta,
+                                               As::OverviewPlot::IntensityToSigmaVsScan,
+                                               As::OverviewPlot::FwhmVsTwoTheta,
+                                               As::OverviewPlot::FlippingRatioVsScan}) {
+        overviewMenu->addAction(As::OverviewPlot::modeName(mode), this, [this, mode]() { showOverview_Slot(mode); }); }
+
     //---------
     // Add menu
     //---------
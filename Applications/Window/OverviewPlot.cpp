@@ -0,0 +1,308 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QString>
+#include <QTimer>
+#include <QtMath>
+
+#include "Colors.hpp"
+#include "Constants.hpp"
+#include "Macros.hpp"
+
+#include "RealVector.hpp"
+#include "Scan.hpp"
+#include "ScanArray.hpp"
+
+#include "OverviewPlot.hpp"
+
+/*!
+    \class As::OverviewPlot
+
+    \brief Shows all the scans of the dataset at once, either as overlaid
+    normalised profiles or as scatter views of the treated results.
+
+    The points of every scan are read once and kept per scan, so that a change
+    of a single scan is applied without re-reading the others. Before every replot
+    the points inside the visible key range are reduced to the minimum and
+    maximum of each pixel column, which keeps the plot interactive with hundreds
+    of thousands of points, but still shows every outlier.
+*/
+
+/*!
+    Constructs an empty overview plot.
+*/
+As::OverviewPlot::OverviewPlot() {
+    axisRect()->setupFullAxesBox();
+    connect(xAxis, SIGNAL(rangeChanged(QCPRange)), xAxis2, SLOT(setRange(QCPRange)));
+    connect(yAxis, SIGNAL(rangeChanged(QCPRange)), yAxis2, SLOT(setRange(QCPRange)));
+    xAxis->setLabelPadding(12);
+    yAxis->setLabelPadding(12);
+    plotLayout()->setMargins(QMargins(10, 7, 7, 10));
+    setLocale(QLocale(QLocale::English, QLocale::UnitedKingdom));
+
+    // Drag and zoom with the mouse
+    setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+
+    // Decimated points of all the scans
+    m_allGraph = addGraph();
+    m_allGraph->setLineStyle(QCPGraph::lsNone);
+    m_allGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, As::Color(As::blue), 3));
+
+    // Points of the current scan on top
+    m_currentGraph = addGraph();
+    m_currentGraph->setLineStyle(QCPGraph::lsNone);
+    m_currentGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, As::Color(As::red), 7));
+
+    // Several data changes in a row are plotted at once
+    m_replotTimer = new QTimer(this);
+    m_replotTimer->setSingleShot(true);
+    m_replotTimer->setInterval(0);
+    connect(m_replotTimer, &QTimer::timeout, this, [this]() { replot(); });
+
+    // Decimate just before drawing, when the visible range or the plot size is known
+    connect(this, &QCustomPlot::beforeReplot, this, &As::OverviewPlot::decimateIfNeeded);
+
+    setAxesLabels(); }
+
+/*!
+    Sets the overview \a mode and re-reads the points of all the scans.
+*/
+void As::OverviewPlot::setMode(const As::OverviewPlot::Mode mode) {
+    m_mode = mode;
+    setAxesLabels();
+    updateAllScans(); }
+
+/*!
+    Returns the current overview mode.
+*/
+As::OverviewPlot::Mode As::OverviewPlot::mode() const {
+    return m_mode; }
+
+/*!
+    Returns the human readable name of the given overview \a mode.
+*/
+QString As::OverviewPlot::modeName(const As::OverviewPlot::Mode mode) {
+    switch (mode) {
+        case Profiles:               return tr("Normalised profiles");
+        case StructFactorVsTwoTheta: return tr("Sf2 vs 2Theta");
+        case IntensityToSigmaVsScan: return tr("I/sigma vs scan");
+        case FwhmVsTwoTheta:         return tr("Fwhm vs 2Theta");
+        case FlippingRatioVsScan:    return tr("FR vs scan"); }
+    return QString(); }
+
+/*!
+    Sets the array of \a scans to be shown and reads the points of all of them.
+*/
+void As::OverviewPlot::setScanArray(const As::ScanArray* scans) {
+    m_scans = scans;
+    m_currentScan = -1;
+    updateAllScans(); }
+
+/*!
+    Re-reads the points of all the scans, e.g. after the whole dataset was treated,
+    and fits the axes to them.
+*/
+void As::OverviewPlot::updateAllScans() {
+    const int size = m_scans ? m_scans->size() : 0;
+    m_blocks.resize(size);
+    for (int i = 0; i < size; ++i) {
+        m_blocks[i] = readPoints(i); }
+    m_isDirty = true;
+    setCurrentScan(m_currentScan);
+    rescaleToAllPoints();
+    m_replotTimer->start(); }
+
+/*!
+    Re-reads the points of the single scan with the 0-based \a index only,
+    e.g. after it was treated again.
+*/
+void As::OverviewPlot::updateScan(const int index) {
+    if (index < 0 OR index >= m_blocks.size()) {
+        return; }
+    m_blocks[index] = readPoints(index);
+    m_isDirty = true;
+    if (index == m_currentScan) {
+        setCurrentScan(index); }
+    m_replotTimer->start(); }
+
+/*!
+    Highlights the points of the scan with the 0-based \a index.
+*/
+void As::OverviewPlot::setCurrentScan(const int index) {
+    m_currentScan = index;
+    QCPDataMap* data = m_currentGraph->data();
+    data->clear();
+    if (index >= 0 AND index < m_blocks.size()) {
+        for (const QPointF& point : m_blocks[index]) {
+            data->insertMulti(point.x(), QCPData(point.x(), point.y())); } }
+    m_replotTimer->start(); }
+
+/*!
+    Fills \a data with the points from all the \a blocks inside the key \a range,
+    keeping only the points with the minimum and maximum value in each of the
+    \a columns the range is split into.
+*/
+void As::OverviewPlot::decimate(const QVector<QVector<QPointF>>& blocks,
+                                const QCPRange& range,
+                                const int columns,
+                                QCPDataMap* data) {
+    data->clear();
+    if (columns < 1 OR range.size() <= 0) {
+        return; }
+
+    QVector<QPointF> minPoints(columns);
+    QVector<QPointF> maxPoints(columns);
+    QVector<bool> isFilled(columns, false);
+    const qreal scale = columns / range.size();
+
+    for (const QVector<QPointF>& block : blocks) {
+        for (const QPointF& point : block) {
+            if (point.x() < range.lower OR point.x() > range.upper) {
+                continue; }
+            const int column = qMin(static_cast<int>((point.x() - range.lower) * scale), columns - 1);
+            if (!isFilled[column]) {
+                minPoints[column] = point;
+                maxPoints[column] = point;
+                isFilled[column] = true; }
+            else if (point.y() < minPoints[column].y()) {
+                minPoints[column] = point; }
+            else if (point.y() > maxPoints[column].y()) {
+                maxPoints[column] = point; } } }
+
+    for (int column = 0; column < columns; ++column) {
+        if (isFilled[column]) {
+            data->insertMulti(minPoints[column].x(), QCPData(minPoints[column].x(), minPoints[column].y()));
+            if (maxPoints[column] != minPoints[column]) {
+                data->insertMulti(maxPoints[column].x(), QCPData(maxPoints[column].x(), maxPoints[column].y())); } } } }
+
+/*!
+    Decimates the points again, if they or the visible range or the plot width
+    changed since the last time.
+*/
+void As::OverviewPlot::decimateIfNeeded() {
+    const QCPRange range = xAxis->range();
+    const int columns = axisRect()->width();
+    if (!m_isDirty AND columns == m_decimatedColumns AND
+        range.lower == m_decimatedRange.lower AND range.upper == m_decimatedRange.upper) {
+        return; }
+    decimate(m_blocks, range, columns, m_allGraph->data());
+    m_isDirty = false;
+    m_decimatedRange = range;
+    m_decimatedColumns = columns; }
+
+/*!
+    Returns the points of the scan with the 0-based \a index for the current mode.
+    Excluded scans and not yet calculated results give no points.
+*/
+QVector<QPointF> As::OverviewPlot::readPoints(const int index) const {
+    QVector<QPointF> points;
+    const As::Scan* scan = m_scans->at(index);
+    if (scan->plotType() == As::PlotType::Excluded) {
+        return points; }
+
+    // Mean 2Theta of the scan, if any
+    auto twoTheta = [scan]() {
+        As::RealVector angle = scan->data("angles", "2Theta");
+        if (angle.isEmpty()) {
+            angle = scan->data("angles", "Gamma"); }
+        return angle.isEmpty() ? qQNaN() : angle.mean(); };
+
+    switch (m_mode) {
+        case Profiles: {
+            // Profile centred at the middle of the scan and scaled to [0, 1]
+            const As::RealVector x = scan->data("angles", scan->scanAngle());
+            const As::RealVector y = scan->data("intensities", "DetectorNorm");
+            const qreal min = y.min();
+            const qreal max = y.max();
+            if (x.size() != y.size() OR x.isEmpty() OR max <= min) {
+                break; }
+            const qreal middle = (x[0] + x[x.size() - 1]) / 2;
+            points.reserve(x.size());
+            for (int i = 0; i < x.size(); ++i) {
+                points << QPointF(x[i] - middle, (y[i] - min) / (max - min)); }
+            break; }
+        case StructFactorVsTwoTheta:
+            points << QPointF(twoTheta(), scan->result(As::Scan::StructFactor));
+            break;
+        case IntensityToSigmaVsScan:
+            points << QPointF(index + 1, scan->result(As::Scan::NormPeakArea) / scan->result(As::Scan::NormPeakAreaErr));
+            break;
+        case FwhmVsTwoTheta:
+            points << QPointF(twoTheta(), scan->result(As::Scan::FullWidthHalfMax));
+            break;
+        case FlippingRatioVsScan:
+            points << QPointF(index + 1, scan->result(As::Scan::FlippingRatio));
+            break; }
+
+    // Skip not calculated values
+    if (m_mode != Profiles AND (qIsNaN(points[0].x()) OR qIsNaN(points[0].y()) OR qIsInf(points[0].y()))) {
+        points.clear(); }
+
+    return points; }
+
+/*!
+    Sets the axes labels according to the current mode.
+*/
+void As::OverviewPlot::setAxesLabels() {
+    switch (m_mode) {
+        case Profiles:
+            xAxis->setLabel(tr("Scan angle from the scan middle (deg)"));
+            yAxis->setLabel(tr("Normalised intensity"));
+            break;
+        case StructFactorVsTwoTheta:
+            xAxis->setLabel(tr("2Theta (deg)"));
+            yAxis->setLabel(tr("Sf2"));
+            break;
+        case IntensityToSigmaVsScan:
+            xAxis->setLabel(tr("Scan"));
+            yAxis->setLabel(tr("I/sigma"));
+            break;
+        case FwhmVsTwoTheta:
+            xAxis->setLabel(tr("2Theta (deg)"));
+            yAxis->setLabel(tr("Fwhm (deg)"));
+            break;
+        case FlippingRatioVsScan:
+            xAxis->setLabel(tr("Scan"));
+            yAxis->setLabel(tr("FR"));
+            break; } }
+
+/*!
+    Sets the axes ranges to show all the points with some extra space around.
+*/
+void As::OverviewPlot::rescaleToAllPoints() {
+    bool hasPoints = false;
+    QCPRange x, y;
+    for (const QVector<QPointF>& block : m_blocks) {
+        for (const QPointF& point : block) {
+            if (!hasPoints) {
+                x = QCPRange(point.x(), point.x());
+                y = QCPRange(point.y(), point.y());
+                hasPoints = true; }
+            else {
+                x.expand(QCPRange(point.x(), point.x()));
+                y.expand(QCPRange(point.y(), point.y())); } } }
+    if (!hasPoints) {
+        return; }
+
+    const qreal xExtra = x.size() > 0 ? 0.05 * x.size() : 1;
+    const qreal yExtra = y.size() > 0 ? 0.05 * y.size() : 1;
+    xAxis->setRange(x.lower - xExtra, x.upper + xExtra);
+    yAxis->setRange(y.lower - yExtra, y.upper + yExtra); }
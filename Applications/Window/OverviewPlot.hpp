@@ -0,0 +1,85 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef AS_OVERVIEWPLOT_HPP
+#define AS_OVERVIEWPLOT_HPP
+
+#include <QPointF>
+#include <QVector>
+
+#include "qcustomplot.h"
+
+class QTimer;
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ScanArray;
+
+class OverviewPlot : public QCustomPlot {
+    Q_OBJECT
+
+  public:
+    enum Mode { Profiles,
+                StructFactorVsTwoTheta,
+                IntensityToSigmaVsScan,
+                FwhmVsTwoTheta,
+                FlippingRatioVsScan };
+
+    OverviewPlot();
+
+    void setMode(const As::OverviewPlot::Mode mode);
+    As::OverviewPlot::Mode mode() const;
+    static QString modeName(const As::OverviewPlot::Mode mode);
+
+    void setScanArray(const As::ScanArray* scans);
+    void updateAllScans();
+    void updateScan(const int index);
+    void setCurrentScan(const int index);
+
+    static void decimate(const QVector<QVector<QPointF>>& blocks,
+                         const QCPRange& range,
+                         const int columns,
+                         QCPDataMap* data);
+
+  private slots:
+    void decimateIfNeeded();
+
+  private:
+    QVector<QPointF> readPoints(const int index) const;
+    void setAxesLabels();
+    void rescaleToAllPoints();
+
+    const As::ScanArray* m_scans = Q_NULLPTR;
+    Mode m_mode = Profiles;
+    int m_currentScan = -1;
+    QVector<QVector<QPointF>> m_blocks;   // Points of every scan, index is the 0-based scan index
+    QCPGraph* m_allGraph;                 // Decimated points of all the scans
+    QCPGraph* m_currentGraph;             // Points of the current scan, not decimated
+    QTimer* m_replotTimer;                // Merges several data changes into a single replot
+    bool m_isDirty = true;                // Points changed since the last decimation
+    QCPRange m_decimatedRange;            // Visible key range of the last decimation
+    int m_decimatedColumns = 0;           // Axis rect width in pixels of the last decimation
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_OVERVIEWPLOT_HPP
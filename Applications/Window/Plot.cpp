@@ -25,6 +25,7 @@
 #include "Constants.hpp"
 #include "Macros.hpp"
 
+#include "PeakFit.hpp"
 #include "RealVector.hpp"
 #include "Scan.hpp"
 
@@ -37,6 +38,15 @@ As::Plot::Plot() {
     m_debugLineWidth = 2;
     m_markSize  = 8;
 
+    // Graphs and items are created on demand and then reused for every next scan
+    m_graph = Q_NULLPTR;
+    m_usedGraphCount = 0;
+    m_usedInfoLabelCount = 0;
+    m_infoBoxAnchor = Q_NULLPTR;
+    m_infoBox = Q_NULLPTR;
+    m_topArrow = Q_NULLPTR;
+    m_bottomArrow = Q_NULLPTR;
+
     // Configure right and top axes to show ticks
     axisRect()->setupFullAxesBox();
 
@@ -152,15 +162,25 @@ void As::Plot::appendArrowInfoLabel(const As::PlotType plotType,
                                     const int arrowLength) {
     setPlotColors(plotType);
 
+    // Create a new label only if all the previously created ones are in use
+    if (m_usedInfoLabelCount == m_infoLabels.size()) {
+        InfoLabel items;
+        items.point = new QCPItemText(this);
+        addItem(items.point);
+        items.label = new QCPItemText(this);
+        addItem(items.label);
+        items.arrow = new QCPItemLine(this);
+        addItem(items.arrow);
+        m_infoLabels << items; }
+    const InfoLabel& items = m_infoLabels[m_usedInfoLabelCount++];
+
     // Point to attach the text label
-    auto point = new QCPItemText(this);
-    addItem(point); // allows to clear it when needed
+    auto point = items.point;
     point->position->setCoords(x, y); // coordinates in the axes rectangle
     point->setVisible(false);
 
     // Text label
-    auto label = new QCPItemText(this);
-    addItem(label);  // allows to clear it when needed
+    auto label = items.label;
     label->position->setParentAnchor(point->position); // set initial position equal to that of the point
     int yShift = labelShift + arrowLength;
     label->position->setCoords(0, -yShift); // additional y-move from the initial anchor
@@ -176,10 +196,10 @@ void As::Plot::appendArrowInfoLabel(const As::PlotType plotType,
     label->setTextAlignment(Qt::AlignHCenter);
     label->setText(QString::number(y, 'f', getNumberPrecision(y)));
     label->setLayer("labels");
+    label->setVisible(true);
 
     // Add the arrow-like marker
-    auto arrow = new QCPItemLine(this);
-    addItem(arrow); // allows to clear it when needed
+    auto arrow = items.arrow;
     arrow->start->setParentAnchor(label->bottom);
     arrow->end->setParentAnchor(label->bottom);
     arrow->end->setCoords(0, arrowLength);
@@ -189,7 +209,8 @@ void As::Plot::appendArrowInfoLabel(const As::PlotType plotType,
     // Create arrow head
     //QCPLineEnding head(QCPLineEnding::esFlatArrow, arrowWidth, arrowLength);
     arrow->setHead(QCPLineEnding(QCPLineEnding::esFlatArrow, arrowWidth, arrowLength));
-    arrow->setLayer("labels"); }
+    arrow->setLayer("labels");
+    arrow->setVisible(true); }
 
 /*!
     ...
@@ -207,8 +228,8 @@ void As::Plot::appendCentralInfoLabel(const As::PlotType plotType,
     ...
 */
 void As::Plot::updateInfoLabels(const As::Scan* scan) {
-    const As::RealVector x = scan->data("angles", scan->scanAngle());
-    const As::RealVector y = scan->data("intensities", "DetectorNorm");
+    const As::RealVector& x = m_x;
+    const As::RealVector& y = m_y;
     appendArrowInfoLabel(scan->plotType(), x[y.indexOfMax()], y.max());
     appendArrowInfoLabel(scan->plotType(), x[y.indexOfMin()], y.min());
     if (scan->plotType() == As::PlotType::Integrated) {
@@ -276,28 +297,37 @@ void As::Plot::updateInfoBox(const As::Scan* scan) {
     text += formatForInfoBox("HKL", scan->millerIndex("H"), scan->millerIndex("K"), scan->millerIndex("L"));
     if (scan->plotType() != As::PlotType::Excluded) {
         for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
-            if (!qIsNaN(scan->m_normPeakArea[countType])) {
-                text += formatForInfoBox("Area" + countType, scan->m_normPeakArea[countType], scan->m_normPeakAreaErr[countType]); } }
+            const qreal normPeakArea = scan->result(As::Scan::NormPeakArea, countType);
+            if (!qIsNaN(normPeakArea)) {
+                text += formatForInfoBox("Area" + countType, normPeakArea, scan->result(As::Scan::NormPeakAreaErr, countType)); } }
+        for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
+            const qreal structFactor = scan->result(As::Scan::StructFactor, countType);
+            if (!qIsNaN(structFactor)) {
+                text += formatForInfoBox("F2" + countType,   structFactor, scan->result(As::Scan::StructFactorErr, countType)); } }
+        text += formatForInfoBox("Fwhm", scan->result(As::Scan::FullWidthHalfMax), scan->result(As::Scan::FullWidthHalfMaxErr));
+        text += formatForInfoBox("FR",   scan->result(As::Scan::FlippingRatio),    scan->result(As::Scan::FlippingRatioErr));
         for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
-            if (!qIsNaN(scan->m_structFactor[countType])) {
-                text += formatForInfoBox("F2" + countType,   scan->m_structFactor[countType], scan->m_structFactorErr[countType]); } }
-        text += formatForInfoBox("Fwhm", scan->m_fullWidthHalfMax, scan->m_fullWidthHalfMaxErr);
-        text += formatForInfoBox("FR",   scan->m_flippingRatio,    scan->m_flippingRatioErr); }
+            const qreal fitPeakArea = scan->result(As::Scan::FitPeakArea, countType);
+            if (!qIsNaN(fitPeakArea)) {
+                text += formatForInfoBox("AreaFit" + countType, fitPeakArea, scan->result(As::Scan::FitPeakAreaErr, countType)); } } }
 
     // Remove last newline symbol
     text.remove(QRegExp("\n$"));
 
     // Create point in the top right corner of the scanPlot to move the plotInfo by some pixels from this point
-    auto point = new QCPItemLine(this);
-    addItem(point);
+    if (!m_infoBoxAnchor) {
+        m_infoBoxAnchor = new QCPItemLine(this);
+        addItem(m_infoBoxAnchor);
+        m_infoBox = new QCPItemText(this);
+        addItem(m_infoBox); }
+    auto point = m_infoBoxAnchor;
     point->start->setType(QCPItemPosition::ptAxisRectRatio);
     point->end->setType(QCPItemPosition::ptAxisRectRatio);
     point->start->setCoords(1, 0);
     point->end->setCoords(point->start->coords());
 
     // Show plot info
-    auto plotInfo = new QCPItemText(this);
-    addItem(plotInfo);
+    auto plotInfo = m_infoBox;
     plotInfo->position->setParentAnchor(point->start);
     plotInfo->position->setCoords(-11, 11);
     plotInfo->setPositionAlignment(Qt::AlignTop | Qt::AlignRight);
@@ -316,18 +346,25 @@ void As::Plot::updateInfoBox(const As::Scan* scan) {
 */
 // Not updated after zoom!?
 void As::Plot::addXMiddleArrows(const As::Scan* scan) {
+    if (!m_topArrow) {
+        m_topArrow = new QCPItemLine(this);
+        addItem(m_topArrow);
+        m_bottomArrow = new QCPItemLine(this);
+        addItem(m_bottomArrow); }
+    m_topArrow->setVisible(scan->plotType() == As::PlotType::Integrated);
+    m_bottomArrow->setVisible(scan->plotType() == As::PlotType::Integrated);
+
     if (scan->plotType() == As::PlotType::Integrated) {
 
         int arrowLength = 8;
         int arrowWidth = 10;
         int yShift = 2;
-        const As::RealVector x = scan->data("angles", scan->scanAngle());
+        const As::RealVector& x = m_x;
         const int l = scan->m_numLeftSkipPoints + scan->m_numLeftBkgPoints;
         const int r = scan->numPoints() - scan->m_numRightBkgPoints - scan->m_numRightSkipPoints - 1;
 
         // Upper (top) arrow
-        auto arrowT = new QCPItemLine(this);
-        addItem(arrowT); // allows to clear it when needed
+        auto arrowT = m_topArrow;
         arrowT->end->setType(QCPItemPosition::ptAxisRectRatio);
         arrowT->end->setCoords(0.5, 0);
         arrowT->end->setType(QCPItemPosition::ptAbsolute);
@@ -342,8 +379,7 @@ void As::Plot::addXMiddleArrows(const As::Scan* scan) {
         arrowT->setLayer("labels");
 
         // Lower (bottom) arrow
-        auto arrowB = new QCPItemLine(this);
-        addItem(arrowB); // allows to clear it when needed
+        auto arrowB = m_bottomArrow;
         /*
             arrow->end->setType(QCPItemPosition::ptAxisRectRatio);
             arrow->end->setCoords(0.5, 0);
@@ -372,34 +408,41 @@ void As::Plot::addCustomGraph(const As::PlotType plotType,
                               const Qt::PenStyle lineType,
                               const Qt::BrushStyle fillType,
                               const QCPGraph::ErrorType errType) {
-    addGraph();
+    // Reuse the next previously created graph, if any, instead of creating a new one
+    if (m_usedGraphCount < graphCount()) {
+        m_graph = graph(m_usedGraphCount); }
+    else {
+        m_graph = addGraph(); }
+    ++m_usedGraphCount;
+    m_graph->setVisible(true);
+    m_graph->setChannelFillGraph(Q_NULLPTR);
+    m_graph->addToLegend();
     setPlotColors(plotType, countType);
 
     // Scatter symbols (marks)
-    graph()->setScatterStyle(QCPScatterStyle(markType, m_markDrawColor, m_markFillColor, m_markSize));
+    m_graph->setScatterStyle(QCPScatterStyle(markType, m_markDrawColor, m_markFillColor, m_markSize));
 
     // Curve line
-    graph()->setPen(QPen(m_lineDrawColor, m_debugLineWidth, lineType));
+    m_graph->setPen(QPen(m_lineDrawColor, m_debugLineWidth, lineType));
 
     // Filled area
-    graph()->setBrush(QBrush(m_areaFillColor, fillType));
+    m_graph->setBrush(QBrush(m_areaFillColor, fillType));
 
     // Error bars
-    graph()->setErrorType(errType);
-    graph()->setErrorPen(QPen(m_errorBarsDrawColor)); }
+    m_graph->setErrorType(errType);
+    m_graph->setErrorPen(QPen(m_errorBarsDrawColor)); }
 
 /*!
     ...
 */
 void As::Plot::addAllGraphs(const As::Scan* scan) {
     // Define data
-    const As::RealVector x  = scan->data("angles", scan->scanAngle());
-    const As::RealVector y  = scan->data("intensities", "DetectorNorm");
-    const As::RealVector sy = scan->data("intensities", "sDetectorNorm");
+    const As::RealVector& x  = m_x;
+    const As::RealVector& y  = m_y;
+    const As::RealVector& sy = m_sy;
 
     // Define local variables
     QPair<QVector<int>, QVector<int>> ranges;
-    QVector<QVector<qreal>> data;
     //bool hasSkipPoints = scan->m_numLeftSkipPoints + scan->m_numRightSkipPoints;
     QStringList countTypes{"" };
 
@@ -413,16 +456,14 @@ void As::Plot::addAllGraphs(const As::Scan* scan) {
             ranges.second << scan->numPoints() - scan->m_numRightSkipPoints;
             // Add graphs according to the measured data (unpolarised or polarised)
             for (const QString& countType : countTypes) {
-                As::RealVector y  = scan->data("intensities", "DetectorNorm" + countType);
-                As::RealVector sy  = scan->data("intensities", "sDetectorNorm" + countType);
+                const As::RealVector y  = countType.isEmpty() ? m_y : scan->data("intensities", "DetectorNorm" + countType);
+                const As::RealVector sy = countType.isEmpty() ? m_sy : scan->data("intensities", "sDetectorNorm" + countType);
                 if (!y.isEmpty()) {
-                    data.clear();
-                    data << x.toQVector() << y.toQVector() << sy.toQVector();
                     addCustomGraph(scan->plotType(), countType,
                                    QCPScatterStyle::ssCircle, Qt::SolidLine,
                                    Qt::SolidPattern, QCPGraph::etValue);
-                    updateGraphOnPlot(ranges, data);
-                    graph()->setName(tr(qPrintable("Scan" + countType))); } }
+                    updateGraphOnPlot(ranges, x, y, sy);
+                    m_graph->setName(tr(qPrintable("Scan" + countType))); } }
             break; }
 
         case As::PlotType::Integrated: {
@@ -431,23 +472,20 @@ void As::Plot::addAllGraphs(const As::Scan* scan) {
             ranges.second.clear();
             ranges.first  << scan->m_numLeftSkipPoints + scan->m_numLeftBkgPoints;
             ranges.second << scan->numPoints() - scan->m_numRightSkipPoints - scan->m_numRightBkgPoints;
-            data.clear();
-            data << x.toQVector() << y.toQVector() << sy.toQVector();
             addCustomGraph(scan->plotType(), "",
                            QCPScatterStyle::ssCircle, Qt::SolidLine,
                            Qt::SolidPattern, QCPGraph::etValue);
-            updateGraphOnPlot(ranges, data);
-            graph()->setName(tr("Peak"));
+            updateGraphOnPlot(ranges, x, y, sy);
+            m_graph->setName(tr("Peak"));
+            QCPGraph* peakGraph = m_graph;
             // Bottom line to cut the filled area of the above peak graph
-            data.clear();
-            data << x.toQVector() << QVector<qreal>(x.toQVector().size(), scan->m_normMeanBkg);
+            const As::RealVector meanBkg(x.size(), scan->m_normMeanBkg);
             addCustomGraph(scan->plotType(), "",
                            QCPScatterStyle::ssNone, Qt::NoPen,
                            Qt::NoBrush, QCPGraph::etNone);
-            updateGraphOnPlot(ranges, data);
-            int previous = graphCount() - 2;
-            graph(previous)->setChannelFillGraph(graph());
-            graph()->removeFromLegend();
+            updateGraphOnPlot(ranges, x, meanBkg);
+            peakGraph->setChannelFillGraph(m_graph);
+            m_graph->removeFromLegend();
             // Skipped marks, if any
             if (scan->m_numLeftSkipPoints + scan->m_numRightSkipPoints > 0) {
                 ranges.first.clear();
@@ -456,13 +494,11 @@ void As::Plot::addAllGraphs(const As::Scan* scan) {
                 ranges.second << scan->m_numLeftSkipPoints;
                 ranges.first  << scan->numPoints() - scan->m_numRightSkipPoints;
                 ranges.second << scan->numPoints();
-                data.clear();
-                data << x.toQVector() << y.toQVector() << sy.toQVector();
                 addCustomGraph(As::PlotType::Excluded, "",
                                QCPScatterStyle::ssCircle, Qt::NoPen,
                                Qt::NoBrush, QCPGraph::etValue);
-                updateGraphOnPlot(ranges, data);
-                graph()->setName(tr("Skipped")); }
+                updateGraphOnPlot(ranges, x, y, sy);
+                m_graph->setName(tr("Skipped")); }
             // Background marks
             ranges.first.clear();
             ranges.second.clear();
@@ -470,29 +506,72 @@ void As::Plot::addAllGraphs(const As::Scan* scan) {
             ranges.second << scan->m_numLeftSkipPoints + scan->m_numLeftBkgPoints;
             ranges.first  << scan->numPoints() - scan->m_numRightSkipPoints - scan->m_numRightBkgPoints;
             ranges.second << scan->numPoints() - scan->m_numRightSkipPoints;
-            data.clear();
-            data << x.toQVector() << y.toQVector() << sy.toQVector();
             addCustomGraph(As::PlotType::Raw, "",
                            QCPScatterStyle::ssCircle, Qt::NoPen,
                            Qt::NoBrush, QCPGraph::etValue);
-            updateGraphOnPlot(ranges, data);
-            graph()->setName(tr("Background"));
+            updateGraphOnPlot(ranges, x, y, sy);
+            m_graph->setName(tr("Background"));
             // Background line
             ranges.first.clear();
             ranges.second.clear();
             ranges.first  << scan->m_numLeftSkipPoints;
             ranges.second << scan->numPoints() - scan->m_numRightSkipPoints;
-            data.clear();
-            data << x.toQVector() << QVector<qreal>(x.toQVector().size(), scan->m_normMeanBkg);
             addCustomGraph(As::PlotType::Raw, "",
                            QCPScatterStyle::ssNone, Qt::DotLine,
                            Qt::SolidPattern, QCPGraph::etNone);
-            updateGraphOnPlot(ranges, data);
-            graph()->setName(tr("Background mean"));
+            updateGraphOnPlot(ranges, x, meanBkg);
+            m_graph->setName(tr("Background mean"));
             break; }
 
         case As::PlotType::Fitted: {
-            ADEBUG;
+            const int from = scan->m_numLeftSkipPoints;
+            const int to   = scan->numPoints() - scan->m_numRightSkipPoints;
+            // Fitted marks
+            ranges.first.clear();
+            ranges.second.clear();
+            ranges.first  << from;
+            ranges.second << to;
+            addCustomGraph(scan->plotType(), "",
+                           QCPScatterStyle::ssCircle, Qt::NoPen,
+                           Qt::NoBrush, QCPGraph::etValue);
+            updateGraphOnPlot(ranges, x, y, sy);
+            m_graph->setName(tr("Scan"));
+            // Fitted profile line, sampled 10 times denser than the measured points
+            const qreal area     = scan->result(As::Scan::FitPeakArea);
+            const qreal position = scan->result(As::Scan::FitPeakPosition);
+            const qreal width    = scan->result(As::Scan::FitFullWidthHalfMax);
+            const qreal bkg      = scan->result(As::Scan::FitBkg);
+            const qreal mixing   = scan->result(As::Scan::FitMixing);
+            if (!qIsNaN(area) AND to - from > 1) {
+                const As::Scan::PeakFitType fitType = scan->peakFitType();
+                const qreal amplitude = area / (width * As::PeakFit::areaFactor(fitType, mixing));
+                const int count = 10 * (to - from - 1) + 1;
+                As::RealVector xFit(count, 0), yFit(count, 0);
+                for (int i = 0; i < count; ++i) {
+                    xFit[i] = x[from] + (x[to - 1] - x[from]) * i / (count - 1);
+                    yFit[i] = bkg + amplitude * As::PeakFit::profile(fitType, xFit[i], position, width, mixing); }
+                ranges.first.clear();
+                ranges.second.clear();
+                ranges.first  << 0;
+                ranges.second << count;
+                addCustomGraph(scan->plotType(), "",
+                               QCPScatterStyle::ssNone, Qt::SolidLine,
+                               Qt::NoBrush, QCPGraph::etNone);
+                updateGraphOnPlot(ranges, xFit, yFit);
+                m_graph->setName(tr("Fit")); }
+            // Skipped marks, if any
+            if (scan->m_numLeftSkipPoints + scan->m_numRightSkipPoints > 0) {
+                ranges.first.clear();
+                ranges.second.clear();
+                ranges.first  << 0;
+                ranges.second << scan->m_numLeftSkipPoints;
+                ranges.first  << scan->numPoints() - scan->m_numRightSkipPoints;
+                ranges.second << scan->numPoints();
+                addCustomGraph(As::PlotType::Excluded, "",
+                               QCPScatterStyle::ssCircle, Qt::NoPen,
+                               Qt::NoBrush, QCPGraph::etValue);
+                updateGraphOnPlot(ranges, x, y, sy);
+                m_graph->setName(tr("Skipped")); }
             break; }
 
         case As::PlotType::Excluded: {
@@ -500,13 +579,11 @@ void As::Plot::addAllGraphs(const As::Scan* scan) {
             ranges.second.clear();
             ranges.first << scan->m_numLeftSkipPoints;
             ranges.second << scan->numPoints() - scan->m_numRightSkipPoints;
-            data.clear();
-            data << x.toQVector() << y.toQVector() << sy.toQVector();
             addCustomGraph(scan->plotType(), "",
                            QCPScatterStyle::ssCircle, Qt::SolidLine,
                            Qt::SolidPattern, QCPGraph::etValue);
-            updateGraphOnPlot(ranges, data);
-            graph()->setName(tr("Scan"));
+            updateGraphOnPlot(ranges, x, y, sy);
+            m_graph->setName(tr("Scan"));
             break; }
 
         default: {
@@ -516,25 +593,22 @@ void As::Plot::addAllGraphs(const As::Scan* scan) {
 /*!
     ...
 */
-void As::Plot::updateGraphOnPlot(const QPair<QVector<int>, QVector<int>> ranges,
-                                 const QVector<QVector<qreal>> data) {
-    QVector<QVector<qreal>> subData(data.size());
-
-    // Fill subData arrays
+void As::Plot::updateGraphOnPlot(const QPair<QVector<int>, QVector<int>>& ranges,
+                                 const As::RealVector& x,
+                                 const As::RealVector& y,
+                                 const As::RealVector& sy) {
+    const bool hasErrors = !sy.isEmpty();
+
+    // Refill the data map of the current graph in place, without intermediate arrays
+    QCPDataMap* data = m_graph->data();
+    data->clear();
     for (int m = 0; m < ranges.first.size(); ++m) {
         for (int k = ranges.first[m]; k < ranges.second[m]; ++k) {
-            for (int i = 0; i < data.size(); ++i) {
-                subData[i] << data[i][k]; } } }
-
-    const int size = subData.size();
-    AASSERT(size == 3 OR size == 2, QString("wrong size of the subData array '%1'").arg(size));
-
-    // Select appropriate plot type depends on number of data columns
-    if (size == 3) {
-        graph()->setDataValueError(subData[0], subData[1], subData[2]); }
-
-    else if (size == 2) {
-        graph()->setData(subData[0], subData[1]); } }
+            QCPData point(x[k], y[k]);
+            if (hasErrors) {
+                point.valueErrorMinus = sy[k];
+                point.valueErrorPlus  = sy[k]; }
+            data->insertMulti(point.key, point); } } }
 
 /*!
     ...
@@ -543,17 +617,29 @@ void As::Plot::updateAllOnPlot(const As::Scan* scan) {
     //ADEBUG << scan;
 
     // Get data to plot
-    const As::RealVector x  = scan->data("angles", scan->scanAngle());
-    const As::RealVector y  = scan->data("intensities", "DetectorNorm");
-    const As::RealVector sy = scan->data("intensities", "sDetectorNorm");
+    updateAllOnPlot(scan,
+                    scan->data("angles", scan->scanAngle()),
+                    scan->data("intensities", "DetectorNorm"),
+                    scan->data("intensities", "sDetectorNorm")); }
 
-    updateAxesRanges(x, y, sy); // Auto by QCustomPlot: rescaleAxes();
+/*!
+    Updates the plot of the given \a scan using the already parsed scan angle \a x,
+    normalised intensity \a y and its ESD \a sy.
+*/
+void As::Plot::updateAllOnPlot(const As::Scan* scan,
+                               const As::RealVector& x,
+                               const As::RealVector& y,
+                               const As::RealVector& sy) {
+    m_x  = x;
+    m_y  = y;
+    m_sy = sy;
 
-    // Remove all existing graphs
-    clearPlottables();
+    updateAxesRanges(x, y, sy); // Auto by QCustomPlot: rescaleAxes();
 
-    // Removes all item from the plot (like additional text previously plotted: info labels and box)
-    clearItems();
+    // Existing graphs and items are reused, the unused ones are hidden below
+    m_usedGraphCount = 0;
+    m_usedInfoLabelCount = 0;
+    legend->clearItems();
 
     setPlotColors(scan->plotType());
 
@@ -562,6 +648,7 @@ void As::Plot::updateAllOnPlot(const As::Scan* scan) {
 
     updateInfoLabels(scan);
     updateInfoBox(scan);
+    hideUnusedGraphsAndItems();
 
     // Create Legend
     auto isLegendHidden = QSettings().value("PlotSettings/hideLegend", false).toBool();
@@ -578,6 +665,19 @@ void As::Plot::updateAllOnPlot(const As::Scan* scan) {
     // Re-plot everything defined above
     replot(); }
 
+/*!
+    Hides the graphs and info labels left over from the previously plotted scan,
+    so that they can be reused later instead of being recreated.
+*/
+void As::Plot::hideUnusedGraphsAndItems() {
+    for (int i = m_usedGraphCount; i < graphCount(); ++i) {
+        graph(i)->setVisible(false);
+        graph(i)->setChannelFillGraph(Q_NULLPTR);
+        graph(i)->removeFromLegend(); }
+    for (int i = m_usedInfoLabelCount; i < m_infoLabels.size(); ++i) {
+        m_infoLabels[i].label->setVisible(false);
+        m_infoLabels[i].arrow->setVisible(false); } }
+
 /*!
     ...
 */
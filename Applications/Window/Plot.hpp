@@ -26,6 +26,8 @@
 #include "Colors.hpp"
 #include "Constants.hpp"
 
+#include "RealVector.hpp"
+
 #include "qcustomplot.h"
 
 class QMouseEvent;
@@ -34,7 +36,6 @@ class QString;
 namespace As { //AS_BEGIN_NAMESPACE
 
 class Color;
-class RealVector;
 class Scan;
 
 class Plot : public QCustomPlot {
@@ -78,9 +79,15 @@ class Plot : public QCustomPlot {
                         const Qt::BrushStyle fillType,
                         const QCPGraph::ErrorType errType);
     void addAllGraphs(const As::Scan* scan);
-    void updateGraphOnPlot(const QPair<QVector<int>, QVector<int>> ranges,
-                           const QVector<QVector<qreal>> data);
+    void updateGraphOnPlot(const QPair<QVector<int>, QVector<int>>& ranges,
+                           const As::RealVector& x,
+                           const As::RealVector& y,
+                           const As::RealVector& sy = As::RealVector());
     void updateAllOnPlot(const Scan* scan);
+    void updateAllOnPlot(const Scan* scan,
+                         const As::RealVector& x,
+                         const As::RealVector& y,
+                         const As::RealVector& sy);
 
   private slots:
     void showPointCoordinatesToolTip(QMouseEvent* event);
@@ -89,6 +96,14 @@ class Plot : public QCustomPlot {
     void mouseReleaseToZoom(QMouseEvent* event);
 
   private:
+    // Items of a single label with an arrow-like marker
+    struct InfoLabel {
+        QCPItemText* point;
+        QCPItemText* label;
+        QCPItemLine* arrow; };
+
+    void hideUnusedGraphsAndItems();
+
     bool m_leftMouseButtonPressed;
     bool m_rightMouseButtonPressed;
     int m_markSize;
@@ -110,6 +125,17 @@ class Plot : public QCustomPlot {
     As::Color m_errorBarsDrawColor;
     As::Color m_areaFillColor;
     QCPItemRect* m_zoomRectangle;
+    QCPGraph* m_graph;              // Graph currently being set up
+    int m_usedGraphCount;           // Graphs in use for the plotted scan, the rest are hidden
+    QVector<InfoLabel> m_infoLabels;
+    int m_usedInfoLabelCount;       // Info labels in use for the plotted scan, the rest are hidden
+    QCPItemLine* m_infoBoxAnchor;
+    QCPItemText* m_infoBox;
+    QCPItemLine* m_topArrow;
+    QCPItemLine* m_bottomArrow;
+    As::RealVector m_x;     // Scan angle of the plotted scan
+    As::RealVector m_y;     // Normalised detector intensity of the plotted scan
+    As::RealVector m_sy;    // ESD of the normalised detector intensity of the plotted scan
 
 };
 
@@ -0,0 +1,248 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QFuture>
+#include <QImage>
+#include <QPageSize>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QPicture>
+#include <QStringList>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#include "Macros.hpp"
+
+#include "ConcurrentWatcher.hpp"
+#include "Scan.hpp"
+#include "ScanArray.hpp"
+
+#include "Plot.hpp"
+
+#include "PlotExporter.hpp"
+
+/*!
+    \class As::PlotExporter
+
+    \brief Exports the plots of many scans at once, either into a single
+    multi-page PDF file or into one PDF or PNG file per scan.
+
+    The selected scans are treated in parallel first. Then every scan is plotted
+    by an off-screen As::Plot, so that exactly the same styling as in the main
+    window is used, and recorded into a QPicture. Widgets can only live in the
+    GUI thread, so this recording is the only sequential step: rasterising,
+    encoding and writing of the recorded pictures is done by a pool of worker
+    threads, one file per worker.
+*/
+
+/*!
+    Constructs an exporter with the given \a parent.
+*/
+As::PlotExporter::PlotExporter(QObject* parent)
+    : QObject(parent),
+      m_width(640),
+      m_height(480) {}
+
+/*!
+    Destroys the exporter after all the files are written.
+*/
+As::PlotExporter::~PlotExporter() {
+    m_threadPool.waitForDone();
+    ADESTROYED; }
+
+/*!
+    Sets the size of the exported plots to \a width and \a height in pixels
+    (in points for the PDF files).
+*/
+void As::PlotExporter::setPageSize(const int width,
+                                   const int height) {
+    m_width = width;
+    m_height = height; }
+
+/*!
+    Exports the plots of the \a scans with the given 0-based \a selectedIndices
+    in the given \a format, once per scan. The scans, which are not treated
+    individually, are treated using the common \a settings first. For the multi-page PDF, \a path is the
+    output file, otherwise it is the directory for the output files.
+    Returns true if all the files are written.
+*/
+bool As::PlotExporter::exportScans(As::ScanArray* scans,
+                                   const QVector<int>& selectedIndices,
+                                   const As::ScanPrefetcher::Settings& settings,
+                                   const As::PlotExporter::Format format,
+                                   const QString& path) {
+    ADEBUG << "format:" << format << "scans:" << selectedIndices.size() << "path:" << path;
+
+    // Every scan is treated and written only once
+    QVector<int> indices = selectedIndices;
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    if (indices.isEmpty()) {
+        return false; }
+
+    m_threadPool.setMaxThreadCount(As::ConcurrentWatcher::threadCount());
+
+    // Rendering of every scan plus writing of the remaining files
+    emit progressRangeChanged(0, indices.size() + 1);
+    emit progressValueChanged(0);
+
+    // Treat the selected scans in parallel, the same way as when they are browsed.
+    // The results may be shared with the output table, unshare them before
+    scans->m_results.detach();
+    As::ConcurrentWatcher::blockingMap(indices, [scans, settings](const int index) {
+        As::ScanPrefetcher::treat(scans, index + 1, settings); });
+
+    // Off-screen plot, which is never shown
+    As::Plot plot;
+    plot.resize(m_width, m_height);
+
+    QList<QFuture<bool>> futures;
+    QVector<QPicture> pages;
+    const int digits = QString::number(scans->size()).size();
+
+    for (int n = 0; n < indices.size(); ++n) {
+        const As::Scan* scan = scans->at(indices[n]);
+
+        // Record the plot, the same as shown in the main window
+        plot.updateAllOnPlot(scan);
+        QPicture picture;
+        QCPPainter painter(&picture);
+        plot.toPainter(&painter, m_width, m_height);
+        painter.end();
+
+        // Write it in background
+        if (format == MultiPagePdf) {
+            pages << picture; }
+        else {
+            const QString fileName = QString("%1_%2.%3").
+                                     arg(indices[n] + 1, digits, 10, QChar('0')).
+                                     arg(QFileInfo(scan->absolutePathWithBaseNameAndHkl()).fileName()).
+                                     arg(format == PngPerScan ? "png" : "pdf");
+            const QString filePath = QDir(path).filePath(fileName);
+            if (format == PngPerScan) {
+                futures << QtConcurrent::run(&m_threadPool, &As::PlotExporter::writePng,
+                                             picture, m_width, m_height, filePath); }
+            else {
+                futures << QtConcurrent::run(&m_threadPool, &As::PlotExporter::writePdf,
+                                             QVector<QPicture>{picture}, m_width, m_height, filePath); } }
+
+        emit progressValueChanged(n + 1);
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents); }
+
+    // All the pages go to a single file
+    if (format == MultiPagePdf) {
+        futures << QtConcurrent::run(&m_threadPool, &As::PlotExporter::writePdf,
+                                     pages, m_width, m_height, path); }
+
+    // Wait for the writers
+    bool isWritten = true;
+    for (QFuture<bool>& future : futures) {
+        isWritten = future.result() AND isWritten; }
+
+    emit progressValueChanged(indices.size() + 1);
+
+    return isWritten; }
+
+/*!
+    Returns the sorted 0-based indices of the scans given by the \a text with the
+    1-based scan numbers and ranges, e.g. "1-20, 35", out of \a count scans. Empty \a text
+    gives all the scans. If \a ok is not null, it is set to false in case of a wrong
+    \a text.
+*/
+QVector<int> As::PlotExporter::parseScanList(const QString& text,
+                                             const int count,
+                                             bool* ok) {
+    QVector<int> indices;
+    bool isValid = true;
+
+    if (text.trimmed().isEmpty()) {
+        for (int i = 0; i < count; ++i) {
+            indices << i; } }
+
+    for (const QString& token : text.split(",", QString::SkipEmptyParts)) {
+        const QStringList range = token.split("-");
+        bool isFirstValid = false, isLastValid = false;
+        const int first = range.first().trimmed().toInt(&isFirstValid);
+        const int last = range.last().trimmed().toInt(&isLastValid);
+        if (range.size() > 2 OR !isFirstValid OR !isLastValid OR
+            first < 1 OR last > count OR first > last) {
+            isValid = false;
+            break; }
+        for (int number = first; number <= last; ++number) {
+            indices << number - 1; } }
+
+    if (!isValid) {
+        indices.clear(); }
+
+    // Overlapping ranges, e.g. "1-5, 3", give every scan once
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    if (ok != Q_NULLPTR) {
+        *ok = isValid; }
+
+    return indices; }
+
+/*!
+    Writes the recorded \a pages of the given \a width and \a height into the
+    PDF file \a filePath, one page each. Runs in a worker thread.
+*/
+bool As::PlotExporter::writePdf(const QVector<QPicture>& pages,
+                                const int width,
+                                const int height,
+                                const QString& filePath) {
+    QPdfWriter writer(filePath);
+    writer.setPageSize(QPageSize(QSize(width, height), QPageSize::Point, QString(), QPageSize::ExactMatch));
+    writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+    writer.setResolution(72); // one plot pixel per point
+
+    QPainter painter;
+    if (!painter.begin(&writer)) {
+        return false; }
+
+    for (int i = 0; i < pages.size(); ++i) {
+        if (i > 0) {
+            writer.newPage(); }
+        painter.drawPicture(0, 0, pages[i]); }
+
+    return painter.end(); }
+
+/*!
+    Rasterises the recorded \a picture of the given \a width and \a height and
+    writes it into the PNG file \a filePath. Runs in a worker thread.
+*/
+bool As::PlotExporter::writePng(const QPicture& picture,
+                                const int width,
+                                const int height,
+                                const QString& filePath) {
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.drawPicture(0, 0, picture);
+    painter.end();
+
+    return image.save(filePath, "PNG"); }
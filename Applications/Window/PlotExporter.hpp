@@ -0,0 +1,84 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef AS_PLOTEXPORTER_HPP
+#define AS_PLOTEXPORTER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include "ScanPrefetcher.hpp"
+
+class QPicture;
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ScanArray;
+
+class PlotExporter : public QObject {
+    Q_OBJECT
+
+  public:
+    enum Format { MultiPagePdf,
+                  PdfPerScan,
+                  PngPerScan };
+
+    PlotExporter(QObject* parent = Q_NULLPTR);
+    ~PlotExporter();
+
+    void setPageSize(const int width,
+                     const int height);
+
+    bool exportScans(As::ScanArray* scans,
+                     const QVector<int>& selectedIndices,
+                     const As::ScanPrefetcher::Settings& settings,
+                     const As::PlotExporter::Format format,
+                     const QString& path);
+
+    static QVector<int> parseScanList(const QString& text,
+                                      const int count,
+                                      bool* ok = Q_NULLPTR);
+
+  signals:
+    void progressRangeChanged(const int minimum, const int maximum);
+    void progressValueChanged(const int value);
+
+  private:
+    static bool writePdf(const QVector<QPicture>& pages,
+                         const int width,
+                         const int height,
+                         const QString& filePath);
+    static bool writePng(const QPicture& picture,
+                         const int width,
+                         const int height,
+                         const QString& filePath);
+
+    int m_width;
+    int m_height;
+    QThreadPool m_threadPool;   // Writers of the rendered plots
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_PLOTEXPORTER_HPP
@@ -27,17 +27,21 @@
 #include <QLineEdit>
 #include <QSettings>
 #include <QTabWidget>
+#include <QThread>
 #include <QVBoxLayout>
 #include <QWidget>
 
 #include "Macros.hpp"
 
+#include "ConcurrentWatcher.hpp"
+
 #include "CheckBox.hpp"
 #include "ComboBox.hpp"
 #include "GroupBox.hpp"
 #include "HBoxLayout.hpp"
 #include "Label.hpp"
 #include "PushButton.hpp"
+#include "SpinBox.hpp"
 #include "Style.hpp"
 #include "VBoxLayout.hpp"
 
@@ -52,6 +56,7 @@ As::PreferencesDialog::PreferencesDialog(QWidget* parent)
 
     auto layout = new As::VBoxLayout;
     layout->addWidget(createLanguageGroup());
+    layout->addWidget(createPerformanceGroup());
     layout->addWidget(createUpdateGroup());
 
     setLayout(layout);
@@ -77,6 +82,49 @@ As::GroupBox* As::PreferencesDialog::createLanguageGroup() {
 
     return group; }
 
+/*!
+    Creates the group with the number of threads used in the data processing.
+*/
+As::GroupBox* As::PreferencesDialog::createPerformanceGroup() {
+    ADEBUG;
+
+    const int maxThreadCount = 4 * QThread::idealThreadCount();
+
+    auto threadsSpinBox = new As::SpinBox;
+    threadsSpinBox->setToolTip(tr("Number of threads used to treat the scans. "
+                                  "Auto: one thread per processor core."));
+    threadsSpinBox->setRange(0, maxThreadCount);
+    threadsSpinBox->setSpecialValueText(tr("Auto"));
+    threadsSpinBox->setValue(QSettings().value("Preferences/threadCount", 0).toInt());
+    connect(threadsSpinBox, QOverload<int>::of(&As::SpinBox::valueChanged), this,
+            &As::PreferencesDialog::setThreadCountSettings);
+
+    auto ioThreadsSpinBox = new As::SpinBox;
+    ioThreadsSpinBox->setToolTip(tr("Number of separate threads used to read the files. "
+                                    "Shared: the files are read by the treatment threads."));
+    ioThreadsSpinBox->setRange(0, maxThreadCount);
+    ioThreadsSpinBox->setSpecialValueText(tr("Shared"));
+    ioThreadsSpinBox->setValue(QSettings().value("Preferences/ioThreadCount", 0).toInt());
+    connect(ioThreadsSpinBox, QOverload<int>::of(&As::SpinBox::valueChanged), this,
+            &As::PreferencesDialog::setIoThreadCountSettings);
+
+    auto threadsLayout = new As::HBoxLayout;
+    threadsLayout->addWidget(new QLabel(tr("Treatment threads")));
+    threadsLayout->addWidget(threadsSpinBox);
+
+    auto ioThreadsLayout = new As::HBoxLayout;
+    ioThreadsLayout->addWidget(new QLabel(tr("File reading threads")));
+    ioThreadsLayout->addWidget(ioThreadsSpinBox);
+
+    auto layout = new QVBoxLayout;
+    layout->addLayout(threadsLayout);
+    layout->addLayout(ioThreadsLayout);
+
+    auto group = new As::GroupBox("PreferencesPerformanceGroup", tr("Performance"));
+    group->setLayout(layout);
+
+    return group; }
+
 /*!
     ...
 */
@@ -114,3 +162,20 @@ void As::PreferencesDialog::setAutoUpdateSettings(const bool autoUpdate) {
 
     QSettings().setValue("Preferences/autoUpdate", autoUpdate); }
 
+/*!
+    Saves the number of the treatment threads \a count and applies it at once.
+*/
+void As::PreferencesDialog::setThreadCountSettings(const int count) {
+    ADEBUG << "threadCount:" << count;
+
+    QSettings().setValue("Preferences/threadCount", count);
+    As::ConcurrentWatcher::setThreadCount(count); }
+
+/*!
+    Saves the number of the file reading threads \a count and applies it at once.
+*/
+void As::PreferencesDialog::setIoThreadCountSettings(const int count) {
+    ADEBUG << "ioThreadCount:" << count;
+
+    QSettings().setValue("Preferences/ioThreadCount", count);
+    As::ConcurrentWatcher::setIoThreadCount(count); }
@@ -40,10 +40,13 @@ class PreferencesDialog : public QDialog {
 
   private:
     As::GroupBox* createLanguageGroup();
+    As::GroupBox* createPerformanceGroup();
     As::GroupBox* createUpdateGroup();
 
   private slots:
     void setAutoUpdateSettings(const bool autoUpdate);
+    void setThreadCountSettings(const int count);
+    void setIoThreadCountSettings(const int count);
 
 };
 
@@ -0,0 +1,256 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QMutexLocker>
+#include <QSettings>
+#include <QThread>
+
+#include <QtConcurrent>
+
+#include "Macros.hpp"
+
+#include "ScanArray.hpp"
+
+#include "ScanPrefetcher.hpp"
+
+/*!
+    \class As::ScanPrefetcher
+
+    \brief The ScanPrefetcher is a class that treats the neighbors of the current scan
+    and prepares their plot data in background, while the user looks at the current one.
+
+    After every navigation, the next and previous range() scans are treated one by one
+    on a single low-priority worker thread, nearest first. The navigation then takes the
+    prepared scan via take(), which stops the running prefetch after the scan being
+    processed, so that the scan array is never modified from two threads at once.
+
+    A prepared scan is only used if it was treated with the same common settings.
+    Individually treated scans are never prefetched.
+*/
+
+/*!
+    \variable As::ScanPrefetcher::DEFAULT_RANGE
+
+    Default number of scans prefetched in each direction.
+*/
+const int As::ScanPrefetcher::DEFAULT_RANGE = 8;
+
+/*!
+    Returns the common treatment settings taken from the generic \a scan.
+*/
+As::ScanPrefetcher::Settings As::ScanPrefetcher::Settings::fromScan(const As::Scan* scan) {
+    Settings settings;
+    settings.neighborsRemoveType = scan->neighborsRemoveType();
+    settings.peakAnalysisType    = scan->peakAnalysisType();
+    settings.bkgDetectType       = scan->bkgDetectType();
+    settings.peakFitType         = scan->peakFitType();
+    settings.plotType            = scan->plotType();
+    settings.numLeftSkipPoints   = scan->m_numLeftSkipPoints;
+    settings.numRightSkipPoints  = scan->m_numRightSkipPoints;
+    settings.numLeftBkgPoints    = scan->m_numLeftBkgPoints;
+    settings.numRightBkgPoints   = scan->m_numRightBkgPoints;
+    return settings; }
+
+/*!
+    Copies the common treatment settings to the given \a scan.
+*/
+void As::ScanPrefetcher::Settings::applyTo(As::Scan* scan) const {
+    scan->setNeighborsRemoveType(neighborsRemoveType);
+
+    scan->m_numLeftSkipPoints = numLeftSkipPoints;
+    scan->m_numRightSkipPoints = numRightSkipPoints;
+
+    scan->setPeakAnalysisType(peakAnalysisType);
+    scan->setBkgDetectType(bkgDetectType);
+    scan->setPeakFitType(peakFitType);
+
+    scan->m_numLeftBkgPoints = numLeftBkgPoints;
+    scan->m_numRightBkgPoints = numRightBkgPoints; }
+
+/*!
+    Returns true if the settings are equal to the \a other ones.
+*/
+bool As::ScanPrefetcher::Settings::operator==(const Settings& other) const {
+    return neighborsRemoveType == other.neighborsRemoveType AND
+           peakAnalysisType    == other.peakAnalysisType AND
+           bkgDetectType       == other.bkgDetectType AND
+           peakFitType         == other.peakFitType AND
+           plotType            == other.plotType AND
+           numLeftSkipPoints   == other.numLeftSkipPoints AND
+           numRightSkipPoints  == other.numRightSkipPoints AND
+           numLeftBkgPoints    == other.numLeftBkgPoints AND
+           numRightBkgPoints   == other.numRightBkgPoints; }
+
+/*!
+    Constructs a prefetcher with the given \a parent.
+*/
+As::ScanPrefetcher::ScanPrefetcher(QObject* parent)
+    : QObject(parent),
+      m_range(QSettings().value("PlotSettings/prefetchRange", DEFAULT_RANGE).toInt()) {
+    m_threadPool.setMaxThreadCount(1); }
+
+/*!
+    Destroys the prefetcher. The running prefetch is stopped first.
+*/
+As::ScanPrefetcher::~ScanPrefetcher() {
+    cancel();
+    m_threadPool.waitForDone();
+    ADESTROYED; }
+
+/*!
+    Sets the scan array to be \a scans. All the prepared scans are dropped.
+*/
+void As::ScanPrefetcher::setScanArray(As::ScanArray* scans) {
+    cancel();
+    m_entries.clear();
+    m_scans = scans; }
+
+/*!
+    Sets the number of scans prefetched in each direction to be \a range.
+    The zero \a range disables the prefetching.
+*/
+void As::ScanPrefetcher::setRange(const int range) {
+    m_range = qMax(0, range); }
+
+/*!
+    Returns the number of scans prefetched in each direction.
+*/
+int As::ScanPrefetcher::range() const {
+    return m_range; }
+
+/*!
+    Stops the running prefetch and waits until the scan being processed is finished.
+*/
+void As::ScanPrefetcher::cancel() {
+    m_canceled.store(1);
+    m_future.waitForFinished(); }
+
+/*!
+    Stops the running prefetch and takes the prepared scan with the 1-based \a index.
+    Returns true and fills the \a series to be plotted, if the scan was treated with the
+    given \a settings; otherwise the scan has to be treated by the caller.
+*/
+bool As::ScanPrefetcher::take(const int index,
+                              const As::ScanPrefetcher::Settings& settings,
+                              As::ScanPrefetcher::Series* series) {
+    cancel();
+
+    QMutexLocker locker(&m_mutex);
+
+    const auto it = m_entries.find(index);
+    if (it == m_entries.end()) {
+        return false; }
+
+    const Entry entry = it.value();
+    m_entries.erase(it);
+
+    if (m_scans == Q_NULLPTR OR m_scans->at(index - 1)->isIndividuallyTreated() OR
+        !(entry.settings == settings)) {
+        return false; }
+
+    *series = entry.series;
+    return true; }
+
+/*!
+    Starts the prefetch of the neighbors of the scan with the 1-based \a index,
+    using the given common \a settings.
+*/
+void As::ScanPrefetcher::prefetch(const int index,
+                                  const As::ScanPrefetcher::Settings& settings) {
+    cancel();
+
+    if (m_scans == Q_NULLPTR OR m_range == 0) {
+        return; }
+
+    // Neighbors, nearest first
+    QList<int> neighbors;
+    for (int distance = 1; distance <= m_range; ++distance) {
+        if (index + distance <= m_scans->size()) {
+            neighbors << index + distance; }
+        if (index - distance >= 1) {
+            neighbors << index - distance; } }
+
+    // Keep the still valid entries, and prefetch all the rest
+    QList<int> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+            if (neighbors.contains(it.key()) AND it.value().settings == settings) {
+                ++it; }
+            else {
+                it = m_entries.erase(it); } }
+        for (const int neighbor : neighbors) {
+            if (!m_entries.contains(neighbor)) {
+                pending << neighbor; } }
+    }
+
+    if (pending.isEmpty()) {
+        return; }
+
+    // The results may be shared with the output table, unshare them before the worker sets them
+    m_scans->m_results.detach();
+
+    m_canceled.store(0);
+    m_future = QtConcurrent::run(&m_threadPool, [this, pending, settings] () {
+        run(pending, settings); }); }
+
+/*!
+    Treats the scan with the 1-based \a index of the scan array \a scans using the
+    common \a settings, unless the scan is individually treated.
+*/
+void As::ScanPrefetcher::treat(As::ScanArray* scans,
+                               const int index,
+                               const As::ScanPrefetcher::Settings& settings) {
+    As::Scan* scan = scans->at(index - 1);
+
+    if (!scan->isIndividuallyTreated()) {
+        settings.applyTo(scan); }
+
+    if (settings.plotType == As::PlotType::Integrated AND scan->plotType() != As::PlotType::Excluded) {
+        scans->treatSinglePeak(index - 1); } }
+
+/*!
+    Treats the scans with the given 1-based \a indices using the common \a settings
+    and prepares their plot data. Runs in the worker thread.
+*/
+void As::ScanPrefetcher::run(const QList<int> indices,
+                             const As::ScanPrefetcher::Settings settings) {
+    QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+    for (const int index : indices) {
+        if (m_canceled.load()) {
+            return; }
+
+        const As::Scan* scan = m_scans->at(index - 1);
+        if (scan->isIndividuallyTreated()) {
+            continue; }
+
+        treat(m_scans, index, settings);
+
+        Entry entry;
+        entry.settings = settings;
+        entry.series.x  = scan->data("angles", scan->scanAngle());
+        entry.series.y  = scan->data("intensities", "DetectorNorm");
+        entry.series.sy = scan->data("intensities", "sDetectorNorm");
+
+        QMutexLocker locker(&m_mutex);
+        m_entries.insert(index, entry); } }
+
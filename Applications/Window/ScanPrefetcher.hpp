@@ -0,0 +1,110 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef AS_SCANPREFETCHER_HPP
+#define AS_SCANPREFETCHER_HPP
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+
+#include "Constants.hpp"
+
+#include "RealVector.hpp"
+#include "Scan.hpp"
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ScanArray;
+
+class ScanPrefetcher : public QObject {
+    Q_OBJECT
+
+  public:
+    // Common treatment settings, which are copied to every not individually treated scan
+    struct Settings {
+        As::Scan::NeighborsRemoveType neighborsRemoveType = As::Scan::ManualNeighborsRemove;
+        As::Scan::PeakAnalysisType peakAnalysisType = As::Scan::PeakIntegration;
+        As::Scan::BkgDetectType bkgDetectType = As::Scan::AutoBkgDetect;
+        As::Scan::PeakFitType peakFitType = As::Scan::GaussFit;
+        As::PlotType plotType = As::PlotType::Raw;
+        int numLeftSkipPoints = 0;
+        int numRightSkipPoints = 0;
+        int numLeftBkgPoints = 0;
+        int numRightBkgPoints = 0;
+
+        static Settings fromScan(const As::Scan* scan);
+        void applyTo(As::Scan* scan) const;
+        bool operator==(const Settings& other) const; };
+
+    // Data series to be plotted
+    struct Series {
+        As::RealVector x;
+        As::RealVector y;
+        As::RealVector sy; };
+
+    static const int DEFAULT_RANGE;
+
+    ScanPrefetcher(QObject* parent = Q_NULLPTR);
+    ~ScanPrefetcher();
+
+    void setScanArray(As::ScanArray* scans);
+    void setRange(const int range);
+    int range() const;
+
+    void cancel();
+    bool take(const int index,
+              const As::ScanPrefetcher::Settings& settings,
+              As::ScanPrefetcher::Series* series);
+    void prefetch(const int index,
+                  const As::ScanPrefetcher::Settings& settings);
+
+    static void treat(As::ScanArray* scans,
+                      const int index,
+                      const As::ScanPrefetcher::Settings& settings);
+
+  private:
+    struct Entry {
+        Settings settings;
+        Series series; };
+
+    void run(const QList<int> indices,
+             const As::ScanPrefetcher::Settings settings);
+
+    As::ScanArray* m_scans = Q_NULLPTR;
+    int m_range;
+
+    QThreadPool m_threadPool;     // Single low-priority worker
+    QFuture<void> m_future;       // Currently running prefetch
+    QAtomicInt m_canceled;        // Set to stop the running prefetch after the current scan
+
+    QMutex m_mutex;               // Protects the prepared entries
+    QHash<int, Entry> m_entries;  // Prepared scans by their 1-based index
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_SCANPREFETCHER_HPP
+
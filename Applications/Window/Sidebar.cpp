@@ -46,6 +46,8 @@
 #include "PushButtonWithProgress.hpp"
 #include "ProgressBar.hpp"
 #include "ProgressDialog.hpp"
+#include "ScanPrefetcher.hpp"
+#include "ResultTable.hpp"
 #include "Scan.hpp"
 #include "ScanDict.hpp"
 #include "SpinBox.hpp"
@@ -216,8 +218,20 @@ As::GroupBox* As::Window::create_Common_ChangeCurrentScanGroup() {
     connect(excludeScan, &As::CheckBox::stateChanged,
             this, &As::Window::createFullOutputTableModel_Slot);
 
+    // Relatives: Go to reflection
+    auto hklField = new As::LineEdit;
+    hklField->setObjectName("hklField"); // required in the findScanByHkl_Slot()
+    hklField->setToolTip(tr("Enter the Miller indices h k l to go to the next scan of this reflection."));
+    hklField->setPlaceholderText(tr("Go to hkl, e.g. 1 0 -2"));
+    hklField->setStyleSheet(QString("color: %1").arg(As::Color(As::gray).name()));
+    connect(hklField, &As::LineEdit::returnPressed, this, [this, hklField, scanChanger]() {
+        const int index = findScanByHkl_Slot(hklField->text());
+        if (index > 0) {
+            scanChanger->setValue(index); } });
+
     auto layout = new QVBoxLayout;
     layout->addWidget(scanBlock);
+    layout->addWidget(hklField);
     layout->addWidget(excludeScan);
 
     auto group = new As::GroupBox;
@@ -663,9 +677,8 @@ As::GroupBox* As::Window::create_Plot_PeakIntegrateGroup(const QString& objectNa
 
     // Relatives: Fit type
     auto fitType = new As::ComboBox;
-    //fitType->setToolTip(tr("Select function for the peak fitting"));
+    fitType->setToolTip(tr("Select function for the peak fitting"));
     fitType->addItems(As::Scan::PeakFitTypeDict.values());
-    fitType->hide(); //hide until implemented
     connect(fitType, QOverload<int>::of(&As::ComboBox::currentIndexChanged),
             this, &As::Window::selectPeakFitType);
 
@@ -792,6 +805,14 @@ As::GroupBox* As::Window::create_Output_FormatGroup(const QString& objectName,
     connect(exportExcluded, &As::CheckBox::toggled,
             this, &As::Window::exportExcluded_Slot);
 
+    // Relatives: Export of the reflections measured repeatedly at the same conditions
+    auto repeatPolicy = new As::ComboBox;
+    repeatPolicy->setToolTip(tr("Select how the reflections measured repeatedly at the same conditions are exported."));
+    repeatPolicy->addItems(As::RepeatedMeasurements::PolicyDict.values());
+    repeatPolicy->setCurrentIndex(As::RepeatedMeasurements::PolicyDict.keys().indexOf(savedRepeatPolicy()));
+    connect(repeatPolicy, QOverload<int>::of(&As::ComboBox::currentIndexChanged),
+            this, &As::Window::selectRepeatPolicy_Slot);
+
     auto alwaysSaveHeaders = new As::CheckBox(tr("Always save headers"));
     alwaysSaveHeaders->setToolTip(tr("Always save headers in the output files."));
     alwaysSaveHeaders->setChecked(isAlwaysHeadersSaved);
@@ -800,6 +821,7 @@ As::GroupBox* As::Window::create_Output_FormatGroup(const QString& objectName,
 
     auto layout = new QVBoxLayout;
     layout->addWidget(exportExcluded);
+    layout->addWidget(repeatPolicy);
     layout->addWidget(alwaysSaveHeaders);
 
     auto group = new As::GroupBox(objectName, title);
@@ -819,11 +841,13 @@ void As::Window::createFullOutputTableModel_Slot() {
         return; }
 
     // Create full output table for every scan using multi-thread
+    m_prefetcher->cancel();
     m_scans->createFullOutputTable();
 
     // Number of columns and rows for the required table
-    const int columnCount = m_scans->m_outputTableHeaders.size();
-    const int rowCount = m_scans->size();
+    const As::ResultTable& outputTable = m_scans->m_outputTable;
+    const int columnCount = outputTable.columnCount();
+    const int rowCount = outputTable.rowCount();
 
     // Create model
     auto tableModel = new QStandardItemModel;
@@ -832,12 +856,12 @@ void As::Window::createFullOutputTableModel_Slot() {
 
     // Set headers
     for (int iColumn = 0; iColumn < columnCount; ++iColumn) {
-        tableModel->setHorizontalHeaderItem(iColumn, new QStandardItem(m_scans->m_outputTableHeaders[iColumn])); }
+        tableModel->setHorizontalHeaderItem(iColumn, new QStandardItem(outputTable.headers()[iColumn])); }
 
     // Set values
     for (int iRow = 0; iRow < rowCount; ++iRow) {
         for (int iColumn = 0; iColumn < columnCount; ++iColumn) {
-            tableModel->setItem(iRow, iColumn, new QStandardItem(m_scans->m_outputTableData[iRow][iColumn]));
+            tableModel->setItem(iRow, iColumn, new QStandardItem(outputTable.printCell(iRow, iColumn)));
             tableModel->item(iRow, iColumn)->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter); } }
 
     // Set model
@@ -22,6 +22,9 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QModelIndex>
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -43,9 +46,13 @@
 #include "SaveHeaders.hpp"
 #include "SpinBox.hpp"
 #include "SyntaxHighlighter.hpp"
+#include "OverviewPlot.hpp"
 #include "Plot.hpp"
+#include "PlotExporter.hpp"
 #include "PreferencesDialog.hpp"
 #include "ProgressBar.hpp"
+#include "ProgressDialog.hpp"
+#include "ScanPrefetcher.hpp"
 #include "TableView.hpp"
 #include "VBoxLayout.hpp"
 
@@ -113,7 +120,7 @@ void As::Window::export_Slot() {
 
     auto currentTab = m_tabsWidget->currentWidget();
 
-    if (currentTab == m_visualizedPlotsWidget) {
+    if (currentTab == m_visualizedPlotsWidget OR currentTab == m_overviewPlotWidget) {
         exportImage_Slot(); }
 
     else if (currentTab == m_outputTableWidget) {
@@ -137,14 +144,83 @@ void As::Window::exportImage_Slot() {
     QFile file(filename);
     file.open(QIODevice::WriteOnly);
 
+    auto plot = qobject_cast<QCustomPlot*>(m_tabsWidget->currentWidget());
+
     if (file.fileName().endsWith("jpg")) {
-        m_visualizedPlotsWidget->saveJpg(filename, 0, 0, 1.0, 100); }
+        plot->saveJpg(filename, 0, 0, 1.0, 100); }
 
     else if (file.fileName().endsWith("pdf")) {
-        m_visualizedPlotsWidget->savePdf(filename, true, 0, 0, "", ""); }
+        plot->savePdf(filename, true, 0, 0, "", ""); }
 
     file.close(); }
 
+/*!
+    Exports the plots of all or some of the scans at once.
+*/
+void As::Window::exportPlots_Slot() {
+    ADEBUG;
+
+    // Select the scans
+    bool ok = false;
+    const QString text = QInputDialog::getText(this,
+                                               tr("Export Plots"),
+                                               tr("Scans to export, e.g. 1-20, 35 (empty for all):"),
+                                               QLineEdit::Normal, "", &ok);
+    if (!ok) {
+        return; }
+
+    QVector<int> indices = As::PlotExporter::parseScanList(text, m_scans->size(), &ok);
+    if (!ok) {
+        As::MessageWidget(this, "", "Warning: Wrong list of scans.", "   OK   ", "", false).exec();
+        return; }
+
+    // Skip the excluded scans, unless they are exported to the output files as well
+    if (!QSettings().value("OutputSettings/exportExcluded", false).toBool()) {
+        QVector<int> included;
+        for (const int index : indices) {
+            if (scanAt(index + 1)->plotType() != As::PlotType::Excluded) {
+                included << index; } }
+        indices = included; }
+
+    if (indices.isEmpty()) {
+        As::MessageWidget(this, "", "Warning: All the selected scans are excluded.", "   OK   ", "", false).exec();
+        return; }
+
+    // Select the output
+    QString selectedFilter;
+    const QString multiPagePdfFilter = tr("PDF, all scans in one file (*.pdf)");
+    const QString pngPerScanFilter = tr("PNG, one file per scan (*.png)");
+    const QString filename = QFileDialog::getSaveFileName(
+                                 this,
+                                 tr("Export Plots"),
+                                 currentScan()->absolutePathWithBaseName() + ".pdf",
+                                 multiPagePdfFilter + ";;" +
+                                 tr("PDF, one file per scan (*.pdf)") + ";;" +
+                                 pngPerScanFilter,
+                                 &selectedFilter);
+    if (filename.isEmpty()) {
+        return; }
+
+    As::PlotExporter::Format format = As::PlotExporter::PdfPerScan;
+    if (selectedFilter == multiPagePdfFilter) {
+        format = As::PlotExporter::MultiPagePdf; }
+    else if (selectedFilter == pngPerScanFilter) {
+        format = As::PlotExporter::PngPerScan; }
+
+    // Export with progress, the scans are treated again by the exporter
+    m_prefetcher->setScanArray(m_scans);
+
+    As::PlotExporter exporter;
+    connect(&exporter, &As::PlotExporter::progressRangeChanged,
+            m_progressDialog, &As::ProgressDialog::setRange);
+    connect(&exporter, &As::PlotExporter::progressValueChanged,
+            m_progressDialog, &As::ProgressDialog::setValue);
+
+    const QString path = format == As::PlotExporter::MultiPagePdf ? filename : QFileInfo(filename).absolutePath();
+    const auto settings = As::ScanPrefetcher::Settings::fromScan(genericScan());
+    if (!exporter.exportScans(m_scans, indices, settings, format, path)) {
+        As::MessageWidget(this, "", "Warning: Not all the plots were exported.", "   OK   ", "", false).exec(); } }
+
 /*!
     Exports the output table.
 */
@@ -177,10 +253,12 @@ void As::Window::exportOutputTable_Slot() {
                               "ShelX with direction cosines, real (*.hkl);;"
                               "TBAR/D9, integer (*.tb);;"
                               "UMWEG, integer (*.obs);;"
-                              "CCSL flipping ratios, integer (*.fli)"),
+                              "CCSL flipping ratios, integer (*.fli);;"
+                              "Davinci binary columnar, real (*.dvc)"),
                            &format); // can be a problem on linux: http://www.qtcentre.org/threads/21019-Determining-selected-filter-on-getSaveFileName
 
     // Save selected columns
+    m_prefetcher->cancel();
     m_scans->saveSelectedOutputColumns(fileName, format); }
 
 /*!
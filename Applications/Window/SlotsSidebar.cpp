@@ -25,6 +25,7 @@
 #include <QModelIndex>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QRegularExpression>
 #include <QSettings>
 #include <QString>
 #include <QStringList>
@@ -47,9 +48,12 @@
 #include "SaveHeaders.hpp"
 #include "SpinBox.hpp"
 #include "SyntaxHighlighter.hpp"
+#include "ExtractedTableModel.hpp"
+#include "OverviewPlot.hpp"
 #include "Plot.hpp"
 #include "PreferencesDialog.hpp"
 #include "ProgressDialog.hpp"
+#include "ScanPrefetcher.hpp"
 #include "TableView.hpp"
 #include "VBoxLayout.hpp"
 
@@ -75,23 +79,13 @@ void As::Window::gotoScan_Slot(const int index) {
     // Set the scan index
     emit currentScanChanged_Signal(index);
 
-    //if (!scanAt(index)->m_isIndividuallyTreated) {
-    if (!currentScan()->isIndividuallyTreated()) {
-        currentScan()->setNeighborsRemoveType( genericScan()->neighborsRemoveType() );
+    // Take the scan prepared in background, or treat it now with the common settings
+    const auto settings = As::ScanPrefetcher::Settings::fromScan(genericScan());
+    As::ScanPrefetcher::Series series;
+    const bool isPrefetched = m_prefetcher->take(index, settings, &series);
 
-        currentScan()->m_numLeftSkipPoints = genericScan()->m_numLeftSkipPoints;
-        currentScan()->m_numRightSkipPoints = genericScan()->m_numRightSkipPoints;
-
-        currentScan()->setPeakAnalysisType( genericScan()->peakAnalysisType() );
-        currentScan()->setBkgDetectType( genericScan()->bkgDetectType() );
-        currentScan()->setPeakFitType( genericScan()->peakFitType() );
-
-        currentScan()->m_numLeftBkgPoints = genericScan()->m_numLeftBkgPoints;
-        currentScan()->m_numRightBkgPoints = genericScan()->m_numRightBkgPoints; }
-
-    // Treat current scan conditions
-    if (genericScan()->plotType() == As::PlotType::Integrated AND currentScan()->plotType() != As::PlotType::Excluded) {
-        m_scans->treatSinglePeak(index - 1); }
+    if (!isPrefetched) {
+        As::ScanPrefetcher::treat(m_scans, index, settings); }
 
     //
     m_scans->setScanIndex(index);
@@ -103,14 +97,18 @@ void As::Window::gotoScan_Slot(const int index) {
         emit excludeScanStateChanged_Signal(false); }
 
     // Update the extracted tables
-    emit extractedTableModelChanged(scanAt(index)->extractedTableModel());
+    m_extractedTableModel->setScan(scanAt(index));
+    emit extractedTableModelChanged(m_extractedTableModel);
 
     // Update the text widget
     m_inputTextWidget->setCursorPosition(currentScan()->scanLine());
 
     // Update the visualized plot
     if (m_visualizedPlotsWidget) {
-        m_visualizedPlotsWidget->updateAllOnPlot(scanAt(index));
+        if (isPrefetched) {
+            m_visualizedPlotsWidget->updateAllOnPlot(scanAt(index), series.x, series.y, series.sy); }
+        else {
+            m_visualizedPlotsWidget->updateAllOnPlot(scanAt(index)); }
         //updateChangeScanGroup(scanAt(index));
         update_Plot_ExpDetailsGroup(scanAt(index));
         update_Plot_ExpAnglesGroup(scanAt(index));
@@ -123,7 +121,61 @@ void As::Window::gotoScan_Slot(const int index) {
         // next to lines are done when we switch to the output table tab only
         //m_scans->createFullOutputTable(); // slows down scan change via go to
         //createFullOutputTableModel_Slot(); // further slows down...
-        update_OutputTable_Highlight(index - 1); } }
+        update_OutputTable_Highlight(index - 1); }
+
+    // Update the overview with the just treated scan
+    if (m_overviewPlotWidget) {
+        m_overviewPlotWidget->updateScan(index - 1);
+        m_overviewPlotWidget->setCurrentScan(index - 1); }
+
+    // Prepare the neighbors in background
+    m_prefetcher->prefetch(index, settings); }
+
+/*!
+    Returns the index of the next scan after the current one, measured at the
+    reflection given by the Miller indices in \a text, or 0 if no such scan is found.
+    The integer indices are looked up in the reflection index, the non-integer ones
+    are searched within the default tolerance in the reciprocal space.
+*/
+int As::Window::findScanByHkl_Slot(const QString& text) {
+    ADEBUG << text;
+
+    auto hklField = findChild<As::LineEdit*>("hklField");
+
+    // Parse the Miller indices
+    const QStringList list = text.split(QRegularExpression("[\\s,;]+"), QString::SkipEmptyParts);
+    QVector<qreal> hkl;
+    for (const QString& item : list) {
+        bool ok = false;
+        hkl << item.toDouble(&ok);
+        if (!ok) {
+            hkl.clear();
+            break; } }
+
+    // Find the scans of the reflection
+    QVector<int> found;
+    if (hkl.size() == 3 AND m_scans != Q_NULLPTR AND m_scans->size() > 0) {
+        if (m_scans->reflectionIndex().isEmpty()) {
+            m_scans->updateReflectionIndex(); }
+        found = m_scans->findScans(hkl[0], hkl[1], hkl[2]); }
+
+    // Go to the next one after the current scan, if any
+    int index = 0;
+    for (const int i : found) {
+        if (i + 1 > currentScanIndex()) {
+            index = i + 1;
+            break; } }
+    if (index == 0 AND !found.isEmpty()) {
+        index = found.first() + 1; }
+
+    // Define color for the hklField depends on searching result
+    As::Color color = As::gray;
+    if (index == 0 AND !text.trimmed().isEmpty()) {
+        color = As::red; }
+    if (hklField) {
+        hklField->setStyleSheet(QString("#hklField {color: %1}").arg(color.name())); }
+
+    return index; }
 
 /*!
     ...
@@ -202,7 +254,7 @@ void As::Window::extractScans_Slot() {
     // Extract data from raw input using multi-threading
     //m_scans->extractInputData();
     concurrentRun("extract", m_scans);
-
+    m_scans->saveSessionCache();
 
     // Exit from function if no scans were found
     if (m_scans->size() == 0) {
@@ -458,7 +510,8 @@ void As::Window::visualizePlots_Slot() {
         ///if (size > 0) {
         ///    emit newScansPlotted_Signal(currentScanIndex()-1); }
 
-        m_tabsWidget->addTab(m_visualizedPlotsWidget, "Visualized Plots"); }
+        m_tabsWidget->addTab(m_visualizedPlotsWidget, "Visualized Plots");
+        emit newScansPlotted_Signal(m_scans->size()); }
 
     // ...
     //updateCurrentScan();
@@ -613,10 +666,22 @@ void As::Window::calcStructureFactor_Slot() {
 void As::Window::showOutput_Slot() {
     ADEBUG_H3;
 
-    // Run data treatment using multi-threading
+    // Apply the common peak analysis to all the scans, which are not individually treated
+    m_prefetcher->cancel();
+    for (int i = 0; i < m_scans->size(); ++i) {
+        As::Scan* scan = m_scans->at(i);
+        if (!scan->isIndividuallyTreated()) {
+            scan->setPeakAnalysisType( genericScan()->peakAnalysisType() );
+            scan->setPeakFitType( genericScan()->peakFitType() ); } }
+
+    // Run data treatment (incl. peak fitting, if selected) using multi-threading
     concurrentRun("treat", m_scans);
     emit peaksTreatmentIsFinished(true);
 
+    // Re-read all the scans shown in the overview, if any
+    if (m_overviewPlotWidget) {
+        m_overviewPlotWidget->updateAllScans(); }
+
     // Create widget if not yet created
     if (m_outputTableWidget == Q_NULLPTR) {
         m_outputTableWidget = new As::TableView();
@@ -631,6 +696,28 @@ void As::Window::showOutput_Slot() {
 
     ADEBUG; }
 
+/*!
+    Shows all the treated scans at once in the overview plot of the given \a mode.
+*/
+void As::Window::showOverview_Slot(const int mode) {
+    ADEBUG << "mode:" << mode;
+
+    // The scans must not be changed in background while they are read
+    m_prefetcher->cancel();
+
+    // Create widget if not yet created
+    if (m_overviewPlotWidget == Q_NULLPTR) {
+        m_overviewPlotWidget = new As::OverviewPlot();
+        m_overviewPlotWidget->setMode(static_cast<As::OverviewPlot::Mode>(mode));
+        m_overviewPlotWidget->setScanArray(m_scans);
+        m_tabsWidget->addTab(m_overviewPlotWidget, "Overview"); }
+    else {
+        m_overviewPlotWidget->setMode(static_cast<As::OverviewPlot::Mode>(mode)); }
+    m_overviewPlotWidget->setCurrentScan(currentScanIndex() - 1);
+
+    // Set focus
+    m_tabsWidget->setCurrentWidget(m_overviewPlotWidget); }
+
 //================
 // Plot - Settings
 //================
@@ -658,6 +745,25 @@ void As::Window::exportExcluded_Slot(const bool save) {
 
     QSettings().setValue("OutputSettings/exportExcluded", save); }
 
+/*!
+    Selects the policy of the export of the repeated measurements by its \a index
+    in As::RepeatedMeasurements::PolicyDict.
+*/
+void As::Window::selectRepeatPolicy_Slot(const int index) {
+    ADEBUG << "index:" << index;
+
+    const auto policy = As::RepeatedMeasurements::PolicyDict.keys().value(index, As::RepeatedMeasurements::KeepAll);
+    QSettings().setValue("OutputSettings/repeatPolicy", As::RepeatedMeasurements::PolicyNameDict.value(policy));
+    if (m_scans) {
+        m_scans->setRepeatPolicy(policy); } }
+
+/*!
+    Returns the policy of the export of the repeated measurements saved in the settings.
+*/
+As::RepeatedMeasurements::Policy As::Window::savedRepeatPolicy() const {
+    const QString name = QSettings().value("OutputSettings/repeatPolicy").toString();
+    return As::RepeatedMeasurements::PolicyNameDict.key(name, As::RepeatedMeasurements::KeepAll); }
+
 /*!
     ...
 */
@@ -58,10 +58,12 @@
 
 #include "ConcurrentWatcher.hpp"
 #include "ComboBox.hpp"
+#include "ExtractedTableModel.hpp"
 #include "FontComboBox.hpp"
 #include "LineEdit.hpp"
 #include "MessageWidget.hpp"
 #include "ProgressDialog.hpp"
+#include "ScanPrefetcher.hpp"
 #include "Style.hpp"
 #include "SyntaxHighlighter.hpp"
 #include "TableView.hpp"
@@ -70,6 +72,7 @@
 #include "ToolBarSpacer.hpp"
 #include "UnderLabeledWidget.hpp"
 
+#include "InputReader.hpp"
 #include "Scan.hpp"
 #include "ScanArray.hpp"
 #include "ScanDict.hpp"
@@ -83,10 +86,16 @@ As::Window::Window() {
     //printAppInfo_Slot();
     SetDebugOutputFormat(IS_DEBUG_OR_PROFILE);
 
+    // Number of threads set in the preferences
+    As::ConcurrentWatcher::setThreadCount(QSettings().value("Preferences/threadCount", 0).toInt());
+    As::ConcurrentWatcher::setIoThreadCount(QSettings().value("Preferences/ioThreadCount", 0).toInt());
+
     setStyleSheet(createStyleSheet());
     createActionsMenusToolBar();
     //createStatusBar();
     setAcceptDrops(true);
+    m_prefetcher = new As::ScanPrefetcher(this);
+    m_extractedTableModel = new As::ExtractedTableModel(this);
     setCentralWidget(createDragAndDropWidget()); // Initial central widget before new files are loaded
     //setCentralWidget(createMainWidget());
     setupWindowSizeAndPosition();
@@ -155,10 +164,13 @@ void As::Window::loadFiles(const QStringList& filePathList) {
     QSettings().setValue("MainWindow/filePathLastOpen", fileLastOpen.absolutePath());
 
     // Create or re-create the scan array
+    m_prefetcher->setScanArray(Q_NULLPTR);
     if (m_scans != Q_NULLPTR) {
         delete m_scans;
         m_scans = Q_NULLPTR; }
     m_scans = new As::ScanArray;
+    m_scans->setRepeatPolicy(savedRepeatPolicy());
+    m_prefetcher->setScanArray(m_scans);
 
     // Signal-slot connections for the scans array
     //connect(this, SIGNAL(currentFileIndexChanged_Signal(int)), m_scans, SLOT(setModel(int)));
@@ -194,29 +206,23 @@ void As::Window::loadFiles(const QStringList& filePathList) {
     // Create or re-create main widget
     setCentralWidget(createMainWidget()); // dragAndDropWidget is then deleted automatically
 
-    // Read all files contents
-    for (const auto& path : filePathList) {
-        // Open file
-        QFile file(path);
-
-        if (!file.open(QFile::ReadOnly | QFile::Text)) {
-            QMessageBox::warning(this,
-                                 tr("Application"),
-                                 tr("Cannot read file %1:\n%2.")
-                                 .arg(QDir::toNativeSeparators(path), file.errorString()));
-            return; }
-
-        // Read file content to QStringList using QTextStream
-        QTextStream textStream(&file);
-        textStream.setAutoDetectUnicode(true);
-        //textStream.setCodec("MacRoman"); // "ISO 8859-1", "UTF-8", "UTF-16", "MacRoman" (POLI)
-        // Add file path and content to the global variable
-        m_scans->m_inputFilesContents.first  << path;
-        m_scans->m_inputFilesContents.second << textStream.readAll(); }
+    // Read all files contents, including the members of the archives, and add them to the global variable
+    QString error;
+    if (!As::InputReader::readFiles(filePathList,
+                                    m_scans->m_inputFilesContents.first,
+                                    m_scans->m_inputFilesContents.second,
+                                    error)) { // "ISO 8859-1", "UTF-8", "UTF-16", "MacRoman" (POLI)
+        QMessageBox::warning(this,
+                             tr("Application"),
+                             error);
+        return; }
 
     // To disable actions and buttons. False - to use both with setEnabled and setChecked
     emit oldFilesClosed_Signal(false);
 
+    // Restore the scans of the unchanged files from the session cache, if possible
+    m_scans->loadSessionCache();
+
     // Detect data
     bool ok = m_scans->detectInputFilesType();
 
@@ -225,6 +231,7 @@ void As::Window::loadFiles(const QStringList& filePathList) {
         msgBox->setIcon(QMessageBox::Warning);
         msgBox->setText("Files of multiple types were selected for opening."
                         "Please open the files of the same type only.");
+        msgBox->setDetailedText(m_scans->inputFilesTypesReport().join("\n"));
         msgBox->exec();
         m_scans->m_inputFilesContents = oldInputFilesContents;
         openFile_Slot(); }
@@ -490,6 +497,9 @@ QString As::Window::maintainerPath() {
 */
 void As::Window::concurrentRun(const QString& type,
                                As::ScanArray* scans) const {
+    // The whole array is processed, so the scans prepared in background are outdated
+    m_prefetcher->setScanArray(scans);
+
     As::ConcurrentWatcher watcher;
 
     connect(&watcher, &As::ConcurrentWatcher::started,
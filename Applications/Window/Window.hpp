@@ -45,10 +45,13 @@ template<typename> class QList;
 namespace As { //AS_BEGIN_NAMESPACE
 
 class ComboBox;
+class ExtractedTableModel;
 class GroupBox;
 class Label;
+class OverviewPlot;
 class Plot;
 class ProgressDialog;
+class ScanPrefetcher;
 class SpinBox;
 class Sidebar;
 class SaveHeaders;
@@ -130,6 +133,7 @@ class Window : public QMainWindow {
     void closeFile_Slot();
     void export_Slot();
     void exportImage_Slot();
+    void exportPlots_Slot();
     void exportOutputTable_Slot();
     void aboutApp_Slot();
     void showPreferences_Slot();
@@ -147,6 +151,7 @@ class Window : public QMainWindow {
 
     // For all sidebar tabs
     void gotoScan_Slot(const int index);
+    int findScanByHkl_Slot(const QString& text);
     void updateScan_Slot();
     void excludeScan_Slot(const bool exclude);
     void autoProcessing_Slot();
@@ -188,10 +193,12 @@ class Window : public QMainWindow {
 
     void calcStructureFactor_Slot();
     void showOutput_Slot();
+    void showOverview_Slot(const int mode);
     void hideLegend_Slot(const bool hide);
 
     // For output sidebar tab
     void exportExcluded_Slot(const bool save);
+    void selectRepeatPolicy_Slot(const int index);
     void alwaysSaveHeaders_Slot(const bool save);
 
   private:
@@ -212,6 +219,7 @@ class Window : public QMainWindow {
     // Misc
     void openFiles(const QStringList& pathList);
     QString maintainerPath();
+    As::RepeatedMeasurements::Policy savedRepeatPolicy() const;
 
     // Update widgets
     //void updateChangeScanGroup(const As::Scan &scan);
@@ -235,6 +243,10 @@ class Window : public QMainWindow {
     // Array of experimental scans and single scan
     As::ScanArray* m_scans = Q_NULLPTR;
     As::Scan* m_commonScan = Q_NULLPTR;
+    // Background treatment of the neighbors of the current scan
+    As::ScanPrefetcher* m_prefetcher = Q_NULLPTR;
+    // Extracted data of the current scan
+    As::ExtractedTableModel* m_extractedTableModel = Q_NULLPTR;
     // Misc
     //QFontComboBox *monospacedFonts;
     QTimer* m_delayBeforeSearching;
@@ -262,6 +274,7 @@ class Window : public QMainWindow {
     //QPointer<As::TableView> m_extractedTableWidget; //signal-slot description doesn't work with QPointer in linux gcc
     //As::TableView *m_extractedTableWidget;          //with * works in linux gcc, but pointer is not set automatically to 0...
     QPointer<As::Plot> m_visualizedPlotsWidget;
+    QPointer<As::OverviewPlot> m_overviewPlotWidget;
     QPointer<As::TableView> m_outputTableWidget;    // with simple pointer crashes if reopen files... fix!
     //As::TableView* m_outputTableWidget;
 
@@ -0,0 +1,508 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QtMath>
+
+#include <algorithm>
+#include <numeric>
+
+#include "Functions.hpp"
+#include "Macros.hpp"
+
+#include "ConcurrentWatcher.hpp"
+#include "Generator.hpp"
+#include "RealVector.hpp"
+#include "Scan.hpp"
+#include "ScanArray.hpp"
+
+#include "Benchmark.hpp"
+
+/*!
+    \class As::Benchmark
+
+    \brief The Benchmark is a class that measures the time of every stage of the data
+    processing pipeline and of the hot kernels on the example datasets.
+
+    Every dataset (subdirectory of the examples directory) can be replicated up to the
+    required number of reflections. Every measurement is repeated several times after
+    the warm-up runs, and the median, minimum and mean times are reported. The results
+    can be saved in JSON format and compared with the previously saved baseline.
+
+    \inmodule Benchmarks
+*/
+
+/*!
+    Constructs a benchmark with the given \a parent.
+*/
+As::Benchmark::Benchmark(QObject* parent)
+    : QObject(parent) {
+    As::SetDebugOutputFormat(false);
+    createCommandLineParser(qApp); }
+
+/*!
+    Destroys the benchmark.
+*/
+As::Benchmark::~Benchmark() {}
+
+/*!
+    Process the actual command line arguments given by the user
+    for a given core application \a app.
+*/
+void As::Benchmark::createCommandLineParser(QCoreApplication* app) {
+    m_parser.setApplicationDescription(QString("%1 v%2 benchmarks").arg(APP_NAME).arg(APP_VERSION));
+
+    m_parser.addHelpOption();
+    m_parser.addOptions({{{"e", "examples" }, "Directory with the example datasets (one per subdirectory).", "dir" },
+        {{"d", "datasets" },    "Comma separated list of the datasets to run. Default: all.", "list" },
+        {{"n", "reflections" }, "Replicate every dataset up to at least <count> reflections.", "count" },
+        {{"r", "repetitions" }, "Number of the measured repetitions. Default: 5.", "count" },
+        {{"w", "warmup" },      "Number of the warm-up runs. Default: 1.", "count" },
+        {{"o", "output" },      "File to save the results in JSON format.", "file" },
+        {{"b", "baseline" },    "File with the baseline results in JSON format to compare with.", "file" },
+        {{"t", "tolerance" },   "Allowed slowdown with respect to the baseline, in %. Default: 10.", "percent" },
+        {{"g", "generate" },    "Generate synthetic input files in <dir> instead of running the benchmarks.", "dir" },
+        {{"f", "format" },      "Format of the generated files: dif4, log, nicos or xml. Default: dif4.", "name" },
+        {{"p", "points" },      "Number of points per generated scan. Default: 31.", "count" },
+        {{"s", "seed" },        "Seed of the random number generator. Default: 1.", "number" },
+        {"polarised",           "Generate polarised up/down channels (nicos and xml only)." }, });
+
+    m_parser.process(*app);
+
+    if (!m_parser.value("repetitions").isEmpty()) {
+        m_repetitions = qMax(1, m_parser.value("repetitions").toInt()); }
+    if (!m_parser.value("warmup").isEmpty()) {
+        m_warmup = qMax(0, m_parser.value("warmup").toInt()); }
+    if (!m_parser.value("reflections").isEmpty()) {
+        m_reflections = qMax(0, m_parser.value("reflections").toInt()); }
+    if (!m_parser.value("tolerance").isEmpty()) {
+        m_tolerance = m_parser.value("tolerance").toDouble() / 100; } }
+
+/*!
+    Runs all the required benchmarks. Returns 0 on success, 1 if a performance regression
+    with respect to the baseline is found and 2 on error.
+*/
+int As::Benchmark::run() {
+    if (!m_parser.value("generate").isEmpty()) {
+        return generate(); }
+
+    const QString examplesPath = m_parser.value("examples");
+    const QDir examplesDir(examplesPath);
+
+    if (examplesPath.isEmpty() OR !examplesDir.exists()) {
+        printMessage(QString("Cannot find examples dir '%1'.").arg(QDir::toNativeSeparators(examplesPath)));
+        printMessage("Run the program with '--help' or '-h' to see more.");
+        return 2; }
+
+    QTemporaryDir exportDir;
+    if (!exportDir.isValid()) {
+        printMessage("Cannot create temporary dir for the exported files.");
+        return 2; }
+    m_exportDir = exportDir.path();
+
+    QStringList names = examplesDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    if (!m_parser.value("datasets").isEmpty()) {
+        names = m_parser.value("datasets").split(",", QString::SkipEmptyParts); }
+
+    QJsonObject datasets;
+
+    for (const QString& name : names) {
+        QStringList paths, contents;
+
+        if (!loadDataset(examplesDir.filePath(name), paths, contents)) {
+            printMessage(QString("Skip dataset '%1': cannot read files.").arg(name));
+            continue; }
+
+        const QJsonObject result = runDataset(name, paths, contents);
+
+        if (result.isEmpty()) {
+            printMessage(QString("Skip dataset '%1': no reflections processed.").arg(name));
+            continue; }
+
+        datasets.insert(name, result); }
+
+    const QJsonObject results{
+        { "application", APP_NAME },
+        { "version", APP_VERSION },
+        { "threads", QThread::idealThreadCount() },
+        { "repetitions", m_repetitions },
+        { "warmup", m_warmup },
+        { "reflections", m_reflections },
+        { "datasets", datasets } };
+
+    // Save results
+    const QString outputPath = m_parser.value("output");
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            printMessage(QString("Cannot write file '%1'.").arg(QDir::toNativeSeparators(outputPath)));
+            return 2; }
+        file.write(QJsonDocument(results).toJson(QJsonDocument::Indented));
+        printMessage(QString("Results:  %1").arg(QDir::toNativeSeparators(outputPath))); }
+
+    // Compare with baseline
+    const QString baselinePath = m_parser.value("baseline");
+    if (!baselinePath.isEmpty()) {
+        QFile file(baselinePath);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            printMessage(QString("Cannot read file '%1'.").arg(QDir::toNativeSeparators(baselinePath)));
+            return 2; }
+        const QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+        if (!compareWithBaseline(results, baseline)) {
+            return 1; } }
+
+    return 0; }
+
+/*!
+    Generates the synthetic input files according to the command line options.
+    Returns 0 on success and 2 on error.
+*/
+int As::Benchmark::generate() {
+    const QString dirPath = m_parser.value("generate");
+    const QString format = m_parser.value("format").isEmpty() ? "dif4" : m_parser.value("format");
+    const As::InputFileType type = As::Generator::typeFromName(format);
+
+    if (type == As::UNKNOWN_FILE) {
+        printMessage(QString("Unknown format '%1'.").arg(format));
+        return 2; }
+
+    As::Generator generator(m_parser.value("seed").isEmpty() ? 1 : m_parser.value("seed").toUInt());
+    generator.setReflectionCount(m_reflections > 0 ? m_reflections : 1000);
+    if (!m_parser.value("points").isEmpty()) {
+        generator.setPointCount(m_parser.value("points").toInt()); }
+    generator.setPolarised(m_parser.isSet("polarised"));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!generator.generate(dirPath, type)) {
+        printMessage(QString("Cannot write files to '%1'.").arg(QDir::toNativeSeparators(dirPath)));
+        return 2; }
+
+    printMessage(QString("Generated: %1 (%2 ms)").arg(QDir::toNativeSeparators(dirPath)).arg(timer.elapsed()));
+    return 0; }
+
+/*!
+    Reads all the files from the dataset directory \a dirPath to the list of file \a paths
+    and their \a contents. Returns \c true on success; otherwise returns \c false.
+*/
+bool As::Benchmark::loadDataset(const QString& dirPath,
+                                QStringList& paths,
+                                QStringList& contents) const {
+    const QDir dir(dirPath);
+
+    for (const QFileInfo& fileInfo : dir.entryInfoList(QDir::Files, QDir::Name)) {
+        QFile file(fileInfo.absoluteFilePath());
+        if (!file.open(QFile::ReadOnly | QFile::Text)) {
+            return false; }
+
+        // The same as in the console application
+        QTextStream textStream(&file);
+        textStream.setAutoDetectUnicode(true);
+        textStream.setCodec("MacRoman");
+
+        paths << fileInfo.absoluteFilePath();
+        contents << textStream.readAll(); }
+
+    return !paths.isEmpty(); }
+
+/*!
+    Returns the number of reflections extracted from the files with the given
+    \a paths and \a contents.
+*/
+int As::Benchmark::countScans(const QStringList& paths,
+                              const QStringList& contents) const {
+    As::ScanArray scans;
+    scans.m_inputFilesContents = qMakePair(paths, contents);
+
+    if (!scans.detectInputFilesType() OR scans.m_inputFilesType == As::UNKNOWN_FILE) {
+        return 0; }
+
+    As::ConcurrentWatcher watcher;
+    watcher.startComputation("extract", &scans);
+
+    const int count = scans.size();
+    deleteScans(&scans);
+    return count; }
+
+/*!
+    Runs the benchmarks for the dataset \a name with the given file \a paths and
+    \a contents. Returns the JSON object with the results, or an empty object on error.
+*/
+QJsonObject As::Benchmark::runDataset(const QString& name,
+                                      const QStringList& paths,
+                                      const QStringList& contents) {
+    const int scansPerCopy = countScans(paths, contents);
+    if (scansPerCopy == 0) {
+        return QJsonObject(); }
+
+    // Replicate the dataset up to the required number of reflections
+    const int copies = qMax(1, qCeil(static_cast<qreal>(m_reflections) / scansPerCopy));
+    QStringList replicatedPaths, replicatedContents;
+    for (int i = 0; i < copies; ++i) {
+        replicatedPaths << paths;
+        replicatedContents << contents; }
+
+    printMessage(QString("Dataset '%1': %2 file(s) x %3 copies, %4 reflections")
+                 .arg(name).arg(paths.size()).arg(copies).arg(scansPerCopy * copies));
+
+    // Warm-up
+    for (int i = 0; i < m_warmup; ++i) {
+        As::ScanArray scans;
+        if (!runPipeline(&scans, replicatedPaths, replicatedContents, Q_NULLPTR)) {
+            printMessage(QString("Dataset '%1': processing failed.").arg(name));
+            return QJsonObject(); }
+        deleteScans(&scans); }
+
+    // Pipeline stages
+    As::Benchmark::Timings_t stageTimings;
+    int scanCount = 0;
+    for (int i = 0; i < m_repetitions; ++i) {
+        As::ScanArray scans;
+        if (!runPipeline(&scans, replicatedPaths, replicatedContents, &stageTimings)) {
+            printMessage(QString("Dataset '%1': processing failed.").arg(name));
+            return QJsonObject(); }
+        scanCount = scans.size();
+        deleteScans(&scans); }
+
+    // Hot kernels
+    As::Benchmark::Timings_t kernelTimings;
+    {
+        As::ScanArray scans;
+        if (!runPipeline(&scans, replicatedPaths, replicatedContents, Q_NULLPTR)) {
+            printMessage(QString("Dataset '%1': processing failed.").arg(name));
+            return QJsonObject(); }
+        for (int i = 0; i < m_repetitions; ++i) {
+            runKernels(&scans, &kernelTimings); }
+        deleteScans(&scans);
+    }
+
+    const QJsonObject stages = statistics(stageTimings);
+    const QJsonObject kernels = statistics(kernelTimings);
+
+    // Print results
+    for (const auto& group : { qMakePair(QString("stage"), stages), qMakePair(QString("kernel"), kernels) }) {
+        for (const QString& key : group.second.keys()) {
+            const QJsonObject measure = group.second[key].toObject();
+            printMessage(QString("  %1 %2 median %3 ms, min %4 ms")
+                         .arg(group.first, -7)
+                         .arg(key, -20)
+                         .arg(measure["median"].toDouble(), 10, 'f', 3)
+                         .arg(measure["min"].toDouble(), 10, 'f', 3)); } }
+
+    return QJsonObject{
+        { "files", replicatedPaths.size() },
+        { "scans", scanCount },
+        { "stages", stages },
+        { "kernels", kernels } }; }
+
+/*!
+    Runs the whole data processing pipeline for the scan array \a scans with the given
+    file \a paths and \a contents, and adds the time of every stage to \a timings,
+    if not null. Returns \c true if any reflection is processed.
+*/
+bool As::Benchmark::runPipeline(As::ScanArray* scans,
+                                const QStringList& paths,
+                                const QStringList& contents,
+                                As::Benchmark::Timings_t* timings) const {
+    scans->m_inputFilesContents = qMakePair(paths, contents);
+
+    bool ok = false;
+    measure("detect", [&] () {
+        ok = scans->detectInputFilesType(); }, timings);
+
+    if (!ok OR scans->m_inputFilesType == As::UNKNOWN_FILE) {
+        return false; }
+
+    for (const QString& type : QStringList{ "extract", "fill", "index", "treat" }) {
+        measure(type, [&] () {
+            As::ConcurrentWatcher watcher;
+            watcher.startComputation(type, scans); }, timings); }
+
+    if (scans->size() == 0) {
+        return false; }
+
+    measure("table", [&] () {
+        scans->createFullOutputTable(); }, timings);
+
+    measure("export", [&] () {
+        for (const QString& format : QStringList{ "general", "shelx", "tbar", "umweg", "ccsl" }) {
+            scans->saveSelectedOutputColumns(QDir(m_exportDir).filePath("benchmark." + format), format); } }, timings);
+
+    return true; }
+
+/*!
+    Runs the hot kernels once for all the scans in the already processed scan array
+    \a scans and adds their time to \a timings.
+*/
+void As::Benchmark::runKernels(As::ScanArray* scans,
+                               As::Benchmark::Timings_t* timings) const {
+    // Prevents the compiler from optimizing the kernels away
+    static volatile qreal sink = 0;
+
+    measure("RealArray(QString)", [&] () {
+        for (int i = 0; i < scans->size(); ++i) {
+            const As::RealVector detector(scans->at(i)->data("intensities", "Detector"));
+            sink = sink + detector.size(); } }, timings);
+
+    measure("FormatString", [&] () {
+        for (int i = 0; i < scans->size(); ++i) {
+            const As::Scan* scan = scans->at(i);
+            for (const QString& element : (*scan)["angles"].keys()) {
+                sink = sink + As::FormatString(scan->data("angles", element), scan->format("angles", element)).size(); } } }, timings);
+
+    // Parse the data arrays outside of the measured kernel
+    QVector<As::RealVector> detectors, sdetectors;
+    for (int i = 0; i < scans->size(); ++i) {
+        detectors << As::RealVector(scans->at(i)->data("intensities", "DetectorNorm"));
+        sdetectors << As::RealVector(scans->at(i)->data("intensities", "sDetectorNorm")); }
+
+    measure("IntensityWithSigma", [&] () {
+        for (int i = 0; i < scans->size(); ++i) {
+            const As::Scan* scan = scans->at(i);
+            if (detectors[i].isEmpty()) {
+                continue; }
+            const As::RealVector intyWithSig = scans->IntensityWithSigma(detectors[i], sdetectors[i],
+                                                                         scan->m_numLeftBkgPoints,
+                                                                         scan->m_numRightBkgPoints,
+                                                                         scan->m_numLeftSkipPoints,
+                                                                         scan->m_numRightSkipPoints,
+                                                                         scan->mcCandlishFactor());
+            sink = sink + intyWithSig[0]; } }, timings);
+
+    measure("findNonPeakPoints", [&] () {
+        for (int i = 0; i < scans->size(); ++i) {
+            scans->findNonPeakPoints(scans->at(i)); } }, timings);
+
+    measure("indexSinglePeak", [&] () {
+        for (int i = 0; i < scans->size(); ++i) {
+            scans->indexSinglePeak(i); } }, timings);
+
+    for (int i = 0; i < scans->size(); ++i) {
+        scans->at(i)->setPeakAnalysisType(As::Scan::PeakFit);
+        scans->at(i)->setPeakFitType(As::Scan::PseudoVoigtFit); }
+
+    measure("calcFittedPeak", [&] () {
+        for (int i = 0; i < scans->size(); ++i) {
+            scans->calcFittedPeak(scans->at(i)); } }, timings); }
+
+/*!
+    Deletes all the scans of the scan array \a scans.
+*/
+void As::Benchmark::deleteScans(As::ScanArray* scans) const {
+    scans->clear(); }
+
+/*!
+    Runs the function \a func and adds its time in milliseconds to the \a timings
+    with the key \a name. If \a timings is null, the function is just run.
+*/
+void As::Benchmark::measure(const QString& name,
+                            const std::function<void ()>& func,
+                            As::Benchmark::Timings_t* timings) {
+    QElapsedTimer timer;
+    timer.start();
+    func();
+    if (timings) {
+        (*timings)[name] << timer.nsecsElapsed() * 1e-6; } }
+
+/*!
+    Returns the median, minimum and mean values of every measurement in \a timings.
+*/
+QJsonObject As::Benchmark::statistics(const As::Benchmark::Timings_t& timings) {
+    QJsonObject result;
+
+    for (auto it = timings.constBegin(); it != timings.constEnd(); ++it) {
+        QVector<qreal> values = it.value();
+        std::sort(values.begin(), values.end());
+
+        const int n = values.size();
+        const qreal median = (n % 2) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+        const qreal mean = std::accumulate(values.constBegin(), values.constEnd(), 0.0) / n;
+
+        result.insert(it.key(), QJsonObject{
+            { "median", median },
+            { "min", values.first() },
+            { "mean", mean } }); }
+
+    return result; }
+
+/*!
+    Compares the \a results with the \a baseline. Prints all the measurements which are
+    slower than the baseline by more than the tolerance. Returns \c false if any
+    regression is found; otherwise returns \c true.
+*/
+bool As::Benchmark::compareWithBaseline(const QJsonObject& results,
+                                        const QJsonObject& baseline) const {
+    const QJsonObject currentDatasets = results["datasets"].toObject();
+    const QJsonObject baselineDatasets = baseline["datasets"].toObject();
+
+    int compared = 0;
+    int regressions = 0;
+
+    for (const QString& name : currentDatasets.keys()) {
+        if (!baselineDatasets.contains(name)) {
+            continue; }
+
+        const QJsonObject current = currentDatasets[name].toObject();
+        const QJsonObject base = baselineDatasets[name].toObject();
+
+        if (current["scans"].toInt() != base["scans"].toInt()) {
+            printMessage(QString("Dataset '%1': number of reflections differs from baseline (%2 vs %3), skipped.")
+                         .arg(name).arg(current["scans"].toInt()).arg(base["scans"].toInt()));
+            continue; }
+
+        for (const QString& group : QStringList{ "stages", "kernels" }) {
+            const QJsonObject currentGroup = current[group].toObject();
+            const QJsonObject baseGroup = base[group].toObject();
+
+            for (const QString& key : currentGroup.keys()) {
+                if (!baseGroup.contains(key)) {
+                    continue; }
+
+                const qreal now = currentGroup[key].toObject()["median"].toDouble();
+                const qreal before = baseGroup[key].toObject()["median"].toDouble();
+                ++compared;
+
+                if (before > 0 AND now > before * (1 + m_tolerance)) {
+                    ++regressions;
+                    printMessage(QString("Regression: %1/%2/%3 %4 ms -> %5 ms (+%6%)")
+                                 .arg(name).arg(group).arg(key)
+                                 .arg(before, 0, 'f', 3).arg(now, 0, 'f', 3)
+                                 .arg(100 * (now / before - 1), 0, 'f', 1)); } } } }
+
+    printMessage(QString("Compared with baseline: %1 measurements, %2 regression(s).")
+                 .arg(compared).arg(regressions));
+
+    return regressions == 0; }
+
+/*!
+    Prints the \a message.
+*/
+void As::Benchmark::printMessage(const QString& message) const {
+    fprintf(stderr, "%s\n", qUtf8Printable(message)); }
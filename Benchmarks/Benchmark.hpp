@@ -0,0 +1,93 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_BENCHMARK_HPP
+#define AS_BENCHMARK_HPP
+
+#include <functional>
+
+#include <QCommandLineParser>
+#include <QJsonObject>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+
+class QCoreApplication;
+class QString;
+class QStringList;
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ScanArray;
+
+class Benchmark : public QObject {
+    Q_OBJECT
+
+  public:
+    using Timings_t = QMap<QString, QVector<qreal>>;
+
+    Benchmark(QObject* parent = Q_NULLPTR);
+    ~Benchmark();
+
+    void createCommandLineParser(QCoreApplication* app);
+
+    int run();
+
+  private:
+    int generate();
+
+    bool loadDataset(const QString& dirPath,
+                     QStringList& paths,
+                     QStringList& contents) const;
+    int countScans(const QStringList& paths,
+                   const QStringList& contents) const;
+    QJsonObject runDataset(const QString& name,
+                           const QStringList& paths,
+                           const QStringList& contents);
+    bool runPipeline(As::ScanArray* scans,
+                     const QStringList& paths,
+                     const QStringList& contents,
+                     As::Benchmark::Timings_t* timings) const;
+    void runKernels(As::ScanArray* scans,
+                    As::Benchmark::Timings_t* timings) const;
+    void deleteScans(As::ScanArray* scans) const;
+
+    static void measure(const QString& name,
+                        const std::function<void ()>& func,
+                        As::Benchmark::Timings_t* timings);
+    static QJsonObject statistics(const As::Benchmark::Timings_t& timings);
+
+    bool compareWithBaseline(const QJsonObject& results,
+                             const QJsonObject& baseline) const;
+
+    void printMessage(const QString& message) const;
+
+    QCommandLineParser m_parser;
+    int m_repetitions = 5;
+    int m_warmup = 1;
+    int m_reflections = 0;
+    qreal m_tolerance = 0.1;
+    QString m_exportDir;
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_BENCHMARK_HPP
@@ -0,0 +1,646 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QLocale>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+#include <QtMath>
+
+#include "Macros.hpp"
+
+#include "RealVector.hpp"
+#include "ScanDict.hpp"
+
+#include "Generator.hpp"
+
+/*!
+    \class As::Generator
+
+    \brief The Generator is a class that writes synthetic input files in the
+    supported formats: HEiDi DIF4 data and log files, POLI NICOS data files and
+    6T2 xml files.
+
+    Every reflection is a Gaussian peak on a flat background with Poisson noise.
+    The reflections are randomly selected from the reciprocal space accessible with
+    the given wavelength, and their scattering angles are calculated with the same
+    diffractometer geometry which is used for indexing. The parameter names in the
+    files are taken from As::ScanDict::FILE_HEADER_MAPS, i.e. the same header maps
+    which are used for extraction.
+
+    The random numbers are generated by std::mt19937 and converted to the required
+    distributions without the implementation-defined std distributions, so the
+    output files are identical for the same seed on every platform.
+
+    \inmodule Benchmarks
+*/
+
+/*!
+    \class As::Generator::Reflection
+    \brief The Reflection is a struct that holds the parameters of a single
+    synthetic reflection.
+*/
+
+/*!
+    \variable As::Generator::REFLECTIONS_PER_FILE
+    \brief the maximum number of reflections in a single file for the formats
+    with many reflections per file.
+*/
+const int As::Generator::REFLECTIONS_PER_FILE = 10000;
+
+/*!
+    Constructs the generator with the given random \a seed.
+*/
+As::Generator::Generator(const quint32 seed)
+    : m_engine(seed) {}
+
+/*!
+    Destroys the generator.
+*/
+As::Generator::~Generator() {}
+
+/*!
+    Returns the input file type for the format \a name: "dif4", "log", "nicos" or "xml".
+    Returns As::UNKNOWN_FILE if the format is not supported.
+*/
+As::InputFileType As::Generator::typeFromName(const QString& name) {
+    const QString format = name.toLower();
+
+    if (format == "dif4") {
+        return As::HEIDI_DAT; }
+
+    else if (format == "log") {
+        return As::HEIDI_LOG; }
+
+    else if (format == "nicos") {
+        return As::NICOS_DAT; }
+
+    else if (format == "xml" OR format == "6t2") {
+        return As::S6T2_DAT; }
+
+    return As::UNKNOWN_FILE; }
+
+/*!
+    Sets the number of reflections to be generated to \a count.
+*/
+void As::Generator::setReflectionCount(const int count) {
+    m_reflectionCount = qMax(1, count); }
+
+/*!
+    Sets the number of points per scan to \a count.
+*/
+void As::Generator::setPointCount(const int count) {
+    m_pointCount = qMax(As::ScanDict::MIN_DATA_POINTS, count); }
+
+/*!
+    Enables the polarised up/down channels if \a polarised is \c true. Only NICOS and
+    6T2 files support polarised neutrons.
+*/
+void As::Generator::setPolarised(const bool polarised) {
+    m_polarised = polarised; }
+
+/*!
+    Writes the synthetic files of the given \a type to the directory \a dirPath.
+    Returns \c true on success; otherwise returns \c false.
+*/
+bool As::Generator::generate(const QString& dirPath,
+                             const As::InputFileType type) {
+    const QDir dir(dirPath);
+
+    if (!dir.mkpath(".")) {
+        return false; }
+
+    createUbMatrix();
+
+    switch (type) {
+
+        case As::HEIDI_DAT:
+            for (int first = 0, file = 1; first < m_reflectionCount; first += REFLECTIONS_PER_FILE, ++file) {
+                const int count = qMin(REFLECTIONS_PER_FILE, m_reflectionCount - first);
+                const QString name = QString("synthetic.%1").arg(file, 2, 10, QChar('0'));
+                if (!writeFile(dir.filePath(name), heidiDat(first, count))) {
+                    return false; } }
+            return true;
+
+        case As::HEIDI_LOG:
+            for (int first = 0, file = 1; first < m_reflectionCount; first += REFLECTIONS_PER_FILE, ++file) {
+                const int count = qMin(REFLECTIONS_PER_FILE, m_reflectionCount - first);
+                const QString name = QString("synthetic_%1.eco").arg(file, 3, 10, QChar('0'));
+                if (!writeFile(dir.filePath(name), heidiLog(first, count))) {
+                    return false; } }
+            return true;
+
+        case As::NICOS_DAT:
+            for (int number = 1; number <= m_reflectionCount; ++number) {
+                const QString name = QString("synthetic_%1.dat").arg(number, 8, 10, QChar('0'));
+                if (!writeFile(dir.filePath(name), nicosDat(number))) {
+                    return false; } }
+            return true;
+
+        case As::S6T2_DAT:
+            for (int number = 1; number <= m_reflectionCount; ++number) {
+                const QString name = QString("synthetic_%1.xml").arg(number, 6, 10, QChar('0'));
+                if (!writeFile(dir.filePath(name), s6t2Xml(number))) {
+                    return false; } }
+            return true;
+
+        default:
+            return false; } }
+
+/*!
+    Returns the uniformly distributed random number in the open interval (0, 1).
+*/
+qreal As::Generator::uniform() {
+    return (static_cast<qreal>(m_engine()) + 0.5) / 4294967296.0; }
+
+/*!
+    \overload
+
+    Returns the uniformly distributed random number between \a min and \a max.
+*/
+qreal As::Generator::uniform(const qreal min,
+                             const qreal max) {
+    return min + (max - min) * uniform(); }
+
+/*!
+    Returns the normally distributed random number with zero mean and unit variance
+    (Box-Muller transform).
+*/
+qreal As::Generator::gaussian() {
+    const qreal u1 = uniform();
+    const qreal u2 = uniform();
+    return qSqrt(-2 * qLn(u1)) * qCos(2 * M_PI * u2); }
+
+/*!
+    Returns the Poisson distributed random number with the given \a mean. The normal
+    approximation is used for the large mean values.
+*/
+int As::Generator::poisson(const qreal mean) {
+    if (mean <= 0) {
+        return 0; }
+
+    if (mean < 30) {
+        const qreal limit = qExp(-mean);
+        qreal product = uniform();
+        int count = 0;
+        while (product > limit) {
+            product *= uniform();
+            ++count; }
+        return count; }
+
+    return qMax(0, qRound(mean + qSqrt(mean) * gaussian())); }
+
+/*!
+    Creates the UB matrix of the orthorhombic crystal in random orientation.
+    The matrix is stored column by column, as expected by As::ScanArray::hklToXyz.
+*/
+void As::Generator::createUbMatrix() {
+    const qreal cell[3] = { 5.4, 7.1, 9.3 };
+
+    // Random rotation from the random unit quaternion
+    qreal q[4];
+    qreal norm = 0;
+    for (qreal& value : q) {
+        value = gaussian();
+        norm += As::Sqr(value); }
+    norm = qSqrt(norm);
+    for (qreal& value : q) {
+        value /= norm; }
+
+    const qreal w = q[0], x = q[1], y = q[2], z = q[3];
+    const qreal u[3][3] = {
+        { 1 - 2 * (y * y + z * z), 2 * (x * y - z * w),     2 * (x * z + y * w) },
+        { 2 * (x * y + z * w),     1 - 2 * (x * x + z * z), 2 * (y * z - x * w) },
+        { 2 * (x * z - y * w),     2 * (y * z + x * w),     1 - 2 * (x * x + y * y) } };
+
+    // UB = U * B, where B is diagonal for the orthorhombic cell
+    m_ub = As::RealMatrix9(u[0][0] / cell[0], u[1][0] / cell[0], u[2][0] / cell[0],
+                           u[0][1] / cell[1], u[1][1] / cell[1], u[2][1] / cell[1],
+                           u[0][2] / cell[2], u[1][2] / cell[2], u[2][2] / cell[2]); }
+
+/*!
+    Returns the random reflection accessible with the given \a wavelength in the
+    four-circle or lifting counter geometry, depending on \a liftingCounter.
+*/
+As::Generator::Reflection As::Generator::createReflection(const qreal wavelength,
+                                                          const bool liftingCounter) {
+    const qreal maxTwoTheta = liftingCounter ? 100 : 110;
+    const qreal maxQ = 2 * qSin(qDegreesToRadians(0.5 * maxTwoTheta)) / wavelength;
+
+    // Maximum Miller indices from the lengths of the UB matrix columns
+    int maxHkl[3];
+    for (int i = 0; i < 3; ++i) {
+        const qreal length = qSqrt(As::Sqr(m_ub[3 * i]) + As::Sqr(m_ub[3 * i + 1]) + As::Sqr(m_ub[3 * i + 2]));
+        maxHkl[i] = qMax(1, qFloor(maxQ / length)); }
+
+    As::Generator::Reflection reflection;
+
+    forever {
+        reflection.h = qRound(uniform(-maxHkl[0] - 0.5, maxHkl[0] + 0.5));
+        reflection.k = qRound(uniform(-maxHkl[1] - 0.5, maxHkl[1] + 0.5));
+        reflection.l = qRound(uniform(-maxHkl[2] - 0.5, maxHkl[2] + 0.5));
+
+        if (reflection.h == 0.0 AND reflection.k == 0.0 AND reflection.l == 0.0) {
+            continue; }
+
+        const As::RealVector xyz = m_geometry.hklToXyz(m_ub, reflection.h, reflection.k, reflection.l);
+        const qreal q = qSqrt(As::Sqr(xyz[0]) + As::Sqr(xyz[1]) + As::Sqr(xyz[2]));
+
+        if (q > maxQ) {
+            continue; }
+
+        reflection.angles = m_geometry.xyzToAngles(wavelength, xyz[0], xyz[1], xyz[2], 0);
+
+        // Angles used for the current geometry must be defined
+        const int from = liftingCounter ? 5 : 0;
+        const int to = liftingCounter ? 8 : 4;
+        bool ok = true;
+        for (int i = from; i < to; ++i) {
+            ok = ok AND qIsFinite(reflection.angles[i]); }
+
+        if (ok) {
+            break; } }
+
+    reflection.amplitude = qPow(10, uniform(0.5, 3.5));
+    reflection.flippingRatio = m_polarised ? uniform(0.5, 1.5) : 1.0;
+    reflection.fwhm = uniform(0.4, 0.8);
+    reflection.shift = uniform(-0.5, 0.5) * m_scanStep;
+    reflection.background = uniform(1, 20);
+
+    return reflection; }
+
+/*!
+    Returns the expected counts per second of the \a reflection at the given scan
+    \a point: unpolarised if \a polarisation is zero, spin up if positive and spin
+    down if negative.
+*/
+qreal As::Generator::peakCounts(const As::Generator::Reflection& reflection,
+                                const int point,
+                                const qreal polarisation) const {
+    const qreal sigma = reflection.fwhm / (2 * qSqrt(2 * M_LN2));
+    const qreal x = scanShift(point) - reflection.shift;
+
+    qreal amplitude = reflection.amplitude;
+    if (polarisation > 0) {
+        amplitude *= 2 * reflection.flippingRatio / (1 + reflection.flippingRatio); }
+    else if (polarisation < 0) {
+        amplitude *= 2 / (1 + reflection.flippingRatio); }
+
+    return reflection.background + amplitude * qExp(-0.5 * As::Sqr(x / sigma)); }
+
+/*!
+    Returns the shift of the scan \a point from the scan centre, in degrees.
+*/
+qreal As::Generator::scanShift(const int point) const {
+    return (point - 0.5 * (m_pointCount - 1)) * m_scanStep; }
+
+/*!
+    Returns the parameter name used in the files of the given \a type for the
+    \a group and \a element, according to As::ScanDict::FILE_HEADER_MAPS.
+*/
+QString As::Generator::fileName(const As::InputFileType type,
+                                const QString& group,
+                                const QString& element) const {
+    for (const QStringList& row : As::ScanDict::FILE_HEADER_MAPS.value(type)) {
+        if (row[0] == group AND row[1] == element) {
+            return row[2].section('|', 0, 0); } }
+
+    return QString(); }
+
+/*!
+    Returns the rows of the UB matrix in the order it is read by As::RealMatrix9,
+    with the numbers separated by \a separator.
+*/
+QStringList As::Generator::ubMatrixRows(const QString& separator) const {
+    QStringList rows;
+
+    for (int i = 0; i < 3; ++i) {
+        QStringList row;
+        for (int j = 0; j < 3; ++j) {
+            row << QString::number(m_ub[3 * i + j], 'f', 9); }
+        rows << row.join(separator); }
+
+    return rows; }
+
+/*!
+    Writes the \a content to the file \a filePath. Returns \c true on success;
+    otherwise returns \c false.
+*/
+bool As::Generator::writeFile(const QString& filePath,
+                              const QString& content) const {
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false; }
+
+    QTextStream stream(&file);
+    stream << content;
+    stream.flush();
+
+    return stream.status() == QTextStream::Ok; }
+
+/*!
+    Returns the content of the HEiDi DIF4 data file with \a count reflections
+    starting from the reflection \a first.
+*/
+QString As::Generator::heidiDat(const int first,
+                                const int count) {
+    const qreal wavelength = 1.17;
+    const int maxCounts = 99999; // 5 characters per value
+    const QDateTime dateTime = QDateTime(QDate(2017, 1, 1), QTime(0, 0)).addSecs(first);
+    const QStringList ub = ubMatrixRows(" ");
+
+    QString content;
+    QTextStream stream(&content);
+
+    stream << QString("File= synthetic created at  %1  by Rev HEIDI/FRM2\n").arg(QLocale::c().toString(dateTime, "dd-MMM-yy hh:mm"));
+    stream << "Titl= Synthetic dataset\n";
+    stream << QString("Wave= %1   Scan= %2 0.000   Nstd=0   Dpsi= 0   Prof_output=1\n").arg(wavelength, 0, 'f', 5).arg(m_scanStep, 0, 'f', 3);
+    stream << "Filt=  0.000  0.000 -0.000   UVW=   10.200   -23.510    16.640\n";
+    stream << "Omat=  " << ub[0] << "\n";
+    stream << "       " << ub[1] << "\n";
+    stream << "       " << ub[2] << "\n";
+
+    for (int i = 0; i < count; ++i) {
+        const As::Generator::Reflection reflection = createReflection(wavelength, false);
+
+        stream << QString("%1%2%3 01 %4%5%6%7%8 0 %9    1E+03\n")
+               .arg(qRound(reflection.h), 4).arg(qRound(reflection.k), 4).arg(qRound(reflection.l), 4)
+               .arg(0.0, 7, 'f', 1).arg(0.0, 6, 'f', 1).arg(0.0, 6, 'f', 1) // Integrated intensity, sigma, psi
+               .arg(m_pointCount, 4)
+               .arg(qRound(10 * m_timePerStep), 4)
+               .arg(300.0, 6, 'f', 2);
+        stream << QString(" 1.00000 1.00000 %1 %2\n")
+               .arg(m_monitorRate * m_timePerStep, 9, 'f', 2)
+               .arg(m_scanStep, 7, 'f', 4);
+
+        // Detector block followed by monitor block, 16 values per line
+        QVector<int> values;
+        for (int point = 0; point < m_pointCount; ++point) {
+            values << qMin(maxCounts, poisson(m_timePerStep * peakCounts(reflection, point, 0))); }
+        for (int point = 0; point < m_pointCount; ++point) {
+            values << qMin(maxCounts, poisson(m_timePerStep * m_monitorRate)); }
+
+        for (int j = 0; j < values.size(); ++j) {
+            stream << QString("%1").arg(values[j], 5);
+            if ((j + 1) % 16 == 0 OR j + 1 == values.size()) {
+                stream << "\n"; } } }
+
+    stream.flush();
+    return content; }
+
+/*!
+    Returns the content of the HEiDi log file with \a count reflections
+    starting from the reflection \a first.
+*/
+QString As::Generator::heidiLog(const int first,
+                                const int count) {
+    const qreal wavelength = 1.17;
+    const QDateTime dateTime = QDateTime(QDate(2017, 1, 1), QTime(0, 0)).addSecs(first);
+    const QStringList ub = ubMatrixRows("  ");
+
+    const QString omega    = fileName(As::HEIDI_LOG, "angles",      "Omega");
+    const QString detector = fileName(As::HEIDI_LOG, "intensities", "Detector");
+    const QString monitor  = fileName(As::HEIDI_LOG, "intensities", "Monitor");
+
+    QString content;
+    QTextStream stream(&content);
+
+    stream << QString(" %1 Protocol ON\n").arg(QLocale::c().toString(dateTime, "dd-MMM-yy hh:mm"));
+    stream << " # d4\n";
+    stream << " Diffractometer parameters\n";
+    stream << QString("  Wavelength [%1] ? \n").arg(wavelength, 0, 'f', 5);
+    stream << QString("  Time/step : %1 sec ? \n").arg(m_timePerStep, 6, 'f', 2);
+    stream << " # mr\n";
+    stream << "    Refined orienting matrix (A* B* C*)\n";
+    for (const QString& row : ub) {
+        stream << "  " << row << "\n"; }
+
+    for (int i = 0; i < count; ++i) {
+        const As::Generator::Reflection reflection = createReflection(wavelength, false);
+        const qreal twotheta = reflection.angles[0];
+        const qreal omegaCentre = reflection.angles[1];
+        const qreal chi = reflection.angles[2];
+        const qreal phi = reflection.angles[3];
+
+        stream << " # ss\n";
+        stream << QString(" Scan centre = %1%2%3%4\n")
+               .arg(twotheta, 10, 'f', 4).arg(omegaCentre, 10, 'f', 4).arg(chi, 10, 'f', 4).arg(phi, 10, 'f', 4);
+        stream << QString(" Scan range  = %1%2%3%4  (%5 steps, continous)\n")
+               .arg(0.0, 10, 'f', 4).arg(m_scanStep * (m_pointCount - 1), 10, 'f', 4).arg(0.0, 10, 'f', 4).arg(0.0, 10, 'f', 4)
+               .arg(m_pointCount, 3);
+        stream << QString(" %1 %2 %3 | Symbols: Detector [o], Monitor [:]\n")
+               .arg(omega, 7).arg(detector, 6).arg(monitor, 7);
+        stream << QString(60, '=') << "\n";
+
+        for (int point = 0; point < m_pointCount; ++point) {
+            const int det = poisson(m_timePerStep * peakCounts(reflection, point, 0));
+            const int mon = poisson(m_timePerStep * m_monitorRate);
+
+            // Text plot of the detector and monitor counts as in the original log files
+            const int detPosition = qBound(0, qRound(40.0 * det / (m_timePerStep * (reflection.background + reflection.amplitude))), 40);
+            const int monPosition = qBound(0, qRound(20.0 * mon / (m_timePerStep * m_monitorRate)), 40);
+            QString symbols(qMax(detPosition, monPosition) + 1, ' ');
+            symbols[monPosition] = ':';
+            symbols[detPosition] = 'o';
+
+            stream << QString(" %1 %2 %3 %4%5\n")
+                   .arg(omegaCentre + scanShift(point), 7, 'f', 2)
+                   .arg(det, 6).arg(mon, 7)
+                   .arg(point % 5 == 4 ? "+" : "|")
+                   .arg(symbols); }
+
+        stream << QString(" Centre at point %1      Angles = %2%3%4%5\n")
+               .arg(0.5 * (m_pointCount + 1), 7, 'f', 3)
+               .arg(twotheta, 10, 'f', 4).arg(omegaCentre, 10, 'f', 4).arg(chi, 10, 'f', 4).arg(phi, 10, 'f', 4); }
+
+    stream.flush();
+    return content; }
+
+/*!
+    Returns the content of the NICOS data file with the reflection \a number.
+*/
+QString As::Generator::nicosDat(const int number) {
+    const qreal wavelength = 1.15;
+    const QDateTime dateTime = QDateTime(QDate(2017, 1, 1), QTime(0, 0)).addSecs(qRound(number * m_pointCount * m_timePerStep));
+    const QString name = QString("synthetic_%1.dat").arg(number, 8, 10, QChar('0'));
+    const As::Generator::Reflection reflection = createReflection(wavelength, true);
+    const qreal gamma = reflection.angles[5];
+    const qreal nu = reflection.angles[6];
+    const qreal omegaCentre = reflection.angles[7];
+
+    // Label of the parameter in the NICOS file header
+    auto label = [] (const QString& key) {
+        return QString("#%1 : ").arg(key, 26); };
+
+    QString content;
+    QTextStream stream(&content);
+
+    stream << "### NICOS data file, created at " << dateTime.toString("yyyy-MM-dd hh:mm:ss") << "\n";
+    stream << label("number") << number << "\n";
+    stream << label("filename") << name << "\n";
+    stream << label("info") << QString("contscan(omega, %1, %2, %3, 1)\n")
+           .arg(omegaCentre + scanShift(0), 0, 'f', 4)
+           .arg(omegaCentre + scanShift(m_pointCount - 1), 0, 'f', 4)
+           .arg(m_scanStep, 0, 'f', 4);
+    stream << "### Sample and alignment\n";
+    stream << label("Sample_ubmatrix") << "([" << ubMatrixRows(", ").join("], [") << "])\n";
+    stream << label("Sample_samplename") << "Synthetic\n";
+    stream << "### Device positions and sample environment state\n";
+    stream << label(fileName(As::NICOS_DAT, "conditions", "Wavelength") + "_value") << QString::number(wavelength, 'f', 3) << " A\n";
+    stream << label(fileName(As::NICOS_DAT, "angles", "Gamma") + "_value") << QString::number(gamma, 'f', 2) << " deg\n";
+    stream << label(fileName(As::NICOS_DAT, "angles", "Nu") + "_value") << QString::number(nu, 'f', 2) << " deg\n";
+    stream << label(fileName(As::NICOS_DAT, "angles", "Omega") + "_value") << QString::number(omegaCentre, 'f', 2) << " deg\n";
+    stream << label(fileName(As::NICOS_DAT, "conditions", "Temperature") + "_value") << "300.000 K\n";
+
+    // Scan data table
+    const QString omega = fileName(As::NICOS_DAT, "angles", "Omega");
+    const QString temperature = fileName(As::NICOS_DAT, "conditions", "Temperature");
+    QStringList headers = { omega, temperature, ";" };
+    QStringList units = { "deg", "K", ";" };
+    QStringList types = { "" };
+
+    if (m_polarised) {
+        types = QStringList{ As::ScanDict::BEAM_TYPES[As::ScanDict::POLARISED_UP],
+                             As::ScanDict::BEAM_TYPES[As::ScanDict::POLARISED_DOWN] }; }
+
+    for (const QString& type : types) {
+        headers << fileName(As::NICOS_DAT, "conditions",  "Time/step" + type)
+                << fileName(As::NICOS_DAT, "intensities", "Monitor1" + type)
+                << fileName(As::NICOS_DAT, "intensities", "Detector" + type);
+        units << "s" << "cts" << "cts"; }
+
+    stream << "### Scan data\n";
+    stream << "# " << headers.join("\t") << "\n";
+    stream << "# " << units.join("\t") << "\n";
+
+    // Counting time is shared between the up and down channels
+    const qreal time = m_timePerStep / types.size();
+
+    for (int point = 0; point < m_pointCount; ++point) {
+        QStringList row = { QString::number(omegaCentre + scanShift(point), 'f', 2), "300.000", ";" };
+
+        for (const QString& type : types) {
+            const qreal polarisation = type.isEmpty() ? 0 : (type == As::ScanDict::BEAM_TYPES[As::ScanDict::POLARISED_UP] ? 1 : -1);
+            const int mon = poisson(time * m_monitorRate);
+            const int det = poisson(time * peakCounts(reflection, point, polarisation));
+            row << QString::number(time, 'f', 2) << QString::number(mon) << QString::number(det); }
+
+        stream << row.join("\t") << "\n"; }
+
+    stream << "### End of NICOS data file " << name << "\n";
+
+    stream.flush();
+    return content; }
+
+/*!
+    Returns the content of the 6T2 xml file with the reflection \a number.
+*/
+QString As::Generator::s6t2Xml(const int number) {
+    const qreal wavelength = 2.35;
+    const QDateTime dateTime = QDateTime(QDate(2017, 1, 1), QTime(0, 0)).addSecs(qRound(number * m_pointCount * m_timePerStep));
+    const QString name = QString("synthetic_%1.xml").arg(number, 6, 10, QChar('0'));
+    const As::Generator::Reflection reflection = createReflection(wavelength, true);
+    const qreal gamma = reflection.angles[5];
+    const qreal nu = reflection.angles[6];
+    const qreal omegaCentre = reflection.angles[7];
+
+    auto tag = [this] (const QString& group, const QString& element) {
+        return fileName(As::S6T2_DAT, group, element); };
+
+    QString content;
+    QXmlStreamWriter xml(&content);
+
+    xml.writeStartDocument();
+    xml.writeStartElement("Acquisition");
+    xml.writeTextElement("manip", "6T2");
+    xml.writeTextElement(tag("conditions", "Wavelength"), QString::number(wavelength));
+
+    const qreal time = m_polarised ? 0.5 * m_timePerStep : m_timePerStep;
+
+    for (int point = 0; point < m_pointCount; ++point) {
+        const QDateTime frameTime = dateTime.addSecs(qRound(point * m_timePerStep));
+
+        xml.writeStartElement("Frame");
+        xml.writeAttribute("date", frameTime.toString("yyyy-MM-dd"));
+        xml.writeAttribute("file", name);
+        xml.writeAttribute("sample", "Synthetic");
+        xml.writeAttribute("time", frameTime.toString("hh:mm:ss"));
+
+        xml.writeStartElement(tag("conditions", "Temperature"));
+        xml.writeAttribute("unit", "Kelvin");
+        xml.writeCharacters("300.0");
+        xml.writeEndElement();
+
+        xml.writeStartElement(tag("conditions", "Magnetic field"));
+        xml.writeAttribute("unit", "T");
+        xml.writeCharacters("0.0");
+        xml.writeEndElement();
+
+        xml.writeStartElement("Monitoring");
+        xml.writeAttribute("Flipping", m_polarised ? "True" : "False");
+
+        if (m_polarised) {
+            const int monUp   = poisson(time * m_monitorRate);
+            const int monDown = poisson(time * m_monitorRate);
+            const int detUp   = poisson(time * peakCounts(reflection, point, 1));
+            const int detDown = poisson(time * peakCounts(reflection, point, -1));
+            xml.writeTextElement(tag("conditions",  "Time/step"),    QString::number(m_timePerStep, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Monitor"),      QString::number(monUp + monDown, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Detector"),     QString::number(detUp + detDown));
+            xml.writeTextElement(tag("conditions",  "Time/step(+)"), QString::number(time, 'f', 1));
+            xml.writeTextElement(tag("conditions",  "Time/step(-)"), QString::number(time, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Monitor(+)"),   QString::number(monUp, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Monitor(-)"),   QString::number(monDown, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Detector(-)"),  QString::number(detDown, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Detector(+)"),  QString::number(detUp, 'f', 1)); }
+        else {
+            const int mon = poisson(time * m_monitorRate);
+            const int det = poisson(time * peakCounts(reflection, point, 0));
+            xml.writeTextElement(tag("conditions",  "Time/step"),    QString::number(time, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Monitor"),      QString::number(mon, 'f', 1));
+            xml.writeTextElement(tag("intensities", "Detector"),     QString::number(det, 'f', 1)); }
+
+        xml.writeEndElement(); // Monitoring
+
+        xml.writeStartElement("hkl");
+        xml.writeTextElement(tag("indices", "H"), QString::number(reflection.h));
+        xml.writeTextElement(tag("indices", "K"), QString::number(reflection.k));
+        xml.writeTextElement(tag("indices", "L"), QString::number(reflection.l));
+        xml.writeEndElement();
+
+        xml.writeStartElement("crystal");
+        xml.writeTextElement("UB", "[[" + ubMatrixRows(", ").join("], [") + "]]");
+        xml.writeEndElement();
+
+        xml.writeStartElement("AXES");
+        xml.writeTextElement(tag("angles", "Omega"), QString::number(omegaCentre + scanShift(point), 'f', 2));
+        xml.writeTextElement(tag("angles", "Gamma"), QString::number(gamma, 'f', 2));
+        xml.writeTextElement(tag("angles", "Nu"),    QString::number(nu, 'f', 2));
+        xml.writeEndElement();
+
+        xml.writeEndElement(); } // Frame
+
+    xml.writeEndElement(); // Acquisition
+    xml.writeEndDocument();
+
+    return content; }
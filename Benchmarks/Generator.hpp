@@ -0,0 +1,108 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_GENERATOR_HPP
+#define AS_GENERATOR_HPP
+
+#include <random>
+
+#include <QString>
+#include <QStringList>
+
+#include "Constants.hpp"
+
+#include "RealMatrix9.hpp"
+#include "RealVector.hpp"
+#include "ScanArray.hpp"
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class Generator {
+
+  public:
+    struct Reflection {
+        qreal h, k, l;                  // Miller indices
+        As::RealVector angles;          // Scan centre angles as returned by xyzToAngles
+        qreal amplitude;                // Peak amplitude, counts per second
+        qreal flippingRatio;            // Ratio of the up and down peak amplitudes
+        qreal fwhm;                     // Peak width, deg
+        qreal shift;                    // Peak centre shift from the scan centre, deg
+        qreal background; };            // Background, counts per second
+
+    static const int REFLECTIONS_PER_FILE;
+
+    Generator(const quint32 seed = 1);
+    ~Generator();
+
+    static As::InputFileType typeFromName(const QString& name);
+
+    void setReflectionCount(const int count);
+    void setPointCount(const int count);
+    void setPolarised(const bool polarised);
+
+    bool generate(const QString& dirPath,
+                  const As::InputFileType type);
+
+  private:
+    qreal uniform();
+    qreal uniform(const qreal min,
+                  const qreal max);
+    qreal gaussian();
+    int poisson(const qreal mean);
+
+    void createUbMatrix();
+    As::Generator::Reflection createReflection(const qreal wavelength,
+                                               const bool liftingCounter);
+
+    qreal peakCounts(const As::Generator::Reflection& reflection,
+                     const int point,
+                     const qreal polarisation) const;
+    qreal scanShift(const int point) const;
+
+    QString fileName(const As::InputFileType type,
+                     const QString& group,
+                     const QString& element) const;
+    QStringList ubMatrixRows(const QString& separator) const;
+
+    bool writeFile(const QString& filePath,
+                   const QString& content) const;
+
+    QString heidiDat(const int first,
+                     const int count);
+    QString heidiLog(const int first,
+                     const int count);
+    QString nicosDat(const int number);
+    QString s6t2Xml(const int number);
+
+    std::mt19937 m_engine;
+    int m_reflectionCount = 1000;
+    int m_pointCount = 31;
+    bool m_polarised = false;
+    qreal m_scanStep = 0.1;
+    qreal m_timePerStep = 1.0;
+    qreal m_monitorRate = 10000.0;
+    As::RealMatrix9 m_ub;
+    As::ScanArray m_geometry;
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_GENERATOR_HPP
@@ -18,7 +18,6 @@
     along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <QColor>
 #include <QHash>
 #include <QString>
 #include <QStringList>
@@ -52,12 +51,6 @@ const int As::APP_SIDEBAR_WIDTH = 300; //settings.value("Sidebar/width", 300).to
 */
 const int As::REDUCED_VERTICAL_SPACING = 7;
 
-/*!
-    \variable As::SELECTION_BACKGROUND
-    \brief the color of the selection background.
-*/
-const QColor As::SELECTION_BACKGROUND("#f8f8f8");
-
 // Internally defined enums
 
 /*!
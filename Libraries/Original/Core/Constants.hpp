@@ -21,7 +21,6 @@
 #ifndef AS_CONSTANTS_HPP
 #define AS_CONSTANTS_HPP
 
-class QColor;
 class QString;
 
 namespace As { //AS_BEGIN_NAMESPACE
@@ -115,8 +114,6 @@ extern const int APP_FULL_WIDTH;
 extern const int APP_SIDEBAR_WIDTH;
 extern const int REDUCED_VERTICAL_SPACING;
 
-extern const QColor SELECTION_BACKGROUND;
-
 } //AS_END_NAMESPACE
 
 #endif // AS_CONSTANTS_HPP
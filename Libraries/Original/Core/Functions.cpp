@@ -21,8 +21,6 @@
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QFileInfo>
-#include <QFont>
-#include <QFontMetrics>
 #include <QRegExp>
 #include <QRegularExpression>
 #include <QSettings>
@@ -189,6 +187,30 @@ const QString As::FormatString(const QString& string,
         result = QString().sprintf(qPrintable("%" + format), qRound(mean)); }
     return result; }
 
+/*!
+    Returns the string formatted to a single value based on the given real \a value and \a format.
+
+    In contrast to FormatString, the value is formatted directly without any intermediate
+    conversion to string, so no precision is lost. Returns an empty string if \a value is NaN.
+*/
+const QString As::FormatNumber(const qreal value,
+                               const QString& format) {
+    if (qIsNaN(value)) {
+        return QString(); }
+    const QString string = QString::number(value, 'g', 17);
+    if (format.isEmpty()) {
+        return string; }
+    // comma separated values, date and time or string
+    if (format.contains("csv") OR format.contains("dd") OR format.contains("s")) {
+        return FormatString(string, format); }
+    // float (real) number
+    if (format.contains("f")) {
+        return QString().sprintf(qPrintable("%" + format), value); }
+    // integer number
+    if (format.contains("i")) {
+        return QString().sprintf(qPrintable("%" + format), qRound(value)); }
+    return string; }
+
 /*!
     Returns the string formatted to a text based on the given \a string and \a format.
 */
@@ -239,17 +261,6 @@ const QString As::FormatStringToRange(const QString& string,
             other = FormatString(string, format); } }
     return other; }
 
-/*!
-    Calculates the width of the sidebar (in px) depends on the width of the given \a font.
-*/
-int As::SidebarWidth(const QFont& font) {
-    QFontMetrics fm(font);
-    //setCursorWidth(fm.averageCharWidth());
-    int widthPx = fm.width("abcdefghijklmnopqrstuvwxyz0123456789-+*");
-    if (widthPx % 2) { // check if it's odd, i.e. 2n+1
-        ++widthPx; }   // if it's odd, convert it to even 2n+2 (for equal widths ofthe sidebar tabs)
-    return widthPx; }
-
 /*!
     Sets the debug output if \a isDebugMode is \c true.
 */
@@ -25,7 +25,6 @@
 
 class QChar;
 class QDateTime;
-class QFont;
 class QMessageLogContext;
 class QString;
 class QStringList;
@@ -46,13 +45,13 @@ QStringList ToStringList(const QString &string);
 
 const QString FormatString(const QString &string, // FormatString? rename?
                            const QString &format);
+const QString FormatNumber(const qreal value,
+                           const QString &format);
 const QString FormatStringToText(const QString &string,
                                  const QString &format);
 const QString FormatStringToRange(const QString &string,
                                   const QString &format);
 
-int SidebarWidth(const QFont &font);
-
 void SetDebugOutputFormat(const bool showDebugInfo);
 
 void NoMessageOutput(QtMsgType type,
@@ -0,0 +1,279 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "Macros.hpp"
+
+#include "Profiler.hpp"
+
+/*!
+    \class As::Profiler
+
+    \brief The Profiler is a class that collects the wall and CPU time, as well as
+    the counters (e.g. scans, files and bytes processed) of the data processing stages.
+
+    The single instance of the profiler is shared by the whole application. It is disabled
+    by default; in this case all the As::ProfilerStage and As::ProfilerItem objects do
+    nothing. The data can be reported as a text summary or as a JSON document.
+
+    The CPU time is measured for the whole process, i.e. it is summed over all the threads
+    running during the stage.
+
+    \inmodule Core
+*/
+
+/*!
+    \variable As::Profiler::SLOWEST_ITEMS_COUNT
+    \brief the number of the slowest items (scans or files) kept for every stage.
+*/
+const int As::Profiler::SLOWEST_ITEMS_COUNT = 5;
+
+/*!
+    Constructs a disabled profiler.
+*/
+As::Profiler::Profiler() {}
+
+/*!
+    Returns the instance of the profiler shared by the application.
+*/
+As::Profiler& As::Profiler::instance() {
+    static As::Profiler profiler;
+    return profiler; }
+
+/*!
+    Enables the profiler if \a enabled is \c true; otherwise disables it.
+*/
+void As::Profiler::setEnabled(const bool enabled) {
+    m_enabled = enabled; }
+
+/*!
+    Returns \c true if the profiler is enabled; otherwise returns \c false.
+*/
+bool As::Profiler::isEnabled() const {
+    return m_enabled; }
+
+/*!
+    Removes all the collected data.
+*/
+void As::Profiler::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_stageOrder.clear();
+    m_stages.clear(); }
+
+/*!
+    Returns the stage with the given \a name. The stage is created, if needed.
+    The caller must hold the mutex.
+*/
+As::Profiler::Stage& As::Profiler::stage(const QString& name) {
+    if (!m_stages.contains(name)) {
+        m_stageOrder << name; }
+    return m_stages[name]; }
+
+/*!
+    Adds the wall time \a wallNsecs and CPU time \a cpuNsecs (both in nanoseconds)
+    to the given \a stage.
+*/
+void As::Profiler::addStageTime(const QString& stage,
+                                const qint64 wallNsecs,
+                                const qint64 cpuNsecs) {
+    if (!m_enabled) {
+        return; }
+
+    QMutexLocker locker(&m_mutex);
+    auto& s = this->stage(stage);
+    ++s.calls;
+    s.wallNsecs += wallNsecs;
+    s.cpuNsecs += cpuNsecs; }
+
+/*!
+    Adds the \a value to the \a counter of the given \a stage.
+*/
+void As::Profiler::addCounter(const QString& stage,
+                              const QString& counter,
+                              const qint64 value) {
+    if (!m_enabled) {
+        return; }
+
+    QMutexLocker locker(&m_mutex);
+    this->stage(stage).counters[counter] += value; }
+
+/*!
+    Registers the wall time \a wallNsecs (in nanoseconds) spent on the item with the given
+    \a index (e.g. scan or file) within the \a stage. Only the slowest items are kept.
+*/
+void As::Profiler::addItemTime(const QString& stage,
+                               const int index,
+                               const qint64 wallNsecs) {
+    if (!m_enabled) {
+        return; }
+
+    QMutexLocker locker(&m_mutex);
+    auto& items = this->stage(stage).slowestItems;
+
+    if (items.size() == SLOWEST_ITEMS_COUNT AND items.last().first >= wallNsecs) {
+        return; }
+
+    int i = 0;
+    while (i < items.size() AND items[i].first >= wallNsecs) {
+        ++i; }
+    items.insert(i, qMakePair(wallNsecs, index));
+
+    if (items.size() > SLOWEST_ITEMS_COUNT) {
+        items.removeLast(); } }
+
+/*!
+    Returns the human readable summary of the collected data, one line per list item.
+*/
+const QStringList As::Profiler::summary() const {
+    QMutexLocker locker(&m_mutex);
+    QStringList lines;
+
+    lines << QString("%1 %2 %3 %4")
+          .arg("Stage", -12).arg("Wall, ms", 12).arg("CPU, ms", 12).arg("Counters");
+
+    qint64 totalWallNsecs = 0;
+
+    for (const QString& name : m_stageOrder) {
+        const auto& s = m_stages[name];
+        totalWallNsecs += s.wallNsecs;
+
+        QStringList counters;
+        for (auto it = s.counters.constBegin(); it != s.counters.constEnd(); ++it) {
+            counters << QString("%1: %2").arg(it.key()).arg(it.value()); }
+
+        lines << QString("%1 %2 %3 %4")
+              .arg(name, -12)
+              .arg(s.wallNsecs * 1e-6, 12, 'f', 1)
+              .arg(s.cpuNsecs * 1e-6, 12, 'f', 1)
+              .arg(counters.join(", "));
+
+        if (!s.slowestItems.isEmpty()) {
+            QStringList items;
+            for (const auto& item : s.slowestItems) {
+                items << QString("#%1 (%2 ms)").arg(item.second + 1).arg(item.first * 1e-6, 0, 'f', 2); }
+            lines << QString("%1 slowest: %2").arg("", -12).arg(items.join(", ")); } }
+
+    lines << QString("%1 %2").arg("Total", -12).arg(totalWallNsecs * 1e-6, 12, 'f', 1);
+
+    return lines; }
+
+/*!
+    Returns the collected data as a JSON object.
+*/
+const QJsonObject As::Profiler::toJson() const {
+    QMutexLocker locker(&m_mutex);
+    QJsonArray stages;
+
+    for (const QString& name : m_stageOrder) {
+        const auto& s = m_stages[name];
+
+        QJsonObject counters;
+        for (auto it = s.counters.constBegin(); it != s.counters.constEnd(); ++it) {
+            counters.insert(it.key(), static_cast<double>(it.value())); }
+
+        QJsonArray slowest;
+        for (const auto& item : s.slowestItems) {
+            slowest.append(QJsonObject{
+                { "index", item.second },
+                { "wallMs", item.first * 1e-6 } }); }
+
+        stages.append(QJsonObject{
+            { "name", name },
+            { "calls", s.calls },
+            { "wallMs", s.wallNsecs * 1e-6 },
+            { "cpuMs", s.cpuNsecs * 1e-6 },
+            { "counters", counters },
+            { "slowest", slowest } }); }
+
+    return QJsonObject{
+        { "threads", QThread::idealThreadCount() },
+        { "stages", stages } }; }
+
+/*!
+    Saves the collected data as a JSON document to the file \a fileName. The additional
+    \a info (e.g. application name and version) is added to the top level object.
+
+    Returns \c true on success; otherwise returns \c false.
+*/
+bool As::Profiler::saveJson(const QString& fileName,
+                            const QJsonObject& info) const {
+    QJsonObject report = toJson();
+    for (auto it = info.constBegin(); it != info.constEnd(); ++it) {
+        report.insert(it.key(), it.value()); }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false; }
+
+    file.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+    return true; }
+
+/*!
+    \class As::ProfilerStage
+
+    \brief The ProfilerStage is a class that measures the wall and CPU time of the
+    stage from its construction till its destruction and adds it to the As::Profiler.
+
+    \inmodule Core
+*/
+
+/*!
+    Starts measuring the time of the given \a stage.
+*/
+As::ProfilerStage::ProfilerStage(const QString& stage)
+    : m_stage(stage),
+      m_cpuStart(std::clock()) {
+    m_timer.start(); }
+
+/*!
+    Stops measuring and adds the time to the profiler.
+*/
+As::ProfilerStage::~ProfilerStage() {
+    const qint64 cpuNsecs = static_cast<qint64>(1e9 * (std::clock() - m_cpuStart) / CLOCKS_PER_SEC);
+    As::Profiler::instance().addStageTime(m_stage, m_timer.nsecsElapsed(), cpuNsecs); }
+
+/*!
+    \class As::ProfilerItem
+
+    \brief The ProfilerItem is a class that measures the wall time spent on the single
+    item (e.g. scan or file) within the stage, in order to find the slowest ones.
+
+    \inmodule Core
+*/
+
+/*!
+    Starts measuring the time of the item with the given \a index within the \a stage.
+*/
+As::ProfilerItem::ProfilerItem(const QString& stage,
+                               const int index)
+    : m_stage(stage),
+      m_index(index) {
+    m_timer.start(); }
+
+/*!
+    Stops measuring and registers the time in the profiler.
+*/
+As::ProfilerItem::~ProfilerItem() {
+    As::Profiler::instance().addItemTime(m_stage, m_index, m_timer.nsecsElapsed()); }
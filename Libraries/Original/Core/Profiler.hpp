@@ -0,0 +1,114 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_PROFILER_HPP
+#define AS_PROFILER_HPP
+
+#include <atomic>
+#include <ctime>
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class Profiler {
+
+  public:
+    static const int SLOWEST_ITEMS_COUNT;
+
+    static As::Profiler& instance();
+
+    void setEnabled(const bool enabled);
+    bool isEnabled() const;
+
+    void clear();
+
+    void addStageTime(const QString& stage,
+                      const qint64 wallNsecs,
+                      const qint64 cpuNsecs);
+    void addCounter(const QString& stage,
+                    const QString& counter,
+                    const qint64 value);
+    void addItemTime(const QString& stage,
+                     const int index,
+                     const qint64 wallNsecs);
+
+    const QStringList summary() const;
+    const QJsonObject toJson() const;
+    bool saveJson(const QString& fileName,
+                  const QJsonObject& info = QJsonObject()) const;
+
+  private:
+    Profiler();
+
+    struct Stage {
+        int calls = 0;
+        qint64 wallNsecs = 0;
+        qint64 cpuNsecs = 0;
+        QMap<QString, qint64> counters;
+        QList<QPair<qint64, int>> slowestItems; // (wall time, item index), sorted descending
+    };
+
+    As::Profiler::Stage& stage(const QString& name);
+
+    std::atomic<bool> m_enabled{false}; // read by every stage and item without locking
+    QStringList m_stageOrder;
+    QMap<QString, As::Profiler::Stage> m_stages;
+    mutable QMutex m_mutex;
+
+};
+
+class ProfilerStage {
+
+  public:
+    explicit ProfilerStage(const QString& stage);
+    ~ProfilerStage();
+
+  private:
+    QString m_stage;
+    QElapsedTimer m_timer;
+    std::clock_t m_cpuStart;
+
+};
+
+class ProfilerItem {
+
+  public:
+    ProfilerItem(const QString& stage,
+                 const int index);
+    ~ProfilerItem();
+
+  private:
+    QString m_stage;
+    int m_index;
+    QElapsedTimer m_timer;
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_PROFILER_HPP
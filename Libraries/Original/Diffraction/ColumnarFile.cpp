@@ -0,0 +1,284 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDataStream>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStringList>
+#include <QtEndian>
+
+#include <cstring>
+
+#include "Macros.hpp"
+
+#include "ResultTable.hpp"
+#include "ScanDict.hpp"
+
+#include "ColumnarFile.hpp"
+
+/*!
+    \class As::ColumnarFile
+
+    \brief The ColumnarFile is a class that provides the binary columnar output file
+    of the treated reflections.
+
+    The file is written straight from the output table, without any conversion of the
+    numbers to text, so that the scripts can load it quickly and without any loss of
+    precision. All the numbers are little-endian. The file consists of:
+
+    \list
+    \li the 24-byte prefix: the MAGIC "DVCOLUMN", the FORMAT_VERSION (uint32), the size
+        of the header in bytes (uint32) and the offset of the data from the beginning
+        of the file (uint64);
+    \li the UTF-8 JSON header with the "rowCount" and the "columns" array, where every
+        column is described by its "name", "group", "units" and "format" taken from
+        As::ScanDict, its "type", and the "offset" from the beginning of the data and
+        the "size" in bytes;
+    \li the data of the columns, one after another, every column starts at a multiple
+        of 8 bytes.
+    \endlist
+
+    The "float64" column is the plain array of doubles. The "utf8" column is the array
+    of rowCount + 1 uint64 offsets of the strings, followed by the strings themselves.
+    Thus, every column can be used in place from the memory mapped file, e.g. by
+    numpy.frombuffer(data, '<f8', rowCount, offset).
+
+    \inmodule Diffraction
+*/
+
+namespace {
+
+const qint64 PREFIX_SIZE = 24;
+
+// Returns the \a size rounded up to the multiple of 8 bytes
+qint64 Aligned(const qint64 size) {
+    return (size + 7) / 8 * 8; }
+
+// Writes the zero bytes to the \a out stream up to the multiple of 8 bytes after \a size
+void WritePadding(QDataStream& out,
+                  const qint64 size) {
+    static const char zeros[8] = {};
+    out.writeRawData(zeros, static_cast<int>(Aligned(size) - size)); }
+
+}
+
+/*!
+    \variable As::ColumnarFile::MAGIC
+
+    Magic bytes written at the beginning of the file.
+*/
+const QByteArray As::ColumnarFile::MAGIC = "DVCOLUMN";
+
+/*!
+    \variable As::ColumnarFile::FORMAT_VERSION
+
+    Version of the format of the file. Must be increased every time the layout of the
+    file is changed.
+*/
+const quint32 As::ColumnarFile::FORMAT_VERSION = 1;
+
+/*!
+    \variable As::ColumnarFile::EXTENSION
+
+    Extension of the file.
+*/
+const QString As::ColumnarFile::EXTENSION = "dvc";
+
+/*!
+    Saves the given \a rows of the \a table to the file \a filePath. Returns true on
+    success.
+*/
+bool As::ColumnarFile::save(const QString& filePath,
+                            const As::ResultTable& table,
+                            const QVector<int>& rows) {
+    ADEBUG << filePath;
+
+    const qint64 rowCount = rows.size();
+
+    // The strings are converted before the header is written, as their size is needed there
+    QVector<QByteArray> strings(table.columnCount());
+    QVector<QVector<quint64>> stringOffsets(table.columnCount());
+
+    QJsonArray columns;
+    qint64 offset = 0;
+    for (int column = 0; column < table.columnCount(); ++column) {
+        const QString& name = table.headers().at(column);
+        const QString group = columnGroup(name);
+
+        QJsonObject description{
+            { "name", name },
+            { "group", group },
+            { "units", group.isEmpty() ? QString() : As::ScanDict::Properties[group][name]["units"] },
+            { "format", table.format(column) } };
+
+        qint64 size = 0;
+        if (table.columnType(column) == As::ResultTable::RealColumn) {
+            description.insert("type", "float64");
+            size = 8 * rowCount; }
+
+        else {
+            description.insert("type", "utf8");
+            stringOffsets[column].reserve(rows.size() + 1);
+            stringOffsets[column] << 0;
+            for (const int row : rows) {
+                strings[column] += table.text(row, column).toUtf8();
+                stringOffsets[column] << strings[column].size(); }
+            size = 8 * (rowCount + 1) + strings[column].size(); }
+
+        description.insert("offset", static_cast<double>(offset));
+        description.insert("size", static_cast<double>(size));
+        columns << description;
+        offset += Aligned(size); }
+
+    const QJsonObject root{
+        { "format", "davinci-columns" },
+        { "version", static_cast<int>(FORMAT_VERSION) },
+        { "byteOrder", "little" },
+        { "rowCount", static_cast<double>(rowCount) },
+        { "columns", columns } };
+    const QByteArray header = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    const qint64 dataOffset = Aligned(PREFIX_SIZE + header.size());
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false; }
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    out.writeRawData(MAGIC.constData(), MAGIC.size());
+    out << FORMAT_VERSION << quint32(header.size()) << quint64(dataOffset);
+    out.writeRawData(header.constData(), header.size());
+    WritePadding(out, PREFIX_SIZE + header.size());
+
+    for (int column = 0; column < table.columnCount(); ++column) {
+        if (table.columnType(column) == As::ResultTable::RealColumn) {
+            const QVector<qreal>& values = table.realColumn(column);
+            for (const int row : rows) {
+                out << static_cast<double>(values.at(row)); } }
+
+        else {
+            for (const quint64 stringOffset : stringOffsets.at(column)) {
+                out << stringOffset; }
+            out.writeRawData(strings.at(column).constData(), strings.at(column).size());
+            WritePadding(out, strings.at(column).size()); } }
+
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false; }
+
+    return file.commit(); }
+
+/*!
+    Loads the whole \a table from the file \a filePath. The file is memory mapped, so
+    that the columns are read in place. Returns true on success, otherwise the table
+    is left empty and false is returned.
+*/
+bool As::ColumnarFile::load(const QString& filePath,
+                            As::ResultTable& table) {
+    ADEBUG << filePath;
+
+    table.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) OR file.size() < PREFIX_SIZE) {
+        return false; }
+
+    const qint64 fileSize = file.size();
+    const uchar* data = file.map(0, fileSize);
+    if (data == Q_NULLPTR) {
+        return false; }
+
+    const quint32 version = qFromLittleEndian<quint32>(data + 8);
+    const quint32 headerSize = qFromLittleEndian<quint32>(data + 12);
+    const quint64 dataOffset = qFromLittleEndian<quint64>(data + 16);
+    if (QByteArray::fromRawData(reinterpret_cast<const char*>(data), MAGIC.size()) != MAGIC OR
+        version != FORMAT_VERSION OR
+        PREFIX_SIZE + headerSize > dataOffset OR dataOffset > static_cast<quint64>(fileSize)) {
+        return false; }
+
+    const QByteArray header(reinterpret_cast<const char*>(data + PREFIX_SIZE), static_cast<int>(headerSize));
+    const QJsonObject root = QJsonDocument::fromJson(header).object();
+    const qint64 rowCount = static_cast<qint64>(root.value("rowCount").toDouble(-1));
+    if (rowCount < 0) {
+        return false; }
+
+    table.setRowCount(static_cast<int>(rowCount));
+
+    for (const QJsonValue& value : root.value("columns").toArray()) {
+        const QJsonObject description = value.toObject();
+        const QString name = description.value("name").toString();
+        const QString format = description.value("format").toString();
+        const QString type = description.value("type").toString();
+        const qint64 offset = static_cast<qint64>(dataOffset) + static_cast<qint64>(description.value("offset").toDouble());
+        const qint64 size = static_cast<qint64>(description.value("size").toDouble());
+        const uchar* columnData = data + offset;
+
+        if (offset + size > fileSize OR table.columnIndex(name) >= 0) {
+            table.clear();
+            return false; }
+
+        if (type == "float64" AND size == 8 * rowCount) {
+            QVector<qreal> values(static_cast<int>(rowCount));
+            for (int row = 0; row < values.size(); ++row) {
+                const quint64 bits = qFromLittleEndian<quint64>(columnData + 8 * row);
+                double number;
+                std::memcpy(&number, &bits, sizeof(number));
+                values[row] = number; }
+            table.appendColumn(name, format, values); }
+
+        else if (type == "utf8" AND size >= 8 * (rowCount + 1)) {
+            const int column = table.appendColumn(name, format, As::ResultTable::TextColumn);
+            const uchar* stringsData = columnData + 8 * (rowCount + 1);
+            const qint64 stringsSize = size - 8 * (rowCount + 1);
+            for (int row = 0; row < rowCount; ++row) {
+                const quint64 begin = qFromLittleEndian<quint64>(columnData + 8 * row);
+                const quint64 end = qFromLittleEndian<quint64>(columnData + 8 * (row + 1));
+                if (begin > end OR end > static_cast<quint64>(stringsSize)) {
+                    table.clear();
+                    return false; }
+                table.setText(row, column, QString::fromUtf8(reinterpret_cast<const char*>(stringsData + begin),
+                                                             static_cast<int>(end - begin))); } }
+
+        else {
+            table.clear();
+            return false; } }
+
+    return true; }
+
+/*!
+    Returns the group of As::ScanDict, which contains the column \a name, or an empty
+    string if there is no such group. The groups of the output table are looked up
+    first, in the order used by As::ScanArray::createFullOutputTable().
+*/
+QString As::ColumnarFile::columnGroup(const QString& name) {
+    QStringList groups = { "number", "indices", "calculations", "angles", "cosines", "conditions" };
+    for (const QString& group : As::ScanDict::Properties.keys()) {
+        if (!groups.contains(group)) {
+            groups << group; } }
+
+    for (const QString& group : groups) {
+        if (As::ScanDict::Properties[group].contains(name)) {
+            return group; } }
+    return QString(); }
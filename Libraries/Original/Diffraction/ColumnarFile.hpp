@@ -0,0 +1,51 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_DIFFRACTION_COLUMNARFILE_HPP
+#define AS_DIFFRACTION_COLUMNARFILE_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ResultTable;
+
+class ColumnarFile {
+
+  public:
+    static const QByteArray MAGIC;
+    static const quint32 FORMAT_VERSION;
+    static const QString EXTENSION;
+
+    static bool save(const QString& filePath,
+                     const As::ResultTable& table,
+                     const QVector<int>& rows);
+    static bool load(const QString& filePath,
+                     As::ResultTable& table);
+
+    static QString columnGroup(const QString& name);
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_COLUMNARFILE_HPP
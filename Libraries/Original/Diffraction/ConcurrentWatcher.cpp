@@ -18,15 +18,20 @@
     along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <QAtomicInt>
+#include <QFutureInterface>
 #include <QThread>
 #include <QThreadPool>
 #include <QtConcurrent>
 
+#include <algorithm>
+
 #include "Macros.hpp"
+#include "Profiler.hpp"
 
-#include "ProgressDialog.hpp"
 #include "Scan.hpp"
 #include "ScanArray.hpp"
+#include "ScanDict.hpp"
 
 #include "ConcurrentWatcher.hpp"
 
@@ -34,19 +39,65 @@
     \class As::ConcurrentWatcher
 
     \brief The ConcurrentWatcher class inherits from QFutureWatcher<void>. It allows monitoring
-    a QFuture computation started via QtConcurrent::map. During the processing, it shows the
-    progress dialog by As::ProgressDialog.
+    a parallel computation on the scans. During the processing, its progress signals can
+    be connected to a progress indicator, e.g. As::ProgressDialog in the GUI.
+
+    The scans are not mapped one by one. The cost of every scan is estimated first, then
+    the scans are sorted from the heaviest to the lightest and grouped into chunks of
+    nearly equal cost. The heavy scans thus start first and don't extend the tail of the
+    computation, while the light ones don't pay the task overhead each. The chunks are
+    taken by the workers from the shared counter as soon as they are free, so the load
+    is balanced dynamically. The progress is reported in chunks.
+
+    The computation runs on the own thread pool of the application, computePool(), and
+    never changes the global thread pool used by the other code. The extraction reads
+    the files one by one in a single worker of ioPool(), which is either a separate pool
+    or the computation one.
 
     \inmodule Diffraction
 */
 
+// Number of threads requested for the parallel computation, 0 means default
+static int requestedThreadCount = 0;
+
+// Number of threads requested for reading the files, 0 means the computation pool is used
+static int requestedIoThreadCount = 0;
+
+// Number of chunks per thread: enough to balance the load, few enough to keep the overhead low
+static const int CHUNKS_PER_THREAD = 8;
+
+// Relative cost of the peak fit per point and beam type, compared to the integration
+static const qreal FIT_COST_PER_POINT = 50.;
+
+namespace {
+
+// Starts \a workerCount workers on the \a pool, which call \a func for all the items of
+// the \a chunks. The chunks are taken in order, the next one by the 1st free worker.
+// The number of the finished chunks is reported to the \a interface.
+QVector<QFuture<void>> startWorkers(QThreadPool* pool,
+                                    const int workerCount,
+                                    const QVector<QVector<int>>& chunks,
+                                    const std::function<void (int)>& func,
+                                    QAtomicInt& nextChunk,
+                                    QAtomicInt& finishedChunks,
+                                    QFutureInterface<void>& interface) {
+    QVector<QFuture<void>> workers;
+    for (int i = 0; i < workerCount; ++i) {
+        workers << QtConcurrent::run(pool, [&] () {
+            for (int chunk = nextChunk.fetchAndAddOrdered(1); chunk < chunks.size();
+                 chunk = nextChunk.fetchAndAddOrdered(1)) {
+                for (const int item : chunks.at(chunk)) {
+                    func(item); }
+                interface.setProgressValue(finishedChunks.fetchAndAddOrdered(1) + 1); } }); }
+    return workers; }
+
+}
+
 /*!
     Constructs a default watcher.
 */
 As::ConcurrentWatcher::ConcurrentWatcher(QObject* parent)
-    : QFutureWatcher<void>(parent) {
-    // Use default number of threads in parallel computation
-    QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount()); }
+    : QFutureWatcher<void>(parent) {}
 
 /*!
     Destroys the watcher.
@@ -61,18 +112,16 @@ void As::ConcurrentWatcher::startComputation(const QString& type,
                                              ScanArray* scans) {
     ADEBUG << "- parallel computation are started for:" << type;
 
-    // Default sequence for QtConcurrent::map
+    // Default sequence of the scan indices
     QVector<int> sequence(scans->size());
     for (int i = 0; i < scans->size(); ++i) {
         sequence[i] = i; }
 
-    // Use lambda function, because QtConcurrent::map doesn't accept class member functions.
-    // In QtConcurrent::run it was possible by providing 2 parameters...
+    // Computation of the single item, called by the workers
     std::function<void (int)> func;
 
     // Computation type dependent parameters
     if (type == "extract") {
-        QThreadPool::globalInstance()->setMaxThreadCount(1);
         const int size = scans->m_inputFilesContents.first.size();
         sequence.resize(size);
         for (int i = 0; i < size; ++i) {
@@ -96,10 +145,210 @@ void As::ConcurrentWatcher::startComputation(const QString& type,
     else {
         return; }
 
+    // The results may be shared with the output table, unshare them before the scans set their rows in parallel
+    scans->m_results.detach();
+
+    // Measure the time of every item, in order to find the slowest ones
+    As::ProfilerStage profilerStage(type);
+    As::Profiler::instance().addCounter(type, type == "extract" ? "files" : "scans", sequence.size());
+
+    if (As::Profiler::instance().isEnabled()) {
+        const std::function<void (int)> computation = func;
+        func = [computation, type] (const int i) {
+            As::ProfilerItem profilerItem(type, i);
+            computation(i); }; }
+
+    // The extraction keeps the order of the files, the other computations are chunked by cost
+    QVector<QVector<int>> chunks;
+    QThreadPool* pool = computePool();
+    int workerCount = threadCount();
+    if (type == "extract") {
+        for (const int i : sequence) {
+            chunks << QVector<int>{ i }; }
+        pool = ioPool();
+        workerCount = 1; }
+    else {
+        QVector<qreal> costs(sequence.size());
+        for (int i = 0; i < sequence.size(); ++i) {
+            costs[i] = scanCost(type, scans->at(sequence[i])); }
+        chunks = chunkSequence(costs, threadCount());
+        for (QVector<int>& chunk : chunks) {
+            for (int& i : chunk) {
+                i = sequence[i]; } }
+        As::Profiler::instance().addCounter(type, "chunks", chunks.size()); }
+
+    if (chunks.isEmpty()) {
+        return; }
+
     // Start the computation
-    setFuture(QtConcurrent::map(sequence, func));
+    QFutureInterface<void> interface;
+    interface.reportStarted();
+    interface.setProgressRange(0, chunks.size());
+    setFuture(interface.future());
+
+    QAtomicInt nextChunk(0);
+    QAtomicInt finishedChunks(0);
+    QVector<QFuture<void>> workers = startWorkers(pool, qMin(workerCount, chunks.size()), chunks, func,
+                                                  nextChunk, finishedChunks, interface);
     emit started();
+
+    for (QFuture<void>& worker : workers) {
+        worker.waitForFinished(); }
+    interface.reportFinished();
     waitForFinished();
 
+    // Follow the newly indexed scans
+    if (type == "index") {
+        scans->updateReflectionIndex(); }
+
     ADEBUG << "- parallel computation are finished." << type; }
 
+/*!
+    Sets the number of threads used in the parallel computation to \a count.
+    If \a count is 0, the ideal number of threads for the system is used.
+*/
+void As::ConcurrentWatcher::setThreadCount(const int count) {
+    requestedThreadCount = qMax(0, count);
+    computePool()->setMaxThreadCount(threadCount()); }
+
+/*!
+    Returns the number of threads used in the parallel computation.
+*/
+int As::ConcurrentWatcher::threadCount() {
+    return requestedThreadCount > 0 ? requestedThreadCount : QThread::idealThreadCount(); }
+
+/*!
+    Sets the number of threads used for reading the files to \a count. If \a count is 0,
+    the files are read by the computation pool, otherwise by the separate one, so that
+    the disk access doesn't compete with the computation for the threads.
+*/
+void As::ConcurrentWatcher::setIoThreadCount(const int count) {
+    requestedIoThreadCount = qMax(0, count);
+    if (requestedIoThreadCount > 0) {
+        ioPool()->setMaxThreadCount(requestedIoThreadCount); } }
+
+/*!
+    Returns the number of threads used for reading the files, or 0 if the files are read
+    by the computation pool.
+*/
+int As::ConcurrentWatcher::ioThreadCount() {
+    return requestedIoThreadCount; }
+
+/*!
+    Returns the thread pool of the parallel computation, owned by the application
+    instead of the global one.
+*/
+QThreadPool* As::ConcurrentWatcher::computePool() {
+    static QThreadPool pool;
+    static const bool isInitialized = [] () {
+        pool.setMaxThreadCount(threadCount());
+        return true; }();
+    Q_UNUSED(isInitialized)
+    return &pool; }
+
+/*!
+    Returns the thread pool for reading the files. It is the computation pool, unless
+    the separate I/O threads are requested by setIoThreadCount().
+*/
+QThreadPool* As::ConcurrentWatcher::ioPool() {
+    static QThreadPool pool;
+    if (requestedIoThreadCount == 0) {
+        return computePool(); }
+    return &pool; }
+
+/*!
+    Calls \a func for every item of the \a sequence on the thread \a pool, which is
+    the computation pool by default, and waits until all the items are processed. The
+    items are grouped into chunks of equal size, as for the computations of the equal
+    cost.
+*/
+void As::ConcurrentWatcher::blockingMap(const QVector<int>& sequence,
+                                        const std::function<void (int)>& func,
+                                        QThreadPool* pool) {
+    const int workerCount = qMax(1, pool->maxThreadCount());
+    QVector<QVector<int>> chunks = chunkSequence(QVector<qreal>(sequence.size(), 1.), workerCount);
+    for (QVector<int>& chunk : chunks) {
+        for (int& i : chunk) {
+            i = sequence[i]; } }
+
+    QFutureInterface<void> interface;
+    interface.reportStarted();
+    interface.setProgressRange(0, chunks.size());
+
+    QAtomicInt nextChunk(0);
+    QAtomicInt finishedChunks(0);
+    QVector<QFuture<void>> workers = startWorkers(pool, qMin(workerCount, chunks.size()), chunks, func,
+                                                  nextChunk, finishedChunks, interface);
+    for (QFuture<void>& worker : workers) {
+        worker.waitForFinished(); }
+    interface.reportFinished(); }
+
+/*!
+    Returns the estimated cost of the computation of type \a type for the given \a scan,
+    in the relative units.
+
+    The cost grows with the number of points and the number of beam types measured.
+    The automatic detection of the background and skip points tries all their
+    combinations and scales with the cube of the number of points, while the peak fit
+    adds the iterations of the minimizer for every beam type.
+*/
+qreal As::ConcurrentWatcher::scanCost(const QString& type,
+                                      const As::Scan* scan) {
+    const qreal points = qMax(1, scan->numPoints());
+
+    int beamCount = 0;
+    for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
+        if (!scan->data("intensities", "Detector" + countType).isEmpty()) {
+            ++beamCount; } }
+    beamCount = qMax(1, beamCount);
+
+    qreal cost = points * beamCount;
+
+    if (type != "treat") {
+        return cost; }
+
+    const bool autoSkip = scan->neighborsRemoveType() == As::Scan::AutoNeighborsRemove;
+    const bool autoBkg = scan->bkgDetectType() == As::Scan::AutoBkgDetect;
+    if (autoBkg AND autoSkip) {
+        cost += points * points * points; }
+    else if (autoBkg OR autoSkip) {
+        cost += points * points * points / 2; }
+
+    if (scan->peakAnalysisType() == As::Scan::PeakFit) {
+        cost += FIT_COST_PER_POINT * points * beamCount; }
+
+    return cost; }
+
+/*!
+    Splits the items with the given \a costs into chunks to be processed by \a threadCount
+    threads. Returns the chunks of the item indices: the heaviest items come first, the
+    items heavier than the average chunk stay alone, and the light ones are grouped
+    together. The result depends on the costs only.
+*/
+QVector<QVector<int>> As::ConcurrentWatcher::chunkSequence(const QVector<qreal>& costs,
+                                                           const int threadCount) {
+    QVector<int> order(costs.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i; }
+    std::stable_sort(order.begin(), order.end(), [&costs] (const int a, const int b) {
+        return costs[a] > costs[b]; });
+
+    qreal totalCost = 0.;
+    for (const qreal cost : costs) {
+        totalCost += cost; }
+    const qreal chunkCost = totalCost / (qMax(1, threadCount) * CHUNKS_PER_THREAD);
+
+    QVector<QVector<int>> chunks;
+    QVector<int> chunk;
+    qreal cost = 0.;
+    for (const int i : order) {
+        chunk << i;
+        cost += costs[i];
+        if (cost >= chunkCost) {
+            chunks << chunk;
+            chunk.clear();
+            cost = 0.; } }
+    if (!chunk.isEmpty()) {
+        chunks << chunk; }
+
+    return chunks; }
@@ -23,11 +23,16 @@
 
 #include <QObject>
 #include <QFutureWatcher>
+#include <QVector>
+
+#include <functional>
 
 class QString;
+class QThreadPool;
 
 namespace As { //AS_BEGIN_NAMESPACE
 
+class Scan;
 class ScanArray;
 
 class ConcurrentWatcher : public QFutureWatcher<void> {
@@ -40,6 +45,23 @@ class ConcurrentWatcher : public QFutureWatcher<void> {
     void startComputation(const QString& type,
                           As::ScanArray* scans);
 
+    static void setThreadCount(const int count);
+    static int threadCount();
+    static void setIoThreadCount(const int count);
+    static int ioThreadCount();
+
+    static QThreadPool* computePool();
+    static QThreadPool* ioPool();
+
+    static void blockingMap(const QVector<int>& sequence,
+                            const std::function<void (int)>& func,
+                            QThreadPool* pool = computePool());
+
+    static qreal scanCost(const QString& type,
+                          const As::Scan* scan);
+    static QVector<QVector<int>> chunkSequence(const QVector<qreal>& costs,
+                                               const int threadCount);
+
   signals:
     void started(); // override
 
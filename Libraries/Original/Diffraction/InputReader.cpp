@@ -0,0 +1,476 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QVector>
+#include <QtEndian>
+#include <QtZlib/zlib.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <numeric>
+
+
+#include "Macros.hpp"
+
+#include "ConcurrentWatcher.hpp"
+
+#include "InputReader.hpp"
+
+/*!
+    \class As::InputReader
+
+    \brief The InputReader is a class that reads the input files, including the
+    compressed files and the archives, without unpacking them to disk.
+
+    The following files are recognized by their extensions:
+
+    \list
+    \li \c .gz - a single gzip compressed file, presented as the file without the
+        \c .gz extension in the same directory;
+    \li \c .tar, \c .tar.gz and \c .tgz - a tar archive, every regular file of which
+        is presented as the virtual file \c {<archive path>/<member path>};
+    \li \c .zip - a zip archive with the stored or deflated members, presented in the
+        same way as the tar archive.
+    \endlist
+
+    The compressed data are inflated with zlib while the file is being read, so that
+    only the decompressed members are kept in memory. The input files are read in
+    parallel on the I/O thread pool, and their texts are then decoded in parallel on
+    the computation pool.
+
+    \inmodule Diffraction
+*/
+
+namespace {
+
+using Reader = std::function<qint64 (char*, qint64)>;
+
+const qint64 TAR_BLOCK_SIZE = 512;
+const int INPUT_CHUNK_SIZE = 64 * 1024;
+
+// Inflates the gzip (or zlib) stream read from the device, including the concatenated gzip members
+class GzipStream {
+
+  public:
+    explicit GzipStream(QIODevice* device)
+        : m_device(device),
+          m_input(INPUT_CHUNK_SIZE, Qt::Uninitialized) {
+        std::memset(&m_stream, 0, sizeof(m_stream));
+        m_isOk = inflateInit2(&m_stream, MAX_WBITS + 32) == Z_OK; } // +32: detect gzip or zlib header
+
+    ~GzipStream() {
+        inflateEnd(&m_stream); }
+
+    // Reads up to size bytes of the decompressed data. Returns the number of bytes read, or -1 on error
+    qint64 read(char* data,
+                const qint64 size) {
+        m_stream.next_out = reinterpret_cast<Bytef*>(data);
+        m_stream.avail_out = static_cast<uInt>(qMin<qint64>(size, INT_MAX));
+        const uInt requested = m_stream.avail_out;
+
+        while (m_isOk AND !m_atEnd AND m_stream.avail_out > 0) {
+            if (m_stream.avail_in == 0) {
+                const qint64 count = m_device->read(m_input.data(), m_input.size());
+                if (count <= 0) {
+                    m_isOk = false; // truncated stream
+                    break; }
+                m_stream.next_in = reinterpret_cast<Bytef*>(m_input.data());
+                m_stream.avail_in = static_cast<uInt>(count); }
+
+            const int status = inflate(&m_stream, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                if (m_stream.avail_in == 0 AND m_device->atEnd()) {
+                    m_atEnd = true; }
+                else {
+                    inflateReset(&m_stream); } }
+            else if (status != Z_OK) {
+                m_isOk = false; } }
+
+        return m_isOk ? static_cast<qint64>(requested - m_stream.avail_out) : -1; }
+
+    bool atEnd() const {
+        return m_atEnd; }
+
+  private:
+    QIODevice* m_device;
+    QByteArray m_input;
+    z_stream m_stream;
+    bool m_isOk = false;
+    bool m_atEnd = false;
+
+};
+
+// Reads exactly size bytes to data, or skips them if data is null
+bool ReadFully(const Reader& read,
+               char* data,
+               qint64 size) {
+    char skipped[TAR_BLOCK_SIZE];
+    while (size > 0) {
+        const qint64 chunk = data != Q_NULLPTR ? size : qMin(size, TAR_BLOCK_SIZE);
+        const qint64 count = read(data != Q_NULLPTR ? data : skipped, chunk);
+        if (count <= 0) {
+            return false; }
+        if (data != Q_NULLPTR) {
+            data += count; }
+        size -= count; }
+    return true; }
+
+// Returns the null-terminated string of at most size bytes
+QString FieldString(const char* field,
+                    const int size) {
+    return QString::fromUtf8(field, static_cast<int>(qstrnlen(field, static_cast<uint>(size)))); }
+
+// Returns the octal number of the tar header field, or -1 if it is not a number
+qint64 FieldOctal(const char* field,
+                  const int size) {
+    bool ok = false;
+    const qint64 number = QByteArray(field, static_cast<int>(qstrnlen(field, static_cast<uint>(size)))).trimmed().toLongLong(&ok, 8);
+    return ok ? number : -1; }
+
+// Returns true if the member should be skipped as the hidden file, as QDir::Files does
+bool IsHidden(const QString& memberPath) {
+    return memberPath.section('/', -1).startsWith('.'); }
+
+// Reads the regular files of the tar archive
+bool ReadTar(const Reader& read,
+             const QString& archivePath,
+             QList<As::InputReader::File>& files,
+             QString& error) {
+    char header[TAR_BLOCK_SIZE];
+    QString longName;
+
+    forever {
+        if (!ReadFully(read, header, TAR_BLOCK_SIZE)) {
+            error = "unexpected end of the tar archive";
+            return false; }
+
+        // The end of the archive is marked by the zero block
+        if (header[0] == '\0') {
+            return true; }
+
+        const qint64 size = FieldOctal(header + 124, 12);
+        if (size < 0 OR size > INT_MAX) {
+            error = "unsupported tar header";
+            return false; }
+
+        QByteArray data(static_cast<int>(size), Qt::Uninitialized);
+        const qint64 padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+        if (!ReadFully(read, data.data(), size) OR !ReadFully(read, Q_NULLPTR, padding)) {
+            error = "unexpected end of the tar archive";
+            return false; }
+
+        const char type = header[156];
+
+        // GNU long name of the next member
+        if (type == 'L') {
+            longName = FieldString(data.constData(), data.size());
+            continue; }
+
+        // POSIX extended header with the path of the next member
+        if (type == 'x') {
+            for (const QByteArray& record : data.split('\n')) {
+                const QByteArray keyValue = record.mid(record.indexOf(' ') + 1);
+                if (keyValue.startsWith("path=")) {
+                    longName = QString::fromUtf8(keyValue.mid(5)); } }
+            continue; }
+
+        QString name = longName;
+        longName.clear();
+
+        // Directories, links and other special members
+        if (type != '0' AND type != '\0') {
+            continue; }
+
+        if (name.isEmpty()) {
+            name = FieldString(header, 100);
+            const QString prefix = FieldString(header + 345, 155);
+            if (std::memcmp(header + 257, "ustar", 5) == 0 AND !prefix.isEmpty()) {
+                name = prefix + "/" + name; } }
+
+        if (name.endsWith('/') OR IsHidden(name)) {
+            continue; }
+
+        files << As::InputReader::File{ QDir::cleanPath(archivePath + "/" + name), data }; } }
+
+// Inflates the raw deflate stream of the zip member
+bool InflateRaw(const QByteArray& compressed,
+                QByteArray& data) {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return false; }
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.constData()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(data.data());
+    stream.avail_out = static_cast<uInt>(data.size());
+
+    const int status = inflate(&stream, Z_FINISH);
+    const bool ok = status == Z_STREAM_END AND stream.avail_out == 0;
+    inflateEnd(&stream);
+    return ok; }
+
+// Reads the regular files of the zip archive, the stored or deflated ones
+bool ReadZip(QFile& file,
+             const QString& archivePath,
+             QList<As::InputReader::File>& files,
+             QString& error) {
+    error = "unsupported or damaged zip archive";
+
+    // Find the end of central directory record, followed by the comment of up to 64 KiB
+    const qint64 tailSize = qMin<qint64>(file.size(), 22 + 0xFFFF);
+    if (tailSize < 22 OR !file.seek(file.size() - tailSize)) {
+        return false; }
+    const QByteArray tail = file.read(tailSize);
+    const int end = tail.lastIndexOf(QByteArray("PK\x05\x06", 4));
+    if (end < 0 OR end + 22 > tail.size()) {
+        return false; }
+
+    const uchar* record = reinterpret_cast<const uchar*>(tail.constData()) + end;
+    const int entryCount = qFromLittleEndian<quint16>(record + 10);
+    const quint32 directorySize = qFromLittleEndian<quint32>(record + 12);
+    const quint32 directoryOffset = qFromLittleEndian<quint32>(record + 16);
+    if (directoryOffset == 0xFFFFFFFF OR !file.seek(directoryOffset)) { // Zip64
+        return false; }
+    const QByteArray directory = file.read(directorySize);
+    if (directory.size() != static_cast<int>(directorySize)) {
+        return false; }
+
+    int position = 0;
+    for (int i = 0; i < entryCount; ++i) {
+        if (position + 46 > directory.size()) {
+            return false; }
+        const uchar* entry = reinterpret_cast<const uchar*>(directory.constData()) + position;
+        if (qFromLittleEndian<quint32>(entry) != 0x02014b50) {
+            return false; }
+
+        const quint16 flags = qFromLittleEndian<quint16>(entry + 8);
+        const quint16 method = qFromLittleEndian<quint16>(entry + 10);
+        const quint32 compressedSize = qFromLittleEndian<quint32>(entry + 20);
+        const quint32 size = qFromLittleEndian<quint32>(entry + 24);
+        const int nameSize = qFromLittleEndian<quint16>(entry + 28);
+        const int extraSize = qFromLittleEndian<quint16>(entry + 30);
+        const int commentSize = qFromLittleEndian<quint16>(entry + 32);
+        const quint32 localOffset = qFromLittleEndian<quint32>(entry + 42);
+        const QString name = QString::fromUtf8(directory.constData() + position + 46, nameSize);
+        position += 46 + nameSize + extraSize + commentSize;
+
+        if (name.endsWith('/') OR IsHidden(name)) {
+            continue; }
+
+        if ((flags & 0x1) OR (method != 0 AND method != 8) OR
+            size == 0xFFFFFFFF OR compressedSize == 0xFFFFFFFF OR size > INT_MAX) {
+            error = QString("unsupported zip member '%1'").arg(name);
+            return false; }
+
+        // The local header has its own name and extra field sizes
+        uchar local[30];
+        if (!file.seek(localOffset) OR file.read(reinterpret_cast<char*>(local), 30) != 30 OR
+            qFromLittleEndian<quint32>(local) != 0x04034b50) {
+            return false; }
+        const qint64 dataOffset = localOffset + 30 + qFromLittleEndian<quint16>(local + 26) +
+                                  qFromLittleEndian<quint16>(local + 28);
+        if (!file.seek(dataOffset)) {
+            return false; }
+        const QByteArray compressed = file.read(compressedSize);
+        if (compressed.size() != static_cast<int>(compressedSize)) {
+            return false; }
+
+        QByteArray data;
+        if (method == 0) {
+            data = compressed; }
+        else {
+            data.resize(static_cast<int>(size));
+            if (size > 0 AND !InflateRaw(compressed, data)) {
+                error = QString("cannot inflate zip member '%1'").arg(name);
+                return false; } }
+
+        files << As::InputReader::File{ QDir::cleanPath(archivePath + "/" + name), data }; }
+
+    error.clear();
+    return true; }
+
+// Returns true if the file is a gzip compressed tar archive
+bool IsTarGz(const QString& filePath) {
+    return filePath.endsWith(".tar.gz", Qt::CaseInsensitive) OR filePath.endsWith(".tgz", Qt::CaseInsensitive); }
+
+}
+
+/*!
+    Returns true if the file \a filePath is the compressed file or the archive, which
+    is read by this class instead of the plain text one.
+*/
+bool As::InputReader::isArchive(const QString& filePath) {
+    return filePath.endsWith(".gz", Qt::CaseInsensitive) OR
+           filePath.endsWith(".tgz", Qt::CaseInsensitive) OR
+           filePath.endsWith(".tar", Qt::CaseInsensitive) OR
+           filePath.endsWith(".zip", Qt::CaseInsensitive); }
+
+/*!
+    Returns the path of the compressed file or the archive, which contains the virtual
+    file \a filePath, or an empty string if \a filePath is not a virtual file.
+*/
+QString As::InputReader::archivePath(const QString& filePath) {
+    if (filePath.isEmpty() OR QFileInfo::exists(filePath)) {
+        return QString(); }
+
+    if (QFileInfo(filePath + ".gz").isFile()) {
+        return filePath + ".gz"; }
+
+    QString path = QFileInfo(filePath).path();
+    QString previousPath;
+    while (path != previousPath) {
+        const QFileInfo fileInfo(path);
+        if (fileInfo.exists()) {
+            return fileInfo.isFile() AND isArchive(path) ? path : QString(); }
+        previousPath = path;
+        path = fileInfo.path(); }
+
+    return QString(); }
+
+/*!
+    Reads the file \a filePath and appends it to the \a files. The archive is appended
+    as the list of its members sorted by their paths, as in the directory listing.
+    Returns true on success, otherwise sets the \a error and returns false.
+*/
+bool As::InputReader::readFile(const QString& filePath,
+                               QList<As::InputReader::File>& files,
+                               QString& error) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot read file '%1': %2.").arg(QDir::toNativeSeparators(filePath), file.errorString());
+        return false; }
+
+    if (!isArchive(filePath)) {
+        files << File{ filePath, file.readAll() };
+        return true; }
+
+    const QString absolutePath = QFileInfo(filePath).absoluteFilePath();
+    QList<File> members;
+    QString reason;
+    bool ok = false;
+
+    if (IsTarGz(filePath)) {
+        GzipStream gzip(&file);
+        ok = ReadTar([&gzip](char* data, qint64 size) { return gzip.read(data, size); },
+                     absolutePath, members, reason); }
+
+    else if (filePath.endsWith(".tar", Qt::CaseInsensitive)) {
+        ok = ReadTar([&file](char* data, qint64 size) { return file.read(data, size); },
+                     absolutePath, members, reason); }
+
+    else if (filePath.endsWith(".zip", Qt::CaseInsensitive)) {
+        ok = ReadZip(file, absolutePath, members, reason); }
+
+    else { // .gz
+        GzipStream gzip(&file);
+        QByteArray data;
+        QByteArray chunk(INPUT_CHUNK_SIZE, Qt::Uninitialized);
+        qint64 count = 0;
+        while (!gzip.atEnd() AND (count = gzip.read(chunk.data(), chunk.size())) >= 0) {
+            data.append(chunk.constData(), static_cast<int>(count)); }
+        ok = gzip.atEnd();
+        reason = "damaged gzip stream";
+        members << File{ absolutePath.left(absolutePath.size() - 3), data }; }
+
+    if (!ok) {
+        error = QString("Cannot read file '%1': %2.").arg(QDir::toNativeSeparators(filePath), reason);
+        return false; }
+
+    std::stable_sort(members.begin(), members.end(), [](const File& a, const File& b) {
+        return a.path < b.path; });
+    files << members;
+    return true; }
+
+/*!
+    Reads all the files \a filePaths in parallel and decodes their texts using the
+    \a codec, if given. The \a paths and \a contents of the files, with the archives
+    replaced by their members, are appended in the order of \a filePaths. Returns true
+    on success, otherwise sets the \a error of the first unreadable file and returns
+    false.
+*/
+bool As::InputReader::readFiles(const QStringList& filePaths,
+                                QStringList& paths,
+                                QStringList& contents,
+                                QString& error,
+                                const char* codec) {
+    ADEBUG << filePaths.size();
+
+    QVector<QList<File>> filesRead(filePaths.size());
+    QVector<QString> errors(filePaths.size());
+    QVector<int> sequence(filePaths.size());
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    // Every file is written by its own worker, hence no detaching of the shared vectors
+    QList<File>* filesData = filesRead.data();
+    QString* errorsData = errors.data();
+    As::ConcurrentWatcher::blockingMap(sequence, [&](const int i) {
+        readFile(filePaths[i], filesData[i], errorsData[i]); }, As::ConcurrentWatcher::ioPool());
+
+    for (const QString& fileError : errors) {
+        if (!fileError.isEmpty()) {
+            error = fileError;
+            return false; } }
+
+    QVector<File*> files;
+    for (QList<File>& list : filesRead) {
+        for (File& file : list) {
+            files << &file; } }
+
+    QVector<QString> texts(files.size());
+    sequence.resize(files.size());
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    QString* textsData = texts.data();
+    File* const* filesList = files.constData();
+    As::ConcurrentWatcher::blockingMap(sequence, [&](const int i) {
+        textsData[i] = decodeText(filesList[i]->data, codec);
+        filesList[i]->data.clear(); });
+
+    for (int i = 0; i < files.size(); ++i) {
+        paths << files[i]->path;
+        contents << texts[i]; }
+
+    return true; }
+
+/*!
+    Returns the text of the file \a data decoded in the same way as the text file,
+    i.e. with the Unicode auto detection, the given \a codec and the line endings
+    converted to '\\n'.
+*/
+QString As::InputReader::decodeText(const QByteArray& data,
+                                    const char* codec) {
+    QByteArray bytes = data;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+
+    QTextStream textStream(&buffer);
+    textStream.setAutoDetectUnicode(true);
+    if (codec != Q_NULLPTR) {
+        textStream.setCodec(codec); }
+
+    return textStream.readAll(); }
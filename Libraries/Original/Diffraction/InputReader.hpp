@@ -0,0 +1,57 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_DIFFRACTION_INPUTREADER_HPP
+#define AS_DIFFRACTION_INPUTREADER_HPP
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class InputReader {
+
+  public:
+    struct File {
+        QString path;       // absolute path, virtual for the archive members
+        QByteArray data; }; // raw content, decompressed
+
+    static bool isArchive(const QString& filePath);
+    static QString archivePath(const QString& filePath);
+
+    static bool readFile(const QString& filePath,
+                         QList<As::InputReader::File>& files,
+                         QString& error);
+    static bool readFiles(const QStringList& filePaths,
+                          QStringList& paths,
+                          QStringList& contents,
+                          QString& error,
+                          const char* codec = Q_NULLPTR);
+
+    static QString decodeText(const QByteArray& data,
+                              const char* codec = Q_NULLPTR);
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_INPUTREADER_HPP
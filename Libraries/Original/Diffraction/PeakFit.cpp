@@ -0,0 +1,428 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QtMath>
+
+#include "Macros.hpp"
+
+#include "PeakFit.hpp"
+
+namespace {
+
+// 4 ln 2, used in the Gaussian profile normalised to the full width at half maximum
+const qreal FOUR_LN2 = 4. * M_LN2;
+
+// Area of the unit height Gaussian and Lorentzian profiles of the unit width
+const qreal GAUSS_AREA   = qSqrt(M_PI / FOUR_LN2);
+const qreal LORENTZ_AREA = M_PI / 2.;
+
+// Damping factor limits of the Levenberg-Marquardt algorithm
+const qreal MIN_LAMBDA = 1e-10;
+const qreal MAX_LAMBDA = 1e10;
+
+} // namespace
+
+/*!
+    \class As::PeakFit
+
+    \brief The PeakFit is a class that fits a single peak profile (Gaussian, Lorentzian
+    or pseudo-Voigt) on a constant background by the Levenberg-Marquardt algorithm.
+
+    The profile y = Background + Amplitude * P(x; Position, Width[, Mixing]) is defined
+    by the full width at half maximum Width and, for the pseudo-Voigt, by the Lorentzian
+    fraction Mixing. The Jacobian is calculated analytically. All the work arrays are
+    allocated once per object and reused, so one object per thread is expected to fit
+    any number of peaks without memory allocation.
+
+    \inmodule Diffraction
+*/
+
+/*!
+    \enum As::PeakFit::Parameter
+
+    This enum type describes the fitted parameters.
+
+    \value Background   Constant background
+    \value Amplitude    Peak height above the background
+    \value Position     Peak position
+    \value Width        Full width at half maximum
+    \value Mixing       Lorentzian fraction of the pseudo-Voigt profile
+*/
+
+/*!
+    \variable As::PeakFit::MAX_ITERATIONS
+
+    Maximum number of the Levenberg-Marquardt iterations.
+*/
+const int As::PeakFit::MAX_ITERATIONS = 100;
+
+/*!
+    \variable As::PeakFit::TOLERANCE
+
+    Relative decrease of the chi-squared below which the fit is considered as converged.
+*/
+const qreal As::PeakFit::TOLERANCE = 1e-8;
+
+/*!
+    Constructs a Gaussian peak fit.
+*/
+As::PeakFit::PeakFit() {
+    setFitType(As::Scan::GaussFit); }
+
+/*!
+    Destroys the peak fit.
+*/
+As::PeakFit::~PeakFit() {
+    ADESTROYED; }
+
+/*!
+    Sets the profile function to be \a type and resizes the workspace accordingly.
+*/
+void As::PeakFit::setFitType(const As::Scan::PeakFitType type) {
+    m_fitType = type;
+
+    const int n = parameterCount();
+    m_derivatives.resize(n);
+    m_params.resize(n);
+    m_trialParams.resize(n);
+    m_alpha.resize(n * n);
+    m_trialAlpha.resize(n * n);
+    m_beta.resize(n);
+    m_trialBeta.resize(n);
+    m_system.resize(n * n);
+    m_step.resize(n);
+    m_covariance.resize(n * n);
+    m_errors.fill(qQNaN(), n); }
+
+/*!
+    Returns the profile function type.
+*/
+As::Scan::PeakFitType As::PeakFit::fitType() const {
+    return m_fitType; }
+
+/*!
+    Returns the number of the fitted parameters.
+*/
+int As::PeakFit::parameterCount() const {
+    return m_fitType == As::Scan::PseudoVoigtFit ? 5 : 4; }
+
+/*!
+    Fits the points \a x, \a y with the standard deviations \a sy starting from the
+    parameters \a start, given in the order of As::PeakFit::Parameter. The zero
+    standard deviations are replaced by 1. Returns true if the fit is converged.
+*/
+bool As::PeakFit::fit(const QVector<qreal>& x,
+                      const QVector<qreal>& y,
+                      const QVector<qreal>& sy,
+                      const QVector<qreal>& start) {
+    const int n = parameterCount();
+
+    m_converged = false;
+    m_iterations = 0;
+    m_chiSquared = qQNaN();
+    m_errors.fill(qQNaN(), n);
+    m_covariance.fill(qQNaN(), n * n);
+
+    m_pointCount = qMin(x.size(), y.size());
+    if (m_pointCount <= n OR start.size() < n) {
+        return false; }
+
+    m_x = x.constData();
+    m_y = y.constData();
+    m_weights.resize(m_pointCount);
+    for (int i = 0; i < m_pointCount; ++i) {
+        const qreal s = i < sy.size() ? sy[i] : 0.;
+        m_weights[i] = s > 0. ? 1. / (s * s) : 1.; }
+
+    for (int j = 0; j < n; ++j) {
+        m_params[j] = start[j]; }
+    constrain(m_params);
+
+    qreal chiSquared = evaluate(m_params, m_alpha, m_beta);
+    qreal lambda = 1e-3;
+
+    while (m_iterations < MAX_ITERATIONS AND lambda < MAX_LAMBDA) {
+        ++m_iterations;
+
+        // Solve the damped normal equations for the parameters step
+        m_system = m_alpha;
+        for (int j = 0; j < n; ++j) {
+            m_system[j * n + j] *= 1. + lambda;
+            m_step[j] = m_beta[j]; }
+
+        if (!solve(m_system, m_step, n)) {
+            lambda *= 10.;
+            continue; }
+
+        for (int j = 0; j < n; ++j) {
+            m_trialParams[j] = m_params[j] + m_step[j]; }
+        constrain(m_trialParams);
+
+        const qreal trialChiSquared = evaluate(m_trialParams, m_trialAlpha, m_trialBeta);
+
+        if (trialChiSquared < chiSquared) {
+            const bool converged = (chiSquared - trialChiSquared) <= TOLERANCE * chiSquared;
+            chiSquared = trialChiSquared;
+            m_params.swap(m_trialParams);
+            m_alpha.swap(m_trialAlpha);
+            m_beta.swap(m_trialBeta);
+            lambda = qMax(lambda / 10., MIN_LAMBDA);
+            if (converged) {
+                m_converged = true;
+                break; } }
+
+        else {
+            lambda *= 10.;
+            // No further improvement is possible
+            if (lambda >= MAX_LAMBDA) {
+                m_converged = true; } } }
+
+    // Reduced chi-squared and the parameters standard deviations from the covariance matrix
+    m_chiSquared = chiSquared / (m_pointCount - n);
+
+    if (invert(m_alpha, m_covariance, n)) {
+        for (int j = 0; j < n; ++j) {
+            m_errors[j] = qSqrt(qAbs(m_covariance[j * n + j]) * m_chiSquared); } }
+    else {
+        m_covariance.fill(qQNaN()); }
+
+    return m_converged; }
+
+/*!
+    Returns true if the last fit is converged.
+*/
+bool As::PeakFit::isConverged() const {
+    return m_converged; }
+
+/*!
+    Returns the number of iterations of the last fit.
+*/
+int As::PeakFit::iterations() const {
+    return m_iterations; }
+
+/*!
+    Returns the reduced chi-squared of the last fit.
+*/
+qreal As::PeakFit::chiSquared() const {
+    return m_chiSquared; }
+
+/*!
+    Returns the fitted parameter \a index, or NaN if it is not used by the profile.
+*/
+qreal As::PeakFit::parameter(const As::PeakFit::Parameter index) const {
+    return index < parameterCount() ? m_params[index] : qQNaN(); }
+
+/*!
+    Returns the standard deviation of the fitted parameter \a index, or NaN if it
+    is not used by the profile.
+*/
+qreal As::PeakFit::error(const As::PeakFit::Parameter index) const {
+    return index < parameterCount() ? m_errors[index] : qQNaN(); }
+
+/*!
+    Returns the area of the fitted peak above the background.
+*/
+qreal As::PeakFit::area() const {
+    return m_params[Amplitude] * m_params[Width] * areaFactor(m_fitType, parameter(Mixing)); }
+
+/*!
+    Returns the standard deviation of the area of the fitted peak, propagated with
+    the full covariance matrix of the parameters, or NaN if the matrix of the last
+    fit can't be obtained.
+*/
+qreal As::PeakFit::areaError() const {
+    const int n = parameterCount();
+    const qreal factor = areaFactor(m_fitType, parameter(Mixing));
+
+    // Gradient of the area with respect to the parameters
+    qreal gradient[5] = { 0., m_params[Width] * factor, 0., m_params[Amplitude] * factor, 0. };
+    if (m_fitType == As::Scan::PseudoVoigtFit) {
+        gradient[Mixing] = m_params[Amplitude] * m_params[Width] * (LORENTZ_AREA - GAUSS_AREA); }
+
+    qreal variance = 0.;
+    for (int j = 0; j < n; ++j) {
+        for (int k = 0; k < n; ++k) {
+            variance += gradient[j] * m_covariance[j * n + k] * gradient[k]; } }
+
+    return qSqrt(qAbs(variance) * m_chiSquared); }
+
+/*!
+    Returns the unit height profile of the given \a type at the point \a x for the peak
+    at \a position with the full width at half maximum \a width. The Lorentzian fraction
+    \a mixing is used by the pseudo-Voigt profile only.
+*/
+qreal As::PeakFit::profile(const As::Scan::PeakFitType type,
+                           const qreal x,
+                           const qreal position,
+                           const qreal width,
+                           const qreal mixing) {
+    const qreal u = (x - position) / width;
+    const qreal gauss = qExp(-FOUR_LN2 * u * u);
+    const qreal lorentz = 1. / (1. + 4. * u * u);
+
+    switch (type) {
+        case As::Scan::GaussFit:
+            return gauss;
+        case As::Scan::LorentzFit:
+            return lorentz;
+        case As::Scan::PseudoVoigtFit:
+            return mixing * lorentz + (1. - mixing) * gauss; }
+
+    return qQNaN(); }
+
+/*!
+    Returns the area of the unit height and unit width profile of the given \a type.
+    The Lorentzian fraction \a mixing is used by the pseudo-Voigt profile only.
+*/
+qreal As::PeakFit::areaFactor(const As::Scan::PeakFitType type,
+                              const qreal mixing) {
+    switch (type) {
+        case As::Scan::GaussFit:
+            return GAUSS_AREA;
+        case As::Scan::LorentzFit:
+            return LORENTZ_AREA;
+        case As::Scan::PseudoVoigtFit:
+            return mixing * LORENTZ_AREA + (1. - mixing) * GAUSS_AREA; }
+
+    return qQNaN(); }
+
+/*!
+    Calculates the weighted sum of squared residuals for the parameters \a params and
+    fills the normal equations matrix \a alpha = J^T W J and vector \a beta = J^T W r
+    using the analytic Jacobian J. Returns the sum of squared residuals.
+*/
+qreal As::PeakFit::evaluate(const QVector<qreal>& params,
+                            QVector<qreal>& alpha,
+                            QVector<qreal>& beta) {
+    const int n = parameterCount();
+    const bool isPseudoVoigt = (m_fitType == As::Scan::PseudoVoigtFit);
+
+    const qreal background = params[Background];
+    const qreal amplitude  = params[Amplitude];
+    const qreal position   = params[Position];
+    const qreal width      = params[Width];
+    const qreal mixing     = isPseudoVoigt ? params[Mixing] : (m_fitType == As::Scan::LorentzFit ? 1. : 0.);
+
+    alpha.fill(0.);
+    beta.fill(0.);
+    qreal* d = m_derivatives.data();
+    qreal chiSquared = 0.;
+
+    for (int i = 0; i < m_pointCount; ++i) {
+        const qreal u = (m_x[i] - position) / width;
+        const qreal u2 = u * u;
+        const qreal gauss = qExp(-FOUR_LN2 * u2);
+        const qreal lorentz = 1. / (1. + 4. * u2);
+        const qreal p = mixing * lorentz + (1. - mixing) * gauss;
+
+        // Derivatives of the profile with respect to the position and width
+        const qreal dGauss   = 2. * FOUR_LN2 * gauss / width;
+        const qreal dLorentz = 8. * lorentz * lorentz / width;
+        const qreal dPosition = mixing * dLorentz * u + (1. - mixing) * dGauss * u;
+        const qreal dWidth    = mixing * dLorentz * u2 + (1. - mixing) * dGauss * u2;
+
+        d[Background] = 1.;
+        d[Amplitude]  = p;
+        d[Position]   = amplitude * dPosition;
+        d[Width]      = amplitude * dWidth;
+        if (isPseudoVoigt) {
+            d[Mixing] = amplitude * (lorentz - gauss); }
+
+        const qreal residual = m_y[i] - background - amplitude * p;
+        const qreal w = m_weights[i];
+        chiSquared += w * residual * residual;
+
+        for (int j = 0; j < n; ++j) {
+            const qreal wd = w * d[j];
+            beta[j] += wd * residual;
+            for (int k = 0; k <= j; ++k) {
+                alpha[j * n + k] += wd * d[k]; } } }
+
+    // Fill the upper triangle of the symmetric matrix
+    for (int j = 0; j < n; ++j) {
+        for (int k = j + 1; k < n; ++k) {
+            alpha[j * n + k] = alpha[k * n + j]; } }
+
+    return chiSquared; }
+
+/*!
+    Keeps the parameters \a params in their physical range: the width is positive and
+    the Lorentzian fraction is between 0 and 1.
+*/
+void As::PeakFit::constrain(QVector<qreal>& params) const {
+    params[Width] = qMax(qAbs(params[Width]), 1e-6);
+    if (m_fitType == As::Scan::PseudoVoigtFit) {
+        params[Mixing] = qBound(0., params[Mixing], 1.); } }
+
+/*!
+    Solves the linear system \a a x = \a b of size \a n by the Gaussian elimination with
+    partial pivoting. Both \a a and \a b are overwritten, the solution is returned in
+    \a b. Returns false if the matrix is singular.
+*/
+bool As::PeakFit::solve(QVector<qreal>& a,
+                        QVector<qreal>& b,
+                        const int n) {
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < n; ++row) {
+            if (qAbs(a[row * n + col]) > qAbs(a[pivot * n + col])) {
+                pivot = row; } }
+
+        if (a[pivot * n + col] == 0. OR !qIsFinite(a[pivot * n + col])) {
+            return false; }
+
+        if (pivot != col) {
+            for (int k = 0; k < n; ++k) {
+                qSwap(a[col * n + k], a[pivot * n + k]); }
+            qSwap(b[col], b[pivot]); }
+
+        for (int row = col + 1; row < n; ++row) {
+            const qreal factor = a[row * n + col] / a[col * n + col];
+            for (int k = col; k < n; ++k) {
+                a[row * n + k] -= factor * a[col * n + k]; }
+            b[row] -= factor * b[col]; } }
+
+    for (int row = n - 1; row >= 0; --row) {
+        qreal sum = b[row];
+        for (int k = row + 1; k < n; ++k) {
+            sum -= a[row * n + k] * b[k]; }
+        b[row] = sum / a[row * n + row]; }
+
+    return true; }
+
+/*!
+    Calculates the \a inverse of the matrix \a a of size \a n column by column.
+    Returns false if the matrix is singular.
+*/
+bool As::PeakFit::invert(const QVector<qreal>& a,
+                         QVector<qreal>& inverse,
+                         const int n) {
+    for (int j = 0; j < n; ++j) {
+        m_system = a;
+        m_step.fill(0.);
+        m_step[j] = 1.;
+        if (!solve(m_system, m_step, n)) {
+            return false; }
+        for (int k = 0; k < n; ++k) {
+            inverse[k * n + j] = m_step[k]; } }
+
+    return true; }
+
@@ -0,0 +1,111 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef AS_DIFFRACTION_PEAKFIT_HPP
+#define AS_DIFFRACTION_PEAKFIT_HPP
+
+#include <QVector>
+
+#include "Scan.hpp"
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class PeakFit {
+
+  public:
+    enum Parameter { Background, Amplitude, Position, Width, Mixing };
+
+    static const int MAX_ITERATIONS;
+    static const qreal TOLERANCE;
+
+    PeakFit();
+    ~PeakFit();
+
+    void setFitType(const As::Scan::PeakFitType type);
+    As::Scan::PeakFitType fitType() const;
+
+    int parameterCount() const;
+
+    bool fit(const QVector<qreal>& x,
+             const QVector<qreal>& y,
+             const QVector<qreal>& sy,
+             const QVector<qreal>& start);
+
+    bool isConverged() const;
+    int iterations() const;
+    qreal chiSquared() const;
+    qreal parameter(const As::PeakFit::Parameter index) const;
+    qreal error(const As::PeakFit::Parameter index) const;
+    qreal area() const;
+    qreal areaError() const;
+
+    static qreal profile(const As::Scan::PeakFitType type,
+                         const qreal x,
+                         const qreal position,
+                         const qreal width,
+                         const qreal mixing = 0.5);
+    static qreal areaFactor(const As::Scan::PeakFitType type,
+                            const qreal mixing = 0.5);
+
+  private:
+    qreal evaluate(const QVector<qreal>& params,
+                   QVector<qreal>& alpha,
+                   QVector<qreal>& beta);
+    void constrain(QVector<qreal>& params) const;
+    static bool solve(QVector<qreal>& a,
+                      QVector<qreal>& b,
+                      const int n);
+    bool invert(const QVector<qreal>& a,
+                QVector<qreal>& inverse,
+                const int n);
+
+    As::Scan::PeakFitType m_fitType = As::Scan::GaussFit;
+
+    // Measured data
+    const qreal* m_x = Q_NULLPTR;
+    const qreal* m_y = Q_NULLPTR;
+    QVector<qreal> m_weights;
+    int m_pointCount = 0;
+
+    // Workspace, allocated once and reused for every fit
+    QVector<qreal> m_derivatives;
+    QVector<qreal> m_params;
+    QVector<qreal> m_trialParams;
+    QVector<qreal> m_alpha;
+    QVector<qreal> m_trialAlpha;
+    QVector<qreal> m_beta;
+    QVector<qreal> m_trialBeta;
+    QVector<qreal> m_system;
+    QVector<qreal> m_step;
+    QVector<qreal> m_covariance;
+
+    // Results
+    bool m_converged = false;
+    int m_iterations = 0;
+    qreal m_chiSquared = qQNaN();
+    QVector<qreal> m_errors;
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_PEAKFIT_HPP
+
@@ -0,0 +1,225 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtMath>
+
+#include <algorithm>
+
+#include "Macros.hpp"
+
+#include "ReflectionMerger.hpp"
+
+#include "ReflectionIndex.hpp"
+
+/*!
+    \class As::ReflectionIndex
+
+    \brief The ReflectionIndex is a class that finds the scans of the given reflection.
+
+    Every item, i.e. the scan, with the integer Miller indices (within the tolerance
+    of As::ReflectionMerger) is added to the hash by its indices rounded to the
+    nearest integers, so that all the scans of the reflection are found in the
+    constant time. The items with the non-integer indices, e.g. the satellites, are
+    not hashed and can be found by nearest() only. The repeated measurements of the same reflection are given by
+    duplicates().
+
+    If the reciprocal space coordinates of the items are known, they are kept in the
+    k-d tree as well, and the item nearest to the given point within the tolerance is
+    found by nearest(). This allows to look for the non-integer indices too.
+
+    \inmodule Diffraction
+*/
+
+/*!
+    \variable As::ReflectionIndex::DEFAULT_TOLERANCE
+
+    Default search radius in the reciprocal space, in the inverse angstroms.
+*/
+const qreal As::ReflectionIndex::DEFAULT_TOLERANCE = 0.05;
+
+/*!
+    Removes all the items from the index.
+*/
+void As::ReflectionIndex::clear() {
+    m_size = 0;
+    m_groups.clear();
+    m_groupStarts.clear();
+    m_groupItems.clear();
+    m_coordinates.clear();
+    m_tree.clear(); }
+
+/*!
+    Returns true if the index contains no items.
+*/
+bool As::ReflectionIndex::isEmpty() const {
+    return m_size == 0; }
+
+/*!
+    Returns the number of the items in the index.
+*/
+int As::ReflectionIndex::size() const {
+    return m_size; }
+
+/*!
+    Returns true if the reciprocal space coordinates of the items are known, i.e.
+    nearest() can be used.
+*/
+bool As::ReflectionIndex::hasReciprocalCoordinates() const {
+    return !m_tree.isEmpty(); }
+
+/*!
+    Builds the index of the items with the given Miller \a indices and, if given,
+    reciprocal space \a coordinates. The items with the unknown or non-integer indices
+    are not hashed, the items with the unknown coordinates are not put in the tree.
+*/
+void As::ReflectionIndex::build(const QVector<As::ReflectionIndex::Point>& indices,
+                                const QVector<As::ReflectionIndex::Point>& coordinates) {
+    clear();
+    m_size = indices.size();
+
+    // Group the items by their rounded indices
+    QVector<int> groupOf(m_size, -1);
+    QVector<int> counts;
+    for (int i = 0; i < m_size; ++i) {
+        const Point& hkl = indices.at(i);
+        int h, k, l;
+        if (!As::ReflectionMerger::integerIndices(hkl[0], hkl[1], hkl[2], h, k, l)) {
+            continue; }
+        const quint64 key = As::ReflectionMerger::packIndices(h, k, l);
+        auto it = m_groups.constFind(key);
+        if (it == m_groups.constEnd()) {
+            it = m_groups.insert(key, counts.size());
+            counts << 0; }
+        groupOf[i] = it.value();
+        ++counts[it.value()]; }
+
+    m_groupStarts.fill(0, counts.size() + 1);
+    for (int group = 0; group < counts.size(); ++group) {
+        m_groupStarts[group + 1] = m_groupStarts.at(group) + counts.at(group); }
+    m_groupItems.resize(m_groupStarts.last());
+    QVector<int> groupEnds = m_groupStarts;
+    for (int i = 0; i < m_size; ++i) {
+        if (groupOf.at(i) >= 0) {
+            m_groupItems[groupEnds[groupOf.at(i)]++] = i; } }
+
+    // Put the items with the known coordinates into the k-d tree
+    if (coordinates.size() == m_size) {
+        m_coordinates = coordinates;
+        for (int i = 0; i < m_size; ++i) {
+            const Point& xyz = coordinates.at(i);
+            if (qIsFinite(xyz[0]) AND qIsFinite(xyz[1]) AND qIsFinite(xyz[2])) {
+                m_tree << i; } }
+        buildTree(0, m_tree.size(), 0); } }
+
+/*!
+    Returns all the items with the Miller indices \a h, \a k and \a l in the order
+    of their addition.
+*/
+QVector<int> As::ReflectionIndex::find(const int h,
+                                       const int k,
+                                       const int l) const {
+    const quint64 key = As::ReflectionMerger::packIndices(h, k, l);
+    if (key == As::ReflectionMerger::INVALID_KEY) {
+        return QVector<int>(); }
+    const auto it = m_groups.constFind(key);
+    if (it == m_groups.constEnd()) {
+        return QVector<int>(); }
+    const int begin = m_groupStarts.at(it.value());
+    const int end = m_groupStarts.at(it.value() + 1);
+    return m_groupItems.mid(begin, end - begin); }
+
+/*!
+    Returns the item nearest to the reciprocal space point \a coordinates, if it is
+    closer than \a tolerance, otherwise -1.
+*/
+int As::ReflectionIndex::nearest(const As::ReflectionIndex::Point& coordinates,
+                                 const qreal tolerance) const {
+    int best = -1;
+    qreal bestDistance2 = tolerance * tolerance;
+    searchTree(0, m_tree.size(), 0, coordinates, best, bestDistance2);
+    return best; }
+
+/*!
+    Returns the groups of the items measured more than once, i.e. with the same
+    rounded Miller indices, in the order of their first items.
+*/
+QVector<QVector<int>> As::ReflectionIndex::duplicates() const {
+    QVector<QVector<int>> groups;
+    for (int group = 0; group < m_groupStarts.size() - 1; ++group) {
+        const int begin = m_groupStarts.at(group);
+        const int end = m_groupStarts.at(group + 1);
+        if (end - begin > 1) {
+            groups << m_groupItems.mid(begin, end - begin); } }
+    return groups; }
+
+/*!
+    Orders the items of the k-d tree range from \a begin to \a end, so that its median
+    splits the range by the coordinate \a depth modulo 3.
+*/
+void As::ReflectionIndex::buildTree(const int begin,
+                                    const int end,
+                                    const int depth) {
+    if (end - begin < 2) {
+        return; }
+
+    const int middle = (begin + end) / 2;
+    const int axis = depth % 3;
+    std::nth_element(m_tree.begin() + begin, m_tree.begin() + middle, m_tree.begin() + end,
+                     [this, axis](const int a, const int b) {
+                         return m_coordinates.at(a)[axis] < m_coordinates.at(b)[axis]; });
+
+    buildTree(begin, middle, depth + 1);
+    buildTree(middle + 1, end, depth + 1); }
+
+/*!
+    Looks for the item nearest to the \a point in the k-d tree range from \a begin to
+    \a end. The \a best item and its squared distance \a bestDistance2 are updated.
+*/
+void As::ReflectionIndex::searchTree(const int begin,
+                                     const int end,
+                                     const int depth,
+                                     const As::ReflectionIndex::Point& point,
+                                     int& best,
+                                     qreal& bestDistance2) const {
+    if (begin >= end) {
+        return; }
+
+    const int middle = (begin + end) / 2;
+    const int item = m_tree.at(middle);
+    const Point& node = m_coordinates.at(item);
+
+    const qreal distance2 = (point[0] - node[0]) * (point[0] - node[0]) +
+                            (point[1] - node[1]) * (point[1] - node[1]) +
+                            (point[2] - node[2]) * (point[2] - node[2]);
+    if (distance2 < bestDistance2) {
+        bestDistance2 = distance2;
+        best = item; }
+
+    // The near side first, then the far one only if it can be closer
+    const int axis = depth % 3;
+    const qreal difference = point[axis] - node[axis];
+    if (difference < 0) {
+        searchTree(begin, middle, depth + 1, point, best, bestDistance2);
+        if (difference * difference < bestDistance2) {
+            searchTree(middle + 1, end, depth + 1, point, best, bestDistance2); } }
+    else {
+        searchTree(middle + 1, end, depth + 1, point, best, bestDistance2);
+        if (difference * difference < bestDistance2) {
+            searchTree(begin, middle, depth + 1, point, best, bestDistance2); } } }
@@ -0,0 +1,75 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_DIFFRACTION_REFLECTIONINDEX_HPP
+#define AS_DIFFRACTION_REFLECTIONINDEX_HPP
+
+#include <QHash>
+#include <QVector>
+
+#include <array>
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ReflectionIndex {
+
+  public:
+    using Point = std::array<qreal, 3>;
+
+    static const qreal DEFAULT_TOLERANCE;
+
+    void clear();
+    bool isEmpty() const;
+    int size() const;
+    bool hasReciprocalCoordinates() const;
+
+    void build(const QVector<As::ReflectionIndex::Point>& indices,
+               const QVector<As::ReflectionIndex::Point>& coordinates = QVector<As::ReflectionIndex::Point>());
+
+    QVector<int> find(const int h,
+                      const int k,
+                      const int l) const;
+    int nearest(const As::ReflectionIndex::Point& coordinates,
+                const qreal tolerance) const;
+    QVector<QVector<int>> duplicates() const;
+
+  private:
+    void buildTree(const int begin,
+                   const int end,
+                   const int depth);
+    void searchTree(const int begin,
+                    const int end,
+                    const int depth,
+                    const As::ReflectionIndex::Point& point,
+                    int& best,
+                    qreal& bestDistance2) const;
+
+    int m_size = 0;
+    QHash<quint64, int> m_groups;   // Group of the items by their rounded Miller indices
+    QVector<int> m_groupStarts;     // Range of every group in m_groupItems
+    QVector<int> m_groupItems;      // Items sorted by their groups
+    QVector<Point> m_coordinates;   // Reciprocal space coordinates of every item
+    QVector<int> m_tree;            // k-d tree: items ordered so, that the median of every range is its node
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_REFLECTIONINDEX_HPP
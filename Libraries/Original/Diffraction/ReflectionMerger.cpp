@@ -0,0 +1,490 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QHash>
+#include <QMap>
+#include <QtMath>
+
+#include <algorithm>
+#include <numeric>
+
+#include "Macros.hpp"
+#include "Profiler.hpp"
+
+#include "ConcurrentWatcher.hpp"
+#include "ResultTable.hpp"
+#include "ScanDict.hpp"
+
+#include "ReflectionMerger.hpp"
+
+/*!
+    \class As::ReflectionMerger
+
+    \brief The ReflectionMerger is a class that merges the symmetry-equivalent
+    reflections of the output table and averages their structure factors.
+
+    The group is given either by the Laue class, which includes the Friedel pairs, or
+    by its rotational point group, which keeps them separate. Hexagonal and trigonal
+    groups use the hexagonal axes, the monoclinic ones have the unique axis b.
+
+    Every observation is mapped to the canonical representative of its equivalent
+    reflections, the one with the largest (h, k, l) in the lexicographic order, and
+    the unique reflections are found by the hash of the canonical indices. Each beam
+    type, i.e. the unpolarised and both polarised ones, is merged separately: the
+    structure factors are averaged with the 1/σ² weights, and the internal R-factor
+    and the reduced χ² of the equivalent observations are given for every unique
+    reflection and for the whole table. The observations with the non-integer
+    Miller indices, e.g. the satellites, are skipped.
+
+    \inmodule Diffraction
+*/
+
+namespace {
+
+using Operation = std::array<int, 9>;
+
+const qint64 INDEX_OFFSET = 1 << 20;
+const qreal INTEGER_TOLERANCE = 0.1;
+
+// Generators of the rotational point group and whether the inversion is added to get the Laue class
+struct GroupGenerators {
+    QVector<Operation> rotations;
+    bool inversion; };
+
+const Operation IDENTITY      = {{  1,  0,  0,   0,  1,  0,   0,  0,  1 }};
+const Operation INVERSION     = {{ -1,  0,  0,   0, -1,  0,   0,  0, -1 }};
+const Operation TWOFOLD_X     = {{  1,  0,  0,   0, -1,  0,   0,  0, -1 }};
+const Operation TWOFOLD_Y     = {{ -1,  0,  0,   0,  1,  0,   0,  0, -1 }};
+const Operation TWOFOLD_Z     = {{ -1,  0,  0,   0, -1,  0,   0,  0,  1 }};
+const Operation FOURFOLD_Z    = {{  0, -1,  0,   1,  0,  0,   0,  0,  1 }}; // (-k, h, l)
+const Operation THREEFOLD_Z   = {{  0,  1,  0,  -1, -1,  0,   0,  0,  1 }}; // (k, -h-k, l)
+const Operation SIXFOLD_Z     = {{  1,  1,  0,  -1,  0,  0,   0,  0,  1 }}; // (h+k, -h, l)
+const Operation TWOFOLD_321   = {{  0,  1,  0,   1,  0,  0,   0,  0, -1 }}; // (k, h, -l)
+const Operation TWOFOLD_312   = {{  0, -1,  0,  -1,  0,  0,   0,  0, -1 }}; // (-k, -h, -l)
+const Operation THREEFOLD_111 = {{  0,  0,  1,   1,  0,  0,   0,  1,  0 }}; // (l, h, k)
+
+// The Laue classes followed by their rotational point groups
+const QMap<QString, GroupGenerators>& Groups() {
+    static const QMap<QString, GroupGenerators> groups = {
+        { "-1",    { {}, true } },
+        { "2/m",   { { TWOFOLD_Y }, true } },
+        { "mmm",   { { TWOFOLD_Z, TWOFOLD_X }, true } },
+        { "4/m",   { { FOURFOLD_Z }, true } },
+        { "4/mmm", { { FOURFOLD_Z, TWOFOLD_X }, true } },
+        { "-3",    { { THREEFOLD_Z }, true } },
+        { "-3m1",  { { THREEFOLD_Z, TWOFOLD_321 }, true } },
+        { "-31m",  { { THREEFOLD_Z, TWOFOLD_312 }, true } },
+        { "6/m",   { { SIXFOLD_Z }, true } },
+        { "6/mmm", { { SIXFOLD_Z, TWOFOLD_321 }, true } },
+        { "m-3",   { { TWOFOLD_Z, TWOFOLD_X, THREEFOLD_111 }, true } },
+        { "m-3m",  { { FOURFOLD_Z, THREEFOLD_111 }, true } },
+        { "1",     { {}, false } },
+        { "2",     { { TWOFOLD_Y }, false } },
+        { "222",   { { TWOFOLD_Z, TWOFOLD_X }, false } },
+        { "4",     { { FOURFOLD_Z }, false } },
+        { "422",   { { FOURFOLD_Z, TWOFOLD_X }, false } },
+        { "3",     { { THREEFOLD_Z }, false } },
+        { "321",   { { THREEFOLD_Z, TWOFOLD_321 }, false } },
+        { "312",   { { THREEFOLD_Z, TWOFOLD_312 }, false } },
+        { "6",     { { SIXFOLD_Z }, false } },
+        { "622",   { { SIXFOLD_Z, TWOFOLD_321 }, false } },
+        { "23",    { { TWOFOLD_Z, TWOFOLD_X, THREEFOLD_111 }, false } },
+        { "432",   { { FOURFOLD_Z, THREEFOLD_111 }, false } } };
+    return groups; }
+
+// Product of the two operations
+Operation Multiply(const Operation& a,
+                   const Operation& b) {
+    Operation product;
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            product[3 * row + column] = a[3 * row] * b[column] +
+                                        a[3 * row + 1] * b[3 + column] +
+                                        a[3 * row + 2] * b[6 + column]; } }
+    return product; }
+
+// Returns the integer index, or false if the value is not close to an integer
+bool ToInteger(const qreal value,
+               int& index) {
+    if (!qIsFinite(value) OR qAbs(value) >= INDEX_OFFSET OR qAbs(value - qRound(value)) > INTEGER_TOLERANCE) {
+        return false; }
+    index = qRound(value);
+    return true; }
+
+}
+
+/*!
+    \variable As::ReflectionMerger::INVALID_KEY
+
+    Key of the observation, which cannot be merged.
+*/
+const quint64 As::ReflectionMerger::INVALID_KEY = ~quint64(0);
+
+/*!
+    Constructs the merger with the triclinic Laue class -1.
+*/
+As::ReflectionMerger::ReflectionMerger() {
+    setGroup("-1"); }
+
+/*!
+    Returns the names of the supported groups: the Laue classes first, then the
+    rotational point groups.
+*/
+QStringList As::ReflectionMerger::groupNames() {
+    return { "-1", "2/m", "mmm", "4/m", "4/mmm", "-3", "-3m1", "-31m", "6/m", "6/mmm", "m-3", "m-3m",
+             "1", "2", "222", "4", "422", "3", "321", "312", "6", "622", "23", "432" }; }
+
+/*!
+    Sets the Laue class or the rotational point group \a name and generates all its
+    operations. Returns false if the group is unknown.
+*/
+bool As::ReflectionMerger::setGroup(const QString& name) {
+    const auto it = Groups().constFind(name);
+    if (it == Groups().constEnd()) {
+        return false; }
+
+    QVector<Operation> generators = it.value().rotations;
+    if (it.value().inversion) {
+        generators << INVERSION; }
+
+    // Close the group by multiplying its elements by the generators
+    m_operations = { IDENTITY };
+    for (int i = 0; i < m_operations.size(); ++i) {
+        for (const Operation& generator : generators) {
+            const Operation product = Multiply(m_operations.at(i), generator);
+            if (!m_operations.contains(product)) {
+                m_operations << product; } } }
+
+    m_group = name;
+    return true; }
+
+/*!
+    Returns the name of the current group.
+*/
+const QString& As::ReflectionMerger::group() const {
+    return m_group; }
+
+/*!
+    Returns the number of the operations of the current group, i.e. its order.
+*/
+int As::ReflectionMerger::operationCount() const {
+    return m_operations.size(); }
+
+/*!
+    Replaces the Miller indices \a h, \a k and \a l by the canonical representative
+    of their symmetry-equivalent reflections.
+*/
+void As::ReflectionMerger::canonicalIndices(int& h,
+                                            int& k,
+                                            int& l) const {
+    const int h0 = h;
+    const int k0 = k;
+    const int l0 = l;
+    for (const Operation& o : m_operations) {
+        const int h1 = o[0] * h0 + o[1] * k0 + o[2] * l0;
+        const int k1 = o[3] * h0 + o[4] * k0 + o[5] * l0;
+        const int l1 = o[6] * h0 + o[7] * k0 + o[8] * l0;
+        if (h1 > h OR (h1 == h AND (k1 > k OR (k1 == k AND l1 > l)))) {
+            h = h1;
+            k = k1;
+            l = l1; } } }
+
+/*!
+    Returns the hash key of the canonical representative of the measured Miller
+    indices \a h, \a k and \a l, or INVALID_KEY if they are not integer.
+*/
+quint64 As::ReflectionMerger::canonicalKey(const qreal h,
+                                           const qreal k,
+                                           const qreal l) const {
+    int hi, ki, li;
+    if (!integerIndices(h, k, l, hi, ki, li)) {
+        return INVALID_KEY; }
+    canonicalIndices(hi, ki, li);
+    return packIndices(hi, ki, li); }
+
+/*!
+    Gets the integer Miller indices \a hi, \a ki and \a li nearest to \a h, \a k
+    and \a l. Returns false if any of the indices is not within the tolerance of an
+    integer, e.g. of a satellite reflection, or cannot be packed by packIndices().
+*/
+bool As::ReflectionMerger::integerIndices(const qreal h,
+                                          const qreal k,
+                                          const qreal l,
+                                          int& hi,
+                                          int& ki,
+                                          int& li) {
+    return ToInteger(h, hi) AND ToInteger(k, ki) AND ToInteger(l, li); }
+
+/*!
+    Returns the integer Miller indices \a h, \a k and \a l packed into a single key.
+    The keys are ordered as the indices in the lexicographic order. Returns
+    INVALID_KEY if any of the indices does not fit into its 21 bits.
+*/
+quint64 As::ReflectionMerger::packIndices(const int h,
+                                          const int k,
+                                          const int l) {
+    if (qAbs(qint64(h)) >= INDEX_OFFSET OR qAbs(qint64(k)) >= INDEX_OFFSET OR qAbs(qint64(l)) >= INDEX_OFFSET) {
+        return INVALID_KEY; }
+    return (quint64(h + INDEX_OFFSET) << 42) | (quint64(k + INDEX_OFFSET) << 21) | quint64(l + INDEX_OFFSET); }
+
+/*!
+    Gets the Miller indices \a h, \a k and \a l from the \a key given by packIndices().
+*/
+void As::ReflectionMerger::unpackIndices(const quint64 key,
+                                         int& h,
+                                         int& k,
+                                         int& l) {
+    const quint64 mask = (quint64(1) << 21) - 1;
+    h = static_cast<int>(static_cast<qint64>((key >> 42) & mask) - INDEX_OFFSET);
+    k = static_cast<int>(static_cast<qint64>((key >> 21) & mask) - INDEX_OFFSET);
+    l = static_cast<int>(static_cast<qint64>(key & mask) - INDEX_OFFSET); }
+
+/*!
+    Merges the given \a rows of the output \a table into the \a merged table, one
+    row per unique reflection sorted by the canonical indices. The structure factors
+    "Sf2" of every beam type are replaced by their weighted means, followed by the
+    number of the merged observations, the internal R-factor and the reduced χ².
+    Returns false if the table has no Miller indices or structure factors.
+*/
+bool As::ReflectionMerger::merge(const As::ResultTable& table,
+                                 const QVector<int>& rows,
+                                 As::ResultTable& merged) {
+    ADEBUG << m_group << rows.size();
+
+    As::ProfilerStage profilerStage("merge");
+
+    merged.clear();
+    m_statistics.clear();
+    m_skippedCount = 0;
+
+    const int hColumn = table.columnIndex("H");
+    const int kColumn = table.columnIndex("K");
+    const int lColumn = table.columnIndex("L");
+    if (hColumn < 0 OR kColumn < 0 OR lColumn < 0 OR
+        table.columnType(hColumn) != As::ResultTable::RealColumn OR
+        table.columnType(kColumn) != As::ResultTable::RealColumn OR
+        table.columnType(lColumn) != As::ResultTable::RealColumn) {
+        return false; }
+
+    QStringList beamTypes;
+    for (const QString& beamType : As::ScanDict::BEAM_TYPES.values()) {
+        if (table.columnIndex("Sf2" + beamType) >= 0 AND table.columnIndex("Sf2Err" + beamType) >= 0) {
+            beamTypes << beamType; } }
+    if (beamTypes.isEmpty()) {
+        return false; }
+
+    const int observationCount = rows.size();
+    QVector<int> sequence(observationCount);
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    // Canonical indices of every observation
+    const QVector<qreal>& hs = table.realColumn(hColumn);
+    const QVector<qreal>& ks = table.realColumn(kColumn);
+    const QVector<qreal>& ls = table.realColumn(lColumn);
+    QVector<quint64> keys(observationCount);
+    quint64* keysData = keys.data();
+    As::ConcurrentWatcher::blockingMap(sequence, [&](const int i) {
+        const int row = rows.at(i);
+        keysData[i] = canonicalKey(hs.at(row), ks.at(row), ls.at(row)); });
+
+    // Unique reflections, found by the hash of their canonical indices
+    QHash<quint64, int> uniqueIndices;
+    uniqueIndices.reserve(observationCount);
+    QVector<quint64> uniqueKeys;
+    QVector<int> uniqueOf(observationCount, -1);
+    for (int i = 0; i < observationCount; ++i) {
+        if (keys.at(i) == INVALID_KEY) {
+            ++m_skippedCount;
+            continue; }
+        auto it = uniqueIndices.constFind(keys.at(i));
+        if (it == uniqueIndices.constEnd()) {
+            it = uniqueIndices.insert(keys.at(i), uniqueKeys.size());
+            uniqueKeys << keys.at(i); }
+        uniqueOf[i] = it.value(); }
+
+    // Sort the unique reflections by their indices
+    const int uniqueCount = uniqueKeys.size();
+    QVector<int> order(uniqueCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&uniqueKeys](const int a, const int b) {
+        return uniqueKeys.at(a) < uniqueKeys.at(b); });
+    QVector<int> rankOf(uniqueCount);
+    for (int rank = 0; rank < uniqueCount; ++rank) {
+        rankOf[order.at(rank)] = rank; }
+
+    // Observations grouped by their unique reflections, in the original order within the group
+    QVector<int> groupStart(uniqueCount + 1, 0);
+    for (int i = 0; i < observationCount; ++i) {
+        if (uniqueOf.at(i) >= 0) {
+            ++groupStart[rankOf.at(uniqueOf.at(i)) + 1]; } }
+    std::partial_sum(groupStart.begin(), groupStart.end(), groupStart.begin());
+    QVector<int> groupRows(groupStart.last());
+    QVector<int> groupEnd = groupStart;
+    for (int i = 0; i < observationCount; ++i) {
+        if (uniqueOf.at(i) >= 0) {
+            groupRows[groupEnd[rankOf.at(uniqueOf.at(i))]++] = rows.at(i); } }
+
+    // Unique reflections
+    merged.setRowCount(uniqueCount);
+    QVector<qreal> scanColumn(uniqueCount);
+    QVector<qreal> hColumnMerged(uniqueCount);
+    QVector<qreal> kColumnMerged(uniqueCount);
+    QVector<qreal> lColumnMerged(uniqueCount);
+    for (int rank = 0; rank < uniqueCount; ++rank) {
+        int h, k, l;
+        unpackIndices(uniqueKeys.at(order.at(rank)), h, k, l);
+        scanColumn[rank] = rank + 1;
+        hColumnMerged[rank] = h;
+        kColumnMerged[rank] = k;
+        lColumnMerged[rank] = l; }
+    merged.appendColumn("Scan", "i", scanColumn);
+    merged.appendColumn("H", "i", hColumnMerged);
+    merged.appendColumn("K", "i", kColumnMerged);
+    merged.appendColumn("L", "i", lColumnMerged);
+
+    // Weighted means and agreement of the equivalent observations of every beam type
+    sequence.resize(uniqueCount);
+    std::iota(sequence.begin(), sequence.end(), 0);
+
+    for (const QString& beamType : beamTypes) {
+        const int valueColumn = table.columnIndex("Sf2" + beamType);
+        const int errorColumn = table.columnIndex("Sf2Err" + beamType);
+        const QVector<qreal>& values = table.realColumn(valueColumn);
+        const QVector<qreal>& errors = table.realColumn(errorColumn);
+
+        QVector<qreal> means(uniqueCount, qQNaN());
+        QVector<qreal> meanErrors(uniqueCount, qQNaN());
+        QVector<qreal> multiplicities(uniqueCount, 0);
+        QVector<qreal> rInts(uniqueCount, qQNaN());
+        QVector<qreal> chi2s(uniqueCount, qQNaN());
+        QVector<qreal> deviationSums(uniqueCount, 0);
+        QVector<qreal> intensitySums(uniqueCount, 0);
+        QVector<qreal> chi2Sums(uniqueCount, 0);
+        QVector<qreal> degreesOfFreedom(uniqueCount, 0);
+
+        // Every unique reflection is written by its own worker only
+        qreal* meansData = means.data();
+        qreal* meanErrorsData = meanErrors.data();
+        qreal* multiplicitiesData = multiplicities.data();
+        qreal* rIntsData = rInts.data();
+        qreal* chi2sData = chi2s.data();
+        qreal* deviationSumsData = deviationSums.data();
+        qreal* intensitySumsData = intensitySums.data();
+        qreal* chi2SumsData = chi2Sums.data();
+        qreal* degreesOfFreedomData = degreesOfFreedom.data();
+
+        As::ConcurrentWatcher::blockingMap(sequence, [&](const int u) {
+            int count = 0;
+            bool isWeighted = true;
+            qreal weightSum = 0;
+            qreal weightedSum = 0;
+            for (int i = groupStart.at(u); i < groupStart.at(u + 1); ++i) {
+                const qreal value = values.at(groupRows.at(i));
+                const qreal error = errors.at(groupRows.at(i));
+                if (!qIsFinite(value)) {
+                    continue; }
+                ++count;
+                isWeighted = isWeighted AND qIsFinite(error) AND error > 0;
+                const qreal weight = isWeighted ? 1 / (error * error) : 1;
+                weightSum += weight;
+                weightedSum += weight * value; }
+
+            multiplicitiesData[u] = count;
+            if (count == 0) {
+                return; }
+
+            // Unit weights, if any of the errors is unknown
+            if (!isWeighted) {
+                weightSum = 0;
+                weightedSum = 0;
+                for (int i = groupStart.at(u); i < groupStart.at(u + 1); ++i) {
+                    const qreal value = values.at(groupRows.at(i));
+                    if (qIsFinite(value)) {
+                        weightSum += 1;
+                        weightedSum += value; } } }
+
+            const qreal mean = weightedSum / weightSum;
+            meansData[u] = mean;
+
+            qreal deviationSum = 0;
+            qreal squaredDeviationSum = 0;
+            qreal intensitySum = 0;
+            qreal chi2Sum = 0;
+            for (int i = groupStart.at(u); i < groupStart.at(u + 1); ++i) {
+                const qreal value = values.at(groupRows.at(i));
+                const qreal error = errors.at(groupRows.at(i));
+                if (!qIsFinite(value)) {
+                    continue; }
+                deviationSum += qAbs(value - mean);
+                squaredDeviationSum += (value - mean) * (value - mean);
+                intensitySum += qAbs(value);
+                chi2Sum += isWeighted ? (value - mean) * (value - mean) / (error * error) : 0; }
+
+            if (count == 1) {
+                meanErrorsData[u] = isWeighted ? 1 / qSqrt(weightSum) : qQNaN();
+                return; }
+
+            meanErrorsData[u] = isWeighted ? 1 / qSqrt(weightSum) :
+                                             qSqrt(squaredDeviationSum / (count * (count - 1)));
+            rIntsData[u] = intensitySum > 0 ? deviationSum / intensitySum : qQNaN();
+            deviationSumsData[u] = deviationSum;
+            intensitySumsData[u] = intensitySum;
+            if (isWeighted) {
+                chi2sData[u] = chi2Sum / (count - 1);
+                chi2SumsData[u] = chi2Sum;
+                degreesOfFreedomData[u] = count - 1; } });
+
+        const QString valueFormat = As::ScanDict::Properties["calculations"]["Sf2" + beamType]["format"];
+        const QString errorFormat = As::ScanDict::Properties["calculations"]["Sf2Err" + beamType]["format"];
+        merged.appendColumn("Sf2" + beamType, valueFormat, means);
+        merged.appendColumn("Sf2Err" + beamType, errorFormat, meanErrors);
+        merged.appendColumn("Multiplicity" + beamType, "i", multiplicities);
+        merged.appendColumn("Rint" + beamType, "0.4f", rInts);
+        merged.appendColumn("Chi2" + beamType, "0.2f", chi2s);
+
+        // Statistics of the whole table
+        Statistics statistics;
+        statistics.beamType = beamType;
+        const qreal intensitySum = std::accumulate(intensitySums.constBegin(), intensitySums.constEnd(), 0.);
+        const qreal degreeSum = std::accumulate(degreesOfFreedom.constBegin(), degreesOfFreedom.constEnd(), 0.);
+        statistics.observationCount = qRound(std::accumulate(multiplicities.constBegin(), multiplicities.constEnd(), 0.));
+        statistics.uniqueCount = static_cast<int>(std::count_if(multiplicities.constBegin(), multiplicities.constEnd(),
+                                                                [](const qreal count) { return count > 0; }));
+        statistics.rInt = intensitySum > 0 ? std::accumulate(deviationSums.constBegin(), deviationSums.constEnd(), 0.) / intensitySum : qQNaN();
+        statistics.chi2 = degreeSum > 0 ? std::accumulate(chi2Sums.constBegin(), chi2Sums.constEnd(), 0.) / degreeSum : qQNaN();
+        m_statistics << statistics; }
+
+    As::Profiler::instance().addCounter("merge", "observations", observationCount);
+    As::Profiler::instance().addCounter("merge", "unique reflections", uniqueCount);
+
+    return true; }
+
+/*!
+    Returns the merging statistics of every beam type found by the last merge().
+*/
+const QList<As::ReflectionMerger::Statistics>& As::ReflectionMerger::statistics() const {
+    return m_statistics; }
+
+/*!
+    Returns the number of the observations skipped by the last merge() because of
+    their non-integer Miller indices.
+*/
+int As::ReflectionMerger::skippedCount() const {
+    return m_skippedCount; }
@@ -0,0 +1,93 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_DIFFRACTION_REFLECTIONMERGER_HPP
+#define AS_DIFFRACTION_REFLECTIONMERGER_HPP
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <array>
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ResultTable;
+
+class ReflectionMerger {
+
+  public:
+    // Merging statistics of a single beam type
+    struct Statistics {
+        QString beamType;
+        int observationCount = 0;
+        int uniqueCount = 0;
+        qreal rInt = 0;
+        qreal chi2 = 0; };
+
+    static const quint64 INVALID_KEY;
+
+    ReflectionMerger();
+
+    static QStringList groupNames();
+
+    bool setGroup(const QString& name);
+    const QString& group() const;
+    int operationCount() const;
+
+    void canonicalIndices(int& h,
+                          int& k,
+                          int& l) const;
+    quint64 canonicalKey(const qreal h,
+                         const qreal k,
+                         const qreal l) const;
+    static bool integerIndices(const qreal h,
+                               const qreal k,
+                               const qreal l,
+                               int& hi,
+                               int& ki,
+                               int& li);
+    static quint64 packIndices(const int h,
+                               const int k,
+                               const int l);
+    static void unpackIndices(const quint64 key,
+                              int& h,
+                              int& k,
+                              int& l);
+
+    bool merge(const As::ResultTable& table,
+               const QVector<int>& rows,
+               As::ResultTable& merged);
+
+    const QList<As::ReflectionMerger::Statistics>& statistics() const;
+    int skippedCount() const;
+
+  private:
+    QString m_group;
+    QVector<std::array<int, 9>> m_operations; // 3x3 integer matrices acting on (h,k,l), row by row
+    QList<Statistics> m_statistics;
+    int m_skippedCount = 0;
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_REFLECTIONMERGER_HPP
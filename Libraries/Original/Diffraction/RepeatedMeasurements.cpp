@@ -0,0 +1,314 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QStringList>
+#include <QtMath>
+
+#include <algorithm>
+
+#include "Macros.hpp"
+#include "Profiler.hpp"
+
+#include "ReflectionIndex.hpp"
+#include "ReflectionMerger.hpp"
+#include "ResultTable.hpp"
+#include "ScanDict.hpp"
+
+#include "RepeatedMeasurements.hpp"
+
+/*!
+    \class As::RepeatedMeasurements
+
+    \brief The RepeatedMeasurements is a class that finds the reflections measured
+    more than once under the same conditions.
+
+    The same reflection is often measured several times, e.g. in different files
+    or after the restart of the measurement. The rows of the output table are
+    grouped by their Miller indices rounded to the nearest integers with the help
+    of As::ReflectionIndex, and then by the temperature, the magnetic and electric
+    fields and the polarisation, so that the time is nearly linear in the number
+    of rows. The measurements at the other conditions are not repeats.
+
+    The groups are linked in the output table by the columns \c Repeat and
+    \c Repeats, and one of the policies is applied on export.
+
+    \inmodule Diffraction
+*/
+
+/*!
+    \enum As::RepeatedMeasurements::Policy
+
+    This enum type describes how the repeated measurements are exported.
+
+    \value KeepAll      All the measurements are exported
+    \value KeepLatest   Only the last measurement of every group is exported
+    \value Average      The last measurement of every group is exported with the
+                        weighted mean of the structure factors of the group
+*/
+
+/*!
+    \variable As::RepeatedMeasurements::PolicyDict
+    \brief the dictionary, which stores the policies as enum and their associated
+    descriptions as string.
+*/
+const QMap<As::RepeatedMeasurements::Policy, QString> As::RepeatedMeasurements::PolicyDict = {
+    { As::RepeatedMeasurements::KeepAll, "Keep all repeated measurements" },
+    { As::RepeatedMeasurements::KeepLatest, "Keep the latest repeated measurement" },
+    { As::RepeatedMeasurements::Average, "Average the repeated measurements" } };
+
+/*!
+    \variable As::RepeatedMeasurements::PolicyNameDict
+    \brief the dictionary, which stores the policies as enum and their short names
+    used in the settings and in the command line.
+*/
+const QMap<As::RepeatedMeasurements::Policy, QString> As::RepeatedMeasurements::PolicyNameDict = {
+    { As::RepeatedMeasurements::KeepAll, "all" },
+    { As::RepeatedMeasurements::KeepLatest, "latest" },
+    { As::RepeatedMeasurements::Average, "average" } };
+
+/*!
+    \variable As::RepeatedMeasurements::TEMPERATURE_TOLERANCE
+
+    Largest difference of the temperatures of the repeated measurements, in kelvins.
+*/
+const qreal As::RepeatedMeasurements::TEMPERATURE_TOLERANCE = 0.5;
+
+/*!
+    \variable As::RepeatedMeasurements::FIELD_TOLERANCE
+
+    Largest difference of the magnetic or electric fields of the repeated measurements.
+*/
+const qreal As::RepeatedMeasurements::FIELD_TOLERANCE = 0.05;
+
+// Returns true if the conditions a and b are the same within the tolerance, or both unknown
+static bool IsSameCondition(const qreal a,
+                            const qreal b,
+                            const qreal tolerance) {
+    if (qIsNaN(a) OR qIsNaN(b)) {
+        return qIsNaN(a) AND qIsNaN(b); }
+    return qAbs(a - b) <= tolerance; }
+
+/*!
+    Removes all the groups.
+*/
+void As::RepeatedMeasurements::clear() {
+    m_groups.clear();
+    m_skippedCount = 0; }
+
+/*!
+    Finds the repeated measurements among the given \a rows of the output \a table.
+    Returns false if the table has no Miller indices.
+*/
+bool As::RepeatedMeasurements::group(const As::ResultTable& table,
+                                     const QVector<int>& rows) {
+    As::ProfilerStage profilerStage("repeats");
+
+    m_groups.clear();
+    m_skippedCount = 0;
+
+    const int hColumn = table.columnIndex("H");
+    const int kColumn = table.columnIndex("K");
+    const int lColumn = table.columnIndex("L");
+    if (hColumn < 0 OR kColumn < 0 OR lColumn < 0 OR
+        table.columnType(hColumn) != As::ResultTable::RealColumn OR
+        table.columnType(kColumn) != As::ResultTable::RealColumn OR
+        table.columnType(lColumn) != As::ResultTable::RealColumn) {
+        return false; }
+
+    // Same reflections, found by the hash of their indices. The satellites and the other
+    // reflections with the non-integer indices are never taken as repeats of the integer ones
+    QVector<As::ReflectionIndex::Point> indices(rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        const int row = rows.at(i);
+        const qreal h = table.real(row, hColumn);
+        const qreal k = table.real(row, kColumn);
+        const qreal l = table.real(row, lColumn);
+        int hi, ki, li;
+        if (As::ReflectionMerger::integerIndices(h, k, l, hi, ki, li)) {
+            indices[i] = {{ h, k, l }}; }
+        else {
+            indices[i] = {{ qQNaN(), qQNaN(), qQNaN() }};
+            ++m_skippedCount; } }
+    As::ReflectionIndex index;
+    index.build(indices);
+
+    // Conditions of the measurements, if known
+    const QStringList conditionNames = { "Temperature", "Magnetic field", "Electric field" };
+    const QVector<qreal> conditionTolerances = { TEMPERATURE_TOLERANCE, FIELD_TOLERANCE, FIELD_TOLERANCE };
+    QVector<int> conditionColumns;
+    QVector<qreal> tolerances;
+    for (int i = 0; i < conditionNames.size(); ++i) {
+        const int column = table.columnIndex(conditionNames.at(i));
+        if (column >= 0 AND table.columnType(column) == As::ResultTable::RealColumn) {
+            conditionColumns << column;
+            tolerances << conditionTolerances.at(i); } }
+    const int polarisationColumn = table.columnIndex("Polarisation (in/out)");
+
+    auto isSameConditions = [&](const int a, const int b) {
+        for (int i = 0; i < conditionColumns.size(); ++i) {
+            const int column = conditionColumns.at(i);
+            const qreal tolerance = tolerances.at(i);
+            if (!IsSameCondition(table.real(a, column), table.real(b, column), tolerance)) {
+                return false; } }
+        return polarisationColumn < 0 OR
+               table.printCell(a, polarisationColumn) == table.printCell(b, polarisationColumn); };
+
+    // Split every reflection by the conditions. The reflection is measured only a few times,
+    // so that every measurement is compared with the first one of every group found so far
+    for (const QVector<int>& items : index.duplicates()) {
+        QVector<QVector<int>> groups;
+        for (const int item : items) {
+            const int row = rows.at(item);
+            bool isFound = false;
+            for (QVector<int>& group : groups) {
+                if (isSameConditions(group.first(), row)) {
+                    group << row;
+                    isFound = true;
+                    break; } }
+            if (!isFound) {
+                groups << QVector<int>{ row }; } }
+        for (QVector<int>& group : groups) {
+            if (group.size() > 1) {
+                std::sort(group.begin(), group.end());
+                m_groups << group; } } }
+
+    std::sort(m_groups.begin(), m_groups.end(),
+              [](const QVector<int>& a, const QVector<int>& b) { return a.first() < b.first(); });
+
+    As::Profiler::instance().addCounter("repeats", "rows", rows.size());
+    As::Profiler::instance().addCounter("repeats", "groups", m_groups.size());
+
+    return true; }
+
+/*!
+    Returns the rows of the repeated measurements of every reflection, sorted by
+    their first rows.
+*/
+const QVector<QVector<int>>& As::RepeatedMeasurements::groups() const {
+    return m_groups; }
+
+/*!
+    Returns the number of the measurements that repeat the earlier ones.
+*/
+int As::RepeatedMeasurements::repeatCount() const {
+    int count = 0;
+    for (const QVector<int>& group : m_groups) {
+        count += group.size() - 1; }
+    return count; }
+
+/*!
+    Returns the number of the rows not grouped, as their Miller indices are not
+    integer, e.g. of the satellite reflections.
+*/
+int As::RepeatedMeasurements::skippedCount() const {
+    return m_skippedCount; }
+
+/*!
+    Links the repeated measurements in the output \a table: the column \c Repeat
+    gets the number of the group and the column \c Repeats its size. Both are empty
+    for the reflections measured only once. The columns are not added, if there are
+    no repeated measurements at all.
+*/
+void As::RepeatedMeasurements::link(As::ResultTable& table) const {
+    int repeatColumn = table.columnIndex("Repeat");
+    int repeatsColumn = table.columnIndex("Repeats");
+    if (m_groups.isEmpty() AND repeatColumn < 0 AND repeatsColumn < 0) {
+        return; }
+    if (repeatColumn < 0) {
+        repeatColumn = table.appendColumn("Repeat", "i", As::ResultTable::RealColumn); }
+    if (repeatsColumn < 0) {
+        repeatsColumn = table.appendColumn("Repeats", "i", As::ResultTable::RealColumn); }
+
+    for (int row = 0; row < table.rowCount(); ++row) {
+        table.setReal(row, repeatColumn, qQNaN());
+        table.setReal(row, repeatsColumn, qQNaN()); }
+
+    for (int group = 0; group < m_groups.size(); ++group) {
+        for (const int row : m_groups.at(group)) {
+            table.setReal(row, repeatColumn, group + 1);
+            table.setReal(row, repeatsColumn, m_groups.at(group).size()); } } }
+
+/*!
+    Applies the \a policy to the given \a rows of the output \a table and returns
+    the rows to be exported. The last measurement of every group is kept, as the
+    latest one. For the averaging, its structure factors are replaced in the
+    \a table by the weighted means of the group.
+*/
+QVector<int> As::RepeatedMeasurements::apply(As::ResultTable& table,
+                                             const QVector<int>& rows,
+                                             const As::RepeatedMeasurements::Policy policy) const {
+    if (policy == KeepAll OR m_groups.isEmpty()) {
+        return rows; }
+
+    QVector<bool> isDropped(table.rowCount(), false);
+    for (const QVector<int>& group : m_groups) {
+        for (int i = 0; i < group.size() - 1; ++i) {
+            isDropped[group.at(i)] = true; } }
+
+    if (policy == Average) {
+        for (const QString& beamType : As::ScanDict::BEAM_TYPES.values()) {
+            const int valueColumn = table.columnIndex("Sf2" + beamType);
+            const int errorColumn = table.columnIndex("Sf2Err" + beamType);
+            if (valueColumn < 0 OR errorColumn < 0) {
+                continue; }
+
+            for (const QVector<int>& group : m_groups) {
+
+                // Weights 1/error^2, or unit weights if any of the errors is unknown
+                int count = 0;
+                bool isWeighted = true;
+                for (const int row : group) {
+                    const qreal value = table.real(row, valueColumn);
+                    const qreal error = table.real(row, errorColumn);
+                    if (qIsFinite(value)) {
+                        ++count;
+                        isWeighted = isWeighted AND qIsFinite(error) AND error > 0; } }
+                if (count == 0) {
+                    continue; }
+
+                qreal weightSum = 0;
+                qreal weightedSum = 0;
+                for (const int row : group) {
+                    const qreal value = table.real(row, valueColumn);
+                    const qreal error = table.real(row, errorColumn);
+                    if (qIsFinite(value)) {
+                        const qreal weight = isWeighted ? 1 / (error * error) : 1;
+                        weightSum += weight;
+                        weightedSum += weight * value; } }
+                const qreal mean = weightedSum / weightSum;
+
+                qreal meanError = isWeighted ? 1 / qSqrt(weightSum) : qQNaN();
+                if (!isWeighted AND count > 1) {
+                    qreal squaredDeviationSum = 0;
+                    for (const int row : group) {
+                        const qreal value = table.real(row, valueColumn);
+                        if (qIsFinite(value)) {
+                            squaredDeviationSum += (value - mean) * (value - mean); } }
+                    meanError = qSqrt(squaredDeviationSum / (count * (count - 1))); }
+
+                table.setReal(group.last(), valueColumn, mean);
+                table.setReal(group.last(), errorColumn, meanError); } } }
+
+    QVector<int> exported;
+    exported.reserve(rows.size());
+    for (const int row : rows) {
+        if (!isDropped.at(row)) {
+            exported << row; } }
+    return exported; }
@@ -0,0 +1,64 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_DIFFRACTION_REPEATEDMEASUREMENTS_HPP
+#define AS_DIFFRACTION_REPEATEDMEASUREMENTS_HPP
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ResultTable;
+
+class RepeatedMeasurements {
+
+  public:
+    enum Policy { KeepAll, KeepLatest, Average };
+
+    static const QMap<As::RepeatedMeasurements::Policy, QString> PolicyDict;
+    static const QMap<As::RepeatedMeasurements::Policy, QString> PolicyNameDict;
+
+    static const qreal TEMPERATURE_TOLERANCE;
+    static const qreal FIELD_TOLERANCE;
+
+    void clear();
+
+    bool group(const As::ResultTable& table,
+               const QVector<int>& rows);
+    const QVector<QVector<int>>& groups() const;
+    int repeatCount() const;
+    int skippedCount() const;
+
+    void link(As::ResultTable& table) const;
+    QVector<int> apply(As::ResultTable& table,
+                       const QVector<int>& rows,
+                       const As::RepeatedMeasurements::Policy policy) const;
+
+  private:
+    QVector<QVector<int>> m_groups; // Rows of the repeated measurements of every reflection, in the table order
+    int m_skippedCount = 0;         // Rows with the non-integer indices
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_REPEATEDMEASUREMENTS_HPP
@@ -0,0 +1,331 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDataStream>
+#include <QtGlobal>
+
+#include <algorithm>
+
+#include "Functions.hpp"
+#include "Macros.hpp"
+
+#include "ResultTable.hpp"
+
+/*!
+    \class As::ResultTable
+
+    \brief The ResultTable is a class that provides a columnar table of the
+    processed scans: one row per scan and one typed column per quantity.
+
+    Real columns store the values as qreal without any conversion to strings, so that
+    no precision is lost before the final output. Text columns store the values which
+    can't be represented by numbers, e.g. date and time.
+
+    \inmodule Diffraction
+*/
+
+/*!
+    \enum As::ResultTable::ColumnType
+
+    This enum type describes the type of the table column.
+
+    \value RealColumn   Column of the real numbers
+    \value TextColumn   Column of the strings
+*/
+
+/*!
+    Constructs an empty table.
+*/
+As::ResultTable::ResultTable() {}
+
+/*!
+    Destroys the table.
+*/
+As::ResultTable::~ResultTable() {
+    ADESTROYED; }
+
+/*!
+    Removes all the rows and columns from the table.
+*/
+void As::ResultTable::clear() {
+    m_rowCount = 0;
+    m_headers.clear();
+    m_formats.clear();
+    m_types.clear();
+    m_storageIndices.clear();
+    m_realColumns.clear();
+    m_textColumns.clear();
+    m_columnIndices.clear(); }
+
+/*!
+    Makes the table the only owner of its data. Then different rows can be set by
+    setReal() from different threads, as no column is detached any more.
+*/
+void As::ResultTable::detach() {
+    m_realColumns.detach();
+    for (QVector<qreal>& column : m_realColumns) {
+        column.detach(); }
+    m_textColumns.detach();
+    for (QStringList& column : m_textColumns) {
+        column.detach(); } }
+
+/*!
+    Returns the number of rows in the table.
+*/
+int As::ResultTable::rowCount() const {
+    return m_rowCount; }
+
+/*!
+    Sets the number of rows in the table to \a count. New cells of the real columns are
+    initialized with NaN, new cells of the text columns are initialized with empty strings.
+*/
+void As::ResultTable::setRowCount(const int count) {
+    for (auto& column : m_realColumns) {
+        const int oldCount = column.size();
+        column.resize(count);
+        for (int row = oldCount; row < count; ++row) {
+            column[row] = qQNaN(); } }
+
+    for (auto& column : m_textColumns) {
+        while (column.size() < count) {
+            column.append(QString()); }
+        while (column.size() > count) {
+            column.removeLast(); } }
+
+    m_rowCount = count; }
+
+/*!
+    Returns the number of columns in the table.
+*/
+int As::ResultTable::columnCount() const {
+    return m_headers.size(); }
+
+/*!
+    Appends a new column with the given \a name, \a format and \a type to the table.
+    Returns the index of the new column.
+*/
+int As::ResultTable::appendColumn(const QString& name,
+                                  const QString& format,
+                                  const As::ResultTable::ColumnType type) {
+    AASSERT(!m_columnIndices.contains(name), QString("column '%1' already exists").arg(name));
+
+    const int column = m_headers.size();
+
+    m_headers << name;
+    m_formats << format;
+    m_types << type;
+    m_columnIndices.insert(name, column);
+
+    if (type == RealColumn) {
+        m_storageIndices << m_realColumns.size();
+        m_realColumns << QVector<qreal>(m_rowCount, qQNaN()); }
+
+    else {
+        m_storageIndices << m_textColumns.size();
+        QStringList strings;
+        for (int row = 0; row < m_rowCount; ++row) {
+            strings << QString(); }
+        m_textColumns << strings; }
+
+    return column; }
+
+/*!
+    \overload
+
+    Appends a new real column with the given \a name and \a format, and fills it with the
+    given \a values.
+
+    The values are copied in a single pass rather than implicitly shared, so that the
+    source table can be modified later from several threads without the detach on write.
+*/
+int As::ResultTable::appendColumn(const QString& name,
+                                  const QString& format,
+                                  const QVector<qreal>& values) {
+    AASSERT(values.size() == m_rowCount, QString("column '%1' size mismatch").arg(name));
+
+    const int column = appendColumn(name, format, RealColumn);
+    QVector<qreal>& target = m_realColumns[m_storageIndices[column]];
+    std::copy(values.constBegin(), values.constBegin() + qMin(values.size(), target.size()), target.begin());
+    return column; }
+
+/*!
+    Returns the index of the column with the given \a name, or -1 if there is no such column.
+*/
+int As::ResultTable::columnIndex(const QString& name) const {
+    return m_columnIndices.value(name, -1); }
+
+/*!
+    Appends all the rows of the \a other table to the end of this table. The columns are
+    matched by name: the cells of the columns missing in the \a other table are left
+    empty, while the columns missing in this table are skipped.
+*/
+void As::ResultTable::appendRows(const As::ResultTable& other) {
+    const int firstRow = m_rowCount;
+    setRowCount(m_rowCount + other.rowCount());
+
+    for (int column = 0; column < columnCount(); ++column) {
+        const int otherColumn = other.columnIndex(m_headers.at(column));
+        if (otherColumn < 0) {
+            continue; }
+
+        for (int row = 0; row < other.rowCount(); ++row) {
+            if (m_types.at(column) == RealColumn) {
+                m_realColumns[m_storageIndices.at(column)][firstRow + row] = other.real(row, otherColumn); }
+            else {
+                m_textColumns[m_storageIndices.at(column)][firstRow + row] = other.text(row, otherColumn); } } } }
+
+/*!
+    Returns the names of all the columns in the table.
+*/
+const QStringList& As::ResultTable::headers() const {
+    return m_headers; }
+
+/*!
+    Returns the format of the given \a column.
+*/
+const QString& As::ResultTable::format(const int column) const {
+    return m_formats.at(column); }
+
+/*!
+    Returns the type of the given \a column.
+*/
+As::ResultTable::ColumnType As::ResultTable::columnType(const int column) const {
+    return m_types.at(column); }
+
+/*!
+    Returns the real value of the cell at \a row and \a column.
+    Returns NaN if the column is not a real one.
+*/
+qreal As::ResultTable::real(const int row,
+                            const int column) const {
+    if (m_types.at(column) != RealColumn) {
+        return qQNaN(); }
+
+    return m_realColumns.at(m_storageIndices.at(column)).at(row); }
+
+/*!
+    Sets the real \a value of the cell at \a row and \a column. The table is detached
+    from its copies, if needed.
+*/
+void As::ResultTable::setReal(const int row,
+                              const int column,
+                              const qreal value) {
+    AASSERT(m_types.at(column) == RealColumn, QString("column '%1' is not a real one").arg(m_headers.at(column)));
+    m_realColumns[m_storageIndices.at(column)][row] = value; }
+
+/*!
+    Returns all the values of the given real \a column.
+*/
+const QVector<qreal>& As::ResultTable::realColumn(const int column) const {
+    return m_realColumns.at(m_storageIndices.at(column)); }
+
+/*!
+    Returns the text of the cell at \a row and \a column. The real values are converted
+    to text without any loss of precision.
+*/
+const QString As::ResultTable::text(const int row,
+                                    const int column) const {
+    if (m_types.at(column) == RealColumn) {
+        return QString::number(real(row, column), 'g', 17); }
+
+    return m_textColumns.at(m_storageIndices.at(column)).at(row); }
+
+/*!
+    Sets the text \a value of the cell at \a row and \a column.
+*/
+void As::ResultTable::setText(const int row,
+                              const int column,
+                              const QString& value) {
+    AASSERT(m_types.at(column) == TextColumn, QString("column '%1' is not a text one").arg(m_headers.at(column)));
+    m_textColumns[m_storageIndices.at(column)][row] = value; }
+
+/*!
+    Returns the cell at \a row and \a column formatted with the column format.
+*/
+const QString As::ResultTable::printCell(const int row,
+                                         const int column) const {
+    return printCell(row, column, m_formats.at(column)); }
+
+/*!
+    \overload
+
+    Returns the cell at \a row and \a column formatted with the given \a format.
+    The real values are formatted directly, without the intermediate string conversion.
+*/
+const QString As::ResultTable::printCell(const int row,
+                                         const int column,
+                                         const QString& format) const {
+    if (m_types.at(column) == RealColumn) {
+        return As::FormatNumber(real(row, column), format); }
+
+    return As::FormatString(text(row, column), format); }
+
+/*!
+    Writes the whole table, including the column formats and types, to the stream \a out.
+    The real values are written in the binary form without any loss of precision.
+*/
+void As::ResultTable::writeTo(QDataStream& out) const {
+    out << qint32(m_rowCount) << qint32(columnCount());
+
+    for (int column = 0; column < columnCount(); ++column) {
+        out << m_headers.at(column) << m_formats.at(column) << qint32(m_types.at(column));
+        if (m_types.at(column) == RealColumn) {
+            out << m_realColumns.at(m_storageIndices.at(column)); }
+        else {
+            out << m_textColumns.at(m_storageIndices.at(column)); } } }
+
+/*!
+    Reads the whole table written by writeTo() from the stream \a in. Returns true on
+    success, otherwise the table is left empty and false is returned.
+*/
+bool As::ResultTable::readFrom(QDataStream& in) {
+    clear();
+
+    qint32 rowCount = 0;
+    qint32 columnCount = 0;
+    in >> rowCount >> columnCount;
+    setRowCount(qMax(0, rowCount));
+
+    for (qint32 i = 0; i < columnCount AND in.status() == QDataStream::Ok; ++i) {
+        QString name;
+        QString format;
+        qint32 type = 0;
+        in >> name >> format >> type;
+
+        if (type == RealColumn) {
+            QVector<qreal> values;
+            in >> values;
+            if (values.size() != m_rowCount OR m_columnIndices.contains(name)) {
+                break; }
+            appendColumn(name, format, values); }
+
+        else {
+            QStringList strings;
+            in >> strings;
+            if (strings.size() != m_rowCount OR m_columnIndices.contains(name)) {
+                break; }
+            const int column = appendColumn(name, format, TextColumn);
+            m_textColumns[m_storageIndices.at(column)] = strings; } }
+
+    if (in.status() != QDataStream::Ok OR columnCount != this->columnCount()) {
+        clear();
+        return false; }
+
+    return true; }
@@ -0,0 +1,98 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_DIFFRACTION_RESULTTABLE_HPP
+#define AS_DIFFRACTION_RESULTTABLE_HPP
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QDataStream;
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ResultTable {
+
+  public:
+    enum ColumnType { RealColumn, TextColumn };
+
+    ResultTable();
+    ~ResultTable();
+
+    void clear();
+    void detach();
+
+    int rowCount() const;
+    void setRowCount(const int count);
+
+    int columnCount() const;
+    int appendColumn(const QString& name,
+                     const QString& format,
+                     const As::ResultTable::ColumnType type);
+    int appendColumn(const QString& name,
+                     const QString& format,
+                     const QVector<qreal>& values);
+    int columnIndex(const QString& name) const;
+
+    void appendRows(const As::ResultTable& other);
+
+    const QStringList& headers() const;
+    const QString& format(const int column) const;
+    As::ResultTable::ColumnType columnType(const int column) const;
+
+    qreal real(const int row,
+               const int column) const;
+    void setReal(const int row,
+                 const int column,
+                 const qreal value);
+    const QVector<qreal>& realColumn(const int column) const;
+
+    const QString text(const int row,
+                       const int column) const;
+    void setText(const int row,
+                 const int column,
+                 const QString& value);
+
+    const QString printCell(const int row,
+                            const int column) const;
+    const QString printCell(const int row,
+                            const int column,
+                            const QString& format) const;
+
+    void writeTo(QDataStream& out) const;
+    bool readFrom(QDataStream& in);
+
+  private:
+    int m_rowCount = 0;
+    QStringList m_headers;
+    QStringList m_formats;
+    QVector<As::ResultTable::ColumnType> m_types;
+    QVector<int> m_storageIndices;            // Index in m_realColumns or m_textColumns
+    QVector<QVector<qreal>> m_realColumns;
+    QVector<QStringList> m_textColumns;
+    QHash<QString, int> m_columnIndices;
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_RESULTTABLE_HPP
@@ -33,6 +33,8 @@
 #include "Macros.hpp"
 
 #include "RealVector.hpp"
+#include "InputReader.hpp"
+#include "ResultTable.hpp"
 #include "ScanDict.hpp"
 
 #include "Scan.hpp"
@@ -79,24 +81,36 @@ void As::Scan::init() {
     m_numRightBkgPoints  = As::ScanDict::MIN_BKG_DATA_POINTS;
     m_numPeakPoints      = 0;
 
+    // Calculated results (incl. the ones depending on polarisation, i.e. BEAM_TYPES)
+    // are stored in the result table of the scan array, see setResultTable.
+
     m_normMeanBkg        = qQNaN();
-    m_fullWidthHalfMax   = qQNaN(); m_fullWidthHalfMaxErr = qQNaN();
-    m_flippingRatio      = qQNaN(); m_flippingRatioErr    = qQNaN();
-    m_peakPosition       = qQNaN(); // Is it used? Calc esd?
+    m_peakPosition       = qQNaN(); } // Is it used? Calc esd?
 
-    // Multi calculated values (depend on polarisation, i.e. BEAM_TYPES).
+/*!
+    \typedef As::Scan::ElementData_t
 
-    for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
-        m_maxPeakInty[countType]  = qQNaN(); m_maxPeakIntyErr[countType]  = qQNaN();
-        m_sumPeakInty[countType]  = qQNaN(); m_sumPeakIntyErr[countType]  = qQNaN();
-        m_peakArea[countType]     = qQNaN(); m_peakAreaErr[countType]     = qQNaN();
-        m_normPeakArea[countType] = qQNaN(); m_normPeakAreaErr[countType] = qQNaN();
-        m_structFactor[countType] = qQNaN(); m_structFactorErr[countType] = qQNaN(); } }
+    Synonym for QPair<int, QString>. Holds the field id of the element in the
+    As::ScanDict::Properties and its data. The format, units and tooltip are not copied
+    into the scan, but are shared by all the scans via the field id.
+*/
+
+/*!
+    \typedef As::Scan::GroupData_t
+
+    Synonym for QMap<QString, ElementData_t>.
+*/
+
+/*!
+    \typedef As::Scan::ScanData_t
+
+    Synonym for QMap<QString, GroupData_t>.
+*/
 
 /*!
     Replaces the \a data of the given scan \a group and \a element, if they exist.
 
-    If the scan doesn't contain [group][element]["data"] yet, but the ScanDatabase does,
+    If the scan doesn't contain [group][element] yet, but the ScanDatabase does,
     the data is inserted.
 */
 void As::Scan::setData(const QString& group,
@@ -106,12 +120,17 @@ void As::Scan::setData(const QString& group,
         //AASSERT(false, QString("empty data array [%1][%2] passed to the function").arg(group).arg(element));
         return; }
 
-    if (m_scan[group].contains(element)) {
-        m_scan[group][element].insert("data", data); }
+    auto& elements = m_scan[group];
+    const auto it = elements.find(element);
+
+    if (it != elements.end()) {
+        it.value().second = data;
+        return; }
+
+    const int id = As::ScanDict::Properties.fieldId(group, element);
 
-    else if (As::ScanDict::Properties[group].contains(element)) {
-        m_scan[group][element] = As::ScanDict::Properties[group][element];
-        m_scan[group][element].insert("data", data); }
+    if (id >= 0) {
+        elements.insert(element, ElementData_t(id, data)); }
 
     else {
         AASSERT(false, QString("no such group '%1' or element '%2' in ScanDatabase").arg(group).arg(element)); } }
@@ -119,7 +138,7 @@ void As::Scan::setData(const QString& group,
 /*!
     Appends the \a data of the given scan \a group and \a element, if they exist.
 
-    If the scan doesn't contain [group][element]["data"] yet, but the ScanDatabase does,
+    If the scan doesn't contain [group][element] yet, but the ScanDatabase does,
     the data is inserted.
 */
 void As::Scan::appendData(const QString& group,
@@ -129,23 +148,32 @@ void As::Scan::appendData(const QString& group,
         //AASSERT(false, QString("empty data array [%1][%2] passed to the function").arg(group).arg(element));
         return; }
 
-    if (m_scan[group].contains(element)) {
-        m_scan[group][element].insert("data", m_scan[group][element]["data"] + " " + data); }
+    auto& elements = m_scan[group];
+    const auto it = elements.find(element);
+
+    if (it != elements.end()) {
+        QString& existing = it.value().second;
+        existing = existing.isNull() ? data : existing + " " + data;
+        return; }
 
-    else if (As::ScanDict::Properties[group].contains(element)) {
-        m_scan[group][element] = As::ScanDict::Properties[group][element];
-        m_scan[group][element].insert("data", data); }
+    const int id = As::ScanDict::Properties.fieldId(group, element);
+
+    if (id >= 0) {
+        elements.insert(element, ElementData_t(id, data)); }
 
     else {
         AASSERT(false, QString("no such group '%1' or element '%2' in ScanDatabase").arg(group).arg(element)); } }
 
 /*!
-    Removes the given \a group and \a element from the scan.
+    Removes the data of the given \a group and \a element from the scan.
+    The element itself is kept in the scan, so that its format is still available.
 */
 void As::Scan::removeData(const QString& group,
                           const QString& element) {
-    if (m_scan[group].contains(element)) {
-        m_scan[group][element].remove("data"); }
+    const auto groupIt = m_scan.find(group);
+
+    if (groupIt != m_scan.end() AND groupIt.value().contains(element)) {
+        groupIt.value()[element].second = QString(); }
 
     else {
         AASSERT(false, QString("no such group '%1' or element '%2' in ScanDatabase").arg(group).arg(element)); } }
@@ -153,17 +181,25 @@ void As::Scan::removeData(const QString& group,
 /*!
     Returns the required field value by the given scan \a group, \a element and field \a name.
 
+    The \a name "data" refers to the scan's own data, while all the other names (format,
+    units, tooltip) refer to the attributes shared via As::ScanDict::Properties.
+
     If an error occurs, *\a{ok} is set to \c false; otherwise *\a{ok} is set to \c true.
 */
 const QString As::Scan::value(const QString& group,
                               const QString& element,
                               const QString& name,
                               bool* ok) const {
-    if (m_scan[group][element].contains(name)) {
+    if (name == "data") {
+        return data(group, element, ok); }
+
+    const int id = fieldId(group, element);
+
+    if (id >= 0 AND As::ScanDict::Properties.attributes(id).contains(name)) {
         if (ok) {
             *ok = true; }
 
-        return m_scan[group][element][name]; }
+        return As::ScanDict::Properties.attributes(id).value(name); }
 
     if (ok) {
         *ok = false; }
@@ -178,7 +214,21 @@ const QString As::Scan::value(const QString& group,
 const QString As::Scan::data(const QString& group,
                              const QString& element,
                              bool* ok) const {
-    return value(group, element, "data", ok); }
+    const auto groupIt = m_scan.constFind(group);
+
+    if (groupIt != m_scan.constEnd()) {
+        const auto it = groupIt.value().constFind(element);
+
+        if (it != groupIt.value().constEnd() AND !it.value().second.isNull()) {
+            if (ok) {
+                *ok = true; }
+
+            return it.value().second; } }
+
+    if (ok) {
+        *ok = false; }
+
+    return QString(); }
 
 /*!
     Returns the format field of the given scan \a group and \a element.
@@ -188,7 +238,26 @@ const QString As::Scan::data(const QString& group,
 const QString As::Scan::format(const QString& group,
                                const QString& element,
                                bool* ok) const {
-    return value(group, element, "format", ok); }
+    const int id = fieldId(group, element);
+
+    if (ok) {
+        *ok = (id >= 0); }
+
+    return id >= 0 ? As::ScanDict::Properties.format(id) : QString(); }
+
+/*!
+    Returns the field id in the As::ScanDict::Properties of the given scan \a group and
+    \a element, or -1 if the scan doesn't contain such an element.
+*/
+int As::Scan::fieldId(const QString& group,
+                      const QString& element) const {
+    const auto groupIt = m_scan.constFind(group);
+
+    if (groupIt == m_scan.constEnd()) {
+        return -1; }
+
+    const auto it = groupIt.value().constFind(element);
+    return it != groupIt.value().constEnd() ? it.value().first : -1; }
 
 /*!
     Returns the single data value of the given scan \a group and \a element
@@ -196,29 +265,31 @@ const QString As::Scan::format(const QString& group,
 */
 const QString As::Scan::printDataSingle(const QString& group,
                                         const QString& element) const {
-    if (!m_scan[group].contains(element)) {
+    const int id = fieldId(group, element);
+
+    if (id < 0) {
         AASSERT(false, QString("no such group '%1' or element '%2' in the current scan"));
         return QString(); }
 
-    const QString format = m_scan[group][element]["format"];
-    const QString data = m_scan[group][element]["data"];
-    return As::FormatString(data, format); }
+    return As::FormatString(data(group, element), As::ScanDict::Properties.format(id)); }
 
 /*!
     Returns the range data values of the given scan \a group and \a element.
 */
 const QString As::Scan::printDataRange(const QString& group,
                                        const QString& element) const {
-    if (!m_scan[group].contains(element)) {
+    const int id = fieldId(group, element);
+
+    if (id < 0) {
         AASSERT(false, QString("no such group '%1' or element '%2' in the current scan"));
         return QString(); }
 
-    const QString format = m_scan[group][element]["format"];
+    const QString& format = As::ScanDict::Properties.format(id);
 
     if (!format.contains("f")) {
         return printDataSingle(group, element); }
 
-    const As::RealVector data = m_scan[group][element]["data"];
+    const As::RealVector data = this->data(group, element);
     const qreal min = data.min();
     const qreal max = data.max();
 
@@ -234,27 +305,30 @@ const QStringList As::Scan::keys() const {
     return m_scan.keys(); }
 
 /*!
-    Returns the As::ScanSection_t associated with the key \a key as a modifiable reference.
+    Returns the group of elements associated with the key \a key as a constant reference.
 
-    If the map contains no item with key \a key, the function inserts a default-constructed
-    value into the map with key \a key, and returns a reference to it. If the map contains
-    multiple items with key \a key key, this function returns a reference to the most recently
-    inserted value.
-*/
-As::ScanDict::GroupElements_t& As::Scan::operator[](const QString& key) {
-    return m_scan[key]; }
-
-/*!
-    \overload
+    If the scan contains no group with key \a key, a reference to an empty group is returned.
 */
-const As::ScanDict::GroupElements_t As::Scan::operator[](const QString& key) const {
-    return m_scan[key]; }
+const As::Scan::GroupData_t& As::Scan::operator[](const QString& key) const {
+    static const GroupData_t emptyGroup;
+    const auto it = m_scan.constFind(key);
+    return it != m_scan.constEnd() ? it.value() : emptyGroup; }
 
 /*!
-    Returns the scan as a QMap.
+    Returns the scan as a QMap, where every element holds all its attributes together
+    with the data. Used for the debug output only.
 */
 const As::ScanDict::PropertyGroups_t As::Scan::toQMap() const {
-    return m_scan; }
+    As::ScanDict::PropertyGroups_t map;
+
+    for (auto groupIt = m_scan.constBegin(); groupIt != m_scan.constEnd(); ++groupIt) {
+        for (auto it = groupIt.value().constBegin(); it != groupIt.value().constEnd(); ++it) {
+            auto attributes = As::ScanDict::Properties.attributes(it.value().first);
+            if (!it.value().second.isNull()) {
+                attributes.insert("data", it.value().second); }
+            map[groupIt.key()][it.key()] = attributes; } }
+
+    return map; }
 
 /*!
     Sets \a name to the scan angle.
@@ -267,7 +341,7 @@ void As::Scan::setScanAngle(const QString& name) {
 */
 void As::Scan::findAndSetScanAngle() {
 
-    const QStringList subitemKeys = m_scan["angles"].keys();
+    const QStringList subitemKeys = m_scan.value("angles").keys();
 
     for (const auto& subitemKey : subitemKeys) {
         const As::RealVector v = data("angles", subitemKey);
@@ -311,10 +385,17 @@ const QString As::Scan::absoluteFilePath() const {
 
 /*!
     Returns the absolute path of the file (without file name) which contains the scan.
+    For the member of an archive, it is the path of the archive itself, so that the
+    output files are saved next to it.
 */
 const QString As::Scan::absolutePath() const {
     // Absolute File Path:             /tmp/dummy.dat
     // Absolute Path:                  /tmp
+    // Absolute File Path in archive:  /tmp/data.tar.gz/nicos/dummy.dat
+    // Absolute Path in archive:       /tmp
+    const QString archivePath = As::InputReader::archivePath(m_absoluteFilePath);
+    if (!archivePath.isEmpty()) {
+        return QFileInfo(archivePath).absolutePath(); }
     return QFileInfo(m_absoluteFilePath).absolutePath(); }
 
 /*!
@@ -377,7 +458,7 @@ As::PlotType As::Scan::plotType() const {
 */
 qreal As::Scan::millerIndex(const QString& name) const {
     if (name == "H" OR name == "K" OR name == "L") {
-        return As::RealVector(m_scan["indices"][name]["data"]).mean(); }
+        return As::RealVector(data("indices", name)).mean(); }
 
     AASSERT(false, QString("Miller index name '%1' is not correct").arg(name));
     return qQNaN(); }
@@ -439,16 +520,11 @@ int As::Scan::scanLine() const {
 
 
 /*!
-    Creates the table model of extracted scans.
+    Returns the table of extracted data: the heading, formatted cell values
+    of the selected scan sections.
 */
-void As::Scan::createExtractedTableModel() {
-
-    // Get the table heading, cell elements values and their formats
-    // from the selected scan sections listed in 'items'
-
-    QStringList headers;
-    QStringList formats;
-    QList<QStringList> dataTable;
+As::Scan::ExtractedTable As::Scan::extractedTable() const {
+    ExtractedTable table;
 
     const QStringList items({ "indices", "angles", "intensities", "conditions" });
     for (const QString& item : items) {
@@ -460,35 +536,14 @@ void As::Scan::createExtractedTableModel() {
             const QString formatString = format(item, subitem);
             if (!dataString.isEmpty() AND !formatString.isEmpty()) {
 
-                headers << subitem;
-                formats << formatString;
-                dataTable << dataString.split(" "); } } }
-
-    // Extracted table size
-
-    int columnCount = dataTable.size();
-    int rowCount = dataTable[0].size();
+                QStringList column;
+                for (const QString& value : dataString.split(" ")) {
+                    column << As::FormatString(value, formatString); }
 
-    // Create the table model based on the extracted one from above
+                table.headers << subitem;
+                table.columns << column; } } }
 
-    m_extractedTableModel = new QStandardItemModel;
-    m_extractedTableModel->setColumnCount(columnCount);
-    m_extractedTableModel->setRowCount(rowCount);
-
-    for (int column = 0; column < columnCount; ++column) {
-        // Headers
-        m_extractedTableModel->setHorizontalHeaderItem(column, new QStandardItem(headers[column]));
-        // Values
-        for (int row = 0; row < rowCount; ++row) {
-            auto const value = As::FormatString( dataTable[column][row], formats[column] );
-            m_extractedTableModel->setItem( row, column, new QStandardItem(value) );
-            m_extractedTableModel->item(row, column)->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter); } } }
-
-/*!
-    Returns the table model of extracted scans as a pointer.
-*/
-QStandardItemModel* As::Scan::extractedTableModel() const {
-    return m_extractedTableModel; }
+    return table; }
 
 /*!
     Returns the true if scan should be treated with individual settings with regards
@@ -538,8 +593,8 @@ As::Scan::NeighborsRemoveType As::Scan::neighborsRemoveType() const {
     as enum and thier associated descriptions as string.
 */
 const QMap<As::Scan::PeakAnalysisType, QString> As::Scan::PeakAnalysisTypeDict  = {
-    //{ As::Scan::PeakFit, "Peak fitting" }
-    { As::Scan::PeakIntegration, "Conventional peak integration" } };
+    { As::Scan::PeakIntegration, "Conventional peak integration" },
+    { As::Scan::PeakFit, "Peak fitting" } };
 
 /*!
     Sets the neighbor peaks removing type as \a type.
@@ -627,6 +682,138 @@ void As::Scan::setMcCandlishFactor(const qreal val) {
 qreal As::Scan::mcCandlishFactor() const {
     return m_mcCandlishFactor; }
 
+/*!
+    \enum As::Scan::ResultType
+
+    This enum type describes the calculated results of the scan treatment.
+
+    \value MaxPeakInty                Maximum peak intensity
+    \value MaxPeakIntyErr             ESD of the maximum peak intensity
+    \value SumPeakInty                Sum of the peak intensities
+    \value SumPeakIntyErr             ESD of the sum of the peak intensities
+    \value PeakArea                   Peak area
+    \value PeakAreaErr                ESD of the peak area
+    \value NormPeakArea               Normalised peak area
+    \value NormPeakAreaErr            ESD of the normalised peak area
+    \value StructFactor               Structure factor squared
+    \value StructFactorErr            ESD of the structure factor squared
+    \value FullWidthHalfMax           Full width at half maximum
+    \value FullWidthHalfMaxErr        ESD of the full width at half maximum
+    \value FlippingRatio              Flipping ratio
+    \value FlippingRatioErr           ESD of the flipping ratio
+    \value FlippingRatioSignificance  Significance of the flipping ratio |FR-1|/FRerr
+    \value FitPeakArea                Peak area of the fitted profile
+    \value FitPeakAreaErr             ESD of the peak area of the fitted profile
+    \value FitPeakPosition            Peak position of the fitted profile
+    \value FitPeakPositionErr         ESD of the peak position of the fitted profile
+    \value FitFullWidthHalfMax        Full width at half maximum of the fitted profile
+    \value FitFullWidthHalfMaxErr     ESD of the full width at half maximum of the fitted profile
+    \value FitBkg                     Background of the fitted profile
+    \value FitBkgErr                  ESD of the background of the fitted profile
+    \value FitMixing                  Lorentzian fraction of the fitted pseudo-Voigt profile
+    \value FitChiSquared              Reduced chi-squared of the fit
+*/
+
+/*!
+    \variable As::Scan::ResultTypeDict
+    \brief the dictionary, which stores the types of the calculated results as enum
+    and their associated names in the 'calculations' group of As::ScanDict as string.
+*/
+const QMap<As::Scan::ResultType, QString> As::Scan::ResultTypeDict = {
+    { As::Scan::MaxPeakInty,               "IntMax" },
+    { As::Scan::MaxPeakIntyErr,            "IntMaxErr" },
+    { As::Scan::SumPeakInty,               "IntSum" },
+    { As::Scan::SumPeakIntyErr,            "IntSumErr" },
+    { As::Scan::PeakArea,                  "Area" },
+    { As::Scan::PeakAreaErr,               "AreaErr" },
+    { As::Scan::NormPeakArea,              "AreaNorm" },
+    { As::Scan::NormPeakAreaErr,           "AreaNormErr" },
+    { As::Scan::StructFactor,              "Sf2" },
+    { As::Scan::StructFactorErr,           "Sf2Err" },
+    { As::Scan::FullWidthHalfMax,          "Fwhm" },
+    { As::Scan::FullWidthHalfMaxErr,       "FwhmErr" },
+    { As::Scan::FlippingRatio,             "FR" },
+    { As::Scan::FlippingRatioErr,          "FRerr" },
+    { As::Scan::FlippingRatioSignificance, "|FR-1|/FRerr" },
+    { As::Scan::FitPeakArea,               "AreaFit" },
+    { As::Scan::FitPeakAreaErr,            "AreaFitErr" },
+    { As::Scan::FitPeakPosition,           "PosFit" },
+    { As::Scan::FitPeakPositionErr,        "PosFitErr" },
+    { As::Scan::FitFullWidthHalfMax,       "FwhmFit" },
+    { As::Scan::FitFullWidthHalfMaxErr,    "FwhmFitErr" },
+    { As::Scan::FitBkg,                    "BkgFit" },
+    { As::Scan::FitBkgErr,                 "BkgFitErr" },
+    { As::Scan::FitMixing,                 "EtaFit" },
+    { As::Scan::FitChiSquared,             "Chi2Fit" } };
+
+/*!
+    Returns the index of the result table column of the given result \a type and \a countType.
+    Every result type has one column per beam type.
+*/
+int As::Scan::resultColumn(const As::Scan::ResultType type,
+                           const QString& countType) {
+    const int beamType = countType.isEmpty() ? static_cast<int>(As::ScanDict::UNPOLARISED) :
+                         As::ScanDict::BEAM_TYPES.key(countType, As::ScanDict::UNPOLARISED);
+    return type * As::ScanDict::BEAM_TYPES.size() + beamType; }
+
+/*!
+    Returns the name of the result of the given \a type and \a countType, as used
+    for the output table headers.
+*/
+QString As::Scan::resultName(const As::Scan::ResultType type,
+                             const QString& countType) {
+    return ResultTypeDict[type] + countType; }
+
+/*!
+    Returns the total number of the result table columns.
+*/
+int As::Scan::resultColumnCount() {
+    return ResultTypeDict.size() * As::ScanDict::BEAM_TYPES.size(); }
+
+/*!
+    Attaches the scan to the given result \a table at the given \a row.
+*/
+void As::Scan::setResultTable(As::ResultTable* table,
+                              const int row) {
+    m_resultTable = table;
+    m_resultRow = row; }
+
+/*!
+    Returns the result table the scan is attached to.
+*/
+As::ResultTable* As::Scan::resultTable() const {
+    return m_resultTable; }
+
+/*!
+    Returns the row of the result table the scan is attached to.
+*/
+int As::Scan::resultRow() const {
+    return m_resultRow; }
+
+/*!
+    Returns the calculated result of the given \a type and \a countType.
+    Returns NaN if the result is not calculated or the scan is not attached to a result table.
+*/
+qreal As::Scan::result(const As::Scan::ResultType type,
+                       const QString& countType) const {
+    if (!m_resultTable) {
+        return qQNaN(); }
+
+    return m_resultTable->real(m_resultRow, resultColumn(type, countType)); }
+
+/*!
+    Sets the calculated result of the given \a type and \a countType to \a value.
+*/
+void As::Scan::setResult(const As::Scan::ResultType type,
+                         const QString& countType,
+                         const qreal value) {
+    if (!m_resultTable) {
+        AASSERT(false, QString("scan is not attached to a result table"));
+        return; }
+
+    // The scans are treated in parallel, each writes its own row only
+    m_resultTable->setReal(m_resultRow, resultColumn(type, countType), value); }
+
 /**
     Overloads operator<< for QDebug to accept the Scan output.
 */
@@ -21,19 +21,21 @@
 #ifndef AS_DIFFRACTION_SCAN_HPP
 #define AS_DIFFRACTION_SCAN_HPP
 
+#include <QList>
 #include <QObject>
-#include <QStandardItemModel>
+#include <QPair>
+#include <QStringList>
 
 #include "Constants.hpp"
 #include "ScanDict.hpp"
 
 class QString;
-class QStringList;
 template <class Key, class T> class QMap;
 
 namespace As { //AS_BEGIN_NAMESPACE
 
 class RealVector;
+class ResultTable;
 //class ScanDict;
 
 class Scan : public QObject {
@@ -41,6 +43,11 @@ class Scan : public QObject {
 
   public:
 
+    // field id (in As::ScanDict::Properties) and data of a single element
+    using ElementData_t = QPair<int, QString>;
+    using GroupData_t   = QMap<QString, ElementData_t>;
+    using ScanData_t    = QMap<QString, GroupData_t>;
+
     // constructor and destructor
 
     Scan(QObject* parent = Q_NULLPTR);
@@ -48,8 +55,7 @@ class Scan : public QObject {
 
     // operators
 
-    const As::ScanDict::GroupElements_t operator[](const QString& key) const;
-    As::ScanDict::GroupElements_t& operator[](const QString& key);
+    const As::Scan::GroupData_t& operator[](const QString& key) const;
 
     // general set data methods
 
@@ -76,6 +82,8 @@ class Scan : public QObject {
     const QString format(const QString& section,
                          const QString& entry,
                          bool* ok = Q_NULLPTR) const;
+    int fieldId(const QString& section,
+                const QString& entry) const;
 
     const QString printDataSingle(const QString& section,
                                   const QString& entry) const;
@@ -123,9 +131,11 @@ class Scan : public QObject {
     qreal mcCandlishFactor() const;
     qreal m_mcCandlishFactor = 0.0; // move to private!
 
-    void createExtractedTableModel();
-    QStandardItemModel* extractedTableModel() const;
-    QStandardItemModel* m_extractedTableModel; // move to private!
+    // Formatted table of the extracted data, one column per data item
+    struct ExtractedTable {
+        QStringList headers;
+        QList<QStringList> columns; };
+    As::Scan::ExtractedTable extractedTable() const;
 
     // sidebar 'scan treatment' group
 
@@ -166,6 +176,37 @@ class Scan : public QObject {
     As::Scan::PeakFitType peakFitType() const;
     As::Scan::PeakFitType m_peakFitType = As::Scan::GaussFit; // move to private!
 
+    // calculated results stored in the columnar result table of the scan array
+
+    enum ResultType { MaxPeakInty, MaxPeakIntyErr,
+                      SumPeakInty, SumPeakIntyErr,
+                      PeakArea, PeakAreaErr,
+                      NormPeakArea, NormPeakAreaErr,
+                      StructFactor, StructFactorErr,
+                      FullWidthHalfMax, FullWidthHalfMaxErr,
+                      FlippingRatio, FlippingRatioErr, FlippingRatioSignificance,
+                      FitPeakArea, FitPeakAreaErr,
+                      FitPeakPosition, FitPeakPositionErr,
+                      FitFullWidthHalfMax, FitFullWidthHalfMaxErr,
+                      FitBkg, FitBkgErr,
+                      FitMixing, FitChiSquared };
+    Q_ENUM(ResultType)
+    static const QMap<As::Scan::ResultType, QString> ResultTypeDict;
+    static int resultColumn(const As::Scan::ResultType type,
+                            const QString& countType = "");
+    static QString resultName(const As::Scan::ResultType type,
+                              const QString& countType = "");
+    static int resultColumnCount();
+    void setResultTable(As::ResultTable* table,
+                        const int row);
+    As::ResultTable* resultTable() const;
+    int resultRow() const;
+    qreal result(const As::Scan::ResultType type,
+                 const QString& countType = "") const;
+    void setResult(const As::Scan::ResultType type,
+                   const QString& countType,
+                   const qreal value);
+
   public: // move to private!
 
     int m_numLeftSkipPoints;
@@ -176,18 +217,13 @@ class Scan : public QObject {
     int m_numPeakPoints;
 
     qreal m_normMeanBkg;
-    qreal m_fullWidthHalfMax, m_fullWidthHalfMaxErr;
-    qreal m_flippingRatio, m_flippingRatioErr;
     qreal m_peakPosition;
 
-    QMap<QString, qreal> m_maxPeakInty,  m_maxPeakIntyErr;
-    QMap<QString, qreal> m_sumPeakInty,  m_sumPeakIntyErr;
-    QMap<QString, qreal> m_peakArea,     m_peakAreaErr;
-    QMap<QString, qreal> m_normPeakArea, m_normPeakAreaErr;
-    QMap<QString, qreal> m_structFactor, m_structFactorErr;
-
   private:
-    As::ScanDict::PropertyGroups_t m_scan;
+    As::Scan::ScanData_t m_scan;
+
+    As::ResultTable* m_resultTable = Q_NULLPTR;
+    int m_resultRow = -1;
 
     // Forbid to copy and assign scans
     Scan(const As::Scan& other);
@@ -25,9 +25,12 @@
 #include "Constants.hpp"
 #include "Functions.hpp"
 #include "Macros.hpp"
+#include "Profiler.hpp"
 
+#include "ColumnarFile.hpp"
 #include "RealMatrix9.hpp"
 #include "RealVector.hpp"
+#include "ResultTable.hpp"
 #include "SaveHeaders.hpp"
 #include "Scan.hpp"
 #include "ScanDict.hpp"
@@ -48,13 +51,21 @@
     Constructs an empty array of the scans with the given \a parent.
 */
 As::ScanArray::ScanArray(QObject* parent)
-    : QObject(parent) {}
+    : QObject(parent) {
+
+    // Create one result column per result type and beam type
+    for (const auto type : As::Scan::ResultTypeDict.keys()) {
+        for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
+            const QString name = As::Scan::resultName(type, countType);
+            const QString format = As::ScanDict::Properties["calculations"][name]["format"];
+            m_results.appendColumn(name, format, As::ResultTable::RealColumn); } } }
 
 /*!
-    Destroys the array.
+    Destroys the array and all its scans.
 */
 As::ScanArray::~ScanArray() {
-    ADESTROYED; }
+    ADESTROYED;
+    qDeleteAll(m_scanArray); }
 
 /*!
     Returns a pointer to the modifiable As::Scan at index position \a i in the base
@@ -120,18 +131,32 @@ As::Scan* As::ScanArray::end() {
     return *m_scanArray.end(); }
 
 /*!
-    Inserts \a scan at the end of the array.
+    Inserts \a scan at the end of the array, which takes the ownership of it.
 */
 void As::ScanArray::append(As::Scan* scan) {
     m_scanArray.append(scan);
     const int i = m_scanArray.size();
-    scan->setData("number", "Scan", QString::number(i)); }
+    scan->setData("number", "Scan", QString::number(i));
+
+    // Attach the scan to the new row of the result table
+    m_results.setRowCount(i);
+    scan->setResultTable(&m_results, i - 1);
+
+    // The index is rebuilt after the scans are indexed
+    m_reflectionIndex.clear(); }
 
 /*!
-    Removes all the elements from the array.
+    Removes all the elements from the array and deletes them. The array owns its
+    scans, so that the long-running server does not keep every processed dataset.
 */
 void As::ScanArray::clear() {
-    m_scanArray.clear(); }
+    qDeleteAll(m_scanArray);
+    m_scanArray.clear();
+    m_results.setRowCount(0);
+    m_outputTable.clear();
+    m_repeatedMeasurements.clear();
+    m_reflectionIndex.clear();
+    m_reflectionIndexUb.clear(); }
 
 /*!
     Sets the index of the currently processed scan to be \a index.
@@ -180,6 +205,54 @@ void As::ScanArray::setFileIndexByScanIndex(const int index) {
 int As::ScanArray::fileIndex() const {
     return m_fileIndex; }
 
+/*!
+    Returns the rows of the output table to be exported. The rows of the excluded
+    scans are skipped, unless the export of the excluded scans is enabled in the
+    output settings.
+*/
+QVector<int> As::ScanArray::exportedRows() const {
+    const bool exportExcluded = QSettings().value("OutputSettings/exportExcluded", false).toBool();
+    const int indexOfExcluded = m_outputTable.columnIndex("Excluded");
+
+    QVector<int> rows;
+    rows.reserve(m_outputTable.rowCount());
+    for (int row = 0; row < m_outputTable.rowCount(); ++row) {
+        const bool isCurrentScanExcluded = indexOfExcluded >= 0 AND
+                                           qRound(m_outputTable.real(row, indexOfExcluded));
+        if (exportExcluded OR !isCurrentScanExcluded) {
+            rows << row; } }
+    return rows; }
+
+/*!
+    Returns the output table to be exported and its \a rows, i.e. exportedRows()
+    with the repeated measurements treated according to repeatPolicy().
+*/
+As::ResultTable As::ScanArray::exportedTable(QVector<int>& rows) const {
+    rows = exportedRows();
+    if (m_repeatPolicy == As::RepeatedMeasurements::KeepAll) {
+        return m_outputTable; }
+
+    // Found again, as the excluded scans might be exported or not since the table was created
+    As::RepeatedMeasurements repeats;
+    if (!repeats.group(m_outputTable, rows)) {
+        return m_outputTable; }
+
+    As::ResultTable table = m_outputTable;
+    rows = repeats.apply(table, rows, m_repeatPolicy);
+    return table; }
+
+/*!
+    Sets the \a policy of the export of the repeated measurements.
+*/
+void As::ScanArray::setRepeatPolicy(const As::RepeatedMeasurements::Policy policy) {
+    m_repeatPolicy = policy; }
+
+/*!
+    Returns the policy of the export of the repeated measurements.
+*/
+As::RepeatedMeasurements::Policy As::ScanArray::repeatPolicy() const {
+    return m_repeatPolicy; }
+
 /*!
     Sets the selected columns for the output \a table according to the given
     headers \a saveHeaders.
@@ -188,9 +261,6 @@ void As::ScanArray::setSelectedOutputColumns(As::SaveHeaders& saveHeaders,
                                              QString& table) {
     ADEBUG;
 
-    auto exportExcluded = QSettings().value("OutputSettings/exportExcluded", false).toBool();
-    int indexOfExcluded = m_outputTableHeaders.indexOf("Excluded");
-
     // Set the table headers
     if (saveHeaders.m_addHeader) {
         for (const QString& header : saveHeaders.m_name) {
@@ -198,42 +268,60 @@ void As::ScanArray::setSelectedOutputColumns(As::SaveHeaders& saveHeaders,
             table.append(As::FormatStringToText(header, saveHeaders.m_format[i])); }
         table.append("\n"); }
 
-    // Set the table data
-    for (const QStringList& row : m_outputTableData) {
-        const bool isCurrentScanExcluded = QString(row[indexOfExcluded]).toInt();
+    // Rows to be exported, with the repeated measurements treated
+    QVector<int> rows;
+    const As::ResultTable outputTable = exportedTable(rows);
+
+    // Find the output table columns once
+    QVector<int> columns;
+    for (const QString& header : saveHeaders.m_name) {
+        columns << outputTable.columnIndex(header); }
 
-        // Conditions to jump to the next row in the output table
-        if (!exportExcluded AND isCurrentScanExcluded) {
-            goto nextrow; }
+    // Set the table data
+    for (const int row : rows) {
 
         // Add data cell by cell. What if cell is empty?
-        for (const QString& header : saveHeaders.m_name) {
-            QString stringNum = "0"; // default value, if header is not found
+        for (int i = 0; i < columns.size(); ++i) {
+            const QString& format = saveHeaders.m_format[i];
+            const int column = columns[i];
 
-            if (m_outputTableHeaders.contains(header)) {
-                stringNum = row[m_outputTableHeaders.indexOf(header)]; }
+            // default value, if header is not found
+            if (column < 0) {
+                table.append(As::FormatString("0", format)); }
 
-            const QString format = saveHeaders.m_format[saveHeaders.m_name.indexOf(header)];
-            table.append(As::FormatString(stringNum, format)); }
+            // comma separated values are written with the precision of the table itself
+            else if (format.contains("csv")) {
+                table.append(As::FormatString(outputTable.printCell(row, column), format)); }
 
-        // Go to the new line
-        table.append("\n");
+            else {
+                table.append(outputTable.printCell(row, column, format)); } }
 
-nextrow: continue; } }
+        // Go to the new line
+        table.append("\n"); } }
 
 /*!
     Saves the selected columns for the output file \a fileName according to the
-    given \a filter.
+    given \a filter. The binary filter saves all the columns of the output table
+    in the As::ColumnarFile format.
 */
 void As::ScanArray::saveSelectedOutputColumns(const QString& fileName,
                                               const QString& filter) {
     ADEBUG;
 
+    As::ProfilerStage profilerStage("export");
+
+    if (filter.contains("binary", Qt::CaseInsensitive)) {
+        QVector<int> rows;
+        const As::ResultTable outputTable = exportedTable(rows);
+        if (As::ColumnarFile::save(fileName, outputTable, rows)) {
+            As::Profiler::instance().addCounter("export", "bytes written", QFileInfo(fileName).size()); }
+        return; }
+
     QFile file(fileName);
     file.open(QIODevice::WriteOnly);
 
     // Define structure for the columns to be saved
-    As::SaveHeaders saveHeaders(filter, m_outputTableHeaders);
+    As::SaveHeaders saveHeaders(filter, m_outputTable.headers());
 
     // Define a text variable to append the required info via text stream
     // Write down the table data to the text variable
@@ -242,6 +330,9 @@ void As::ScanArray::saveSelectedOutputColumns(const QString& fileName,
 
     QTextStream stream(&file);
     stream << table;
+    stream.flush();
+
+    As::Profiler::instance().addCounter("export", "bytes written", file.size());
 
     file.close(); }
 
@@ -0,0 +1,57 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Macros.hpp"
+
+#include "SessionCache.hpp"
+
+#include "ScanArray.hpp"
+
+/*!
+    Loads the session cache for the current input files and starts using it for the
+    detection and extraction. Returns true if the cache is valid for all the input
+    files, so that their contents are not needed for the data extraction.
+*/
+bool As::ScanArray::loadSessionCache() {
+    ADEBUG;
+
+    m_sessionCacheFilePath = As::SessionCache::defaultFilePath(m_inputFilesContents.first);
+    m_sessionCache.load(m_sessionCacheFilePath);
+
+    return isSessionCacheValid(); }
+
+/*!
+    Saves the session cache, if it is in use and was modified. Returns true on success.
+*/
+bool As::ScanArray::saveSessionCache() {
+    ADEBUG;
+
+    if (m_sessionCacheFilePath.isEmpty()) {
+        return true; }
+
+    return m_sessionCache.save(m_sessionCacheFilePath); }
+
+/*!
+    Returns true if the session cache is in use and valid for all the input files.
+*/
+bool As::ScanArray::isSessionCacheValid() const {
+    return !m_sessionCacheFilePath.isEmpty() AND
+           m_sessionCache.isValid(m_inputFilesContents.first); }
+
@@ -18,69 +18,146 @@
     along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <QFileInfo>
+#include <QLatin1String>
+#include <QMap>
+#include <QStringRef>
+
 #include "Constants.hpp"
 #include "Macros.hpp"
 
 #include "ScanArray.hpp"
 
-/*!
-    Returns true if the input file type is detected.
-*/
-bool As::ScanArray::detectInputFilesType() {
-    ADEBUG;
-
-    QList<QStringList> filesAsListOfStringLists;
+#include <QtConcurrent>
 
-    for (const QString fileAsString : m_inputFilesContents.second) {
-        filesAsListOfStringLists << fileAsString.split("\n"); }
+namespace {
 
-    // Go through all the files to get the list of all the opened file types
-    QList<As::InputFileType> detectedTypes;
+// How the signature is matched against a line of the input file
+enum SignatureMatch { StartsWith, EndsWith, Contains };
 
-    for (const QStringList& fileAsListOfStrings : filesAsListOfStringLists) {
-        As::InputFileType type = As::InputFileType(0);
+struct Signature {
+    const char* text;
+    SignatureMatch match;
+    As::InputFileType type; };
 
-        for (const QString& str : fileAsListOfStrings) {
+// Known signatures of the input file types, checked against every line in the given order
+const Signature SIGNATURES[] = {
+    { "### NICOS data file",                      StartsWith, As::NICOS_DAT },
+    { "4-CIRCLE DIFFRACTOMETER CONTROL PROGRAM",  EndsWith,   As::HEIDI_LOG },
+    { "Protocol ON",                              EndsWith,   As::HEIDI_LOG },
+    { "Rev HEIDI/FRM2",                           EndsWith,   As::HEIDI_DAT },
+    { "  => Now executing the cmd GEO",           StartsWith, As::POLI_LOG },
+    { "<manip>6T2</manip>",                       Contains,   As::S6T2_DAT } };
 
-            // Check the file content line by line
-            if (str.startsWith("### NICOS data file")) {
-                type = As::InputFileType::NICOS_DAT;
-                break; }
+// Facility, instrument and data type names of the input file types
+const QMap<As::InputFileType, QStringList> INPUT_FILE_TYPE_NAMES = {
+    { As::UNKNOWN_FILE, { "Unknown",   "Unknown", "Unknown" } },
+    { As::HEIDI_DAT,    { "MLZ/FRMII", "HEiDi",   "DIF4 dat" } },
+    { As::HEIDI_LOG,    { "MLZ/FRMII", "HEiDi",   "DIF4 log" } },
+    { As::NICOS_DAT,    { "MLZ/FRMII", "POLI",    "NICOS dat" } },
+    { As::POLI_LOG,     { "MLZ/FRMII", "POLI",    "IgorPro log" } },
+    { As::S6T2_DAT,     { "LLB",       "6T2",     "NEW xml" } } };
 
-            else if (str.endsWith("4-CIRCLE DIFFRACTOMETER CONTROL PROGRAM") || str.endsWith("Protocol ON")) {
-                type = As::InputFileType::HEIDI_LOG;
-                break; }
+} // namespace
 
-            else if (str.endsWith("Rev HEIDI/FRM2")) {
-                type = As::InputFileType::HEIDI_DAT;
-                break; }
+/*!
+    Returns true if the input file type is detected.
 
-            else if (str.startsWith("  => Now executing the cmd GEO")) {
-                type = As::InputFileType::POLI_LOG;
-                break; }
+    The files are checked in parallel, see detectFileType(). The type of every file
+    is then available via inputFilesTypes(). If the files of different types are
+    found, the type is set to unknown and false is returned.
+*/
+bool As::ScanArray::detectInputFilesType() {
+    ADEBUG;
 
-            else if (str.contains("<manip>6T2</manip>")) {
-                type = As::InputFileType::S6T2_DAT;
-                break; } }
+    // Take the type from the session cache, if none of the input files was changed
+    if (isSessionCacheValid()) {
+        m_inputFilesTypes.fill(m_sessionCache.inputFilesType(), m_inputFilesContents.first.size());
+        setInputFileType(m_sessionCache.inputFilesType());
+        return true; }
 
-        detectedTypes << type; }
+    // Go through all the files to get the list of all the opened file types
+    m_inputFilesTypes = QtConcurrent::blockingMapped<QVector<As::InputFileType>>(
+                m_inputFilesContents.second, &As::ScanArray::detectFileType);
 
-    // Get the size of the detectedTypes list converted to set and back to list in order to remove duplicates
-    int size = detectedTypes.toSet().toList().size();
+    // Get the number of different types
+    const QList<As::InputFileType> types = m_inputFilesTypes.toList().toSet().toList();
+    const int size = types.size();
 
-    // Set m_inputFilesType depends on the size of the detectedTypes list
+    // Set m_inputFilesType depends on the number of different types
     if (size == 0) {
         setInputFileType(As::InputFileType(0));
         return true; }
 
     else if (size == 1) {
-        setInputFileType(detectedTypes[0]);
+        setInputFileType(types[0]);
+        m_sessionCache.setInputFilesType(types[0]);
         return true; }
 
     else {
         setInputFileType(As::InputFileType(0));
         return false; } }
 
+/*!
+    Returns the type of the input file with the given \a content.
+
+    The content is streamed line by line without splitting it as a whole, and all the
+    known signatures are matched against every line. The detection stops at the first
+    line which matches any of them, so that usually only the file header is read.
+*/
+As::InputFileType As::ScanArray::detectFileType(const QString& content) {
+    const int length = content.size();
+    int from = 0;
+
+    while (from <= length) {
+        int to = content.indexOf('\n', from);
+        if (to < 0) {
+            to = length; }
+
+        const QStringRef line = content.midRef(from, to - from);
+
+        for (const Signature& signature : SIGNATURES) {
+            const QLatin1String text(signature.text);
+            const bool matched = (signature.match == StartsWith AND line.startsWith(text)) OR
+                                 (signature.match == EndsWith   AND line.endsWith(text)) OR
+                                 (signature.match == Contains   AND line.indexOf(text) >= 0);
+            if (matched) {
+                return signature.type; } }
+
+        from = to + 1; }
+
+    return As::InputFileType(0); }
+
+/*!
+    Returns the types of the input files detected by detectInputFilesType(), one per file.
+*/
+const QVector<As::InputFileType>& As::ScanArray::inputFilesTypes() const {
+    return m_inputFilesTypes; }
+
+/*!
+    Returns the human-readable list of the detected input file types. Every line
+    contains the type name and the names of the files of that type.
+*/
+QStringList As::ScanArray::inputFilesTypesReport() const {
+    QList<As::InputFileType> types;
+    QMap<As::InputFileType, QStringList> fileNames;
+
+    for (int i = 0; i < m_inputFilesTypes.size() AND i < m_inputFilesContents.first.size(); ++i) {
+        const As::InputFileType type = m_inputFilesTypes[i];
+        if (!types.contains(type)) {
+            types << type; }
+        fileNames[type] << QFileInfo(m_inputFilesContents.first[i]).fileName(); }
+
+    QStringList report;
+    for (const As::InputFileType type : types) {
+        const QStringList names = INPUT_FILE_TYPE_NAMES.value(type);
+        report << QString("%1 %2 (%3 files): %4")
+                  .arg(names[1]).arg(names[2])
+                  .arg(fileNames[type].size())
+                  .arg(fileNames[type].join(", ")); }
+
+    return report; }
+
 /*!
     Sets the input file type to be \a type.
 */
@@ -92,48 +169,13 @@ void As::ScanArray::setInputFileType(const As::InputFileType type) {
 
     m_inputFilesType = type;
 
-    switch (m_inputFilesType) {
-
-        case As::InputFileType::UNKNOWN_FILE:
-            m_facilityType = "Unknown";
-            m_instrumentType = "Unknown";
-            m_dataType = "Unknown";
-            break;
-
-        case As::InputFileType::HEIDI_DAT:
-            m_facilityType = "MLZ/FRMII";
-            m_instrumentType = "HEiDi";
-            m_dataType = "DIF4 dat";
-            break;
-
-        case As::InputFileType::HEIDI_LOG:
-            m_facilityType = "MLZ/FRMII";
-            m_instrumentType = "HEiDi";
-            m_dataType = "DIF4 log";
-            break;
-
-        case As::InputFileType::NICOS_DAT:
-            m_facilityType = "MLZ/FRMII";
-            m_instrumentType = "POLI";
-            m_dataType = "NICOS dat";
-            break;
-
-        case As::InputFileType::POLI_LOG:
-            m_facilityType = "MLZ/FRMII";
-            m_instrumentType = "POLI";
-            m_dataType = "IgorPro log";
-            break;
-
-        case As::InputFileType::S6T2_DAT:
-            m_facilityType = "LLB";
-            m_instrumentType = "6T2";
-            m_dataType = "NEW xml";
-            break; }
+    const QStringList names = INPUT_FILE_TYPE_NAMES.value(m_inputFilesType,
+                                                          INPUT_FILE_TYPE_NAMES.value(As::UNKNOWN_FILE));
+    m_facilityType   = names[0];
+    m_instrumentType = names[1];
+    m_dataType       = names[2];
 
     emit facilityTypeChanged(m_facilityType);
     emit instrumentTypeChanged(m_instrumentType);
     emit dataTypeChanged(m_dataType); }
 
-
-
-
@@ -30,12 +30,18 @@
 
 #include "RealVector.hpp"
 #include "Scan.hpp"
+#include "ScanDict.hpp"
 #include "StringParser.hpp"
 
 #include "ScanArray.hpp"
 
 /*!
-    ...
+    Extracts the scans from the input file with the given \a index and appends them to
+    the array.
+
+    If the session cache is in use, the scans of the unchanged file are restored from
+    the cache instead, while the newly extracted scans are stored there. The files have
+    to be extracted sequentially in order to keep the scans order.
 */
 void As::ScanArray::extractDataFromFile(const int index) {
     //ADEBUG_H2 << index;
@@ -43,6 +49,18 @@ void As::ScanArray::extractDataFromFile(const int index) {
     const QString& filePath    = m_inputFilesContents.first[index];
     const QString& fileContent = m_inputFilesContents.second[index];
 
+    const bool useSessionCache = !m_sessionCacheFilePath.isEmpty();
+
+    if (useSessionCache AND m_sessionCache.isValid(filePath)) {
+        for (As::Scan* scan : m_sessionCache.restoreScans(filePath, index)) {
+            append(scan); }
+        const QString cachedContent = m_sessionCache.content(filePath);
+        if (!cachedContent.isNull()) {
+            m_inputFilesContents.second[index] = cachedContent; }
+        return; }
+
+    const int firstScanIndex = size();
+
     switch (m_inputFilesType) {
 
         case UNKNOWN_FILE:
@@ -71,6 +89,11 @@ void As::ScanArray::extractDataFromFile(const int index) {
         default:
             ADEBUG << "Not implemented yet"; break; }
 
+    if (useSessionCache) {
+        // The 6T2 file content is reformatted during the extraction
+        const QString modifiedContent = m_inputFilesType == S6T2_DAT ?
+                                        m_inputFilesContents.second[index] : QString();
+        m_sessionCache.store(filePath, m_scanArray.mid(firstScanIndex), modifiedContent); }
 }
 
 /*!
@@ -141,10 +164,8 @@ void As::ScanArray::extractHeidiData(const int fileIndex,
             // Scandata group. Make own headers, as file has no any
             scan->setData("scandata", "headers", "Detector Monitor");
 
-            // Make a header map between the possible internal names and headers created above
-            QList<QStringList> headerMap;
-            headerMap.append({"intensities", "Detector", "Detector" });
-            headerMap.append({"intensities", "Monitor",  "Monitor" });
+            // Get a header map between the internal names and headers created above
+            const QList<QStringList> headerMap = As::ScanDict::FILE_HEADER_MAPS.value(As::HEIDI_DAT);
 
             // Define position of the data to be read
             const int nValuesPerLine = 16;
@@ -182,14 +203,8 @@ void As::ScanArray::extractHeidiLog(const int fileIndex,
                                     const QString& fileContent) {
     ADEBUG;
 
-    // Make a header map between the possible internal names and HEIDI log parameter names
-    QList<QStringList> headerMap;
-    headerMap.append({"angles",      "2Theta",          "2Theta" });
-    headerMap.append({"angles",      "Omega",           "Omega" });
-    headerMap.append({"angles",      "Phi",             "Phi" });
-    headerMap.append({"angles",      "Chi",             "Chi" });
-    headerMap.append({"intensities", "Detector",        "Idet" });
-    headerMap.append({"intensities", "Monitor",         "Imon" });
+    // Get a header map between the internal names and HEIDI log parameter names
+    const QList<QStringList> headerMap = As::ScanDict::FILE_HEADER_MAPS.value(As::HEIDI_LOG);
 
     const QRegExp re("[^-.0-9]");     // regular expression for the splitting: all characters but "-", ".", "0123456789"
     QStringList list;
@@ -299,39 +314,8 @@ void As::ScanArray::extractHeidiLog(const int fileIndex,
 void As::ScanArray::extractNicosData(const int fileIndex,
                                      const QString& filePath,
                                      const QString& fileContent) {
-    // Make a header map between the possible internal names and NICOS parameter names
-    QList<QStringList> headerMap;
-    headerMap.append({"angles",        "Chi1",          "chi1" });
-    headerMap.append({"angles",        "Chi2",          "chi2" });
-    headerMap.append({"angles",        "Gamma",         "gamma" });
-    headerMap.append({"angles",        "2Theta",        "twotheta" });
-    headerMap.append({"angles",        "Nu",            "liftingctr" });
-    headerMap.append({"angles",        "Omega",         "omega|sth" });
-    headerMap.append({"angles",        "Psi",           "psi_virtual" });
-    headerMap.append({"indices",       "H",             "h" });
-    headerMap.append({"indices",       "K",             "k" });
-    headerMap.append({"indices",       "L",             "l" });
-    headerMap.append({"conditions",    "Temperature",   "Ts" });
-    headerMap.append({"conditions",    "Magnetic field", "B" });
-    headerMap.append({"conditions",    "Electric field", "fug" });
-    headerMap.append({"conditions",    "Wavelength",    "wavelength" });
-    // Append additional possible header names to the header map (apriori not single numbers in the scan table)
-    headerMap.append({"conditions",    "Time/step",     "timer" });
-    headerMap.append({"conditions",    "Time/step(+)",  "timer_up" });
-    headerMap.append({"conditions",    "Time/step(-)",  "timer_dn" });
-    headerMap.append({"intensities",   "Detector",      "ctr1" });
-    headerMap.append({"intensities",   "Detector(+)",   "ctr1_up" });
-    headerMap.append({"intensities",   "Detector(-)",   "ctr1_dn" });
-    headerMap.append({"intensities",   "Monitor1",      "mon1" });
-    headerMap.append({"intensities",   "Monitor1(+)",   "mon1_up" });
-    headerMap.append({"intensities",   "Monitor1(-)",   "mon1_dn" });
-    headerMap.append({"intensities",   "Monitor2",      "mon2" });
-    headerMap.append({"intensities",   "Monitor2(+)",   "mon2_up" });
-    headerMap.append({"intensities",   "Monitor2(-)",   "mon2_dn" });
-    headerMap.append({"polarisation",  "Pin",           "Pin" });
-    headerMap.append({"polarisation",  "Pout",          "Pout" });
-    headerMap.append({"polarisation",  "Fin",           "Fin" });
-    headerMap.append({"polarisation",  "Fout",          "Fout" });
+    // Get a header map between the internal names and NICOS parameter names
+    const QList<QStringList> headerMap = As::ScanDict::FILE_HEADER_MAPS.value(As::NICOS_DAT);
 
     // Variables
     const QStringList file = fileContent.split("\n"); // every file content as a list of strings
@@ -416,29 +400,8 @@ void As::ScanArray::extract6t2Data(const int fileIndex,
                                    QString& fileContent) {
     ADEBUG;
 
-    // Make a header map between the possible internal names and 6T2 xml parameter names
-    QList<QStringList> headerMap;
-    headerMap.append({"indices",     "H",               "h" });
-    headerMap.append({"indices",     "K",               "k" });
-    headerMap.append({"indices",     "L",               "l" });
-    headerMap.append({"angles",      "Gamma",           "Gamma" });
-    headerMap.append({"angles",      "2Theta",          "theta2" });
-    headerMap.append({"angles",      "Nu",              "Nu" });
-    headerMap.append({"angles",      "Omega",           "Omega" });
-    headerMap.append({"angles",      "Phi",             "Phi" });
-    headerMap.append({"angles",      "Chi",             "Chi" });
-    headerMap.append({"conditions",  "Wavelength",      "wavelength" });
-    headerMap.append({"conditions",  "Temperature",     "Temperature" });
-    headerMap.append({"conditions",  "Magnetic field",  "magneticField" });
-    headerMap.append({"conditions",  "Time/step",       "totaltimecount" });
-    headerMap.append({"conditions",  "Time/step(+)",    "timeUp" });
-    headerMap.append({"conditions",  "Time/step(-)",    "timeDown" });
-    headerMap.append({"intensities", "Detector",        "counter" });
-    headerMap.append({"intensities", "Detector(+)",     "counterUp" });
-    headerMap.append({"intensities", "Detector(-)",     "counterDown" });
-    headerMap.append({"intensities", "Monitor",         "totalmonitorcount" });
-    headerMap.append({"intensities", "Monitor(+)",      "MonitorUpCount" });
-    headerMap.append({"intensities", "Monitor(-)",      "MonitorDownCount" });
+    // Get a header map between the internal names and 6T2 xml parameter names
+    const QList<QStringList> headerMap = As::ScanDict::FILE_HEADER_MAPS.value(As::S6T2_DAT);
 
     // Variables
     auto scan = new As::Scan; // scan to be added to the scan array
@@ -505,7 +468,7 @@ void As::ScanArray::extract6t2Data(const int fileIndex,
     provided list of headers \a headerMap.
 */
 void As::ScanArray::extractDataFromTable(As::Scan* scan,
-                                         QList<QStringList>& headerMap) {
+                                         const QList<QStringList>& headerMap) {
 
     // Make 2D map of the actually measured data from the single data string
     const QStringList dataList = scan->data("scandata", "data").split("\n");
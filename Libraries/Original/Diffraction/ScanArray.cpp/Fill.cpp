@@ -19,7 +19,6 @@
 */
 
 #include <QtConcurrent>
-#include <QStandardItemModel>
 #include <QString>
 #include <QStringList>
 
@@ -79,9 +78,7 @@ void As::ScanArray::fillMissingDataArray(const int index) {
                 scan->setData(group, element, list.join(" ")); } } }
 
     // All the reflections are considered to belong to just 1st group...
-    scan->setData("number", "Batch", "1");
-
-    scan->createExtractedTableModel(); }
+    scan->setData("number", "Batch", "1"); }
 
 /*!
     Sets the unpolarised neutron data based on the polarised neutron diffraction
@@ -95,7 +92,6 @@ void As::ScanArray::calcUnpolData(const QString& group,
     const QString typeUp   = As::ScanDict::BEAM_TYPES[As::ScanDict::POLARISED_UP];
     const QString typeDown = As::ScanDict::BEAM_TYPES[As::ScanDict::POLARISED_DOWN];
 
-    ADEBUG << (*scan)["intensities"]["Detector(+)"]["data"];
     ADEBUG << scan->data("intensities", "Detector(+)");
     ADEBUG << scan->data(group, element + typeUp);
     ADEBUG << scan->data(group, element + typeUp, &okUp) << okUp;
@@ -0,0 +1,115 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtMath>
+
+#include "Macros.hpp"
+
+#include "PeakFit.hpp"
+#include "RealVector.hpp"
+#include "Scan.hpp"
+#include "ScanDict.hpp"
+
+#include "ScanArray.hpp"
+
+/*!
+    Fits the peak profile of the given \a scan for every beam type, if the peak fit
+    analysis is selected for the scan; otherwise the fit results are reset.
+
+    The fit uses the non-skipped points and starts from the results of the conventional
+    integration: the mean background, the position of the maximum within the peak points
+    and the full width at half maximum. Every thread keeps its own As::PeakFit, so that
+    the scans are fitted in parallel without any memory allocation in the fit itself.
+    The results of the fit, which is not converged, are left NaN.
+*/
+void As::ScanArray::calcFittedPeak(As::Scan* scan) {
+    const QList<As::Scan::ResultType> fitResults = {
+        As::Scan::FitPeakArea, As::Scan::FitPeakAreaErr,
+        As::Scan::FitPeakPosition, As::Scan::FitPeakPositionErr,
+        As::Scan::FitFullWidthHalfMax, As::Scan::FitFullWidthHalfMaxErr,
+        As::Scan::FitBkg, As::Scan::FitBkgErr,
+        As::Scan::FitMixing, As::Scan::FitChiSquared };
+
+    for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
+        for (const auto type : fitResults) {
+            scan->setResult(type, countType, qQNaN()); } }
+
+    if (scan->peakAnalysisType() != As::Scan::PeakFit) {
+        return; }
+
+    static thread_local As::PeakFit peakFit;
+    peakFit.setFitType(scan->peakFitType());
+
+    const As::RealVector angle = scan->data("angles", scan->scanAngle());
+
+    // Fitted range: all the non-skipped points
+    const int from = scan->m_numLeftSkipPoints;
+    const int to   = scan->numPoints() - scan->m_numRightSkipPoints;
+    const int peakFrom = from + scan->m_numLeftBkgPoints;
+    const int peakTo   = to - scan->m_numRightBkgPoints;
+
+    if (to - from <= peakFit.parameterCount() OR peakTo <= peakFrom OR angle.size() < to) {
+        return; }
+
+    const QVector<qreal> x = angle.toQVector().mid(from, to - from);
+
+    for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
+        const As::RealVector detector  = scan->data("intensities", "DetectorNorm" + countType);
+        const As::RealVector sdetector = scan->data("intensities", "sDetectorNorm" + countType);
+
+        if (detector.size() < to) {
+            continue; }
+
+        const QVector<qreal> y  = detector.toQVector().mid(from, to - from);
+        const QVector<qreal> sy = sdetector.toQVector().mid(from, to - from);
+
+        // Start from the conventional integration results
+        qreal bkg = 0.;
+        for (int i = 0; i < scan->m_numLeftBkgPoints; ++i) {
+            bkg += y[i]; }
+        for (int i = y.size() - scan->m_numRightBkgPoints; i < y.size(); ++i) {
+            bkg += y[i]; }
+        bkg /= qMax(1, scan->m_numLeftBkgPoints + scan->m_numRightBkgPoints);
+
+        int iMax = peakFrom - from;
+        for (int i = peakFrom - from; i < peakTo - from; ++i) {
+            if (y[i] > y[iMax]) {
+                iMax = i; } }
+
+        qreal width = scan->result(As::Scan::FullWidthHalfMax);
+        if (qIsNaN(width) OR width <= 0.) {
+            width = 3. * qAbs(angle.step()); }
+
+        const QVector<qreal> start = { bkg, y[iMax] - bkg, x[iMax], width, 0.5 };
+
+        if (!peakFit.fit(x, y, sy, start)) {
+            continue; }
+
+        scan->setResult(As::Scan::FitPeakArea,            countType, peakFit.area());
+        scan->setResult(As::Scan::FitPeakAreaErr,         countType, peakFit.areaError());
+        scan->setResult(As::Scan::FitPeakPosition,        countType, peakFit.parameter(As::PeakFit::Position));
+        scan->setResult(As::Scan::FitPeakPositionErr,     countType, peakFit.error(As::PeakFit::Position));
+        scan->setResult(As::Scan::FitFullWidthHalfMax,    countType, peakFit.parameter(As::PeakFit::Width));
+        scan->setResult(As::Scan::FitFullWidthHalfMaxErr, countType, peakFit.error(As::PeakFit::Width));
+        scan->setResult(As::Scan::FitBkg,                 countType, peakFit.parameter(As::PeakFit::Background));
+        scan->setResult(As::Scan::FitBkgErr,              countType, peakFit.error(As::PeakFit::Background));
+        scan->setResult(As::Scan::FitMixing,              countType, peakFit.parameter(As::PeakFit::Mixing));
+        scan->setResult(As::Scan::FitChiSquared,          countType, peakFit.chiSquared()); } }
+
@@ -22,9 +22,12 @@
 
 #include "Macros.hpp"
 #include "Functions.hpp"
+#include "Profiler.hpp"
 
+#include "ConcurrentWatcher.hpp"
 #include "RealMatrix9.hpp"
 #include "RealVector.hpp"
+#include "ReflectionMerger.hpp"
 #include "Scan.hpp"
 
 #include "ScanArray.hpp"
@@ -108,6 +111,75 @@ void As::ScanArray::indexSinglePeak(const int index) {
     // Calc direction cosines
     calcDirectionCosines(scan); }
 
+/*!
+    Rebuilds the index of the scans by their Miller indices and, if the UB matrices
+    are known, by their reciprocal space coordinates. Called after the scans are
+    indexed, so that the index follows every reload of the data.
+*/
+void As::ScanArray::updateReflectionIndex() {
+    As::ProfilerStage profilerStage("reflection index");
+
+    const int count = size();
+    QVector<As::ReflectionIndex::Point> indices(count);
+    QVector<As::ReflectionIndex::Point> coordinates(count);
+    As::ReflectionIndex::Point* indicesData = indices.data();
+    As::ReflectionIndex::Point* coordinatesData = coordinates.data();
+
+    QVector<int> sequence(count);
+    for (int i = 0; i < count; ++i) {
+        sequence[i] = i; }
+
+    As::ConcurrentWatcher::blockingMap(sequence, [&] (const int i) {
+        const As::Scan* scan = at(i);
+        const qreal h = As::RealVector(scan->data("indices", "H")).mean();
+        const qreal k = As::RealVector(scan->data("indices", "K")).mean();
+        const qreal l = As::RealVector(scan->data("indices", "L")).mean();
+        indicesData[i] = {{ h, k, l }};
+        coordinatesData[i] = {{ qQNaN(), qQNaN(), qQNaN() }};
+
+        const QString ub = scan->data("orientation", "matrix");
+        if (!ub.isEmpty()) {
+            const As::RealVector xyz = hklToXyz(As::RealMatrix9(ub), h, k, l);
+            coordinatesData[i] = {{ xyz[0], xyz[1], xyz[2] }}; } });
+
+    m_reflectionIndexUb.clear();
+    for (int i = 0; i < count AND m_reflectionIndexUb.isEmpty(); ++i) {
+        m_reflectionIndexUb = at(i)->data("orientation", "matrix"); }
+
+    m_reflectionIndex.build(indices, coordinates);
+    As::Profiler::instance().addCounter("reflection index", "scans", count); }
+
+/*!
+    Returns the index of the scans by their Miller indices.
+*/
+const As::ReflectionIndex& As::ScanArray::reflectionIndex() const {
+    return m_reflectionIndex; }
+
+/*!
+    Returns the indices of the scans measured at the reflection \a h, \a k, \a l.
+    The integer indices are looked up in the hash. Otherwise, the scan nearest
+    in the reciprocal space within the \a tolerance is returned, if the UB matrix
+    is known.
+*/
+QVector<int> As::ScanArray::findScans(const qreal h,
+                                      const qreal k,
+                                      const qreal l,
+                                      const qreal tolerance) const {
+    int hi, ki, li;
+    if (As::ReflectionMerger::integerIndices(h, k, l, hi, ki, li)) {
+        const QVector<int> found = m_reflectionIndex.find(hi, ki, li);
+        if (!found.isEmpty()) {
+            return found; } }
+
+    if (!m_reflectionIndex.hasReciprocalCoordinates() OR m_reflectionIndexUb.isEmpty()) {
+        return QVector<int>(); }
+
+    const As::RealVector xyz = hklToXyz(As::RealMatrix9(m_reflectionIndexUb), h, k, l);
+    const int nearest = m_reflectionIndex.nearest({{ xyz[0], xyz[1], xyz[2] }}, tolerance);
+    if (nearest < 0) {
+        return QVector<int>(); }
+    return QVector<int>{ nearest }; }
+
 /*!
     Returns the calculated reciprocal lattice vectors \e x, \e y, \e z from the
     given wavelength \a wavelength and scattering angles \a gamma, \a nu, \a omega
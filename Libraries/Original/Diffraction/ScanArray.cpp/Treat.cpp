@@ -1,17 +1,29 @@
 #include <QDateTime>
+#include <QSet>
 #include <QtConcurrent>
 #include <QtMath>
 
+#include <algorithm>
+
 #include "Constants.hpp"
 #include "Functions.hpp"
 #include "Macros.hpp"
+#include "Profiler.hpp"
 
 #include "Line.hpp"
 #include "RealVector.hpp"
+#include "ResultTable.hpp"
 #include "Scan.hpp"
+#include "ScanDict.hpp"
 
 #include "ScanArray.hpp"
 
+namespace {
+
+// Groups shown in the output table. Their order is preserved
+const QStringList OUTPUT_GROUPS = { "number", "indices", "calculations",
+                                    "angles", "cosines", "conditions" }; }
+
 /*!
     Treats the data preliminary for the single scan at \a index in the scan array.
 */
@@ -39,43 +51,123 @@ void As::ScanArray::treatSinglePeak(const int index) {
     calcStructFactor(scan);
     calcFullWidthHalfMax(scan);
     calcFlippingRatio(scan);
+    calcFittedPeak(scan);
 
     if (scan->plotType() != As::PlotType::Excluded) {
-        scan->setPlotType(As::PlotType::Integrated); } }
+        scan->setPlotType(scan->peakAnalysisType() == As::Scan::PeakFit ? As::PlotType::Fitted :
+                                                                          As::PlotType::Integrated); } }
 
 /*!
     Creates the full output table with all the processed parameters.
+
+    The calculated results are taken from the result table as whole columns without
+    any conversion, the other parameters are converted once to the typed cells:
+    numbers are averaged over the scan points, all the rest is kept as text.
+
+    Only the results available for any of the scans are shown, unless
+    \a allResultColumns is true. The latter keeps the columns of the shards of
+    the same dataset alike, whatever scans they contain.
 */
-void As::ScanArray::createFullOutputTable() {
+void As::ScanArray::createFullOutputTable(const bool allResultColumns) {
     ADEBUG;
 
-    // Set the groups to be shown in the output table. Their order is preserved.
-    // Group elements (subitems) are sorted automatically by QMap in alphabetic order
-    // of their string keys
-    const QStringList itemKeys = {"number", "indices", "calculations",
-                                  "angles", "cosines", "conditions" };
-
-    // Make a map (headerMap) and list (m_outputTableHeaders) of the actually measured headers
-    // from the 1st scan: m_scanArray.at(0)
-    m_outputTableHeaders = QStringList();
-    QMap<QString, QStringList> headerMap;
-    for (const auto& itemKey : itemKeys) {
-        const QStringList subitemKeys = (*m_scanArray.at(0))[itemKey].keys();
-        m_outputTableHeaders.append(subitemKeys);
-        headerMap.insert(itemKey, subitemKeys); }
-
-    // Make a table of the calculated values according to the headerMap for all the peaks
-    m_outputTableData = QList<QStringList>();
-    for (const auto scan : m_scanArray) {
-        QStringList dataRow;
-        int j = 0;
-        for (const auto& itemKey : itemKeys)
-            for (const auto& subitemKey : headerMap[itemKey]) {
-                dataRow.insert(j++, scan->printDataSingle(itemKey, subitemKey)); }
-        m_outputTableData << dataRow; }
+    As::ProfilerStage profilerStage("table");
+
+    m_outputTable.clear();
+
+    if (m_scanArray.isEmpty()) {
+        return; }
+
+    m_outputTable.setRowCount(m_scanArray.size());
+
+    // Calculated results actually available for any of the scans, e.g. the fit of the 1st one may fail
+    QMap<QString, int> resultColumns;
+    for (int column = 0; column < As::Scan::resultColumnCount(); ++column) {
+        const QVector<qreal>& values = m_results.realColumn(column);
+        if (allResultColumns OR
+            std::any_of(values.constBegin(), values.constEnd(), [](const qreal value) { return !qIsNaN(value); })) {
+            resultColumns.insert(m_results.headers().at(column), column); } }
+
+    // Group elements (subitems) are sorted in alphabetic order of their string keys
+    for (const auto& itemKey : OUTPUT_GROUPS) {
+
+        // Actually measured headers of all the scans
+        QSet<QString> measuredKeys;
+        for (const As::Scan* scan : m_scanArray) {
+            const As::Scan::GroupData_t& group = (*scan)[itemKey];
+            for (auto it = group.constBegin(); it != group.constEnd(); ++it) {
+                measuredKeys.insert(it.key()); } }
+        if (itemKey == "calculations") {
+            measuredKeys.unite(resultColumns.keys().toSet()); }
+        QStringList subitemKeys = measuredKeys.toList();
+        subitemKeys.sort();
+
+        for (const auto& subitemKey : subitemKeys) {
+            const QString format = As::ScanDict::Properties[itemKey][subitemKey]["format"];
+
+            // Calculated results: share the whole column
+            if (itemKey == "calculations" AND resultColumns.contains(subitemKey)) {
+                m_outputTable.appendColumn(subitemKey, format, m_results.realColumn(resultColumns[subitemKey]));
+                continue; }
+
+            // Measured parameters: convert every scan once
+            const bool isNumber = !format.contains("dd") AND !format.contains("s") AND
+                                  (format.contains("f") OR format.contains("i"));
+            const int column = m_outputTable.appendColumn(subitemKey, format,
+                                                          isNumber ? As::ResultTable::RealColumn :
+                                                                     As::ResultTable::TextColumn);
+
+            for (int row = 0; row < m_scanArray.size(); ++row) {
+                const QString data = m_scanArray.at(row)->data(itemKey, subitemKey);
+                if (data.isEmpty()) {
+                    continue; }
+                if (isNumber) {
+                    m_outputTable.setReal(row, column, As::RealVector(data).mean()); }
+                else {
+                    m_outputTable.setText(row, column, data); } } } }
+
+    linkRepeatedMeasurements();
+
+    As::Profiler::instance().addCounter("table", "rows", m_outputTable.rowCount());
+    As::Profiler::instance().addCounter("table", "columns", m_outputTable.columnCount());
 
     ADEBUG; }
 
+/*!
+    Returns the given column \a names in the order of the output table created by
+    createFullOutputTable(): by the groups, and alphabetically within a group.
+    The names out of these groups are kept in their order at the end.
+*/
+QStringList As::ScanArray::outputColumnOrder(const QStringList& names) {
+    auto groupIndex = [](const QString& name) {
+        for (int i = 0; i < OUTPUT_GROUPS.size(); ++i) {
+            if (As::ScanDict::Properties[OUTPUT_GROUPS.at(i)].contains(name)) {
+                return i; } }
+        return OUTPUT_GROUPS.size(); };
+
+    QStringList ordered = names;
+    std::stable_sort(ordered.begin(), ordered.end(), [&groupIndex](const QString& a, const QString& b) {
+        const int groupA = groupIndex(a);
+        const int groupB = groupIndex(b);
+        if (groupA != groupB) {
+            return groupA < groupB; }
+        return groupA < OUTPUT_GROUPS.size() AND a < b; });
+    return ordered; }
+
+/*!
+    Finds the repeated measurements among the exported rows of the output table
+    and links them by the columns \c Repeat and \c Repeats.
+*/
+void As::ScanArray::linkRepeatedMeasurements() {
+    if (m_repeatedMeasurements.group(m_outputTable, exportedRows())) {
+        m_repeatedMeasurements.link(m_outputTable); } }
+
+/*!
+    Returns the repeated measurements found by linkRepeatedMeasurements().
+*/
+const As::RepeatedMeasurements& As::ScanArray::repeatedMeasurements() const {
+    return m_repeatedMeasurements; }
+
 /*!
     Defines the polarisation cross-section for the given \a scan.
 */
@@ -393,12 +485,8 @@ void As::ScanArray::calcMaxPeakInty(As::Scan* scan) {
         if (detector.isEmpty()) {
             continue; }
 
-        scan->m_maxPeakInty[countType]    = detector.max();
-        scan->m_maxPeakIntyErr[countType] = sdetector.max();
-
-        // Set data for the auto appearance in the output table
-        scan->setData("calculations", "IntMax" + countType, QString::number(scan->m_maxPeakInty[countType]));
-        scan->setData("calculations", "IntMaxErr" + countType, QString::number(scan->m_maxPeakIntyErr[countType])); } }
+        scan->setResult(As::Scan::MaxPeakInty,    countType, detector.max());
+        scan->setResult(As::Scan::MaxPeakIntyErr, countType, sdetector.max()); } }
 
 /*!
     Calculates the sum of all the peak point intensities of the given \a scan.
@@ -418,12 +506,8 @@ void As::ScanArray::calcSumPeakInty(As::Scan* scan) {
                                                         scan->m_numLeftSkipPoints,
                                                         scan->m_numRightSkipPoints,
                                                         scan->mcCandlishFactor());
-        scan->m_sumPeakInty[countType]    = intyWithSig[0];
-        scan->m_sumPeakIntyErr[countType] = intyWithSig[1];
-
-        // Set data for the auto appearance in the output table
-        scan->setData("calculations", "IntSum" + countType, QString::number(scan->m_sumPeakInty[countType]));
-        scan->setData("calculations", "IntSumErr" + countType, QString::number(scan->m_sumPeakIntyErr[countType])); } }
+        scan->setResult(As::Scan::SumPeakInty,    countType, intyWithSig[0]);
+        scan->setResult(As::Scan::SumPeakIntyErr, countType, intyWithSig[1]); } }
 
 /*!
     Calculates the peak area of the given \a scan.
@@ -433,12 +517,10 @@ void As::ScanArray::calcPeakArea(As::Scan* scan) {
     const qreal step = angle.step();
 
     for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
-        if (!qIsNaN(scan->m_sumPeakInty[countType])) {
-            scan->m_peakArea[countType]    = scan->m_sumPeakInty[countType]    * step;
-            scan->m_peakAreaErr[countType] = scan->m_sumPeakIntyErr[countType] * step;
-            // Set data for the auto appearance in the output table
-            scan->setData("calculations", "Area" + countType, QString::number(scan->m_peakArea[countType]));
-            scan->setData("calculations", "AreaErr" + countType, QString::number(scan->m_peakAreaErr[countType])); } } }
+        const qreal sumPeakInty = scan->result(As::Scan::SumPeakInty, countType);
+        if (!qIsNaN(sumPeakInty)) {
+            scan->setResult(As::Scan::PeakArea,    countType, sumPeakInty * step);
+            scan->setResult(As::Scan::PeakAreaErr, countType, scan->result(As::Scan::SumPeakIntyErr, countType) * step); } } }
 
 /*!
     Calculates the normalised peak area of the given \a scan.
@@ -455,12 +537,10 @@ void As::ScanArray::calcNormPeakArea(As::Scan* scan) {
     const qreal normalizer = As::ScanDict::DEFAULT_MONITOR / monitorMean;
 
     for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
-        if (!qIsNaN(scan->m_peakArea[countType])) {
-            scan->m_normPeakArea[countType]    = scan->m_peakArea[countType]    * normalizer;
-            scan->m_normPeakAreaErr[countType] = scan->m_peakAreaErr[countType] * normalizer;
-            // Set data for the auto appearance in the output table
-            scan->setData("calculations", "AreaNorm" + countType, QString::number(scan->m_normPeakArea[countType]));
-            scan->setData("calculations", "AreaNormErr" + countType, QString::number(scan->m_normPeakAreaErr[countType])); } }
+        const qreal peakArea = scan->result(As::Scan::PeakArea, countType);
+        if (!qIsNaN(peakArea)) {
+            scan->setResult(As::Scan::NormPeakArea,    countType, peakArea * normalizer);
+            scan->setResult(As::Scan::NormPeakAreaErr, countType, scan->result(As::Scan::PeakAreaErr, countType) * normalizer); } }
     //}
 }
 
@@ -493,12 +573,10 @@ void As::ScanArray::calcStructFactor(As::Scan* scan) {
     //    qFatal("%s: unknown Lorentz correction input", __FUNCTION__);
 
     for (const QString& countType : As::ScanDict::BEAM_TYPES.values()) {
-        if (!qIsNaN(scan->m_normPeakArea[countType])) {
-            scan->m_structFactor[countType]    = scan->m_normPeakArea[countType]    * correction;
-            scan->m_structFactorErr[countType] = scan->m_normPeakAreaErr[countType] * correction;
-            // Set data for the auto appearance in the output table
-            scan->setData("calculations", "Sf2" + countType, QString::number(scan->m_structFactor[countType]));
-            scan->setData("calculations", "Sf2Err" + countType, QString::number(scan->m_structFactorErr[countType])); } } }
+        const qreal normPeakArea = scan->result(As::Scan::NormPeakArea, countType);
+        if (!qIsNaN(normPeakArea)) {
+            scan->setResult(As::Scan::StructFactor,    countType, normPeakArea * correction);
+            scan->setResult(As::Scan::StructFactorErr, countType, scan->result(As::Scan::NormPeakAreaErr, countType) * correction); } } }
 
 /*!
     Calculates the full width at half maximum (FWHM) of the given \a scan.
@@ -567,13 +645,9 @@ void As::ScanArray::calcFullWidthHalfMax(As::Scan* scan) {
     const As::Line right(xR1, yR1, xR2, yR2, sxR1, syR1, sxR2, syR2);
 
     // Full width at half maximum (Fwhm) and its estimated standard deviation
-    scan->m_fullWidthHalfMax    = qAbs(right.xForY(yHM) - left.xForY(yHM));
-    scan->m_fullWidthHalfMaxErr = qSqrt(As::Sqr(left.esdXForY(yHM, left.esdYForY(yHM))) +
-                                        As::Sqr(right.esdXForY(yHM, right.esdYForY(yHM))));
-
-    // Set data for the auto appearance in the output table
-    scan->setData("calculations", "Fwhm",  QString::number(scan->m_fullWidthHalfMax));
-    scan->setData("calculations", "FwhmErr", QString::number(scan->m_fullWidthHalfMaxErr)); }
+    scan->setResult(As::Scan::FullWidthHalfMax,    "", qAbs(right.xForY(yHM) - left.xForY(yHM)));
+    scan->setResult(As::Scan::FullWidthHalfMaxErr, "", qSqrt(As::Sqr(left.esdXForY(yHM, left.esdYForY(yHM))) +
+                                                             As::Sqr(right.esdXForY(yHM, right.esdYForY(yHM))))); }
 
 /*!
     Calculates the flipping ratio of the given \a scan.
@@ -581,29 +655,28 @@ void As::ScanArray::calcFullWidthHalfMax(As::Scan* scan) {
 void As::ScanArray::calcFlippingRatio(As::Scan* scan) {
     // Check if all the countTypes are defined
     for (const QString& countType : As::ScanDict::BEAM_TYPES.values())
-        if (qIsNaN(scan->m_structFactor[countType])) {
+        if (qIsNaN(scan->result(As::Scan::StructFactor, countType))) {
             return; }
 
     // Get structure factors of the up(-) and down(-) polarised data
     const QString typeUp   = As::ScanDict::BEAM_TYPES[As::ScanDict::POLARISED_UP];
     const QString typeDown = As::ScanDict::BEAM_TYPES[As::ScanDict::POLARISED_DOWN];
-    const qreal plus     = scan->m_structFactor[typeUp];
-    const qreal minus    = scan->m_structFactor[typeDown];
-    const qreal sigPlus  = scan->m_structFactorErr[typeUp];
-    const qreal sigMinus = scan->m_structFactorErr[typeDown];
+    const qreal plus     = scan->result(As::Scan::StructFactor,    typeUp);
+    const qreal minus    = scan->result(As::Scan::StructFactor,    typeDown);
+    const qreal sigPlus  = scan->result(As::Scan::StructFactorErr, typeUp);
+    const qreal sigMinus = scan->result(As::Scan::StructFactorErr, typeDown);
 
     // Calc flipping ratio
-    scan->m_flippingRatio    = plus / minus;
-    scan->m_flippingRatioErr = qSqrt(As::Sqr(1 / minus * sigPlus) +
-                                     As::Sqr(-plus / As::Sqr(minus) * sigMinus));
-    qreal significance = qAbs(scan->m_flippingRatio - 1) / scan->m_flippingRatioErr;
-    if (scan->m_flippingRatio < 0) {
+    const qreal flippingRatio    = plus / minus;
+    const qreal flippingRatioErr = qSqrt(As::Sqr(1 / minus * sigPlus) +
+                                         As::Sqr(-plus / As::Sqr(minus) * sigMinus));
+    qreal significance = qAbs(flippingRatio - 1) / flippingRatioErr;
+    if (flippingRatio < 0) {
         significance *= -1; }
 
-    // Set data for the auto appearance in the output table
-    scan->setData("calculations", "FR",           QString::number(scan->m_flippingRatio));
-    scan->setData("calculations", "FRerr",        QString::number(scan->m_flippingRatioErr));
-    scan->setData("calculations", "|FR-1|/FRerr", QString::number(significance)); }
+    scan->setResult(As::Scan::FlippingRatio,             "", flippingRatio);
+    scan->setResult(As::Scan::FlippingRatioErr,          "", flippingRatioErr);
+    scan->setResult(As::Scan::FlippingRatioSignificance, "", significance); }
 
 /*!
     \fn void As::ScanArray::facilityTypeChanged(const QString &type)
@@ -26,6 +26,11 @@
 
 #include "Constants.hpp"
 
+#include "ReflectionIndex.hpp"
+#include "RepeatedMeasurements.hpp"
+#include "ResultTable.hpp"
+#include "SessionCache.hpp"
+
 class QString;
 class QStringList;
 template<typename> class QFutureWatcher;
@@ -64,13 +69,25 @@ class ScanArray : public QObject {
     int scanIndex() const;
     int fileIndex() const;
 
+    QVector<int> exportedRows() const;
+    As::ResultTable exportedTable(QVector<int>& rows) const;
+    void setRepeatPolicy(const As::RepeatedMeasurements::Policy policy);
+    As::RepeatedMeasurements::Policy repeatPolicy() const;
     void setSelectedOutputColumns(As::SaveHeaders& saveHeaders,
                                   QString& table);
     void saveSelectedOutputColumns(const QString& fileName,
                                    const QString& filter);
 
+    // ScanArray.cpp/Cache.cpp
+    bool loadSessionCache();
+    bool saveSessionCache();
+    bool isSessionCacheValid() const;
+
     // ScanArray.cpp/Detect.cpp
     bool detectInputFilesType();
+    static As::InputFileType detectFileType(const QString& content);
+    const QVector<As::InputFileType>& inputFilesTypes() const;
+    QStringList inputFilesTypesReport() const;
 
     // ScanArray.cpp/Extract.cpp
     void extractDataFromFile(const int index);
@@ -78,13 +95,42 @@ class ScanArray : public QObject {
     // ScanArray.cpp/Fill.cpp
     void fillMissingDataArray(const int index);
 
+    // ScanArray.cpp/Fit.cpp
+    void calcFittedPeak(As::Scan* scan);
+
     // ScanArray.cpp/Index.cpp
     void indexSinglePeak(const int index);
+    const As::RealVector hklToXyz(const As::RealMatrix9& ub,
+                                  const qreal h,
+                                  const qreal k,
+                                  const qreal l) const;
+    const As::RealVector xyzToAngles(const qreal wavelength,
+                                     const qreal x,
+                                     const qreal y,
+                                     const qreal z,
+                                     qreal psi) const;
+    void updateReflectionIndex();
+    const As::ReflectionIndex& reflectionIndex() const;
+    QVector<int> findScans(const qreal h,
+                           const qreal k,
+                           const qreal l,
+                           const qreal tolerance = As::ReflectionIndex::DEFAULT_TOLERANCE) const;
 
     // ScanArray.cpp/Treat.cpp
     void preTreatSinglePeak(const int index);
     void treatSinglePeak(const int index);
-    void createFullOutputTable();
+    void findNonPeakPoints(As::Scan* scan);
+    As::RealVector IntensityWithSigma(const As::RealVector& intensities,
+                                      const As::RealVector& sigmas,
+                                      const int numLeftBkgPoints,
+                                      const int numRightBkgPoints,
+                                      const int numLeftSkipPoints,
+                                      const int numRightSkipPoints,
+                                      const qreal mcCandlishFactor);
+    void createFullOutputTable(const bool allResultColumns = false);
+    static QStringList outputColumnOrder(const QStringList& names);
+    void linkRepeatedMeasurements();
+    const As::RepeatedMeasurements& repeatedMeasurements() const;
 
   public slots:
 
@@ -117,8 +163,8 @@ class ScanArray : public QObject {
 
     As::InputFileType m_inputFilesType = As::InputFileType(0); // Type of input file
 
-    QStringList m_outputTableHeaders;       // Headers of the output table
-    QList<QStringList> m_outputTableData;   // Output table data
+    As::ResultTable m_results;      // Calculated results: one row per scan, one column per result type and beam type
+    As::ResultTable m_outputTable;  // Full output table
 
 
   private:
@@ -128,6 +174,17 @@ class ScanArray : public QObject {
     int m_scanIndex = 0; // Index of the currently processed scan
     int m_fileIndex = 0; // Index of the file which contains the currently processed scan
 
+    QVector<As::InputFileType> m_inputFilesTypes; // Detected types of the individual input files
+
+    As::SessionCache m_sessionCache;    // Cache of the scans extracted from the unchanged input files
+    QString m_sessionCacheFilePath;     // Path of the cache file, empty if the cache is not in use
+
+    As::ReflectionIndex m_reflectionIndex;  // Scans by their Miller indices, built after the indexing
+    QString m_reflectionIndexUb;            // UB matrix used to search the non-integer indices
+
+    As::RepeatedMeasurements m_repeatedMeasurements;    // Repeats linked in the output table
+    As::RepeatedMeasurements::Policy m_repeatPolicy = As::RepeatedMeasurements::KeepAll; // Export of the repeats
+
     // Forbid to copy and assign scan array
     ScanArray(const As::ScanArray& other);
     As::ScanArray& operator=(const As::ScanArray& other);
@@ -152,7 +209,7 @@ class ScanArray : public QObject {
                         QString& fileContent);
     // Common methods
     void extractDataFromTable(As::Scan* scan,
-                              QList<QStringList>& headerMap);
+                              const QList<QStringList>& headerMap);
     void appendScan(As::Scan* scan);
 
 
@@ -178,15 +235,6 @@ class ScanArray : public QObject {
                                   const qreal x,
                                   const qreal y,
                                   const qreal z) const;
-    const As::RealVector hklToXyz(const As::RealMatrix9& ub,
-                                  const qreal h,
-                                  const qreal k,
-                                  const qreal l) const;
-    const As::RealVector xyzToAngles(const qreal wavelength,
-                                     const qreal x,
-                                     const qreal y,
-                                     const qreal z,
-                                     qreal psi) const;
     const As::RealVector directionCosines(const As::RealMatrix9& ub,
                                           qreal twotheta,
                                           qreal omega,
@@ -203,7 +251,6 @@ class ScanArray : public QObject {
     // ScanArray.cpp/Treat.cpp
     void definePolarisationCrossSection(As::Scan* scan);
     void normalizeByTime(As::Scan* scan);
-    void findNonPeakPoints(As::Scan* scan);
     void adjustBkgPoints(As::Scan* scan);
 
     void calcEsd(As::Scan* scan);
@@ -218,13 +265,6 @@ class ScanArray : public QObject {
 
     qreal lorentzCorrectionFactor(const qreal gammaMean,
                                   const qreal nuMean = 0.);
-    As::RealVector IntensityWithSigma(const As::RealVector& intensities,
-                                      const As::RealVector& sigmas,
-                                      const int numLeftBkgPoints,
-                                      const int numRightBkgPoints,
-                                      const int numLeftSkipPoints,
-                                      const int numRightSkipPoints,
-                                      const qreal mcCandlishFactor);
 
 };
 
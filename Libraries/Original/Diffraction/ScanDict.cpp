@@ -52,6 +52,12 @@
     Synonym for QMap<QString, GroupElements_t>.
 */
 
+/*!
+    \typedef As::ScanDict::FieldIds_t
+
+    Synonym for QMap<QString, QMap<QString, int>>.
+*/
+
 /*!
     \variable As::ScanDict::MIN_DATA_POINTS
     \brief the minimum number of data points in the measured scan.
@@ -124,6 +130,80 @@ const QMap<int, QString> As::ScanDict::BEAM_TYPES = {
     { As::ScanDict::POLARISED_UP,    "(+)" },
     { As::ScanDict::POLARISED_DOWN,  "(-)" } };
 
+/*!
+    \variable As::ScanDict::FILE_HEADER_MAPS
+    \brief the header maps between the internal names and the parameter names used
+    in the input files, depending on the input file type.
+
+    Every row of the map contains the group name, the element name and the parameter
+    name in the file. Alternative parameter names are separated by "|".
+*/
+const QMap<int, QList<QStringList>> As::ScanDict::FILE_HEADER_MAPS {
+    { As::HEIDI_DAT, {
+          { "intensities",   "Detector",        "Detector" },
+          { "intensities",   "Monitor",         "Monitor" } } },
+    { As::HEIDI_LOG, {
+          { "angles",        "2Theta",          "2Theta" },
+          { "angles",        "Omega",           "Omega" },
+          { "angles",        "Phi",             "Phi" },
+          { "angles",        "Chi",             "Chi" },
+          { "intensities",   "Detector",        "Idet" },
+          { "intensities",   "Monitor",         "Imon" } } },
+    { As::NICOS_DAT, {
+          { "angles",        "Chi1",            "chi1" },
+          { "angles",        "Chi2",            "chi2" },
+          { "angles",        "Gamma",           "gamma" },
+          { "angles",        "2Theta",          "twotheta" },
+          { "angles",        "Nu",              "liftingctr" },
+          { "angles",        "Omega",           "omega|sth" },
+          { "angles",        "Psi",             "psi_virtual" },
+          { "indices",       "H",               "h" },
+          { "indices",       "K",               "k" },
+          { "indices",       "L",               "l" },
+          { "conditions",    "Temperature",     "Ts" },
+          { "conditions",    "Magnetic field",  "B" },
+          { "conditions",    "Electric field",  "fug" },
+          { "conditions",    "Wavelength",      "wavelength" },
+          // Additional possible header names (apriori not single numbers in the scan table)
+          { "conditions",    "Time/step",       "timer" },
+          { "conditions",    "Time/step(+)",    "timer_up" },
+          { "conditions",    "Time/step(-)",    "timer_dn" },
+          { "intensities",   "Detector",        "ctr1" },
+          { "intensities",   "Detector(+)",     "ctr1_up" },
+          { "intensities",   "Detector(-)",     "ctr1_dn" },
+          { "intensities",   "Monitor1",        "mon1" },
+          { "intensities",   "Monitor1(+)",     "mon1_up" },
+          { "intensities",   "Monitor1(-)",     "mon1_dn" },
+          { "intensities",   "Monitor2",        "mon2" },
+          { "intensities",   "Monitor2(+)",     "mon2_up" },
+          { "intensities",   "Monitor2(-)",     "mon2_dn" },
+          { "polarisation",  "Pin",             "Pin" },
+          { "polarisation",  "Pout",            "Pout" },
+          { "polarisation",  "Fin",             "Fin" },
+          { "polarisation",  "Fout",            "Fout" } } },
+    { As::S6T2_DAT, {
+          { "indices",       "H",               "h" },
+          { "indices",       "K",               "k" },
+          { "indices",       "L",               "l" },
+          { "angles",        "Gamma",           "Gamma" },
+          { "angles",        "2Theta",          "theta2" },
+          { "angles",        "Nu",              "Nu" },
+          { "angles",        "Omega",           "Omega" },
+          { "angles",        "Phi",             "Phi" },
+          { "angles",        "Chi",             "Chi" },
+          { "conditions",    "Wavelength",      "wavelength" },
+          { "conditions",    "Temperature",     "Temperature" },
+          { "conditions",    "Magnetic field",  "magneticField" },
+          { "conditions",    "Time/step",       "totaltimecount" },
+          { "conditions",    "Time/step(+)",    "timeUp" },
+          { "conditions",    "Time/step(-)",    "timeDown" },
+          { "intensities",   "Detector",        "counter" },
+          { "intensities",   "Detector(+)",     "counterUp" },
+          { "intensities",   "Detector(-)",     "counterDown" },
+          { "intensities",   "Monitor",         "totalmonitorcount" },
+          { "intensities",   "Monitor(+)",      "MonitorUpCount" },
+          { "intensities",   "Monitor(-)",      "MonitorDownCount" } } } };
+
 /*!
     Constructs the dictionary.
 */
@@ -282,7 +362,17 @@ As::ScanDict::ScanDict()  {
         set("AreaNorm" + t,    "0.2f", "arb.units", "Normalised integrated intensity");
         set("AreaNormErr" + t, "0.2f", "arb.units", "ESD Normalised integrated intensity");
         set("Sf2" + t,         "0.2f", "arb.units", "Corrected and normalised integrated intensity (structure factor)");
-        set("Sf2Err" + t,      "0.2f", "arb.units", "ESD Corrected and normalised integrated intensity"); }
+        set("Sf2Err" + t,      "0.2f", "arb.units", "ESD Corrected and normalised integrated intensity");
+        set("AreaFit" + t,     "0.2f", "arb.units", "Integrated intensity of the fitted profile");
+        set("AreaFitErr" + t,  "0.2f", "arb.units", "ESD Integrated intensity of the fitted profile");
+        set("PosFit" + t,      "0.4f", "deg",       "Peak position of the fitted profile");
+        set("PosFitErr" + t,   "0.4f", "deg",       "ESD Peak position of the fitted profile");
+        set("FwhmFit" + t,     "0.4f", "deg",       "Full width at half max of the fitted profile");
+        set("FwhmFitErr" + t,  "0.4f", "deg",       "ESD Full width at half max of the fitted profile");
+        set("BkgFit" + t,      "0.4f", "arb.units", "Background of the fitted profile");
+        set("BkgFitErr" + t,   "0.4f", "arb.units", "ESD Background of the fitted profile");
+        set("EtaFit" + t,      "0.4f", "arb.units", "Lorentzian fraction of the fitted pseudo-Voigt profile");
+        set("Chi2Fit" + t,     "0.2f", "arb.units", "Reduced chi-squared of the fit"); }
 
     //  --------------------------------------------------------------------------------------
     //  Holds the orientation matrix.
@@ -332,10 +422,14 @@ As::ScanDict::~ScanDict() {
     ADESTROYED; }
 
 /*!
-    Returns the value associated with the key \a section.
+    Returns the value associated with the key \a section as a constant reference.
+
+    If the dictionary contains no such section, a reference to an empty group is returned.
 */
-const As::ScanDict::GroupElements_t As::ScanDict::operator[](const QString& section) const {
-    return m_scanDict[section]; }
+const As::ScanDict::GroupElements_t& As::ScanDict::operator[](const QString& section) const {
+    static const GroupElements_t emptyGroup;
+    const auto it = m_scanDict.constFind(section);
+    return it != m_scanDict.constEnd() ? it.value() : emptyGroup; }
 
 /*!
     Returns a list containing all the keys in the map in ascending order.
@@ -343,6 +437,51 @@ const As::ScanDict::GroupElements_t As::ScanDict::operator[](const QString& sect
 const QStringList As::ScanDict::keys() const {
     return m_scanDict.keys(); }
 
+/*!
+    Returns the field id of the given \a group and \a element, or -1 if the dictionary
+    doesn't contain such a field.
+
+    Field ids are assigned once when the dictionary is constructed and are shared by all
+    the scans, which store only their data values together with the field id.
+*/
+int As::ScanDict::fieldId(const QString& group,
+                          const QString& element) const {
+    const auto groupIt = m_fieldIds.constFind(group);
+    if (groupIt == m_fieldIds.constEnd()) {
+        return -1; }
+
+    return groupIt.value().value(element, -1); }
+
+/*!
+    Returns the number of fields in the dictionary.
+*/
+int As::ScanDict::fieldCount() const {
+    return m_fieldAttributes.size(); }
+
+/*!
+    Returns all the attributes (format, units and tooltip) of the field with the given \a id.
+*/
+const As::ScanDict::ElementAttributes_t& As::ScanDict::attributes(const int id) const {
+    return m_fieldAttributes.at(id); }
+
+/*!
+    Returns the format of the field with the given \a id.
+*/
+const QString& As::ScanDict::format(const int id) const {
+    return m_fieldFormats.at(id); }
+
+/*!
+    Returns the units of the field with the given \a id.
+*/
+const QString& As::ScanDict::units(const int id) const {
+    return m_fieldUnits.at(id); }
+
+/*!
+    Returns the tooltip of the field with the given \a id.
+*/
+const QString& As::ScanDict::tooltip(const int id) const {
+    return m_fieldTooltips.at(id); }
+
 /*!
     Selects a \a group where all the set methods write to.
 */
@@ -360,8 +499,27 @@ void As::ScanDict::set(const QString& element,
 
     //ADEBUG << BEAM_TYPES;
 
-    m_scanDict[m_selectedGroup][element] = ElementAttributes_t{
-        {"format", format }, {"units", units }, {"tooltip", tooltip } }; }
+    const ElementAttributes_t attributes{
+        {"format", format }, {"units", units }, {"tooltip", tooltip } };
+
+    m_scanDict[m_selectedGroup][element] = attributes;
+
+    // Register a new field id or overwrite the attributes of the existing one
+    int id = fieldId(m_selectedGroup, element);
+
+    if (id < 0) {
+        id = m_fieldAttributes.size();
+        m_fieldIds[m_selectedGroup][element] = id;
+        m_fieldAttributes.append(attributes);
+        m_fieldFormats.append(format);
+        m_fieldUnits.append(units);
+        m_fieldTooltips.append(tooltip); }
+
+    else {
+        m_fieldAttributes[id] = attributes;
+        m_fieldFormats[id] = format;
+        m_fieldUnits[id] = units;
+        m_fieldTooltips[id] = tooltip; } }
 
 
 
@@ -21,12 +21,14 @@
 #ifndef AS_SCANDICT_HPP
 #define AS_SCANDICT_HPP
 
+#include <QList>
 #include <QMap>
+#include <QStringList>
+#include <QVector>
 
 #include "Constants.hpp"
 
 class QString;
-class QStringList;
 
 namespace As { //AS_BEGIN_NAMESPACE
 
@@ -36,6 +38,7 @@ class ScanDict {
     using ElementAttributes_t = QMap<QString, QString>;
     using GroupElements_t     = QMap<QString, ElementAttributes_t>;
     using PropertyGroups_t    = QMap<QString, GroupElements_t>;
+    using FieldIds_t          = QMap<QString, QMap<QString, int>>;
 
     static const As::ScanDict Properties;
     static const int MIN_DATA_POINTS;
@@ -46,14 +49,23 @@ class ScanDict {
     static const QString DATE_TIME_FORMAT;
     static const QMap<int, qreal> MC_CANDLISH_FACTOR;
     static const QMap<int, QString> BEAM_TYPES;
+    static const QMap<int, QList<QStringList>> FILE_HEADER_MAPS;
     enum BeamTypes { UNPOLARISED, POLARISED_UP, POLARISED_DOWN };
 
     ScanDict();
     ~ScanDict();
 
-    const GroupElements_t operator[](const QString& section) const;
+    const GroupElements_t& operator[](const QString& section) const;
     const QStringList keys() const;
 
+    int fieldId(const QString& group,
+                const QString& element) const;
+    int fieldCount() const;
+    const ElementAttributes_t& attributes(const int id) const;
+    const QString& format(const int id) const;
+    const QString& units(const int id) const;
+    const QString& tooltip(const int id) const;
+
   private:
     void selectGroup(const QString& group);
     void set(const QString& element,
@@ -64,6 +76,11 @@ class ScanDict {
     QStringList m_beamTypes;
     QString m_selectedGroup;
     PropertyGroups_t m_scanDict;
+    FieldIds_t m_fieldIds;
+    QVector<ElementAttributes_t> m_fieldAttributes;
+    QVector<QString> m_fieldFormats;
+    QVector<QString> m_fieldUnits;
+    QVector<QString> m_fieldTooltips;
 
 };
 
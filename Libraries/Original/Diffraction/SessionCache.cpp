@@ -0,0 +1,337 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+
+#include "Macros.hpp"
+
+#include "InputReader.hpp"
+#include "Scan.hpp"
+
+#include "SessionCache.hpp"
+
+/*!
+    \class As::SessionCache
+
+    \brief The SessionCache is a class that provides a persistent binary cache
+    of the scans extracted from the input files.
+
+    Every input file is identified by its absolute path and validated by its size and
+    last modification time. Unchanged files are not detected and extracted again, but
+    their scans are restored directly from the cache. The cache file starts with the
+    MAGIC number and the FORMAT_VERSION, and is discarded as a whole if any of them
+    doesn't match.
+
+    \inmodule Diffraction
+*/
+
+/*!
+    \variable As::SessionCache::MAGIC
+
+    Magic number written at the beginning of the cache file.
+*/
+const quint32 As::SessionCache::MAGIC = 0x44564343; // "DVCC"
+
+/*!
+    \variable As::SessionCache::FORMAT_VERSION
+
+    Version of the binary format of the cache file. Must be increased every time
+    the format, or the extraction of the scans, is changed.
+*/
+const qint32 As::SessionCache::FORMAT_VERSION = 1;
+
+/*!
+    Constructs an empty cache.
+*/
+As::SessionCache::SessionCache() {}
+
+/*!
+    Destroys the cache.
+*/
+As::SessionCache::~SessionCache() {
+    ADESTROYED; }
+
+/*!
+    Returns the default path of the cache file for the given list of input files
+    \a filePaths. The file is located in the user cache directory and named after
+    the hash of the input files paths.
+*/
+QString As::SessionCache::defaultFilePath(const QStringList& filePaths) {
+    QStringList absolutePaths;
+    for (const QString& filePath : filePaths) {
+        absolutePaths << QFileInfo(filePath).absoluteFilePath(); }
+    absolutePaths.sort();
+
+    const QByteArray hash = QCryptographicHash::hash(absolutePaths.join("\n").toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex();
+    const QString dirPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+    return QDir(dirPath).filePath(QString::fromLatin1(hash) + ".davinci-cache"); }
+
+/*!
+    Loads the cache from the file \a cacheFilePath. Returns true on success, otherwise
+    the cache is left empty and false is returned.
+*/
+bool As::SessionCache::load(const QString& cacheFilePath) {
+    ADEBUG << cacheFilePath;
+
+    clear();
+
+    QFile file(cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false; }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    in >> magic >> version;
+    if (magic != MAGIC OR version != FORMAT_VERSION) {
+        return false; }
+
+    qint32 type = 0;
+    quint32 count = 0;
+    in >> type >> count;
+
+    for (quint32 i = 0; i < count AND in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        Entry entry;
+        in >> filePath >> entry.size >> entry.modified >> entry.scans >> entry.content;
+        m_entries.insert(filePath, entry); }
+
+    if (in.status() != QDataStream::Ok) {
+        clear();
+        return false; }
+
+    m_inputFilesType = As::InputFileType(type);
+    return true; }
+
+/*!
+    Saves the cache to the file \a cacheFilePath, if it was modified since the last
+    load or save. Returns true on success.
+*/
+bool As::SessionCache::save(const QString& cacheFilePath) {
+    ADEBUG << cacheFilePath;
+
+    if (!m_modified) {
+        return true; }
+
+    QDir().mkpath(QFileInfo(cacheFilePath).absolutePath());
+
+    QSaveFile file(cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false; }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+
+    out << MAGIC << FORMAT_VERSION;
+    out << qint32(m_inputFilesType) << quint32(m_entries.size());
+
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const Entry& entry = it.value();
+        out << it.key() << entry.size << entry.modified << entry.scans << entry.content; }
+
+    if (!file.commit()) {
+        return false; }
+
+    m_modified = false;
+    return true; }
+
+/*!
+    Removes all the entries from the cache.
+*/
+void As::SessionCache::clear() {
+    m_entries.clear();
+    m_inputFilesType = As::InputFileType(0);
+    m_modified = false; }
+
+/*!
+    Returns true if the cache was modified since the last load or save.
+*/
+bool As::SessionCache::isModified() const {
+    return m_modified; }
+
+/*!
+    Returns the type of the cached input files.
+*/
+As::InputFileType As::SessionCache::inputFilesType() const {
+    return m_inputFilesType; }
+
+/*!
+    Sets the type of the cached input files to be \a type. All the cached entries
+    are removed if the type is changed.
+*/
+void As::SessionCache::setInputFilesType(const As::InputFileType type) {
+    if (m_inputFilesType == type) {
+        return; }
+
+    m_entries.clear();
+    m_inputFilesType = type;
+    m_modified = true; }
+
+/*!
+    Returns true if the cache contains the scans of the input file \a filePath,
+    and the file wasn't changed since then.
+*/
+bool As::SessionCache::isValid(const QString& filePath) const {
+    const auto it = m_entries.constFind(QFileInfo(filePath).absoluteFilePath());
+    if (it == m_entries.constEnd()) {
+        return false; }
+
+    qint64 size, modified;
+    if (!stamp(filePath, size, modified)) {
+        return false; }
+
+    return size == it.value().size AND modified == it.value().modified; }
+
+/*!
+    Returns true if the cache is valid for all the input files \a filePaths.
+*/
+bool As::SessionCache::isValid(const QStringList& filePaths) const {
+    if (filePaths.isEmpty()) {
+        return false; }
+
+    for (const QString& filePath : filePaths) {
+        if (!isValid(filePath)) {
+            return false; } }
+
+    return true; }
+
+/*!
+    Returns the new scans restored from the cache for the input file \a filePath
+    with the given \a fileIndex. The caller takes ownership of the scans.
+*/
+QList<As::Scan*> As::SessionCache::restoreScans(const QString& filePath,
+                                                const int fileIndex) const {
+    QList<As::Scan*> scans;
+
+    const QByteArray bytes = qUncompress(m_entries.value(QFileInfo(filePath).absoluteFilePath()).scans);
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_5_6);
+
+    quint32 scanCount = 0;
+    in >> scanCount;
+
+    for (quint32 i = 0; i < scanCount AND in.status() == QDataStream::Ok; ++i) {
+        auto scan = new As::Scan;
+        scan->setFileIndex(fileIndex + 1);
+        scan->setAbsoluteFilePath(filePath);
+
+        double scanStep = 0;
+        QString scanAngle;
+        quint32 groupCount = 0;
+        in >> scanStep >> scanAngle >> groupCount;
+        scan->setScanStep(scanStep);
+        scan->setScanAngle(scanAngle);
+
+        for (quint32 j = 0; j < groupCount AND in.status() == QDataStream::Ok; ++j) {
+            QString group;
+            quint32 elementCount = 0;
+            in >> group >> elementCount;
+
+            for (quint32 k = 0; k < elementCount AND in.status() == QDataStream::Ok; ++k) {
+                QString element, data;
+                in >> element >> data;
+                scan->setData(group, element, data); } }
+
+        scans << scan; }
+
+    if (in.status() != QDataStream::Ok) {
+        qDeleteAll(scans);
+        scans.clear(); }
+
+    return scans; }
+
+/*!
+    Returns the cached content of the input file \a filePath, if it was modified
+    during the extraction; otherwise returns a null string.
+*/
+QString As::SessionCache::content(const QString& filePath) const {
+    return m_entries.value(QFileInfo(filePath).absoluteFilePath()).content; }
+
+/*!
+    Stores the \a scans extracted from the input file \a filePath in the cache together
+    with the file \a content, if it was modified during the extraction.
+*/
+void As::SessionCache::store(const QString& filePath,
+                             const QVector<As::Scan*>& scans,
+                             const QString& content) {
+    Entry entry;
+    if (!stamp(filePath, entry.size, entry.modified)) {
+        return; }
+
+    entry.scans = qCompress(serializeScans(scans));
+    entry.content = content;
+
+    m_entries.insert(QFileInfo(filePath).absoluteFilePath(), entry);
+    m_modified = true; }
+
+/*!
+    Gets the \a size and the last \a modified time of the file \a filePath, or of
+    the archive which contains it. Returns false if the file doesn't exist.
+*/
+bool As::SessionCache::stamp(const QString& filePath,
+                             qint64& size,
+                             qint64& modified) {
+    const QString archivePath = As::InputReader::archivePath(filePath);
+    const QFileInfo fileInfo(archivePath.isEmpty() ? filePath : archivePath);
+    if (!fileInfo.exists()) {
+        return false; }
+
+    size = fileInfo.size();
+    modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    return true; }
+
+/*!
+    Returns the binary form of the given \a scans. Only the data set during the
+    extraction are stored, i.e. the scan step, the scan angle and all the non-empty
+    elements of the scan groups.
+*/
+QByteArray As::SessionCache::serializeScans(const QVector<As::Scan*>& scans) {
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_6);
+
+    out << quint32(scans.size());
+
+    for (const As::Scan* scan : scans) {
+        const QStringList groups = scan->keys();
+        out << double(scan->scanStep()) << scan->scanAngle() << quint32(groups.size());
+
+        for (const QString& group : groups) {
+            const As::Scan::GroupData_t& elements = (*scan)[group];
+            out << group << quint32(elements.size());
+
+            for (auto it = elements.constBegin(); it != elements.constEnd(); ++it) {
+                out << it.key() << it.value().second; } } }
+
+    return bytes; }
+
@@ -0,0 +1,90 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef AS_DIFFRACTION_SESSIONCACHE_HPP
+#define AS_DIFFRACTION_SESSIONCACHE_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "Constants.hpp"
+
+class QStringList;
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class Scan;
+
+class SessionCache {
+
+  public:
+    static const quint32 MAGIC;
+    static const qint32 FORMAT_VERSION;
+
+    SessionCache();
+    ~SessionCache();
+
+    static QString defaultFilePath(const QStringList& filePaths);
+
+    bool load(const QString& cacheFilePath);
+    bool save(const QString& cacheFilePath);
+    void clear();
+
+    bool isModified() const;
+
+    As::InputFileType inputFilesType() const;
+    void setInputFilesType(const As::InputFileType type);
+
+    bool isValid(const QString& filePath) const;
+    bool isValid(const QStringList& filePaths) const;
+
+    QList<As::Scan*> restoreScans(const QString& filePath,
+                                  const int fileIndex) const;
+    QString content(const QString& filePath) const;
+    void store(const QString& filePath,
+               const QVector<As::Scan*>& scans,
+               const QString& content = QString());
+
+  private:
+    struct Entry {
+        qint64 size = -1;        // Size of the input file, in bytes
+        qint64 modified = -1;    // Last modification time of the input file, in ms since epoch
+        QByteArray scans;        // Compressed binary form of the extracted scans
+        QString content; };      // Content of the input file if modified during the extraction
+
+    static bool stamp(const QString& filePath,
+                      qint64& size,
+                      qint64& modified);
+    static QByteArray serializeScans(const QVector<As::Scan*>& scans);
+
+    QHash<QString, Entry> m_entries; // Cached entries by the absolute input file path
+    As::InputFileType m_inputFilesType = As::InputFileType(0);
+    bool m_modified = false;
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_SESSIONCACHE_HPP
+
@@ -0,0 +1,269 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDataStream>
+#include <QFile>
+#include <QMap>
+#include <QPair>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+#include <QtMath>
+
+#include <algorithm>
+
+#include "Macros.hpp"
+
+#include "Scan.hpp"
+#include "ScanArray.hpp"
+#include "ScanDict.hpp"
+
+#include "ShardFile.hpp"
+
+/*!
+    \class As::ShardFile
+
+    \brief The ShardFile is a class that provides the intermediate result of one
+    shard of the dataset processed on a separate node.
+
+    The sorted list of the input files is split into \c count contiguous parts of
+    nearly equal size, so that every node can find its own part without any
+    communication. The shard keeps the full output table with all the real values in
+    the binary form. The shards are then merged into the table identical to the one
+    of a single-node run: the rows follow the order of the input files and the scans
+    are numbered anew through the whole dataset.
+
+    The file starts with the MAGIC number and the FORMAT_VERSION.
+
+    \inmodule Diffraction
+*/
+
+/*!
+    \variable As::ShardFile::MAGIC
+
+    Magic number written at the beginning of the shard file.
+*/
+const quint32 As::ShardFile::MAGIC = 0x44565348; // "DVSH"
+
+/*!
+    \variable As::ShardFile::FORMAT_VERSION
+
+    Version of the binary format of the shard file.
+*/
+const qint32 As::ShardFile::FORMAT_VERSION = 1;
+
+/*!
+    \variable As::ShardFile::EXTENSION
+
+    Extension of the shard file.
+*/
+const QString As::ShardFile::EXTENSION = "shard";
+
+/*!
+    Constructs an empty shard.
+*/
+As::ShardFile::ShardFile() {}
+
+/*!
+    Destroys the shard.
+*/
+As::ShardFile::~ShardFile() {
+    ADESTROYED; }
+
+/*!
+    Parses the shard specification \a spec given as "i/N", where i is the 1-based
+    \a index of the shard and N is the total \a count of the shards. Returns false if
+    the specification is wrong.
+*/
+bool As::ShardFile::parseSpec(const QString& spec,
+                              int& index,
+                              int& count) {
+    const QRegularExpressionMatch match = QRegularExpression("^\\s*(\\d+)\\s*/\\s*(\\d+)\\s*$").match(spec);
+    if (!match.hasMatch()) {
+        return false; }
+
+    index = match.captured(1).toInt();
+    count = match.captured(2).toInt();
+
+    return count > 0 AND index > 0 AND index <= count; }
+
+/*!
+    Returns the range of the input files from \a first to \a last (exclusive) of the
+    shard \a index of \a count for the dataset of \a fileCount files. The range
+    depends on the numbers only, so every node gets the same partition.
+*/
+void As::ShardFile::fileRange(const int fileCount,
+                              const int index,
+                              const int count,
+                              int& first,
+                              int& last) {
+    first = static_cast<int>(static_cast<qint64>(fileCount) * (index - 1) / count);
+    last  = static_cast<int>(static_cast<qint64>(fileCount) * index / count); }
+
+/*!
+    Loads the shard from the file \a filePath. Returns true on success.
+*/
+bool As::ShardFile::load(const QString& filePath) {
+    ADEBUG << filePath;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false; }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    in >> magic >> version;
+    if (magic != MAGIC OR version != FORMAT_VERSION) {
+        return false; }
+
+    qint32 shardIndex = 0;
+    qint32 shardCount = 0;
+    qint32 files = 0;
+    qint32 firstFile = 0;
+    qint32 type = 0;
+    in >> shardIndex >> shardCount >> files >> firstFile >> type;
+    in >> fit >> firstBaseName >> lastBaseName >> lastAbsolutePath;
+
+    if (in.status() != QDataStream::Ok OR !table.readFrom(in)) {
+        return false; }
+
+    index = shardIndex;
+    count = shardCount;
+    fileCount = files;
+    firstFileIndex = firstFile;
+    inputFilesType = As::InputFileType(type);
+    return true; }
+
+/*!
+    Saves the shard to the file \a filePath. Returns true on success.
+*/
+bool As::ShardFile::save(const QString& filePath) const {
+    ADEBUG << filePath;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false; }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+
+    out << MAGIC << FORMAT_VERSION;
+    out << qint32(index) << qint32(count) << qint32(fileCount) << qint32(firstFileIndex) << qint32(inputFilesType);
+    out << fit << firstBaseName << lastBaseName << lastAbsolutePath;
+    table.writeTo(out);
+
+    return file.commit(); }
+
+/*!
+    Merges all the \a shards of the dataset into the \a merged one. The shards may be
+    given in any order, but must be complete and come from the same run. The columns
+    are the union of the columns of all the shards, without the results missing for
+    every scan, and the "Scan" numbers are set anew, exactly as if all the files were
+    processed together. Returns false and sets the \a error message if the shards
+    can't be merged.
+*/
+bool As::ShardFile::merge(QList<As::ShardFile> shards,
+                          As::ShardFile& merged,
+                          QString& error) {
+    if (shards.isEmpty()) {
+        error = "No shards to merge.";
+        return false; }
+
+    std::sort(shards.begin(), shards.end(), [] (const As::ShardFile& a, const As::ShardFile& b) {
+        return a.index < b.index; });
+
+    const As::ShardFile& first = shards.first();
+    if (shards.size() != first.count) {
+        error = QString("Expected %1 shards, but %2 are given.").arg(first.count).arg(shards.size());
+        return false; }
+
+    for (int i = 0; i < shards.size(); ++i) {
+        const As::ShardFile& shard = shards.at(i);
+        if (shard.index != i + 1 OR shard.count != first.count OR shard.fileCount != first.fileCount) {
+            error = QString("Shard %1/%2 doesn't belong to the same dataset or is given twice.").arg(shard.index).arg(shard.count);
+            return false; }
+        if (shard.fit != first.fit) {
+            error = QString("Shard %1/%2 is processed with another peak fit function.").arg(shard.index).arg(shard.count);
+            return false; } }
+
+    merged = As::ShardFile();
+    merged.fileCount = first.fileCount;
+    merged.fit = first.fit;
+
+    // Names of the calculated results
+    QSet<QString> resultNames;
+    for (const auto type : As::Scan::ResultTypeDict.keys()) {
+        for (const auto& countType : As::ScanDict::BEAM_TYPES) {
+            resultNames.insert(As::Scan::resultName(type, countType)); } }
+
+    // Union of the columns of all the shards. The repeated measurements are linked
+    // anew through the whole dataset, so their columns are skipped
+    QStringList names;
+    QMap<QString, QPair<QString, As::ResultTable::ColumnType> > columns;
+    for (const As::ShardFile& shard : shards) {
+        if (shard.table.rowCount() == 0) {
+            continue; }
+
+        if (names.isEmpty()) {
+            merged.inputFilesType = shard.inputFilesType;
+            merged.firstBaseName = shard.firstBaseName; }
+        else if (shard.inputFilesType != merged.inputFilesType) {
+            error = QString("Shard %1/%2 contains the files of another type.").arg(shard.index).arg(shard.count);
+            return false; }
+
+        for (int column = 0; column < shard.table.columnCount(); ++column) {
+            const QString& name = shard.table.headers().at(column);
+            if (name == "Repeat" OR name == "Repeats" OR columns.contains(name)) {
+                continue; }
+
+            // Calculated results actually available for any of the scans, as for a single-node run
+            if (resultNames.contains(name)) {
+                const bool isAvailable = std::any_of(shards.constBegin(), shards.constEnd(), [&name] (const As::ShardFile& other) {
+                    const int otherColumn = other.table.columnIndex(name);
+                    if (otherColumn < 0 OR other.table.columnType(otherColumn) != As::ResultTable::RealColumn) {
+                        return false; }
+                    const QVector<qreal>& values = other.table.realColumn(otherColumn);
+                    return std::any_of(values.constBegin(), values.constEnd(), [] (const qreal value) { return !qIsNaN(value); }); });
+                if (!isAvailable) {
+                    continue; } }
+
+            names << name;
+            columns.insert(name, qMakePair(shard.table.format(column), shard.table.columnType(column))); } }
+
+    for (const auto& name : As::ScanArray::outputColumnOrder(names)) {
+        merged.table.appendColumn(name, columns[name].first, columns[name].second); }
+
+    for (const As::ShardFile& shard : shards) {
+        if (shard.table.rowCount() == 0) {
+            continue; }
+        merged.table.appendRows(shard.table);
+        merged.lastBaseName = shard.lastBaseName;
+        merged.lastAbsolutePath = shard.lastAbsolutePath; }
+
+    // Number the scans through the whole dataset
+    const int scanColumn = merged.table.columnIndex("Scan");
+    if (scanColumn >= 0 AND merged.table.columnType(scanColumn) == As::ResultTable::RealColumn) {
+        for (int row = 0; row < merged.table.rowCount(); ++row) {
+            merged.table.setReal(row, scanColumn, row + 1); } }
+
+    return true; }
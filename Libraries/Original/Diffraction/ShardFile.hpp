@@ -0,0 +1,74 @@
+/*
+    Davinci, a software for the single-crystal diffraction data reduction.
+    Copyright (C) 2015-2017 Andrew Sazonov
+
+    This file is part of Davinci.
+
+    Davinci is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Davinci is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef AS_DIFFRACTION_SHARDFILE_HPP
+#define AS_DIFFRACTION_SHARDFILE_HPP
+
+#include <QList>
+#include <QString>
+
+#include "Constants.hpp"
+
+#include "ResultTable.hpp"
+
+namespace As { //AS_BEGIN_NAMESPACE
+
+class ShardFile {
+
+  public:
+    static const quint32 MAGIC;
+    static const qint32 FORMAT_VERSION;
+    static const QString EXTENSION;
+
+    ShardFile();
+    ~ShardFile();
+
+    static bool parseSpec(const QString& spec,
+                          int& index,
+                          int& count);
+    static void fileRange(const int fileCount,
+                          const int index,
+                          const int count,
+                          int& first,
+                          int& last);
+
+    bool load(const QString& filePath);
+    bool save(const QString& filePath) const;
+
+    static bool merge(QList<As::ShardFile> shards,
+                      As::ShardFile& merged,
+                      QString& error);
+
+    int index = 1;                      // 1-based index of the shard
+    int count = 1;                      // Total number of the shards
+    int fileCount = 0;                  // Number of the input files of the whole dataset
+    int firstFileIndex = 0;             // Index of the 1st input file of the shard in the whole dataset
+    As::InputFileType inputFilesType = As::InputFileType(0);
+    QString fit;                        // Peak profile function, if the peaks are fitted
+    QString firstBaseName;              // Base name of the 1st scan
+    QString lastBaseName;               // Base name of the last scan
+    QString lastAbsolutePath;           // Absolute path of the last scan
+    As::ResultTable table;              // Full output table of the shard
+
+};
+
+} //AS_END_NAMESPACE
+
+#endif // AS_DIFFRACTION_SHARDFILE_HPP
@@ -27,9 +27,15 @@
 
 It has its own color scheme and some additional methods.
 
-\inmodule Core
+\inmodule Widgets
 */
 
+/*!
+    \variable As::SELECTION_BACKGROUND
+    \brief the color of the selection background.
+*/
+const QColor As::SELECTION_BACKGROUND("#f8f8f8");
+
 /*!
 Constructs an invalid color with the RGB value (0, 0, 0). An invalid color is a color
 that is not properly set up for the underlying window system.
@@ -18,8 +18,8 @@
  * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#ifndef AS_COLORS_HPP
-#define AS_COLORS_HPP
+#ifndef AS_WIDGETS_COLORS_HPP
+#define AS_WIDGETS_COLORS_HPP
 
 #include "Constants.hpp"
 
@@ -48,8 +48,10 @@ public:
 
 };
 
+extern const QColor SELECTION_BACKGROUND;
+
 } //AS_END_NAMESPACE
 
-#endif // AS_COLORS_HPP
+#endif // AS_WIDGETS_COLORS_HPP
 
 
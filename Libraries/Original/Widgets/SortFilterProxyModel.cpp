@@ -21,6 +21,7 @@
 #include <QtWidgets>
 
 #include "Constants.hpp"
+#include "Macros.hpp"
 
 #include "ScanDict.hpp"
 
@@ -43,6 +44,135 @@
 As::SortFilterProxyModel::SortFilterProxyModel(QObject* parent)
     : QSortFilterProxyModel(parent) {}
 
+/*!
+    \enum As::SortFilterProxyModel::SortKeyType
+
+    This enum type describes the type of the sort keys of the column.
+
+    \value DateTimeKey     Date and time in the As::ScanDict::DATE_TIME_FORMAT, compared as
+                           seconds since epoch
+    \value NumberKey       Real number
+    \value StringKey       Any other string
+*/
+
+/*!
+    Sets the given \a sourceModel to be processed by the proxy model. The precomputed sort
+    keys are dropped every time the source model data is changed.
+*/
+void As::SortFilterProxyModel::setSourceModel(QAbstractItemModel* sourceModel) {
+    if (this->sourceModel()) {
+        disconnect(this->sourceModel(), Q_NULLPTR, this, SLOT(invalidateSortKeys())); }
+
+    invalidateSortKeys();
+
+    // Connect before the base class does, so that the keys are dropped before resorting
+    if (sourceModel) {
+        connect(sourceModel, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)), this, SLOT(invalidateSortKeys()));
+        connect(sourceModel, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(invalidateSortKeys()));
+        connect(sourceModel, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(invalidateSortKeys()));
+        connect(sourceModel, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), this, SLOT(invalidateSortKeys()));
+        connect(sourceModel, SIGNAL(columnsInserted(QModelIndex, int, int)), this, SLOT(invalidateSortKeys()));
+        connect(sourceModel, SIGNAL(columnsRemoved(QModelIndex, int, int)), this, SLOT(invalidateSortKeys()));
+        connect(sourceModel, SIGNAL(layoutChanged()), this, SLOT(invalidateSortKeys()));
+        connect(sourceModel, SIGNAL(modelReset()), this, SLOT(invalidateSortKeys())); }
+
+    QSortFilterProxyModel::setSourceModel(sourceModel); }
+
+/*!
+    Sorts the model by \a column in the given \a order.
+
+    Before sorting, the type of the \a column is classified once and all its cells are
+    converted to the typed sort keys, so that the comparisons in lessThan don't need to
+    parse any strings.
+*/
+void As::SortFilterProxyModel::sort(int column,
+                                    Qt::SortOrder order) {
+    if (column >= 0 AND column != m_sortKeysColumn) {
+        buildSortKeys(column); }
+
+    QSortFilterProxyModel::sort(column, order); }
+
+/*!
+    Drops the precomputed sort keys.
+*/
+void As::SortFilterProxyModel::invalidateSortKeys() {
+    clearSortKeys(); }
+
+/*!
+    Clears all the sort keys arrays.
+*/
+void As::SortFilterProxyModel::clearSortKeys() const {
+    m_sortKeysColumn = -1;
+    m_emptyKeys.clear();
+    m_numberKeys.clear();
+    m_stringKeys.clear(); }
+
+/*!
+    Classifies the type of the given \a column and builds the array of its typed sort keys.
+
+    If the first non-empty cell can be converted to date and time, the column is sorted
+    by date. If all the non-empty cells can be converted to numbers, the column is sorted
+    numerically. Otherwise, the column is sorted alphabetically.
+*/
+void As::SortFilterProxyModel::buildSortKeys(const int column) const {
+    clearSortKeys();
+
+    const QAbstractItemModel* model = sourceModel();
+    if (!model OR column >= model->columnCount()) {
+        return; }
+
+    const int rowCount = model->rowCount();
+
+    m_emptyKeys.resize(rowCount);
+    m_stringKeys.resize(rowCount);
+
+    for (int row = 0; row < rowCount; ++row) {
+        m_stringKeys[row] = model->data(model->index(row, column), sortRole()).toString();
+        m_emptyKeys[row] = m_stringKeys[row].isEmpty(); }
+
+    // Classify the column type by its non-empty cells
+
+    m_sortKeyType = StringKey;
+
+    int firstRow = 0;
+    while (firstRow < rowCount AND m_emptyKeys[firstRow]) {
+        ++firstRow; }
+
+    if (firstRow < rowCount) {
+        if (QDateTime::fromString(m_stringKeys[firstRow], As::ScanDict::DATE_TIME_FORMAT).isValid()) {
+            m_sortKeyType = DateTimeKey; }
+        else {
+            m_sortKeyType = NumberKey; } }
+
+    // Convert the cells to the typed keys
+
+    if (m_sortKeyType != StringKey) {
+        m_numberKeys.resize(rowCount);
+
+        for (int row = 0; row < rowCount; ++row) {
+            if (m_emptyKeys[row]) {
+                continue; }
+
+            bool ok = true;
+
+            if (m_sortKeyType == DateTimeKey) {
+                const QDateTime dateTime = QDateTime::fromString(m_stringKeys[row], As::ScanDict::DATE_TIME_FORMAT);
+                ok = dateTime.isValid();
+                m_numberKeys[row] = dateTime.toMSecsSinceEpoch() / 1000; }
+            else {
+                m_numberKeys[row] = m_stringKeys[row].toDouble(&ok); }
+
+            // Mixed column: fall back to the alphabetical order
+            if (!ok) {
+                m_sortKeyType = StringKey;
+                m_numberKeys.clear();
+                break; } } }
+
+    if (m_sortKeyType != StringKey) {
+        m_stringKeys.clear(); }
+
+    m_sortKeysColumn = column; }
+
 /*!
     Returns \c true if the value of the item referred to by the given index \a left is less than
     the value of the item referred to by the given index \a right, otherwise returns \c false.
@@ -58,16 +188,45 @@ As::SortFilterProxyModel::SortFilterProxyModel(QObject* parent)
 
     Otherwise, alphabetical order is applied.
 
+    Empty cells are always placed after the non-empty ones.
+
+    The typed keys precomputed by sort are used, if available. Otherwise, the cells are
+    converted on the fly.
+
     \sa \link https://en.wikipedia.org/wiki/Natural_sort_order Wiki: Natural sort order \endlink
 */
 bool As::SortFilterProxyModel::lessThan(const QModelIndex& left,
                                         const QModelIndex& right) const {
-    const QString leftDataStr = sourceModel()->data(left).toString();
-    const QString rightDataStr = sourceModel()->data(right).toString();
+
+    // Build the sort keys once per column, e.g. when dynamic resorting is triggered
+    if (left.column() == right.column() AND left.column() != m_sortKeysColumn) {
+        buildSortKeys(left.column()); }
+
+    // Use the precomputed sort keys
+    if (left.column() == m_sortKeysColumn AND right.column() == m_sortKeysColumn AND
+        left.row() < m_emptyKeys.size() AND right.row() < m_emptyKeys.size()) {
+        const int l = left.row();
+        const int r = right.row();
+
+        // Skip empty rows
+        if (m_emptyKeys[l]) {
+            return false; }
+        if (m_emptyKeys[r]) {
+            return true; }
+
+        if (m_sortKeyType == StringKey) {
+            return m_stringKeys[l] < m_stringKeys[r]; }
+
+        return m_numberKeys[l] < m_numberKeys[r]; }
+
+    const QString leftDataStr = sourceModel()->data(left, sortRole()).toString();
+    const QString rightDataStr = sourceModel()->data(right, sortRole()).toString();
 
     // Skip empty rows
     if (leftDataStr.isEmpty()) {
         return false; }
+    if (rightDataStr.isEmpty()) {
+        return true; }
 
     // Check if the cell contains date&time object in the specific format
     const QDateTime leftDateTime = QDateTime::fromString(leftDataStr, As::ScanDict::DATE_TIME_FORMAT);
@@ -23,6 +23,8 @@
 
 #include <QDate>
 #include <QSortFilterProxyModel>
+#include <QString>
+#include <QVector>
 
 namespace As { //AS_BEGIN_NAMESPACE
 
@@ -32,9 +34,27 @@ class SortFilterProxyModel : public QSortFilterProxyModel {
   public:
     SortFilterProxyModel(QObject* parent = 0);
 
+    enum SortKeyType { DateTimeKey, NumberKey, StringKey };
+
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
   protected:
     bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
 
+  private slots:
+    void invalidateSortKeys();
+
+  private:
+    void clearSortKeys() const;
+    void buildSortKeys(const int column) const;
+
+    mutable int m_sortKeysColumn = -1;
+    mutable SortKeyType m_sortKeyType = StringKey;
+    mutable QVector<bool> m_emptyKeys;
+    mutable QVector<qreal> m_numberKeys;
+    mutable QVector<QString> m_stringKeys;
+
 };
 
 } //AS_END_NAMESPACE
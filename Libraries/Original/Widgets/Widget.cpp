@@ -18,6 +18,9 @@
     along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <QFont>
+#include <QFontMetrics>
+
 #include "Macros.hpp"
 
 #include "Widget.hpp"
@@ -42,3 +45,14 @@ As::Widget::Widget(QWidget* parent)
 */
 As::Widget::~Widget() {
     ADESTROYED; }
+
+/*!
+    Calculates the width of the sidebar (in px) depends on the width of the given \a font.
+*/
+int As::SidebarWidth(const QFont& font) {
+    QFontMetrics fm(font);
+    //setCursorWidth(fm.averageCharWidth());
+    int widthPx = fm.width("abcdefghijklmnopqrstuvwxyz0123456789-+*");
+    if (widthPx % 2) { // check if it's odd, i.e. 2n+1
+        ++widthPx; }   // if it's odd, convert it to even 2n+2 (for equal widths ofthe sidebar tabs)
+    return widthPx; }
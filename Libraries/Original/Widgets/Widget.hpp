@@ -22,8 +22,12 @@
 
 #include <QWidget>
 
+class QFont;
+
 namespace As { //AS_BEGIN_NAMESPACE
 
+int SidebarWidth(const QFont& font);
+
 class Widget : public QWidget {
 
   public:
@@ -8,7 +8,8 @@ from qtprofile import *
 # Common setting for all apps and libs
 ######################################
 
-def SetCommonForAll(pro):
+# Headless apps (console, tests, benchmarks) use only the libs without Qt GUI
+def SetCommonForAll(pro, myLibs=MY_LIBS_NAMES, otherLibs=OTHER_LIBS_NAMES):
 
     # Build type (as directory name)
     pro.addBuildType(DEBUG_DIR_NAME, PROFILE_DIR_NAME, RELEASE_DIR_NAME)
@@ -17,20 +18,23 @@ def SetCommonForAll(pro):
     pro.addDestDir(BUILD_TYPE_DIR)
 
     # Source paths to be included
-    for lib in MY_LIBS_NAMES:
+    for lib in myLibs:
         pro.addIncludePath(MY_LIBS_DIR + [lib])
-    for lib in OTHER_LIBS_NAMES:
+    for lib in otherLibs:
         pro.addIncludePath(OTHER_LIBS_DIR + [lib])
 
     # Resources
     pro.addIncludePath(RESOURCES_DIR)
 
     # Compiled libraries paths to be included
-    for lib in MY_LIBS_NAMES:
+    for lib in myLibs:
         pro.addLibs(BUILD_TYPE_DIR, MY_LIBS_PREFIX, lib)
-    for lib in OTHER_LIBS_NAMES:
+    for lib in otherLibs:
         pro.addLibs(BUILD_TYPE_DIR, '', lib)
 
+    # zlib of Qt itself, also available where the system one is missing, e.g. on Windows
+    pro.addQt(ZLIB_QT_MODULES)
+
     # C++11 support for qmake when generating a Makefile.
     pro.addCppVersion(CPP_VERSION)
     pro.addQmakeCxxFlags(QMAKE_CXXFLAGS)
@@ -39,7 +43,7 @@ def SetCommonForAll(pro):
 # Common Window and Console application settings
 ################################################
 
-def SetCommonForApps(pro):
+def SetCommonForApps(pro, myLibs=MY_LIBS_NAMES, otherLibs=OTHER_LIBS_NAMES):
 
     # Build output type
     pro.addTemplate(APPS_TEMPLATE)
@@ -49,9 +53,9 @@ def SetCommonForApps(pro):
     pro.addDefines(DEFINES_MISC)
 
     # List of libraries to be checked on changes when building the project
-    for lib in MY_LIBS_NAMES:
+    for lib in myLibs:
         pro.addPostTargetDeps(BUILD_TYPE_DIR, MY_LIBS_PREFIX, lib)
-    for lib in OTHER_LIBS_NAMES:
+    for lib in otherLibs:
         pro.addPostTargetDeps(BUILD_TYPE_DIR, '', lib)
 
 ###########################
@@ -85,6 +89,7 @@ project.addSubDirs(PROJECT_SUBDIRS)
 # What subproject depends on others: To build libs before apps
 project.addDepends(APPS_DIR_NAME, LIBS_DIR_NAME)
 project.addDepends(TESTS_DIR_NAME, LIBS_DIR_NAME)
+project.addDepends(BENCHMARKS_DIR_NAME, LIBS_DIR_NAME)
 
 # Other files which are part of a Qt project
 #OTHER_FILES += README.md LICENSE Project.qdocconf .gitignore .travis.yml .appveyor.yml
@@ -144,11 +149,12 @@ window.save(WINDOW_APP_DIR + [WINDOW_APP_DIR_NAME])
 #####################
 
 console = QtProFile()
-SetCommonForAll(console)
-SetCommonForApps(console)
+SetCommonForAll(console, HEADLESS_LIBS_NAMES, [])
+SetCommonForApps(console, HEADLESS_LIBS_NAMES, [])
 
 # Qt modules to used in the project
 console.addQt(CONSOLE_APP_QT_MODULES)
+console.delQt(HEADLESS_QT_MODULES_DEL)
 
 # Set name of the executable
 console.addTarget(CONSOLE_APP_NAME)
@@ -233,9 +239,11 @@ for lib in MY_LIBS_NAMES:
     SetCommonForAll(pro)
     SetCommonForLibs(pro)
     if lib == 'Diffraction':
-        pro.addQt('widgets concurrent') # move to variables.py!?
+        pro.addQt('concurrent') # move to variables.py!?
     if lib == 'Widgets':
         pro.addQt('widgets') # move to variables.py!?
+    if lib in HEADLESS_LIBS_NAMES:
+        pro.delQt(HEADLESS_QT_MODULES_DEL)
     pro.addTarget(MY_LIBS_PREFIX + lib)
     pro.addObjectsDir(BUILD_TYPE_DIR + [OBJECTS_DIR_NAME] + [LIBS_DIR_NAME] + [MY_LIBS_DIR_NAME] + [lib])
     pro.addMocDir(BUILD_TYPE_DIR + [MOC_DIR_NAME] + [LIBS_DIR_NAME] + [MY_LIBS_DIR_NAME] + [lib])
@@ -252,12 +260,19 @@ for lib in MY_LIBS_NAMES:
 ###################
 
 tests = QtProFile()
-SetCommonForAll(tests)
-SetCommonForApps(tests)
+SetCommonForAll(tests, HEADLESS_LIBS_NAMES, [])
+SetCommonForApps(tests, HEADLESS_LIBS_NAMES, [])
 
 # Set name of the executable
 tests.addTarget(TESTS_NAME)
 
+# Qt modules to used in the project
+tests.addQt(CONSOLE_APP_QT_MODULES)
+tests.delQt(HEADLESS_QT_MODULES_DEL)
+
+# Paths to the example datasets and reference outputs
+tests.addDefines(TESTS_DEFINES_DICT)
+
 # Variable that qmake uses when generating a Makefile
 tests.addConfig(CONSOLE_APP_CONFIG)
 tests.delConfig(CONSOLE_APP_CONFIG_DEL)
@@ -272,5 +287,42 @@ tests.addUiDir(BUILD_TYPE_DIR + [UI_DIR_NAME] + [APPS_DIR_NAME] + [TESTS_NAME])
 tests.addHeaders(GetSelectedFileList(TESTS_DIR, HEADER_EXT))
 tests.addSources(GetSelectedFileList(TESTS_DIR, SOURCE_EXT))
 
+# Console application, but its main(), to test the whole jobs
+tests.addIncludePath(CONSOLE_APP_DIR)
+tests.addHeaders([pjoin(CONSOLE_APP_DIR + [file]) for file in GetSelectedFileList(CONSOLE_APP_DIR, HEADER_EXT)])
+tests.addSources([pjoin(CONSOLE_APP_DIR + [file]) for file in GetSelectedFileList(CONSOLE_APP_DIR, SOURCE_EXT) if file != 'main.cpp'])
+
 # Save to files
 tests.save(TESTS_DIR + [TESTS_DIR_NAME])
+
+########################
+# Benchmarks application
+########################
+
+benchmarks = QtProFile()
+SetCommonForAll(benchmarks, HEADLESS_LIBS_NAMES, [])
+SetCommonForApps(benchmarks, HEADLESS_LIBS_NAMES, [])
+
+# Qt modules to used in the project
+benchmarks.addQt(BENCHMARKS_QT_MODULES)
+benchmarks.delQt(HEADLESS_QT_MODULES_DEL)
+
+# Set name of the executable
+benchmarks.addTarget(BENCHMARKS_NAME)
+
+# Variable that qmake uses when generating a Makefile
+benchmarks.addConfig(CONSOLE_APP_CONFIG)
+benchmarks.delConfig(CONSOLE_APP_CONFIG_DEL)
+
+# Builds paths
+benchmarks.addObjectsDir(BUILD_TYPE_DIR + [OBJECTS_DIR_NAME] + [APPS_DIR_NAME] + [BENCHMARKS_NAME])
+benchmarks.addMocDir(BUILD_TYPE_DIR + [MOC_DIR_NAME] + [APPS_DIR_NAME] + [BENCHMARKS_NAME])
+benchmarks.addRccDir(BUILD_TYPE_DIR + [RCC_DIR_NAME] + [APPS_DIR_NAME] + [BENCHMARKS_NAME])
+benchmarks.addUiDir(BUILD_TYPE_DIR + [UI_DIR_NAME] + [APPS_DIR_NAME] + [BENCHMARKS_NAME])
+
+# List of files to be used in the project
+benchmarks.addHeaders(GetSelectedFileList(BENCHMARKS_DIR, HEADER_EXT))
+benchmarks.addSources(GetSelectedFileList(BENCHMARKS_DIR, SOURCE_EXT))
+
+# Save to files
+benchmarks.save(BENCHMARKS_DIR + [BENCHMARKS_DIR_NAME])
@@ -61,6 +61,8 @@ class QtProFile:
         if vars: self.addData('OTHER_FILES', '+=', vars)
     def addQt(self, vars):
         if vars: self.addData('QT', '+=', vars)
+    def delQt(self, vars):
+        if vars: self.addData('QT', '-=', vars)
 
     def addDefines(self, vars):
         if type(vars) is str:
@@ -24,10 +24,13 @@ CONSOLE_APP_SUFFIX          = 'Console'
 CONSOLE_APP_NAME            = APP_NAME + CONSOLE_APP_SUFFIX
 TESTS_SUFFIX                = 'Tests'
 TESTS_NAME                  = APP_NAME + TESTS_SUFFIX
+BENCHMARKS_SUFFIX           = 'Benchmarks'
+BENCHMARKS_NAME             = APP_NAME + BENCHMARKS_SUFFIX
 
 WINDOW_APP_FILE             = OsSpecificGui(WINDOW_APP_NAME)
 CONSOLE_APP_FILE            = OsSpecificCli(CONSOLE_APP_NAME)
 TESTS_FILE                  = OsSpecificCli(TESTS_NAME)
+BENCHMARKS_FILE             = OsSpecificCli(BENCHMARKS_NAME)
 
 APP_VERSION                 = Changelog().version()
 APP_RELEASE_DATE            = Changelog().date()
@@ -69,7 +72,8 @@ APPS_SUBDIRS                = [CONSOLE_APP_DIR_NAME, WINDOW_APP_DIR_NAME]
 
 # Modules and config
 WINDOW_APP_QT_MODULES       = 'core gui xml svg network widgets printsupport concurrent'.split()
-CONSOLE_APP_QT_MODULES      = 'concurrent'.split()
+CONSOLE_APP_QT_MODULES      = 'concurrent network'.split()
+ZLIB_QT_MODULES             = 'zlib-private'.split() # zlib bundled with Qt, to read the compressed input files
 CONSOLE_APP_CONFIG          = 'console'.split()
 CONSOLE_APP_CONFIG_DEL      = 'app_bundle'.split()
 LIBS_CONFIG                 = 'staticlib'
@@ -79,6 +83,8 @@ LIBS_DIR_NAME               = 'Libraries'
 MY_LIBS_PREFIX              = 'As'
 MY_LIBS_DIR_NAME            = 'Original'
 MY_LIBS_NAMES               = 'Core Widgets Diffraction DataTypes'.split() # order is important!
+HEADLESS_LIBS_NAMES         = 'Core Diffraction DataTypes'.split() # depend on QtCore only
+HEADLESS_QT_MODULES_DEL     = 'gui'.split()
 OTHER_LIBS_DIR_NAME         = '3rdParty'
 OTHER_LIBS_NAMES            = 'QCodeEditor QCustomPlot'.split()
 LIBS_DIR                    = PROJECT_DIR + [LIBS_DIR_NAME]
@@ -89,9 +95,15 @@ LIBS_SUBDIRS                = [OTHER_LIBS_DIR_NAME, MY_LIBS_DIR_NAME]
 # Tests
 TESTS_DIR_NAME              = 'Tests'
 TESTS_DIR                   = PROJECT_DIR + [TESTS_DIR_NAME]
+TESTS_REFERENCES_DIR_NAME   = 'References'
+
+# Benchmarks
+BENCHMARKS_DIR_NAME         = 'Benchmarks'
+BENCHMARKS_DIR              = PROJECT_DIR + [BENCHMARKS_DIR_NAME]
+BENCHMARKS_QT_MODULES       = 'concurrent'.split()
 
 # Global
-PROJECT_SUBDIRS             = [APPS_DIR_NAME, LIBS_DIR_NAME, TESTS_DIR_NAME]
+PROJECT_SUBDIRS             = [APPS_DIR_NAME, LIBS_DIR_NAME, TESTS_DIR_NAME, BENCHMARKS_DIR_NAME]
 
 # Resources
 RESOURCES_DIR_NAME          = 'Resources'
@@ -251,6 +263,10 @@ DEFINES_DICT                = {'APP_NAME':              APP_NAME,
                                'USERMANUAL_URL':        USERMANUAL_URL,
                                'ISSUETRACKER_URL':      ISSUETRACKER_URL}
 
+# Data used by the tests: qmake expands $$PWD to the directory of the tests pro file
+TESTS_DEFINES_DICT          = {'EXAMPLES_DIR':          '$$PWD/../' + EXAMPLES_DIR_NAME,
+                               'REFERENCES_DIR':        '$$PWD/' + TESTS_REFERENCES_DIR_NAME}
+
 # Add in release output of such information as %{function}, %{line}, %{message}, etc.
 DEFINES_MISC                = 'QT_MESSAGELOGCONTEXT'
 
@@ -0,0 +1,82 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFile>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include "catch.hpp"
+
+#include "ColumnarFile.hpp"
+#include "ResultTable.hpp"
+
+TEST_CASE( "As::ColumnarFile Class", "[As::ColumnarFile]" )
+{
+    As::ResultTable table;
+    table.setRowCount(3);
+    const int scan = table.appendColumn("Scan", "i", As::ResultTable::RealColumn);
+    const int sf2 = table.appendColumn("Sf2", "0.2f", As::ResultTable::RealColumn);
+    const int comment = table.appendColumn("Comment", "s", As::ResultTable::TextColumn);
+    for (int row = 0; row < 3; ++row) {
+        table.setReal(row, scan, row + 1);
+        table.setReal(row, sf2, 1.0 / 3.0 + row); }
+    table.setText(0, comment, "first");
+    table.setText(2, comment, QString::fromUtf8("\xce\xb1-phase"));
+
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString filePath = dir.path() + "/output." + As::ColumnarFile::EXTENSION;
+
+    SECTION("Round trip keeps the selected rows exactly") {
+        REQUIRE(As::ColumnarFile::save(filePath, table, { 0, 2 }));
+        As::ResultTable loaded;
+        REQUIRE(As::ColumnarFile::load(filePath, loaded));
+        REQUIRE(loaded.rowCount() == 2);
+        CHECK(loaded.headers() == table.headers());
+        CHECK(loaded.format(sf2) == "0.2f");
+        CHECK(loaded.columnType(comment) == As::ResultTable::TextColumn);
+        CHECK(loaded.real(1, scan) == 3);
+        CHECK(loaded.real(1, sf2) == 1.0 / 3.0 + 2);
+        CHECK(loaded.text(0, comment) == "first");
+        CHECK(loaded.text(1, comment) == QString::fromUtf8("\xce\xb1-phase")); }
+
+    SECTION("Columns are aligned and described in the header") {
+        REQUIRE(As::ColumnarFile::save(filePath, table, { 0, 1, 2 }));
+        QFile file(filePath);
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        CHECK(file.size() % 8 == 0);
+        const QByteArray content = file.readAll();
+        CHECK(content.startsWith(As::ColumnarFile::MAGIC));
+        CHECK(content.contains("\"type\":\"float64\""));
+        CHECK(content.contains("\"units\":\"arb.units\"")); }
+
+    SECTION("Corrupted file is rejected") {
+        QFile file(filePath);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write("DVCOLUMN but not really");
+        file.close();
+        As::ResultTable loaded;
+        CHECK_FALSE(As::ColumnarFile::load(filePath, loaded));
+        CHECK(loaded.columnCount() == 0); }
+
+    CHECK(As::ColumnarFile::columnGroup("Sf2") == "calculations");
+    CHECK(As::ColumnarFile::columnGroup("Unknown").isEmpty());
+}
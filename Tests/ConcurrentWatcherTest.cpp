@@ -0,0 +1,54 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QVector>
+
+#include "catch.hpp"
+
+#include "ConcurrentWatcher.hpp"
+
+TEST_CASE( "As::ConcurrentWatcher Class", "[As::ConcurrentWatcher]" )
+{
+    SECTION("Chunks cover every item once, heavy items first") {
+        QVector<qreal> costs(100, 1.);
+        costs[37] = 1000.;
+        costs[5] = 500.;
+        const QVector<QVector<int>> chunks = As::ConcurrentWatcher::chunkSequence(costs, 4);
+
+        REQUIRE(chunks.size() > 2);
+        CHECK(chunks[0] == QVector<int>{ 37 });
+        CHECK(chunks[1] == QVector<int>{ 5 });
+
+        QVector<int> count(costs.size(), 0);
+        for (const QVector<int>& chunk : chunks) {
+            for (const int i : chunk) {
+                ++count[i]; } }
+        CHECK(count == QVector<int>(costs.size(), 1)); }
+
+    SECTION("Light items are grouped") {
+        const QVector<qreal> costs(1000, 1.);
+        const QVector<QVector<int>> chunks = As::ConcurrentWatcher::chunkSequence(costs, 2);
+        CHECK(chunks.size() == 16);
+        CHECK(chunks[0].size() == 63); }
+
+    SECTION("Empty sequence") {
+        CHECK(As::ConcurrentWatcher::chunkSequence(QVector<qreal>(), 4).isEmpty()); }
+}
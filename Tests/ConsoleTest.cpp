@@ -0,0 +1,57 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDir>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "catch.hpp"
+
+#include "Console.hpp"
+
+TEST_CASE( "As::Console Class", "[As::Console]" )
+{
+    // Single file dataset: the 1st of 2 shards gets no files
+    As::Console::Job job;
+    job.path = QDir(EXAMPLES_DIR).filePath("5C2");
+    job.useCache = false;
+
+    QTemporaryDir outputDir;
+    REQUIRE(outputDir.isValid());
+
+    SECTION("Empty shard is exported and merged") {
+        job.output = outputDir.filePath("output");
+
+        QStringList shardPaths;
+        for (const QString& shard : QStringList{ "1/2", "2/2" }) {
+            job.shard = shard;
+            As::Console worker(job);
+            CHECK(worker.processJob(job));
+            shardPaths << worker.outputFileNameWithExt();
+            CHECK(QFileInfo(shardPaths.last()).exists()); }
+
+        As::Console::Job mergeJob;
+        mergeJob.output = outputDir.filePath("merged");
+        As::Console merger(mergeJob);
+        CHECK(merger.mergeShards(shardPaths));
+        CHECK(QFileInfo(merger.outputFileNameWithExt()).exists()); }
+}
@@ -0,0 +1,60 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QString>
+#include <QStringList>
+
+#include "catch.hpp"
+
+#include "Constants.hpp"
+
+#include "ScanArray.hpp"
+
+TEST_CASE( "Input file type detection", "[As::ScanArray]" )
+{
+    SECTION("Single file signatures") {
+        CHECK(As::ScanArray::detectFileType("### NICOS data file, created at 2017\n#") == As::NICOS_DAT);
+        CHECK(As::ScanArray::detectFileType("header\n  Rev HEIDI/FRM2\n") == As::HEIDI_DAT);
+        CHECK(As::ScanArray::detectFileType("Mon Jan 1 Protocol ON") == As::HEIDI_LOG);
+        CHECK(As::ScanArray::detectFileType("<data><manip>6T2</manip></data>") == As::S6T2_DAT);
+        CHECK(As::ScanArray::detectFileType("  => Now executing the cmd GEO 1") == As::POLI_LOG);
+        CHECK(As::ScanArray::detectFileType("") == As::UNKNOWN_FILE);
+        CHECK(As::ScanArray::detectFileType("text\nwithout\nsignature") == As::UNKNOWN_FILE); }
+
+    SECTION("The first matching line wins") {
+        CHECK(As::ScanArray::detectFileType("### NICOS data file\nRev HEIDI/FRM2") == As::NICOS_DAT); }
+
+    SECTION("Per-file types of the mixed files") {
+        As::ScanArray scans;
+        scans.m_inputFilesContents.first  << "a.dat" << "b.dat" << "c.log";
+        scans.m_inputFilesContents.second << "### NICOS data file" << "### NICOS data file" << "Protocol ON";
+
+        CHECK_FALSE(scans.detectInputFilesType());
+        REQUIRE(scans.inputFilesTypes().size() == 3);
+        CHECK(scans.inputFilesTypes()[0] == As::NICOS_DAT);
+        CHECK(scans.inputFilesTypes()[2] == As::HEIDI_LOG);
+
+        const QStringList report = scans.inputFilesTypesReport();
+        REQUIRE(report.size() == 2);
+        CHECK(report[0] == QString("POLI NICOS dat (2 files): a.dat, b.dat"));
+        CHECK(report[1] == QString("HEiDi DIF4 log (1 files): c.log")); }
+}
+
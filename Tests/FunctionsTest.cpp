@@ -18,6 +18,7 @@
  * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QString>
 #include <QVector>
 
 #include "catch.hpp"
@@ -37,5 +38,11 @@ TEST_CASE( "As::Functions", "[As::Functions]" )
         QVector<qreal> answer{   0.,  160., -180., -90., 0., 90., 180., -160.,   0.,  20.,  20.};
         for (int i = 0; i < value.size(); ++i)
             CHECK(As::ToMainAngularRange(value[i]) == Approx(answer[i])); }
+
+    SECTION("As::FormatNumber function") {
+        CHECK(As::FormatNumber(1.23456, "8.3f") == QString("   1.235"));
+        CHECK(As::FormatNumber(-2.6, "4i") == QString("  -3"));
+        CHECK(As::FormatNumber(0.1, "") == QString("0.10000000000000001"));
+        CHECK(As::FormatNumber(qQNaN(), "8.3f").isEmpty()); }
 }
 
@@ -0,0 +1,142 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtZlib/zlib.h>
+
+#include <cstring>
+
+
+#include "catch.hpp"
+
+#include "InputReader.hpp"
+
+// Gzip compressed data
+static QByteArray gzip(const QByteArray& data) {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+    QByteArray compressed(static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    deflate(&stream, Z_FINISH);
+    compressed.resize(static_cast<int>(stream.total_out));
+    deflateEnd(&stream);
+    return compressed; }
+
+// Tar archive with the given members, the header checksums are not needed by the reader
+static QByteArray tar(const QList<QPair<QByteArray, QByteArray>>& members) {
+    QByteArray archive;
+    for (const auto& member : members) {
+        QByteArray header(512, '\0');
+        std::memcpy(header.data(), member.first.constData(), static_cast<size_t>(member.first.size()));
+        const QByteArray size = QByteArray::number(member.second.size(), 8).rightJustified(11, '0');
+        std::memcpy(header.data() + 124, size.constData(), 11);
+        header[156] = '0';
+        archive += header + member.second;
+        archive += QByteArray((512 - member.second.size() % 512) % 512, '\0'); }
+    return archive + QByteArray(1024, '\0'); }
+
+// Zip archive with the single stored member
+static QByteArray zip(const QByteArray& name,
+                      const QByteArray& data) {
+    auto u16 = [](const int value) {
+        QByteArray bytes(2, '\0');
+        qToLittleEndian<quint16>(static_cast<quint16>(value), reinterpret_cast<uchar*>(bytes.data()));
+        return bytes; };
+    auto u32 = [](const quint32 value) {
+        QByteArray bytes(4, '\0');
+        qToLittleEndian<quint32>(value, reinterpret_cast<uchar*>(bytes.data()));
+        return bytes; };
+    const quint32 crc = static_cast<quint32>(crc32(0, reinterpret_cast<const Bytef*>(data.constData()), static_cast<uInt>(data.size())));
+
+    const QByteArray local = u32(0x04034b50) + u16(20) + u16(0) + u16(0) + u16(0) + u16(0) + u32(crc) +
+                             u32(data.size()) + u32(data.size()) + u16(name.size()) + u16(0) + name + data;
+    const QByteArray central = u32(0x02014b50) + u16(20) + u16(20) + u16(0) + u16(0) + u16(0) + u16(0) + u32(crc) +
+                               u32(data.size()) + u32(data.size()) + u16(name.size()) + u16(0) + u16(0) +
+                               u16(0) + u16(0) + u32(0) + u32(0) + name;
+    const QByteArray end = u32(0x06054b50) + u16(0) + u16(0) + u16(1) + u16(1) +
+                           u32(central.size()) + u32(local.size()) + u16(0);
+    return local + central + end; }
+
+static void write(const QString& filePath,
+                  const QByteArray& data) {
+    QFile file(filePath);
+    file.open(QIODevice::WriteOnly);
+    file.write(data); }
+
+TEST_CASE( "As::InputReader Class", "[As::InputReader]" )
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = QDir(dir.path()).absolutePath();
+
+    SECTION("Gzip compressed file keeps its name without the extension") {
+        write(path + "/scan_1.dat.gz", gzip("line 1\r\nline 2\n"));
+        QStringList paths;
+        QStringList contents;
+        QString error;
+        REQUIRE(As::InputReader::readFiles({ path + "/scan_1.dat.gz" }, paths, contents, error));
+        CHECK(paths == QStringList{ path + "/scan_1.dat" });
+        CHECK(contents == QStringList{ "line 1\nline 2\n" });
+        CHECK(As::InputReader::archivePath(path + "/scan_1.dat") == path + "/scan_1.dat.gz"); }
+
+    SECTION("Tar archive members are virtual files in the file order") {
+        write(path + "/plain.dat", "plain");
+        write(path + "/beamtime.tar.gz", gzip(tar({ { "data/scan_2.dat", "second" },
+                                                    { "data/scan_1.dat", QByteArray(1000, 'x') },
+                                                    { "data/.hidden", "hidden" } })));
+        QStringList paths;
+        QStringList contents;
+        QString error;
+        REQUIRE(As::InputReader::readFiles({ path + "/beamtime.tar.gz", path + "/plain.dat" }, paths, contents, error));
+        CHECK(paths == QStringList({ path + "/beamtime.tar.gz/data/scan_1.dat",
+                                     path + "/beamtime.tar.gz/data/scan_2.dat",
+                                     path + "/plain.dat" }));
+        CHECK(contents == QStringList({ QString(1000, 'x'), "second", "plain" }));
+        CHECK(As::InputReader::archivePath(paths[0]) == path + "/beamtime.tar.gz");
+        CHECK(As::InputReader::archivePath(paths[2]).isEmpty()); }
+
+    SECTION("Zip archive stored members") {
+        write(path + "/beamtime.zip", zip("scan_3.dat", "third"));
+        QList<As::InputReader::File> files;
+        QString error;
+        REQUIRE(As::InputReader::readFile(path + "/beamtime.zip", files, error));
+        REQUIRE(files.size() == 1);
+        CHECK(files[0].path == path + "/beamtime.zip/scan_3.dat");
+        CHECK(files[0].data == "third"); }
+
+    SECTION("Damaged archive is reported") {
+        write(path + "/broken.tar.gz", gzip(tar({ { "scan.dat", "data" } })).left(20));
+        QStringList paths;
+        QStringList contents;
+        QString error;
+        CHECK_FALSE(As::InputReader::readFiles({ path + "/broken.tar.gz" }, paths, contents, error));
+        CHECK(error.contains("broken.tar.gz")); }
+}
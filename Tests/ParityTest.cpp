@@ -0,0 +1,196 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include "Macros.hpp"
+
+#include "catch.hpp"
+
+#include "ConcurrentWatcher.hpp"
+#include "Scan.hpp"
+#include "ScanArray.hpp"
+#include "ScanDict.hpp"
+
+namespace {
+
+// Allowed absolute and relative deviations of the output columns from the reference,
+// the same for all the beam types. Columns which are not listed here should be identical.
+const QHash<QString, QPair<qreal, qreal>> COLUMN_TOLERANCES = {
+    { "Sf2",            { 1e-2, 1e-4 } },
+    { "Sf2Err",         { 1e-2, 1e-4 } },
+    { "IntMax",         { 1e-2, 1e-4 } },
+    { "IntMaxErr",      { 1e-2, 1e-4 } },
+    { "IntSum",         { 1e-2, 1e-4 } },
+    { "IntSumErr",      { 1e-2, 1e-4 } },
+    { "Area",           { 1e-2, 1e-4 } },
+    { "AreaErr",        { 1e-2, 1e-4 } },
+    { "AreaNorm",       { 1e-2, 1e-4 } },
+    { "AreaNormErr",    { 1e-2, 1e-4 } },
+    { "BkgNorm",        { 1e-4, 1e-4 } },
+    { "BkgNormErr",     { 1e-4, 1e-4 } },
+    { "Fwhm",           { 1e-4, 1e-4 } },
+    { "FwhmErr",        { 1e-4, 1e-4 } },
+    { "FR",             { 1e-4, 1e-4 } },
+    { "FRerr",          { 1e-4, 1e-4 } },
+    { "|FR-1|/FRerr",   { 1e-2, 1e-4 } },
+    { "S0X",            { 1e-5, 0. } },
+    { "S0Y",            { 1e-5, 0. } },
+    { "S0Z",            { 1e-5, 0. } },
+    { "S2X",            { 1e-5, 0. } },
+    { "S2Y",            { 1e-5, 0. } },
+    { "S2Z",            { 1e-5, 0. } } };
+
+// Runs the same processing stages as the console application for all the files
+// in the directory dirPath, and returns the output table in the General format
+QString runPipeline(const QString& dirPath,
+                    const int threadCount) {
+    As::ConcurrentWatcher::setThreadCount(threadCount);
+
+    As::ScanArray scans;
+    for (const QFileInfo& fileInfo : QDir(dirPath).entryInfoList(QDir::Files, QDir::Name)) {
+        QFile file(fileInfo.absoluteFilePath());
+        if (!file.open(QFile::ReadOnly | QFile::Text)) {
+            continue; }
+        QTextStream textStream(&file);
+        textStream.setAutoDetectUnicode(true);
+        textStream.setCodec("MacRoman");
+        scans.m_inputFilesContents.first  << fileInfo.absoluteFilePath();
+        scans.m_inputFilesContents.second << textStream.readAll(); }
+
+    QString output;
+
+    if (scans.detectInputFilesType()) {
+        for (const QString& type : QStringList{ "extract", "fill", "index", "treat" }) {
+            As::ConcurrentWatcher watcher;
+            watcher.startComputation(type, &scans); }
+
+        scans.createFullOutputTable();
+
+        QTemporaryDir outputDir;
+        const QString fileName = outputDir.filePath("output.csv");
+        scans.saveSelectedOutputColumns(fileName, "General");
+
+        QFile file(fileName);
+        if (file.open(QFile::ReadOnly | QFile::Text)) {
+            output = QString::fromUtf8(file.readAll()); } }
+
+    scans.clear();
+
+    As::ConcurrentWatcher::setThreadCount(0);
+
+    return output; }
+
+// Splits the General format output to the rows of cells
+QList<QStringList> parseOutput(const QString& output) {
+    QList<QStringList> rows;
+    for (const QString& line : output.split("\n", QString::SkipEmptyParts)) {
+        QStringList cells = line.split(";");
+        if (!cells.isEmpty() AND cells.last().trimmed().isEmpty()) {
+            cells.removeLast(); }
+        rows << cells; }
+    return rows; }
+
+// Returns true if the actual cell of the column header matches the reference one
+bool cellsMatch(const QString& header,
+                const QString& actual,
+                const QString& reference) {
+    if (actual.trimmed() == reference.trimmed()) {
+        return true; }
+
+    bool okActual, okReference;
+    const qreal a = actual.trimmed().toDouble(&okActual);
+    const qreal b = reference.trimmed().toDouble(&okReference);
+    if (!okActual OR !okReference) {
+        return false; }
+
+    QString name = header;
+    for (const QString& beamType : As::ScanDict::BEAM_TYPES) {
+        if (!beamType.isEmpty()) {
+            name.remove(beamType); } }
+
+    const QPair<qreal, qreal> tolerance = COLUMN_TOLERANCES.value(name, qMakePair(0., 0.));
+    return qAbs(a - b) <= tolerance.first + tolerance.second * qAbs(b); }
+
+}
+
+// The references are checked in, and a missing one fails the test. To create or update
+// the references after an intended change of the results, run the tests with the
+// environment variable DAVINCI_UPDATE_REFERENCES=1, review the new files and check them in.
+TEST_CASE( "Golden output parity of the Examples datasets", "[parity]" )
+{
+    const QDir examplesDir(EXAMPLES_DIR);
+    const QDir referencesDir(REFERENCES_DIR);
+    REQUIRE(examplesDir.exists());
+
+    for (const QString& name : examplesDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        INFO("Dataset: " << name.toStdString());
+
+        const QString multiThreaded = runPipeline(examplesDir.filePath(name), 0);
+        const QString singleThreaded = runPipeline(examplesDir.filePath(name), 1);
+        REQUIRE_FALSE(multiThreaded.isEmpty());
+
+        // The number of threads must not change the results at all
+        CHECK(singleThreaded.toStdString() == multiThreaded.toStdString());
+
+        const QString referencePath = referencesDir.filePath(name + ".csv");
+        QFile referenceFile(referencePath);
+
+        if (qEnvironmentVariableIsSet("DAVINCI_UPDATE_REFERENCES")) {
+            QDir().mkpath(referencesDir.path());
+            REQUIRE(referenceFile.open(QFile::WriteOnly | QFile::Text));
+            referenceFile.write(multiThreaded.toUtf8());
+            WARN("Reference written: " << QDir::toNativeSeparators(referencePath).toStdString());
+            continue; }
+
+        if (!referenceFile.exists()) {
+            FAIL("Reference is missing: " << QDir::toNativeSeparators(referencePath).toStdString()); }
+
+        REQUIRE(referenceFile.open(QFile::ReadOnly | QFile::Text));
+        const QList<QStringList> reference = parseOutput(QString::fromUtf8(referenceFile.readAll()));
+        const QList<QStringList> actual = parseOutput(multiThreaded);
+
+        REQUIRE(actual.size() == reference.size());
+        REQUIRE(actual.first().join(";").toStdString() == reference.first().join(";").toStdString());
+
+        const QStringList headers = reference.first();
+        QStringList mismatches;
+
+        for (int row = 1; row < reference.size(); ++row) {
+            for (int column = 0; column < headers.size(); ++column) {
+                const QString actualCell = actual[row].value(column);
+                const QString referenceCell = reference[row].value(column);
+                if (!cellsMatch(headers[column].trimmed(), actualCell, referenceCell)) {
+                    mismatches << QString("row %1, %2: '%3' instead of '%4'")
+                                  .arg(row).arg(headers[column].trimmed())
+                                  .arg(actualCell.trimmed()).arg(referenceCell.trimmed()); } } }
+
+        INFO(mismatches.mid(0, 20).join("\n").toStdString());
+        CHECK(mismatches.isEmpty()); }
+}
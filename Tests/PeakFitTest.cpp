@@ -0,0 +1,87 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QVector>
+#include <QtMath>
+
+#include "catch.hpp"
+
+#include "PeakFit.hpp"
+#include "Scan.hpp"
+
+TEST_CASE( "As::PeakFit Class", "[As::PeakFit]" )
+{
+    // Noise-free peak on a constant background: 41 points, step 0.05 deg
+    const qreal bkg = 10., amplitude = 200., position = 12.3, width = 0.4, mixing = 0.3;
+
+    QVector<qreal> x, sy;
+    for (int i = 0; i < 41; ++i) {
+        x << 11.3 + 0.05 * i;
+        sy << 1.; }
+
+    auto peak = [&] (const As::Scan::PeakFitType type) {
+        QVector<qreal> y;
+        for (const qreal xi : x) {
+            y << bkg + amplitude * As::PeakFit::profile(type, xi, position, width, mixing); }
+        return y; };
+
+    // Rough start, as given by the conventional integration
+    const QVector<qreal> start = { 12., 170., 12.25, 0.6, 0.5 };
+
+    SECTION("Profiles are normalised to the unit height and width") {
+        CHECK(As::PeakFit::profile(As::Scan::GaussFit, 1., 1., 2.) == Approx(1.));
+        CHECK(As::PeakFit::profile(As::Scan::GaussFit, 2., 1., 2.) == Approx(0.5));
+        CHECK(As::PeakFit::profile(As::Scan::LorentzFit, 0., 1., 2.) == Approx(0.5));
+        CHECK(As::PeakFit::areaFactor(As::Scan::LorentzFit) == Approx(M_PI / 2)); }
+
+    SECTION("Gaussian fit") {
+        As::PeakFit fit;
+        fit.setFitType(As::Scan::GaussFit);
+        CHECK(fit.fit(x, peak(As::Scan::GaussFit), sy, start));
+        CHECK(fit.parameter(As::PeakFit::Position) == Approx(position));
+        CHECK(fit.parameter(As::PeakFit::Width) == Approx(width));
+        CHECK(fit.parameter(As::PeakFit::Background) == Approx(bkg));
+        CHECK(fit.area() == Approx(amplitude * width * As::PeakFit::areaFactor(As::Scan::GaussFit)));
+        CHECK(qIsNaN(fit.parameter(As::PeakFit::Mixing))); }
+
+    SECTION("Pseudo-Voigt fit") {
+        As::PeakFit fit;
+        fit.setFitType(As::Scan::PseudoVoigtFit);
+        CHECK(fit.fit(x, peak(As::Scan::PseudoVoigtFit), sy, start));
+        CHECK(fit.parameter(As::PeakFit::Amplitude) == Approx(amplitude));
+        CHECK(fit.parameter(As::PeakFit::Mixing) == Approx(mixing).epsilon(1e-4));
+        CHECK(fit.areaError() < 1e-3); }
+
+    SECTION("Too few points") {
+        As::PeakFit fit;
+        CHECK_FALSE(fit.fit(x.mid(0, 3), peak(As::Scan::GaussFit).mid(0, 3), sy, start));
+        CHECK(qIsNaN(fit.chiSquared())); }
+
+    SECTION("Failed fit keeps no errors of the previous one") {
+        As::PeakFit fit;
+        fit.setFitType(As::Scan::GaussFit);
+        CHECK(fit.fit(x, peak(As::Scan::GaussFit), sy, start));
+        CHECK_FALSE(qIsNaN(fit.areaError()));
+        CHECK_FALSE(fit.fit(x.mid(0, 3), peak(As::Scan::GaussFit).mid(0, 3), sy, start));
+        CHECK(qIsNaN(fit.areaError()));
+        CHECK(qIsNaN(fit.error(As::PeakFit::Position))); }
+}
+
@@ -0,0 +1,108 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QVector>
+#include <QtMath>
+
+#include "catch.hpp"
+
+#include "ReflectionIndex.hpp"
+
+TEST_CASE( "As::ReflectionIndex Class", "[As::ReflectionIndex]" )
+{
+    const QVector<As::ReflectionIndex::Point> indices = {
+        {{  1.0, 0.0, -2.0 }},
+        {{  0.0, 0.0,  1.0 }},
+        {{  0.98, 0.01, -2.03 }},
+        {{ qQNaN(), 0.0, 0.0 }},
+        {{  1.0, 0.0, -2.0 }},
+        {{ -3.0, 4.0,  5.0 }},
+        {{  1.0, 0.0,  0.5 }} };
+
+    // Cubic lattice with a = 5 angstrom
+    QVector<As::ReflectionIndex::Point> coordinates;
+    for (const As::ReflectionIndex::Point& hkl : indices) {
+        coordinates << As::ReflectionIndex::Point{{ 0.2 * hkl[0], 0.2 * hkl[1], 0.2 * hkl[2] }}; }
+
+    As::ReflectionIndex index;
+
+    SECTION("Empty index finds nothing") {
+        REQUIRE(index.isEmpty());
+        REQUIRE(index.find(1, 0, -2).isEmpty());
+        REQUIRE(index.nearest({{ 0.0, 0.0, 0.0 }}, 1.0) == -1);
+        REQUIRE(index.duplicates().isEmpty()); }
+
+    SECTION("Items are found by their rounded indices") {
+        index.build(indices);
+        REQUIRE(index.size() == indices.size());
+        REQUIRE_FALSE(index.hasReciprocalCoordinates());
+        REQUIRE(index.find(1, 0, -2) == QVector<int>({ 0, 2, 4 }));
+        REQUIRE(index.find(0, 0, 1) == QVector<int>({ 1 }));
+        REQUIRE(index.find(-3, 4, 5) == QVector<int>({ 5 }));
+        REQUIRE(index.find(0, 0, 0).isEmpty());
+        REQUIRE(index.find(2, 0, -4).isEmpty()); }
+
+    SECTION("Satellites are not hashed with the integer reflections") {
+        index.build(indices, coordinates);
+        REQUIRE(index.find(1, 0, 1).isEmpty());
+        REQUIRE(index.find(1, 0, 0).isEmpty());
+        REQUIRE(index.nearest({{ 0.2, 0.0, 0.1 }}, 0.05) == 6); }
+
+    SECTION("Indices out of the packed range are not found") {
+        index.build(indices);
+        REQUIRE(index.find(1 << 20, 0, 0).isEmpty());
+        REQUIRE(index.find(0, -(1 << 21), 0).isEmpty()); }
+
+    SECTION("Duplicates are the repeated reflections") {
+        index.build(indices);
+        const QVector<QVector<int>> duplicates = index.duplicates();
+        REQUIRE(duplicates.size() == 1);
+        REQUIRE(duplicates.first() == QVector<int>({ 0, 2, 4 })); }
+
+    SECTION("Nearest item is found within the tolerance") {
+        index.build(indices, coordinates);
+        REQUIRE(index.hasReciprocalCoordinates());
+        REQUIRE(index.nearest({{ 0.0, 0.0, 0.21 }}, 0.05) == 1);
+        REQUIRE(index.nearest({{ -0.6, 0.8, 1.0 }}, 0.05) == 5);
+        REQUIRE(index.nearest({{ 0.0, 0.0, 0.3 }}, 0.05) == -1);
+        REQUIRE(index.nearest({{ 0.0, 0.0, 0.3 }}, 0.15) == 1); }
+
+    SECTION("Nearest search agrees with the brute force one") {
+        QVector<As::ReflectionIndex::Point> grid;
+        for (int h = -6; h <= 6; ++h) {
+            for (int k = -6; k <= 6; ++k) {
+                for (int l = -6; l <= 6; ++l) {
+                    grid << As::ReflectionIndex::Point{{ h + 0.01 * k, k - 0.02 * l, l + 0.03 * h }}; } } }
+        index.build(grid, grid);
+
+        const QVector<As::ReflectionIndex::Point> points = {
+            {{ 0.4, -2.7, 3.3 }}, {{ 5.9, 6.2, -6.1 }}, {{ -1.5, 0.5, 2.5 }}, {{ 10.0, 10.0, 10.0 }} };
+        for (const As::ReflectionIndex::Point& point : points) {
+            int expected = -1;
+            qreal expectedDistance2 = 1.0;
+            for (int i = 0; i < grid.size(); ++i) {
+                const qreal distance2 = qPow(point[0] - grid[i][0], 2) +
+                                        qPow(point[1] - grid[i][1], 2) +
+                                        qPow(point[2] - grid[i][2], 2);
+                if (distance2 < expectedDistance2) {
+                    expectedDistance2 = distance2;
+                    expected = i; } }
+            REQUIRE(index.nearest(point, 1.0) == expected); } }
+}
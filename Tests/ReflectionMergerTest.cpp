@@ -0,0 +1,101 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QStringList>
+#include <QVector>
+#include <QtMath>
+
+#include "catch.hpp"
+
+#include "ReflectionMerger.hpp"
+#include "ResultTable.hpp"
+
+#include "TestTables.hpp"
+
+// Miller indices and structure factors of the unpolarised beam
+static const QStringList COLUMNS = { "H", "K", "L", "Sf2", "Sf2Err" };
+
+TEST_CASE( "As::ReflectionMerger Class", "[As::ReflectionMerger]" )
+{
+    As::ReflectionMerger merger;
+
+    SECTION("Groups have their orders") {
+        const QVector<int> orders = { 2, 4, 8, 8, 16, 6, 12, 12, 12, 24, 24, 48,
+                                      1, 2, 4, 4, 8, 3, 6, 6, 6, 12, 12, 24 };
+        const QStringList names = As::ReflectionMerger::groupNames();
+        REQUIRE(names.size() == orders.size());
+        for (int i = 0; i < names.size(); ++i) {
+            REQUIRE(merger.setGroup(names[i]));
+            CHECK(merger.operationCount() == orders[i]); }
+        CHECK_FALSE(merger.setGroup("P21/c")); }
+
+    SECTION("Canonical indices are the same for the equivalent reflections") {
+        REQUIRE(merger.setGroup("m-3m"));
+        int h = -1, k = 3, l = -2;
+        merger.canonicalIndices(h, k, l);
+        CHECK(h == 3);
+        CHECK(k == 2);
+        CHECK(l == 1);
+
+        REQUIRE(merger.setGroup("-3m1"));
+        CHECK(merger.canonicalKey(1, 2, 3) == merger.canonicalKey(2, 1, -3));
+        CHECK(merger.canonicalKey(1, 2, 3) != merger.canonicalKey(2, 1, 3));
+
+        REQUIRE(merger.setGroup("2"));
+        CHECK(merger.canonicalKey(1, 2, 3) == merger.canonicalKey(-1, 2, -3));
+        CHECK(merger.canonicalKey(1, 2, 3) != merger.canonicalKey(-1, -2, -3));
+        CHECK(merger.canonicalKey(0.5, 0, 0) == As::ReflectionMerger::INVALID_KEY); }
+
+    SECTION("Equivalent observations are averaged with their weights") {
+        const As::ResultTable table = makeTable(COLUMNS, { { 1, 0, 0, 100, 10 },
+                                                           { 0, 0, 2, 50, 5 },
+                                                           { -1, 0, 0, 110, 10 },
+                                                           { 0, 1, 0, 90, 5 },
+                                                           { 0.5, 0, 0, 1, 1 } });
+        REQUIRE(merger.setGroup("mmm"));
+        As::ResultTable merged;
+        REQUIRE(merger.merge(table, allRows(table), merged));
+        CHECK(merger.skippedCount() == 1);
+        REQUIRE(merged.rowCount() == 3);
+
+        // Sorted by the canonical indices: (0,0,2), (0,1,0), (1,0,0)
+        CHECK(merged.real(0, merged.columnIndex("L")) == 2);
+        CHECK(merged.real(1, merged.columnIndex("K")) == 1);
+        const int row = 2;
+        CHECK(merged.real(row, merged.columnIndex("H")) == 1);
+        CHECK(merged.real(row, merged.columnIndex("Sf2")) == Approx(105));
+        CHECK(merged.real(row, merged.columnIndex("Sf2Err")) == Approx(10 / qSqrt(2)));
+        CHECK(merged.real(row, merged.columnIndex("Multiplicity")) == 2);
+        CHECK(merged.real(row, merged.columnIndex("Rint")) == Approx(10. / 210));
+        CHECK(merged.real(row, merged.columnIndex("Chi2")) == Approx(0.5));
+        CHECK(qIsNaN(merged.real(0, merged.columnIndex("Rint"))));
+
+        REQUIRE(merger.statistics().size() == 1);
+        CHECK(merger.statistics()[0].observationCount == 4);
+        CHECK(merger.statistics()[0].uniqueCount == 3);
+        CHECK(merger.statistics()[0].rInt == Approx(10. / 210)); }
+
+    SECTION("Table without structure factors is rejected") {
+        As::ResultTable table;
+        table.setRowCount(1);
+        table.appendColumn("H", "0.3f", As::ResultTable::RealColumn);
+        As::ResultTable merged;
+        CHECK_FALSE(merger.merge(table, { 0 }, merged)); }
+}
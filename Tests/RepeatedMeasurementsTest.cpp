@@ -0,0 +1,110 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QStringList>
+#include <QVector>
+#include <QtMath>
+
+#include "catch.hpp"
+
+#include "RepeatedMeasurements.hpp"
+#include "ResultTable.hpp"
+
+#include "TestTables.hpp"
+
+// Miller indices, temperatures and structure factors of the unpolarised beam
+static const QStringList COLUMNS = { "H", "K", "L", "Temperature", "Sf2", "Sf2Err" };
+
+TEST_CASE( "As::RepeatedMeasurements Class", "[As::RepeatedMeasurements]" )
+{
+    // Reflection 1 0 -2 is measured twice at 2 K and once at 100 K, 0 0 1 twice at 2 K
+    As::ResultTable table = makeTable(COLUMNS, {
+        {  1, 0, -2,   2.0, 100, 10 },
+        {  0, 0,  1,   2.0,  50,  5 },
+        {  2, 2,  0,   2.0,  70,  7 },
+        {  1, 0, -2, 100.0,  40,  4 },
+        {  1, 0, -2,   2.2, 110, 10 },
+        {  0, 0,  1,   1.9,  60, 10 } });
+
+    As::RepeatedMeasurements repeats;
+    REQUIRE(repeats.group(table, allRows(table)));
+
+    SECTION("Repeats are grouped by indices and conditions") {
+        REQUIRE(repeats.groups().size() == 2);
+        REQUIRE(repeats.groups().at(0) == QVector<int>({ 0, 4 }));
+        REQUIRE(repeats.groups().at(1) == QVector<int>({ 1, 5 }));
+        REQUIRE(repeats.repeatCount() == 2); }
+
+    SECTION("Only the given rows are grouped") {
+        REQUIRE(repeats.group(table, QVector<int>({ 0, 1, 2, 3, 5 })));
+        REQUIRE(repeats.groups().size() == 1);
+        REQUIRE(repeats.groups().at(0) == QVector<int>({ 1, 5 })); }
+
+    SECTION("Repeats are linked in the table") {
+        repeats.link(table);
+        const int repeat = table.columnIndex("Repeat");
+        const int count = table.columnIndex("Repeats");
+        REQUIRE(repeat >= 0);
+        REQUIRE(count >= 0);
+        REQUIRE(table.real(0, repeat) == 1);
+        REQUIRE(table.real(4, repeat) == 1);
+        REQUIRE(table.real(1, repeat) == 2);
+        REQUIRE(table.real(5, count) == 2);
+        REQUIRE(qIsNaN(table.real(2, repeat)));
+        REQUIRE(qIsNaN(table.real(3, repeat))); }
+
+    SECTION("Table without repeats is not changed") {
+        As::ResultTable unique = makeTable(COLUMNS, { { 1, 0, 0, 2.0, 10, 1 }, { 0, 1, 0, 2.0, 20, 2 } });
+        REQUIRE(repeats.group(unique, allRows(unique)));
+        repeats.link(unique);
+        REQUIRE(unique.columnIndex("Repeat") < 0); }
+
+    SECTION("All measurements are kept") {
+        REQUIRE(repeats.apply(table, allRows(table), As::RepeatedMeasurements::KeepAll) == allRows(table)); }
+
+    SECTION("Latest measurements are kept") {
+        REQUIRE(repeats.apply(table, allRows(table), As::RepeatedMeasurements::KeepLatest) == QVector<int>({ 2, 3, 4, 5 }));
+        REQUIRE(table.real(4, table.columnIndex("Sf2")) == Approx(110)); }
+
+    SECTION("Repeats are averaged with the weights 1/error^2") {
+        REQUIRE(repeats.apply(table, allRows(table), As::RepeatedMeasurements::Average) == QVector<int>({ 2, 3, 4, 5 }));
+        const int sf2 = table.columnIndex("Sf2");
+        const int sf2Err = table.columnIndex("Sf2Err");
+        REQUIRE(table.real(4, sf2) == Approx(105));
+        REQUIRE(table.real(4, sf2Err) == Approx(10 / qSqrt(2)));
+        REQUIRE(table.real(5, sf2) == Approx((50 / 25. + 60 / 100.) / (1 / 25. + 1 / 100.)));
+        REQUIRE(table.real(0, sf2) == Approx(100)); }
+
+    SECTION("Satellites are not repeats of the integer reflections") {
+        As::ResultTable satellites = makeTable(COLUMNS, {
+            { 1, 0, 1,    2.0, 100, 10 },
+            { 1, 0, 0.5,  2.0,  20,  2 },
+            { 1, 0, 0,    2.0,  80,  8 },
+            { 1, 0, 0.3,  2.0,  10,  1 },
+            { 1, 0, -0.3, 2.0,  12,  1 } });
+        REQUIRE(repeats.group(satellites, allRows(satellites)));
+        REQUIRE(repeats.groups().isEmpty());
+        REQUIRE(repeats.skippedCount() == 3);
+        REQUIRE(repeats.apply(satellites, allRows(satellites), As::RepeatedMeasurements::KeepLatest) == allRows(satellites)); }
+
+    SECTION("Table without indices cannot be grouped") {
+        As::ResultTable empty;
+        REQUIRE_FALSE(repeats.group(empty, QVector<int>())); }
+}
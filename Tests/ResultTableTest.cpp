@@ -0,0 +1,116 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QString>
+#include <QVector>
+
+#include "catch.hpp"
+
+#include "ResultTable.hpp"
+
+TEST_CASE( "As::ResultTable Class", "[As::ResultTable]" )
+{
+    As::ResultTable table;
+    table.setRowCount(3);
+    const int real = table.appendColumn("Sf2", "8.2f", As::ResultTable::RealColumn);
+    const int text = table.appendColumn("Date", "s", As::ResultTable::TextColumn);
+
+    SECTION("Columns lookup") {
+        CHECK(table.columnCount() == 2);
+        CHECK(table.columnIndex("Sf2") == real);
+        CHECK(table.columnIndex("Date") == text);
+        CHECK(table.columnIndex("Missing") == -1); }
+
+    SECTION("Real cells keep the full precision") {
+        CHECK(qIsNaN(table.real(1, real)));
+        table.setReal(1, real, 0.123456789012345);
+        CHECK(table.real(1, real) == 0.123456789012345);
+        CHECK(table.printCell(1, real) == QString("    0.12"));
+        CHECK(table.printCell(1, real, "10.6f") == QString("  0.123457"));
+        CHECK(table.printCell(0, real).isEmpty()); }
+
+    SECTION("Text cells") {
+        table.setText(2, text, "abc");
+        CHECK(table.text(2, text) == QString("abc"));
+        CHECK(table.text(0, text).isEmpty()); }
+
+    SECTION("Copied real columns") {
+        table.setReal(0, real, 1.);
+        As::ResultTable copy;
+        copy.setRowCount(3);
+        const int column = copy.appendColumn("Sf2", "8.2f", table.realColumn(real));
+        table.setReal(0, real, 2.);
+        CHECK(copy.real(0, column) == 1.);
+        CHECK(table.real(0, real) == 2.); }
+
+    SECTION("Detached copy") {
+        table.setReal(0, real, 1.5);
+        As::ResultTable copy = table;
+        copy.detach();
+        CHECK(copy.realColumn(real).constData() != table.realColumn(real).constData());
+        copy.setReal(0, real, 2.5);
+        copy.setReal(2, real, 3.5);
+        CHECK(copy.real(0, real) == 2.5);
+        CHECK(copy.real(2, real) == 3.5);
+        CHECK(table.real(0, real) == 1.5);
+        CHECK(qIsNaN(table.real(2, real))); }
+
+    SECTION("Resizing") {
+        table.setReal(0, real, 1.);
+        table.setRowCount(5);
+        CHECK(table.rowCount() == 5);
+        CHECK(table.real(0, real) == 1.);
+        CHECK(qIsNaN(table.real(4, real))); }
+
+    SECTION("Appended rows are matched by column name") {
+        table.setReal(0, real, 1.);
+        As::ResultTable other;
+        other.setRowCount(2);
+        const int otherText = other.appendColumn("Date", "s", As::ResultTable::TextColumn);
+        other.appendColumn("Extra", "i", As::ResultTable::RealColumn);
+        other.setText(1, otherText, "xyz");
+        table.appendRows(other);
+        CHECK(table.rowCount() == 5);
+        CHECK(table.columnCount() == 2);
+        CHECK(table.real(0, real) == 1.);
+        CHECK(qIsNaN(table.real(4, real)));
+        CHECK(table.text(4, text) == QString("xyz")); }
+
+    SECTION("Binary round trip") {
+        table.setReal(1, real, 0.123456789012345);
+        table.setText(2, text, "abc");
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        QDataStream out(&buffer);
+        table.writeTo(out);
+        buffer.seek(0);
+        QDataStream in(&buffer);
+        As::ResultTable copy;
+        CHECK(copy.readFrom(in));
+        CHECK(copy.rowCount() == 3);
+        CHECK(copy.headers() == table.headers());
+        CHECK(copy.format(real) == QString("8.2f"));
+        CHECK(copy.columnType(text) == As::ResultTable::TextColumn);
+        CHECK(copy.real(1, real) == 0.123456789012345);
+        CHECK(copy.text(2, text) == QString("abc")); }
+}
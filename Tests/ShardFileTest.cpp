@@ -0,0 +1,120 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QList>
+#include <QString>
+#include <QtMath>
+
+#include "catch.hpp"
+
+#include "ResultTable.hpp"
+#include "Scan.hpp"
+#include "ShardFile.hpp"
+
+// Shard of the dataset with one scan per file, numbered within the shard
+static As::ShardFile makeShard(const int index,
+                               const int count,
+                               const int fileCount) {
+    As::ShardFile shard;
+    shard.index = index;
+    shard.count = count;
+    shard.fileCount = fileCount;
+
+    int first = 0;
+    int last = 0;
+    As::ShardFile::fileRange(fileCount, index, count, first, last);
+    shard.firstFileIndex = first;
+
+    shard.table.setRowCount(last - first);
+    const int scan = shard.table.appendColumn("Scan", "i", As::ResultTable::RealColumn);
+    const int file = shard.table.appendColumn("File", "i", As::ResultTable::RealColumn);
+    for (int row = 0; row < last - first; ++row) {
+        shard.table.setReal(row, scan, row + 1);
+        shard.table.setReal(row, file, first + row); }
+
+    return shard; }
+
+TEST_CASE( "As::ShardFile Class", "[As::ShardFile]" )
+{
+    SECTION("Shard specification") {
+        int index = 0;
+        int count = 0;
+        CHECK(As::ShardFile::parseSpec("2/8", index, count));
+        CHECK(index == 2);
+        CHECK(count == 8);
+        CHECK_FALSE(As::ShardFile::parseSpec("0/8", index, count));
+        CHECK_FALSE(As::ShardFile::parseSpec("9/8", index, count));
+        CHECK_FALSE(As::ShardFile::parseSpec("2", index, count)); }
+
+    SECTION("Partition covers every file once") {
+        for (int count = 1; count <= 7; ++count) {
+            int expected = 0;
+            for (int index = 1; index <= count; ++index) {
+                int first = 0;
+                int last = 0;
+                As::ShardFile::fileRange(5, index, count, first, last);
+                CHECK(first == expected);
+                CHECK(last >= first);
+                expected = last; }
+            CHECK(expected == 5); } }
+
+    SECTION("Merge keeps the file order and numbers the scans anew") {
+        const QList<As::ShardFile> shards = { makeShard(3, 3, 7), makeShard(1, 3, 7), makeShard(2, 3, 7) };
+        As::ShardFile merged;
+        QString error;
+        CHECK(As::ShardFile::merge(shards, merged, error));
+        REQUIRE(merged.table.rowCount() == 7);
+        const int scan = merged.table.columnIndex("Scan");
+        const int file = merged.table.columnIndex("File");
+        for (int row = 0; row < 7; ++row) {
+            CHECK(merged.table.real(row, scan) == row + 1);
+            CHECK(merged.table.real(row, file) == row); } }
+
+    SECTION("Merge takes the union of the columns without the missing results") {
+        QList<As::ShardFile> shards = { makeShard(1, 2, 4), makeShard(2, 2, 4) };
+        const QString area = As::Scan::resultName(As::Scan::PeakArea);
+        const QString fitArea = As::Scan::resultName(As::Scan::FitPeakArea);
+        for (As::ShardFile& shard : shards) {
+            shard.table.appendColumn(area, "f", As::ResultTable::RealColumn);
+            shard.table.appendColumn(fitArea, "f", As::ResultTable::RealColumn); }
+        const int extra = shards[1].table.appendColumn("Extra", "i", As::ResultTable::RealColumn);
+        shards[1].table.setReal(0, extra, 5);
+        shards[1].table.setReal(0, shards[1].table.columnIndex(area), 1.5);
+
+        As::ShardFile merged;
+        QString error;
+        CHECK(As::ShardFile::merge(shards, merged, error));
+        REQUIRE(merged.table.rowCount() == 4);
+        CHECK(merged.table.columnIndex(fitArea) < 0);
+        REQUIRE(merged.table.columnIndex("Extra") >= 0);
+        REQUIRE(merged.table.columnIndex(area) >= 0);
+        CHECK(qIsNaN(merged.table.real(0, merged.table.columnIndex("Extra"))));
+        CHECK(merged.table.real(2, merged.table.columnIndex("Extra")) == 5);
+        CHECK(qIsNaN(merged.table.real(0, merged.table.columnIndex(area))));
+        CHECK(merged.table.real(2, merged.table.columnIndex(area)) == 1.5); }
+
+    SECTION("Incomplete shards are rejected") {
+        const QList<As::ShardFile> shards = { makeShard(1, 3, 7), makeShard(3, 3, 7) };
+        As::ShardFile merged;
+        QString error;
+        CHECK_FALSE(As::ShardFile::merge(shards, merged, error));
+        CHECK_FALSE(error.isEmpty()); }
+}
@@ -0,0 +1,49 @@
+/*
+ * Davinci, a software for the single-crystal diffraction data reduction.
+ * Copyright (C) 2015-2017 Andrew Sazonov
+ *
+ * This file is part of Davinci.
+ *
+ * Davinci is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Davinci is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Davinci.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AS_TESTS_TESTTABLES_HPP
+#define AS_TESTS_TESTTABLES_HPP
+
+#include <QStringList>
+#include <QVector>
+
+#include "ResultTable.hpp"
+
+// Output table with the real columns of the given headers, e.g. the Miller indices and
+// the structure factors, filled in row by row with the given values
+inline As::ResultTable makeTable(const QStringList& headers,
+                                 const QVector<QVector<qreal>>& values) {
+    As::ResultTable table;
+    table.setRowCount(values.size());
+    for (const QString& header : headers) {
+        table.appendColumn(header, "0.3f", As::ResultTable::RealColumn); }
+    for (int row = 0; row < values.size(); ++row) {
+        for (int column = 0; column < headers.size(); ++column) {
+            table.setReal(row, column, values[row][column]); } }
+    return table; }
+
+// Indices of all the rows of the table
+inline QVector<int> allRows(const As::ResultTable& table) {
+    QVector<int> rows;
+    for (int row = 0; row < table.rowCount(); ++row) {
+        rows << row; }
+    return rows; }
+
+#endif // AS_TESTS_TESTTABLES_HPP